@@ -0,0 +1,243 @@
+// Load test for AsyncClassifier: relay producer threads submit as fast as
+// the lanes accept (or at --rate) while a block thread submits a block's
+// worth of transactions on the Block lane every --block-ms. Reports accepted
+// throughput, backpressure signals and end-to-end latency (submit to
+// callback) per lane, next to the single-thread synchronous classify rate.
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/bench_async.cpp src/buds_async.cpp src/buds_tagger.cpp
+//       src/buds_tx.cpp src/buds_hex.cpp src/buds_labels.cpp src/buds_script.cpp
+//       src/buds_threadpool.cpp src/buds_registry.cpp src/buds_json.cpp src/buds_entropy.cpp
+//       src/buds_metrics.cpp -o bench-async
+//   ./bench-async [--producers N] [--threads N] [--seconds S] [--rate TX/S]
+//                 [--block-txs N] [--block-ms MS] [--capacity N]
+//
+// --rate caps the combined relay submission rate (0, the default, means
+// unbounded: the pool is saturated and relay latency is dominated by
+// queueing). A rejected relay submission is retried after a yield, as a
+// network thread would after backing off.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buds_async.h"
+#include "buds_metrics.h"
+
+using namespace buds;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Bytes = std::vector<std::uint8_t>;
+
+double secondsSince(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void putLE(Bytes& out, std::uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+void putVarInt(Bytes& out, std::uint64_t v) {
+    if (v < 0xfd) {
+        out.push_back(static_cast<std::uint8_t>(v));
+    } else {
+        out.push_back(0xfd);
+        putLE(out, v, 2);
+    }
+}
+
+void putRandom(Bytes& out, std::size_t n, std::uint32_t& seed) {
+    putVarInt(out, n);
+    for (std::size_t i = 0; i < n; ++i) out.push_back(static_cast<std::uint8_t>(nextRand(seed) >> 5));
+}
+
+// Segwit spend of one input to two P2WPKH outputs; `blob` > 0 adds a
+// random witness item of that size (obfuscated data, dispatched alone
+// once it exceeds AsyncOptions::smallTxBytes).
+Bytes makeTx(std::size_t blob, std::uint32_t& seed) {
+    Bytes tx;
+    putLE(tx, 2, 4);
+    tx.push_back(0x00);
+    tx.push_back(0x01);
+    putVarInt(tx, 1);
+    for (int i = 0; i < 36; ++i) tx.push_back(static_cast<std::uint8_t>(nextRand(seed)));
+    putVarInt(tx, 0);
+    putLE(tx, 0xfffffffd, 4);
+    putVarInt(tx, 2);
+    for (int o = 0; o < 2; ++o) {
+        putLE(tx, 1000 + nextRand(seed) % 100000, 8);
+        putVarInt(tx, 22);
+        tx.push_back(0x00);
+        tx.push_back(0x14);
+        for (int i = 0; i < 20; ++i) tx.push_back(static_cast<std::uint8_t>(nextRand(seed)));
+    }
+    putVarInt(tx, blob ? 3 : 2);
+    putRandom(tx, 72, seed);
+    putRandom(tx, 33, seed);
+    if (blob) putRandom(tx, blob, seed);
+    putLE(tx, 0, 4);
+    return tx;
+}
+
+// Relay traffic: mostly plain payments, one in ten carries a 6 KB blob.
+std::vector<Bytes> makeCorpus(std::size_t n, std::uint32_t seed) {
+    std::vector<Bytes> out;
+    out.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) out.push_back(makeTx(i % 10 == 9 ? 6000 : 0, seed));
+    return out;
+}
+
+// Lock-free histogram fed from pool workers.
+struct SharedHistogram {
+    std::array<std::atomic<std::uint64_t>, LatencyHistogram::kBuckets> counts{};
+    std::atomic<std::uint64_t> sumNs{0};
+
+    void record(Clock::time_point start) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        std::uint64_t v = ns > 0 ? static_cast<std::uint64_t>(ns) : 0;
+        counts[LatencyHistogram::bucketFor(v)].fetch_add(1, std::memory_order_relaxed);
+        sumNs.fetch_add(v, std::memory_order_relaxed);
+    }
+    LatencyHistogram snapshot() const {
+        LatencyHistogram h;
+        for (std::size_t b = 0; b < LatencyHistogram::kBuckets; ++b) {
+            if (std::uint64_t n = counts[b].load(std::memory_order_relaxed)) h.add(b, n, 0);
+        }
+        h.add(0, 0, sumNs.load(std::memory_order_relaxed));
+        return h;
+    }
+};
+
+double us(std::uint64_t ns) { return static_cast<double>(ns) / 1e3; }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t producers = 4;
+    std::size_t threads = 0;
+    double seconds = 3.0;
+    double rate = 0;
+    std::size_t blockTxs = 2000;
+    std::size_t blockMs = 250;
+    AsyncOptions opts;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* flag = argv[i];
+        const char* value = argv[i + 1];
+        if (!std::strcmp(flag, "--producers")) producers = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(flag, "--threads")) threads = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(flag, "--seconds")) seconds = std::atof(value);
+        else if (!std::strcmp(flag, "--rate")) rate = std::atof(value);
+        else if (!std::strcmp(flag, "--block-txs")) blockTxs = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(flag, "--block-ms")) blockMs = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(flag, "--capacity")) opts.capacity = std::strtoul(value, nullptr, 10);
+        else {
+            std::fprintf(stderr, "unknown option %s\n", flag);
+            return 2;
+        }
+    }
+    producers = producers ? producers : 1;
+
+    TagEngine engine;
+    std::vector<Bytes> corpus = makeCorpus(4096, 0x2545f491u);
+    std::vector<Bytes> block = makeCorpus(blockTxs ? blockTxs : 1, 0x9e3779b9u);
+
+    // Synchronous single-thread baseline.
+    Classification c;
+    std::size_t syncTxs = 0;
+    auto t0 = Clock::now();
+    while (secondsSince(t0) < 0.5) {
+        for (const auto& raw : corpus) engine.classify(ByteSpan(raw), c);
+        syncTxs += corpus.size();
+    }
+    double syncRate = syncTxs / secondsSince(t0);
+
+    ThreadPool pool(threads);
+    AsyncClassifier async(engine, pool, opts);
+    SharedHistogram latency[kLaneCount];
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> retries{0};
+
+    auto submitTimed = [&](const Bytes& raw, Lane lane) {
+        SharedHistogram* h = &latency[static_cast<std::size_t>(lane)];
+        Bytes copy = raw;
+        for (;;) {
+            SubmitStatus s = async.trySubmit(copy, lane, [h, start = Clock::now()](AsyncResult&&) {
+                h->record(start);
+            });
+            if (accepted(s) || s == SubmitStatus::Closed) return;
+            retries.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    };
+
+    std::vector<std::thread> relay;
+    for (std::size_t p = 0; p < producers; ++p) {
+        relay.emplace_back([&, p] {
+            auto interval = rate > 0 ? std::chrono::duration<double>(producers / rate)
+                                     : std::chrono::duration<double>(0);
+            auto next = Clock::now();
+            for (std::size_t i = p; !stop.load(std::memory_order_relaxed); i += producers) {
+                submitTimed(corpus[i % corpus.size()], Lane::Relay);
+                if (rate > 0) {
+                    next += std::chrono::duration_cast<Clock::duration>(interval);
+                    std::this_thread::sleep_until(next);
+                }
+            }
+        });
+    }
+    std::thread blocks([&] {
+        while (!stop.load(std::memory_order_relaxed) && blockTxs) {
+            for (const auto& raw : block) submitTimed(raw, Lane::Block);
+            std::this_thread::sleep_for(std::chrono::milliseconds(blockMs));
+        }
+    });
+
+    t0 = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto& t : relay) t.join();
+    blocks.join();
+    async.close();
+    double elapsed = secondsSince(t0);
+
+    AsyncStats st = async.stats();
+    std::uint64_t completed = st.lanes[0].completed + st.lanes[1].completed;
+    std::printf("pool %zu threads, %zu relay producers, lane capacity %zu, %s relay load\n", pool.size(),
+                producers, async.options().capacity, rate > 0 ? "paced" : "unbounded");
+    std::printf("sync classify (1 thread): %.0f tx/s\n", syncRate);
+    std::printf("async completed:          %.0f tx/s (%llu tx in %.2f s)\n", completed / elapsed,
+                static_cast<unsigned long long>(completed), elapsed);
+    std::printf("batches: %llu, %.1f tx/batch, %.0f%% of txs batched; %llu retries after Full\n",
+                static_cast<unsigned long long>(st.batches),
+                st.batches ? static_cast<double>(completed) / st.batches : 0.0,
+                completed ? 100.0 * st.batchedTxs / completed : 0.0,
+                static_cast<unsigned long long>(retries.load()));
+    std::printf("%-6s %10s %10s %9s %9s %10s %10s %10s %10s\n", "lane", "completed", "backlogged",
+                "rejected", "max depth", "p50 us", "p99 us", "p99.9 us", "mean us");
+    for (std::size_t l = 0; l < kLaneCount; ++l) {
+        const LaneStats& ls = st.lanes[l];
+        LatencyHistogram h = latency[l].snapshot();
+        std::printf("%-6s %10llu %10llu %9llu %9zu %10.1f %10.1f %10.1f %10.1f\n",
+                    laneName(static_cast<Lane>(l)), static_cast<unsigned long long>(ls.completed),
+                    static_cast<unsigned long long>(ls.backlogged),
+                    static_cast<unsigned long long>(ls.rejected), ls.maxDepth, us(h.quantile(0.5)),
+                    us(h.quantile(0.99)), us(h.quantile(0.999)),
+                    h.count() ? us(h.sumNs()) / h.count() : 0.0);
+    }
+    return 0;
+}
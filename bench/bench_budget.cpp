@@ -0,0 +1,181 @@
+// Benchmark: per-transaction evaluate() latency on adversarial input shapes,
+// unbudgeted versus with a WorkBudget, as seen by an admission thread.
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/bench_budget.cpp src/buds_tagger.cpp src/buds_tx.cpp
+//       src/buds_hex.cpp src/buds_labels.cpp src/buds_script.cpp src/buds_threadpool.cpp
+//       src/buds_registry.cpp src/buds_json.cpp src/buds_entropy.cpp -o bench-budget
+//   ./bench-budget [calls per shape]    (default 2000)
+//
+// Each shape is a consensus-valid serialization of up to ~400 KB. Latency
+// includes parsing, which is linear in the transaction size and not charged
+// against the budget; the budget bounds the detector work on top of it.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "buds_tagger.h"
+
+using namespace buds;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void putLE(std::vector<std::uint8_t>& out, std::uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+void putVarInt(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    if (v < 0xfd) {
+        out.push_back(static_cast<std::uint8_t>(v));
+    } else if (v <= 0xffff) {
+        out.push_back(0xfd);
+        putLE(out, v, 2);
+    } else {
+        out.push_back(0xfe);
+        putLE(out, v, 4);
+    }
+}
+
+void putBytes(std::vector<std::uint8_t>& out, const std::vector<std::uint8_t>& bytes) {
+    putVarInt(out, bytes.size());
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+// Segwit transaction with one input spending a dummy outpoint.
+std::vector<std::uint8_t> makeTx(const std::vector<std::vector<std::uint8_t>>& outputs,
+                                 const std::vector<std::vector<std::uint8_t>>& witness) {
+    std::vector<std::uint8_t> tx;
+    putLE(tx, 2, 4);
+    tx.push_back(0x00);
+    tx.push_back(0x01);
+    putVarInt(tx, 1);
+    tx.insert(tx.end(), 32, 0x11);
+    putLE(tx, 0, 4);
+    putVarInt(tx, 0);
+    putLE(tx, 0xfffffffd, 4);
+    putVarInt(tx, outputs.size());
+    for (const auto& spk : outputs) {
+        putLE(tx, 1000, 8);
+        putBytes(tx, spk);
+    }
+    putVarInt(tx, witness.size());
+    for (const auto& item : witness) putBytes(tx, item);
+    putLE(tx, 0, 4);
+    return tx;
+}
+
+std::vector<std::uint8_t> randomBytes(std::size_t n, std::uint32_t& seed) {
+    std::vector<std::uint8_t> out(n);
+    for (auto& b : out) b = static_cast<std::uint8_t>(nextRand(seed) >> 5);
+    return out;
+}
+
+struct Shape {
+    const char* name;
+    std::vector<std::uint8_t> raw;
+};
+
+std::vector<Shape> makeShapes() {
+    std::uint32_t seed = 0x3c6ef372;
+    std::vector<std::uint8_t> p2wpkh(22, 0x00);
+    p2wpkh[1] = 0x14;
+    std::vector<Shape> shapes;
+
+    shapes.push_back({"p2wpkh payment", makeTx({p2wpkh, p2wpkh},
+                                               {randomBytes(72, seed), randomBytes(33, seed)})});
+
+    shapes.push_back({"390KB random item", makeTx({p2wpkh}, {randomBytes(390000, seed)})});
+
+    std::vector<std::uint8_t> tapscript;
+    for (int k = 0; k < 11000; ++k) {  // ~375 KB of key pushes and OP_CHECKSIGADD
+        tapscript.push_back(0x20);
+        std::vector<std::uint8_t> key = randomBytes(32, seed);
+        tapscript.insert(tapscript.end(), key.begin(), key.end());
+        tapscript.push_back(k ? 0xba : 0xac);
+    }
+    shapes.push_back({"375KB multisig", makeTx({p2wpkh}, {randomBytes(64, seed), tapscript})});
+
+    std::vector<std::uint8_t> envelope = {0x20};
+    std::vector<std::uint8_t> key = randomBytes(32, seed);
+    envelope.insert(envelope.end(), key.begin(), key.end());
+    envelope.insert(envelope.end(), {0xac, 0x00, 0x63, 0x03, 'o', 'r', 'd', 0x00});
+    for (int chunk = 0; chunk < 700; ++chunk) {
+        envelope.insert(envelope.end(), {0x4d, 0x08, 0x02});  // PUSHDATA2 520
+        std::vector<std::uint8_t> body = randomBytes(520, seed);
+        envelope.insert(envelope.end(), body.begin(), body.end());
+    }
+    envelope.push_back(0x68);
+    shapes.push_back({"360KB inscription", makeTx({p2wpkh}, {randomBytes(64, seed), envelope})});
+
+    std::vector<std::vector<std::uint8_t>> tiny(60000, std::vector<std::uint8_t>{0x01});
+    shapes.push_back({"60k tiny items", makeTx({p2wpkh}, tiny)});
+
+    std::vector<std::vector<std::uint8_t>> opReturns;
+    for (int i = 0; i < 4000; ++i) {
+        std::vector<std::uint8_t> spk = {0x6a, 0x4c, 80};
+        std::vector<std::uint8_t> payload = randomBytes(80, seed);
+        spk.insert(spk.end(), payload.begin(), payload.end());
+        opReturns.push_back(spk);
+    }
+    shapes.push_back({"4000 OP_RETURNs", makeTx(opReturns, {randomBytes(64, seed)})});
+    return shapes;
+}
+
+struct Latency {
+    double p50, p99, p999, max;
+    std::size_t truncated;
+};
+
+Latency measure(const TagEngine& engine, const Shape& shape, const WorkBudget* budget,
+                std::size_t calls) {
+    std::vector<double> us(calls);
+    std::size_t truncated = 0;
+    for (std::size_t i = 0; i < calls; ++i) {
+        auto t0 = Clock::now();
+        Evaluation e = budget ? engine.evaluate(ByteSpan(shape.raw), 1.0, 5.0, *budget)
+                              : engine.evaluate(ByteSpan(shape.raw), 1.0, 5.0);
+        us[i] = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        truncated += e.truncated;
+    }
+    std::sort(us.begin(), us.end());
+    auto at = [&](double q) { return us[std::min(calls - 1, static_cast<std::size_t>(q * calls))]; };
+    return Latency{at(0.50), at(0.99), at(0.999), us.back(), truncated};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t calls = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    if (calls == 0) calls = 1;
+
+    TagEngine engine;
+    WorkBudget budget;
+    budget.maxBytes = 64 * 1024;
+    budget.maxTime = std::chrono::microseconds(200);
+
+    std::printf("budget: %zu bytes, %lld us; latency in us over %zu calls\n", budget.maxBytes,
+                static_cast<long long>(budget.maxTime.count() / 1000), calls);
+    std::printf("%-20s %8s | %8s %8s %8s %8s | %8s %8s %8s %8s %6s\n", "shape", "bytes", "p50",
+                "p99", "p99.9", "max", "p50", "p99", "p99.9", "max", "trunc");
+    for (const Shape& shape : makeShapes()) {
+        Latency plain = measure(engine, shape, nullptr, calls);
+        Latency bounded = measure(engine, shape, &budget, calls);
+        std::printf("%-20s %8zu | %8.1f %8.1f %8.1f %8.1f | %8.1f %8.1f %8.1f %8.1f %6zu\n",
+                    shape.name, shape.raw.size(), plain.p50, plain.p99, plain.p999, plain.max,
+                    bounded.p50, bounded.p99, bounded.p999, bounded.max, bounded.truncated);
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Benchmark: columnar region file write rate and aggregate query rate over
+// a synthetic chain (a few label sets, realistic region sizes), including
+// the projected time for a year of blocks (52,560) at the same density.
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/bench_columnar.cpp src/buds_columnar.cpp
+//       src/buds_mmap.cpp src/buds_tagger.cpp src/buds_tx.cpp src/buds_hex.cpp
+//       src/buds_labels.cpp src/buds_script.cpp src/buds_threadpool.cpp
+//       src/buds_registry.cpp src/buds_json.cpp src/buds_entropy.cpp -o bench-columnar
+//   ./bench-columnar [blocks] [regions-per-block]    (default 2000 x 5000)
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+#include "buds_columnar.h"
+#include "buds_threadpool.h"
+
+using namespace buds;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+double secondsSince(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// Roughly the region mix of a recent block: mostly signatures and payment
+// outputs, some OP_RETURN and inscription envelopes.
+Tag randomTag(std::uint32_t& seed) {
+    Tag tag;
+    std::uint32_t r = nextRand(seed) % 100;
+    if (r < 45) {
+        tag.labels.insert(label::ConsensusSig);
+        tag.end = 72;
+    } else if (r < 85) {
+        tag.labels.insert(label::PayStandard);
+        tag.end = 25;
+    } else if (r < 92) {
+        tag.labels.insert(label::DaOpReturnEmbed);
+        tag.labels.insert(label::MetaIndexerHint);
+        tag.end = 40 + nextRand(seed) % 40;
+    } else {
+        tag.labels.insert(label::MetaInscription);
+        tag.labels.insert(label::DaEmbedMisc);
+        tag.end = 300 + nextRand(seed) % 4000;
+    }
+    return tag;
+}
+
+void report(const char* name, const ColumnAggregate& a, double seconds, std::uint64_t fileRows) {
+    std::printf("%-22s %8.3f s  %10.1f M rows/s  regions=%llu read=%zu skipped=%zu\n", name,
+                seconds, seconds > 0 ? fileRows / seconds / 1e6 : 0.0,
+                static_cast<unsigned long long>(a.regions), a.chunksRead, a.chunksSkipped);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::uint32_t blocks = argc > 1 ? static_cast<std::uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 2000;
+    std::size_t perBlock = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000;
+    std::string path = (std::filesystem::temp_directory_path() / "bench_columnar.col").string();
+
+    std::uint32_t seed = 0x2545f491;
+    std::vector<Tag> tags(perBlock);
+    auto t0 = Clock::now();
+    {
+        ColumnarWriter writer;
+        if (!writer.open(path)) return 1;
+        for (std::uint32_t h = 0; h < blocks; ++h) {
+            for (auto& tag : tags) tag = randomTag(seed);
+            writer.append(800000 + h, tags.data(), tags.size());
+        }
+        if (!writer.close()) return 1;
+    }
+    double writeSeconds = secondsSince(t0);
+    std::uint64_t rows = std::uint64_t(blocks) * perBlock;
+    std::uint64_t fileBytes = std::filesystem::file_size(path);
+    std::printf("wrote %llu rows in %.2f s (%.1f M rows/s), %.2f bytes/row\n",
+                static_cast<unsigned long long>(rows), writeSeconds, rows / writeSeconds / 1e6,
+                static_cast<double>(fileBytes) / rows);
+
+    ColumnarReader reader;
+    if (!reader.open(path)) return 1;
+    ThreadPool pool;
+
+    // Warm the page cache so the numbers measure the scan, not the disk.
+    reader.aggregate();
+
+    t0 = Clock::now();
+    ColumnAggregate all = reader.aggregate();
+    double allSeconds = secondsSince(t0);
+    report("all heights", all, allSeconds, rows);
+
+    t0 = Clock::now();
+    ColumnAggregate pooled = reader.aggregate(ColumnQuery(), pool);
+    double pooledSeconds = secondsSince(t0);
+    report("all heights, pool", pooled, pooledSeconds, rows);
+
+    ColumnQuery half;
+    half.minHeight = 800000 + blocks / 4;
+    half.maxHeight = 800000 + blocks * 3 / 4;
+    t0 = Clock::now();
+    ColumnAggregate a = reader.aggregate(half);
+    report("middle half", a, secondsSince(t0), rows / 2);
+
+    ColumnQuery t2;
+    t2.minTier = Tier::T2;
+    t0 = Clock::now();
+    a = reader.aggregate(t2);
+    report("T2+ regions only", a, secondsSince(t0), rows);
+
+    ColumnQuery one;
+    one.minHeight = one.maxHeight = 800000 + blocks / 2;
+    t0 = Clock::now();
+    a = reader.aggregate(one);
+    report("one block", a, secondsSince(t0), perBlock);
+
+    double perRow = allSeconds / rows;
+    std::printf("projected year (52560 blocks x %zu regions): %.1f s single-threaded\n", perBlock,
+                perRow * 52560.0 * perBlock);
+
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Benchmark: one TagEngine shared by 1..64 classifier threads, with and
+// without a writer switching the policy profile in the background.
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/bench_engine.cpp src/buds_tagger.cpp src/buds_tx.cpp
+//       src/buds_hex.cpp src/buds_labels.cpp src/buds_script.cpp src/buds_threadpool.cpp
+//       src/buds_registry.cpp src/buds_json.cpp src/buds_entropy.cpp -o bench-engine
+//   ./bench-engine [evaluations per run]    (default 400000)
+//
+// Readers pin the engine config once per evaluate() call; a profile switch
+// publishes a new snapshot and never makes a reader wait, so throughput
+// with switching should track the static column.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buds_tagger.h"
+
+using namespace buds;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+std::vector<Tx> makeCorpus(std::size_t count) {
+    std::vector<Tx> txs;
+    std::uint32_t seed = 0x1234567;
+    for (std::size_t i = 0; i < count; ++i) {
+        Tx tx;
+        tx.txid = "bench-" + std::to_string(i);
+        std::uint32_t outputs = 1 + nextRand(seed) % 4;
+        for (std::uint32_t o = 0; o < outputs; ++o) {
+            TxOutput out;
+            out.spk.hex = nextRand(seed) % 5 == 0 ? "6a026f6b"
+                                                  : "76a91400112233445566778899aabbccddeeff0011223388ac";
+            tx.vout.push_back(out);
+        }
+        Witness w;
+        w.stack.push_back(WitnessItem{std::string(144, '3')});        // signature-sized
+        if (nextRand(seed) % 8 == 0) {
+            w.stack.push_back(WitnessItem{std::string(2 * (100 + nextRand(seed) % 900), '0')});
+        }
+        tx.witness.push_back(w);
+        txs.push_back(tx);
+    }
+    return txs;
+}
+
+struct RunResult {
+    double txPerSecond{0.0};
+    std::uint64_t switches{0};
+};
+
+RunResult run(TagEngine& engine, const std::vector<Tx>& txs, unsigned threads,
+              std::size_t evaluations, bool switching) {
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> switches{0};
+    std::thread writer;
+    if (switching) {
+        writer = std::thread([&] {
+            for (unsigned p = 0; !done.load(std::memory_order_relaxed); ++p) {
+                engine.setPolicyProfile(static_cast<PolicyProfile>(p % 3));
+                switches.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        });
+    }
+
+    std::vector<std::thread> readers;
+    std::atomic<std::uint64_t> sink{0};
+    auto t0 = Clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        readers.emplace_back([&, t] {
+            double local = 0.0;
+            for (std::size_t i = t; i < evaluations; i += threads) {
+                local += engine.evaluate(txs[i % txs.size()], 1.0, 10.0).policy.score;
+            }
+            sink.fetch_add(static_cast<std::uint64_t>(local), std::memory_order_relaxed);
+        });
+    }
+    for (auto& r : readers) r.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    done.store(true);
+    if (writer.joinable()) writer.join();
+
+    RunResult result;
+    result.txPerSecond = evaluations / seconds;
+    result.switches = switches.load();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t evaluations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 400000;
+    std::vector<Tx> txs = makeCorpus(4096);
+    TagEngine engine;
+
+    std::printf("hardware threads: %u, %zu evaluations per run\n",
+                std::thread::hardware_concurrency(), evaluations);
+    std::printf("%8s %14s %9s %16s %9s %10s\n", "threads", "static tx/s", "speedup",
+                "switching tx/s", "ratio", "switches");
+
+    double base = 0.0;
+    for (unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+        RunResult still = run(engine, txs, threads, evaluations, false);
+        RunResult moving = run(engine, txs, threads, evaluations, true);
+        if (threads == 1) base = still.txPerSecond;
+        std::printf("%8u %14.0f %8.2fx %16.0f %8.2fx %10llu\n", threads, still.txPerSecond,
+                    still.txPerSecond / base, moving.txPerSecond,
+                    moving.txPerSecond / still.txPerSecond,
+                    static_cast<unsigned long long>(moving.switches));
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+// Microbenchmark: hex decode + printable-ratio (the ASCII heuristic) versus
+// the original substr/stoul implementation.
+//
+//   g++ -std=c++17 -O2 -Isrc bench/bench_hex.cpp src/buds_hex.cpp -o bench-hex
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "buds_hex.h"
+
+using namespace buds;
+
+namespace {
+
+// Verbatim copy of the pre-kernel TagEngine::isMostlyAscii.
+bool legacyIsMostlyAscii(const std::string& hex) {
+    if (hex.empty()) return false;
+    std::size_t printable = 0;
+    std::size_t total = 0;
+    for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+        unsigned int byte = 0;
+        try {
+            byte = static_cast<unsigned int>(std::stoul(hex.substr(i, 2), nullptr, 16));
+        } catch (...) {
+            continue;
+        }
+        ++total;
+        if (byte >= 0x20 && byte <= 0x7e) ++printable;
+    }
+    if (total == 0) return false;
+    return (static_cast<double>(printable) / static_cast<double>(total)) >= 0.8;
+}
+
+template <typename Fn>
+bool kernelIsMostlyAscii(const std::string& hex, std::vector<std::uint8_t>& buf, Fn decode,
+                         std::size_t (*count)(const std::uint8_t*, std::size_t)) {
+    std::size_t n = decode(hex.data(), hex.size(), buf.data());
+    if (n == 0) return false;
+    return static_cast<double>(count(buf.data(), n)) / static_cast<double>(n) >= 0.8;
+}
+
+volatile bool gSink;
+
+// Returns GB/s of hex input processed.
+template <typename Fn>
+double measure(const std::string& hex, Fn fn) {
+    using clock = std::chrono::steady_clock;
+    std::size_t iters = 1;
+    for (;;) {
+        auto t0 = clock::now();
+        for (std::size_t i = 0; i < iters; ++i) gSink = fn(hex);
+        double secs = std::chrono::duration<double>(clock::now() - t0).count();
+        if (secs > 0.2) return static_cast<double>(hex.size()) * iters / secs / 1e9;
+        iters *= 2;
+    }
+}
+
+} // namespace
+
+int main() {
+    const std::size_t sizes[] = {8, 64, 512, 4096, 32768, 409600};
+    std::printf("kernel: %s\n", hexKernelName());
+    std::printf("%10s %12s %12s %12s %10s\n", "bytes", "legacy GB/s", "scalar GB/s",
+                "simd GB/s", "speedup");
+
+    for (std::size_t size : sizes) {
+        std::string hex;
+        hex.reserve(size * 2);
+        for (std::size_t i = 0; i < size; ++i) {
+            static const char digits[] = "0123456789abcdef";
+            std::uint8_t b = static_cast<std::uint8_t>(0x20 + (i * 37) % 0x70);
+            hex += digits[b >> 4];
+            hex += digits[b & 0x0f];
+        }
+        std::vector<std::uint8_t> buf(size);
+
+        double legacy = measure(hex, [](const std::string& h) { return legacyIsMostlyAscii(h); });
+        double scalar = measure(hex, [&](const std::string& h) {
+            return kernelIsMostlyAscii(h, buf, hexDecodeScalar, countPrintableScalar);
+        });
+        double simd = measure(hex, [&](const std::string& h) {
+            return kernelIsMostlyAscii(h, buf, hexDecode, countPrintable);
+        });
+        std::printf("%10zu %12.3f %12.3f %12.3f %9.1fx\n", size, legacy, scalar, simd,
+                    simd / legacy);
+    }
+    return 0;
+}
@@ -0,0 +1,603 @@
+// Benchmark suite: every TagEngine entry point over a deterministic
+// synthetic corpus, one workload per transaction shape of the buds-lab test
+// matrix (buds-lab/docs/buds-lab-test-matrix.md) plus a weighted mix.
+// Reports ns/tx, MB/s of serialized transaction, heap allocations per call
+// and p50 / p99 per-call latency.
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/bench_suite.cpp src/buds_tagger.cpp src/buds_tx.cpp
+//       src/buds_hex.cpp src/buds_labels.cpp src/buds_script.cpp src/buds_threadpool.cpp
+//       src/buds_registry.cpp src/buds_json.cpp src/buds_entropy.cpp src/buds_metrics.cpp
+//       -o bench-suite
+//   ./bench-suite [--filter TEXT] [--txs N] [--min-ms MS] [--save FILE]
+//                 [--compare FILE] [--tolerance PCT]
+//
+// --save writes the results as a JSON baseline. --compare reads one and
+// exits 1 if any entry's ns/tx grew by more than the tolerance (default
+// 10%) or it allocates more per call than the baseline did. Baselines are
+// only comparable on the same machine and build flags; a baseline from the
+// default build compared against one with -DBUDS_ENABLE_METRICS gives the
+// cost of the instrumentation.
+//
+// Throughput and allocations come from untimed-per-call passes repeated for
+// at least --min-ms; latency comes from a separate pass that times each call,
+// so p50 / p99 include the clock overhead (~20 ns).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buds_json.h"
+#include "buds_tagger.h"
+#include "buds_threadpool.h"
+
+using namespace buds;
+
+// Every heap allocation in the process goes through these, so the suite can
+// report allocations per call without an external profiler.
+namespace {
+std::atomic<std::uint64_t> gAllocations{0};
+}
+
+void* operator new(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t a = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) return p;
+    throw std::bad_alloc();
+}
+
+// GCC assumes a pointer reaching operator delete came from the library
+// operator new and flags free() on it; here both sides are malloc.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Bytes = std::vector<std::uint8_t>;
+
+double secondsSince(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void putLE(Bytes& out, std::uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+void putVarInt(Bytes& out, std::uint64_t v) {
+    if (v < 0xfd) {
+        out.push_back(static_cast<std::uint8_t>(v));
+    } else if (v <= 0xffff) {
+        out.push_back(0xfd);
+        putLE(out, v, 2);
+    } else {
+        out.push_back(0xfe);
+        putLE(out, v, 4);
+    }
+}
+
+void putBytes(Bytes& out, const Bytes& bytes) {
+    putVarInt(out, bytes.size());
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+Bytes randomBytes(std::size_t n, std::uint32_t& seed) {
+    Bytes out(n);
+    for (auto& b : out) b = static_cast<std::uint8_t>(nextRand(seed) >> 5);
+    return out;
+}
+
+Bytes asciiBytes(std::size_t n, std::uint32_t& seed) {
+    Bytes out(n);
+    for (auto& b : out) b = static_cast<std::uint8_t>(' ' + nextRand(seed) % 95);
+    return out;
+}
+
+Bytes concat(Bytes a, const Bytes& b) {
+    a.insert(a.end(), b.begin(), b.end());
+    return a;
+}
+
+// One input spending a random outpoint. Without witness items the legacy
+// serialization is used, as for a P2PKH spend.
+Bytes makeTx(const std::vector<Bytes>& outputs, const std::vector<Bytes>& witness,
+             std::uint32_t& seed) {
+    Bytes tx;
+    putLE(tx, 2, 4);
+    if (!witness.empty()) {
+        tx.push_back(0x00);
+        tx.push_back(0x01);
+    }
+    putVarInt(tx, 1);
+    Bytes prevout = randomBytes(32, seed);
+    tx.insert(tx.end(), prevout.begin(), prevout.end());
+    putLE(tx, nextRand(seed) % 4, 4);
+    if (witness.empty()) {
+        // scriptSig: <72-byte signature> <33-byte key>
+        putBytes(tx, concat(concat({0x48}, randomBytes(72, seed)), concat({0x21}, randomBytes(33, seed))));
+    } else {
+        putVarInt(tx, 0);
+    }
+    putLE(tx, 0xfffffffd, 4);
+    putVarInt(tx, outputs.size());
+    for (const auto& spk : outputs) {
+        putLE(tx, 1000 + nextRand(seed) % 100000, 8);
+        putBytes(tx, spk);
+    }
+    if (!witness.empty()) {
+        putVarInt(tx, witness.size());
+        for (const auto& item : witness) putBytes(tx, item);
+    }
+    putLE(tx, 0, 4);
+    return tx;
+}
+
+// --- Shapes (test matrix group in brackets) ---
+
+Bytes p2pkh(std::uint32_t& s) { return concat(concat({0x76, 0xa9, 0x14}, randomBytes(20, s)), {0x88, 0xac}); }
+Bytes p2wpkh(std::uint32_t& s) { return concat({0x00, 0x14}, randomBytes(20, s)); }
+Bytes p2tr(std::uint32_t& s) { return concat({0x51, 0x20}, randomBytes(32, s)); }
+Bytes sig64(std::uint32_t& s) { return randomBytes(64, s); }
+
+// Ordinals envelope in a tapscript: <key> CHECKSIG FALSE IF "ord" 0 <body
+// in 520-byte pushes> ENDIF, revealed with a signature and control block.
+std::vector<Bytes> inscriptionWitness(std::size_t bodyBytes, std::uint32_t& s) {
+    Bytes script = concat({0x20}, randomBytes(32, s));
+    script.insert(script.end(), {0xac, 0x00, 0x63, 0x03, 'o', 'r', 'd', 0x01, 0x01, 0x0a});
+    script.insert(script.end(), {'t', 'e', 'x', 't', '/', 'p', 'l', 'a', 'i', 'n', 0x00});
+    for (std::size_t done = 0; done < bodyBytes;) {
+        std::size_t n = std::min<std::size_t>(520, bodyBytes - done);
+        script.insert(script.end(), {0x4d, static_cast<std::uint8_t>(n), static_cast<std::uint8_t>(n >> 8)});
+        Bytes body = asciiBytes(n, s);
+        script.insert(script.end(), body.begin(), body.end());
+        done += n;
+    }
+    script.push_back(0x68);
+    return {sig64(s), script, concat({0xc0}, randomBytes(32, s))};
+}
+
+using ShapeFn = Bytes (*)(std::uint32_t&);
+
+const struct Shape {
+    const char* name;
+    ShapeFn make;
+} kShapes[] = {
+    // [A1] legacy P2PKH payment
+    {"p2pkh", [](std::uint32_t& s) { return makeTx({p2pkh(s), p2pkh(s)}, {}, s); }},
+    // [A2] P2WPKH payment: 72-byte signature, 33-byte key
+    {"p2wpkh", [](std::uint32_t& s) {
+         return makeTx({p2wpkh(s), p2wpkh(s)}, {randomBytes(72, s), concat({0x02}, randomBytes(32, s))}, s);
+     }},
+    // [A3] P2TR key-path payment
+    {"p2tr", [](std::uint32_t& s) { return makeTx({p2tr(s), p2tr(s)}, {sig64(s)}, s); }},
+    // [B1] 32-byte rollup root next to a change output
+    {"rollup_root", [](std::uint32_t& s) {
+         return makeTx({concat({0x6a, 0x20}, randomBytes(32, s)), p2tr(s)}, {sig64(s)}, s);
+     }},
+    // [B2] tiny ASCII indexer hint
+    {"op_return_hint", [](std::uint32_t& s) {
+         return makeTx({{0x6a, 0x02, 'o', 'k'}, p2tr(s)}, {sig64(s)}, s);
+     }},
+    // [B4/B5] 80-byte OP_RETURN embed
+    {"op_return_embed", [](std::uint32_t& s) {
+         return makeTx({concat({0x6a, 0x4c, 80}, randomBytes(80, s)), p2tr(s)}, {sig64(s)}, s);
+     }},
+    // [C3] 120-byte ASCII vendor blob in the witness
+    {"vendor_ascii", [](std::uint32_t& s) {
+         return makeTx({p2wpkh(s)}, {randomBytes(72, s), asciiBytes(120, s)}, s);
+     }},
+    // [C4] 4 KB high-entropy witness blob
+    {"obfuscated_4k", [](std::uint32_t& s) {
+         return makeTx({p2wpkh(s)}, {randomBytes(72, s), randomBytes(4096, s)}, s);
+     }},
+    // [C4] 100 KB high-entropy witness blob
+    {"obfuscated_100k", [](std::uint32_t& s) {
+         return makeTx({p2wpkh(s)}, {randomBytes(72, s), randomBytes(100000, s)}, s);
+     }},
+    // [D1] small text inscription
+    {"inscription", [](std::uint32_t& s) { return makeTx({p2tr(s)}, inscriptionWitness(400, s), s); }},
+    // [D2] 40 KB inscription split over 520-byte pushes
+    {"inscription_40k", [](std::uint32_t& s) {
+         return makeTx({p2tr(s)}, inscriptionWitness(40000, s), s);
+     }},
+};
+
+// [E] Weighted mix, roughly a busy mempool: mostly payments, then OP_RETURN
+// and inscription traffic, a few blobs.
+Bytes mixTx(std::uint32_t& s) {
+    static const std::size_t kWeights[] = {10, 25, 25, 4, 4, 6, 3, 4, 1, 16, 2};
+    static_assert(sizeof(kWeights) / sizeof(kWeights[0]) == sizeof(kShapes) / sizeof(kShapes[0]),
+                  "one weight per shape");
+    std::uint32_t pick = nextRand(s) % 100;
+    std::size_t i = 0;
+    for (std::uint32_t acc = 0; i + 1 < std::size(kWeights); ++i) {
+        acc += static_cast<std::uint32_t>(kWeights[i]);
+        if (pick < acc) break;
+    }
+    return kShapes[i].make(s);
+}
+
+// Every input form an entry point takes, prepared up front so that only the
+// call under test is measured.
+struct Corpus {
+    std::string name;
+    std::vector<Bytes> raw;
+    std::vector<TxView> views;
+    std::vector<Tx> hex;
+    std::vector<ByteSpan> spans;
+    std::vector<Classification> classified;
+    std::vector<CompactClassification> compact;
+    double bytesPerTx{0};
+};
+
+std::string toHex(ByteSpan bytes) {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string out(bytes.size() * 2, '0');
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        out[2 * i] = kDigits[bytes[i] >> 4];
+        out[2 * i + 1] = kDigits[bytes[i] & 15];
+    }
+    return out;
+}
+
+Tx toHexTx(const TxView& view) {
+    Tx tx;
+    tx.txid = view.txid().toHex();
+    for (const auto& out : view.vout) tx.vout.push_back(TxOutput{ScriptPubKey{"", toHex(out.scriptPubKey)}});
+    if (view.segwit) {
+        for (std::size_t in = 0; in < view.vin.size(); ++in) {
+            Witness w;
+            for (std::size_t k = 0; k < view.vin[in].witnessCount; ++k) {
+                w.stack.push_back(WitnessItem{toHex(view.witnessItem(in, k))});
+            }
+            tx.witness.push_back(std::move(w));
+        }
+    }
+    return tx;
+}
+
+// Large shapes get fewer transactions so every corpus stays around 16 MB.
+Corpus makeCorpus(const std::string& name, ShapeFn make, std::size_t txs, std::uint32_t seed,
+                  const TagEngine& engine) {
+    Corpus c;
+    c.name = name;
+    std::size_t bytes = 0;
+    while (c.raw.size() < txs && (c.raw.size() < 16 || bytes < (16u << 20))) {
+        c.raw.push_back(make(seed));
+        bytes += c.raw.back().size();
+    }
+    std::size_t n = c.raw.size();
+    c.bytesPerTx = static_cast<double>(bytes) / n;
+    c.views.resize(n);
+    c.classified.resize(n);
+    c.compact.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!parseTx(ByteSpan(c.raw[i]), c.views[i])) {
+            std::fprintf(stderr, "%s: generated transaction %zu does not parse\n", name.c_str(), i);
+            std::exit(2);
+        }
+        c.spans.push_back(ByteSpan(c.raw[i]));
+        c.hex.push_back(toHexTx(c.views[i]));
+        engine.classify(c.views[i], c.classified[i]);
+        engine.classifyCompact(c.views[i], c.compact[i]);
+    }
+    return c;
+}
+
+struct Result {
+    std::string workload;
+    std::string entry;
+    std::size_t txs{0};
+    double bytesPerTx{0};
+    double nsPerTx{0};
+    double mbPerSec{0};
+    double allocsPerTx{0};
+    double p50{0};
+    double p99{0};
+};
+
+volatile std::size_t sink;
+
+// Runs fn(i) over the corpus until minSeconds have passed (after one warm-up
+// pass), then times individual calls for the latency percentiles.
+Result measure(const Corpus& c, const char* entry, double minSeconds,
+               const std::function<std::size_t(std::size_t)>& fn) {
+    std::size_t n = c.raw.size();
+    std::size_t acc = 0;
+    for (std::size_t i = 0; i < n; ++i) acc += fn(i);
+
+    std::size_t calls = 0;
+    std::uint64_t allocs0 = gAllocations.load(std::memory_order_relaxed);
+    auto t0 = Clock::now();
+    double elapsed = 0;
+    do {
+        for (std::size_t i = 0; i < n; ++i) acc += fn(i);
+        calls += n;
+        elapsed = secondsSince(t0);
+    } while (elapsed < minSeconds);
+    std::uint64_t allocs = gAllocations.load(std::memory_order_relaxed) - allocs0;
+
+    std::vector<double> ns;
+    ns.reserve(std::max<std::size_t>(n, 2000));
+    while (ns.size() < 2000) {
+        for (std::size_t i = 0; i < n; ++i) {
+            auto c0 = Clock::now();
+            acc += fn(i);
+            ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - c0).count());
+        }
+    }
+    std::sort(ns.begin(), ns.end());
+    sink = acc;
+
+    Result r;
+    r.workload = c.name;
+    r.entry = entry;
+    r.txs = n;
+    r.bytesPerTx = c.bytesPerTx;
+    r.nsPerTx = elapsed * 1e9 / calls;
+    r.mbPerSec = c.bytesPerTx * calls / elapsed / 1e6;
+    r.allocsPerTx = static_cast<double>(allocs) / calls;
+    r.p50 = ns[ns.size() / 2];
+    r.p99 = ns[std::min(ns.size() - 1, ns.size() * 99 / 100)];
+    return r;
+}
+
+// classifyBatch is one call per corpus: ns/tx is the batch time over its
+// size and the percentiles are left at zero.
+Result measureBatch(const Corpus& c, const TagEngine& engine, ThreadPool& pool, double minSeconds) {
+    std::size_t n = c.raw.size();
+    std::size_t acc = engine.classifyBatch(c.spans, pool).size();
+    std::size_t calls = 0;
+    std::uint64_t allocs0 = gAllocations.load(std::memory_order_relaxed);
+    auto t0 = Clock::now();
+    double elapsed = 0;
+    do {
+        acc += engine.classifyBatch(c.spans, pool).size();
+        calls += n;
+        elapsed = secondsSince(t0);
+    } while (elapsed < minSeconds);
+    std::uint64_t allocs = gAllocations.load(std::memory_order_relaxed) - allocs0;
+    sink = acc;
+
+    Result r;
+    r.workload = c.name;
+    r.entry = "classifyBatch";
+    r.txs = n;
+    r.bytesPerTx = c.bytesPerTx;
+    r.nsPerTx = elapsed * 1e9 / calls;
+    r.mbPerSec = c.bytesPerTx * calls / elapsed / 1e6;
+    r.allocsPerTx = static_cast<double>(allocs) / calls;
+    return r;
+}
+
+void run(const Corpus& c, const TagEngine& engine, ThreadPool& pool, double minSeconds,
+         const std::string& filter, std::vector<Result>& results) {
+    Classification out;
+    TxView view;
+    CompactClassification compact;
+    WorkBudget budget;
+    auto wanted = [&](const char* entry) {
+        return filter.empty() || (c.name + " " + entry).find(filter) != std::string::npos;
+    };
+    auto add = [&](const char* entry, const std::function<std::size_t(std::size_t)>& fn) {
+        if (!wanted(entry)) return;
+        results.push_back(measure(c, entry, minSeconds, fn));
+        const Result& r = results.back();
+        std::printf("%-16s %-18s %9.0f %9.1f %8.2f %9.0f %9.0f\n", r.workload.c_str(),
+                    r.entry.c_str(), r.nsPerTx, r.mbPerSec, r.allocsPerTx, r.p50, r.p99);
+        std::fflush(stdout);
+    };
+
+    add("parseTx", [&](std::size_t i) { return parseTx(c.spans[i], view) ? view.vout.size() : 0; });
+    add("classify(raw)", [&](std::size_t i) {
+        engine.classify(c.spans[i], out);
+        return out.tags.size();
+    });
+    add("classify(raw)->new", [&](std::size_t i) { return engine.classify(c.spans[i]).tags.size(); });
+    add("classify(view)", [&](std::size_t i) {
+        engine.classify(c.views[i], out);
+        return out.tags.size();
+    });
+    add("classify(hex)", [&](std::size_t i) {
+        engine.classify(c.hex[i], out);
+        return out.tags.size();
+    });
+    add("summarizeTiers", [&](std::size_t i) {
+        return static_cast<std::size_t>(engine.summarizeTiers(c.classified[i]).counts.T3);
+    });
+    add("computePolicy", [&](std::size_t i) {
+        return static_cast<std::size_t>(engine.computePolicy(c.classified[i], 1.0, 5.0).required);
+    });
+    add("countTiers", [&](std::size_t i) {
+        return static_cast<std::size_t>(engine.countTiers(c.views[i]).T2);
+    });
+    add("evaluate(raw)", [&](std::size_t i) {
+        return static_cast<std::size_t>(engine.evaluate(c.spans[i], 1.0, 5.0).arbda);
+    });
+    add("evaluate(hex)", [&](std::size_t i) {
+        return static_cast<std::size_t>(engine.evaluate(c.hex[i], 1.0, 5.0).arbda);
+    });
+    add("evaluate(budget)", [&](std::size_t i) {
+        return static_cast<std::size_t>(engine.evaluate(c.spans[i], 1.0, 5.0, budget).arbda);
+    });
+    add("triage(raw)", [&](std::size_t i) {
+        return static_cast<std::size_t>(engine.triage(c.spans[i]).arbda);
+    });
+    add("classifyCompact", [&](std::size_t i) {
+        engine.classifyCompact(c.views[i], compact);
+        return static_cast<std::size_t>(compact.labelCount);
+    });
+    add("evaluate(compact)", [&](std::size_t i) {
+        return static_cast<std::size_t>(engine.evaluate(c.compact[i], 1.0, 5.0).arbda);
+    });
+    if (wanted("classifyBatch")) {
+        results.push_back(measureBatch(c, engine, pool, minSeconds));
+        const Result& r = results.back();
+        std::printf("%-16s %-18s %9.0f %9.1f %8.2f %9s %9s\n", r.workload.c_str(), r.entry.c_str(),
+                    r.nsPerTx, r.mbPerSec, r.allocsPerTx, "-", "-");
+    }
+}
+
+bool save(const std::string& path, const std::vector<Result>& results) {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "{\n  \"suite\": \"buds-bench-suite\",\n  \"version\": 1,\n  \"results\": [\n");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(f,
+                     "    {\"workload\": \"%s\", \"entry\": \"%s\", \"txs\": %zu, \"bytes_per_tx\": %.1f, "
+                     "\"ns_per_tx\": %.1f, \"mb_per_s\": %.2f, \"allocs_per_tx\": %.3f, "
+                     "\"p50_ns\": %.0f, \"p99_ns\": %.0f}%s\n",
+                     r.workload.c_str(), r.entry.c_str(), r.txs, r.bytesPerTx, r.nsPerTx, r.mbPerSec,
+                     r.allocsPerTx, r.p50, r.p99, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+double numberOr(const JsonValue& v, const char* key, double fallback) {
+    const JsonValue* m = v.find(key);
+    return m && m->isNumber() ? m->number : fallback;
+}
+
+// Returns the number of regressions, or -1 if the baseline is unreadable.
+int compare(const std::string& path, const std::vector<Result>& results, double tolerancePct) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream text;
+    text << in.rdbuf();
+    JsonValue doc;
+    std::string error;
+    if (!in || !parseJson(text.str(), doc, &error)) {
+        std::cerr << path << ": " << (error.empty() ? "cannot read" : error) << "\n";
+        return -1;
+    }
+    const JsonValue* list = doc.find("results");
+    if (!list || !list->isArray()) {
+        std::cerr << path << ": no \"results\" array\n";
+        return -1;
+    }
+
+    std::printf("\n%-16s %-18s %9s %9s %7s %8s %8s  %s\n", "workload", "entry", "ns/tx", "base",
+                "delta", "allocs", "base", "status");
+    int regressions = 0;
+    for (const Result& r : results) {
+        const JsonValue* base = nullptr;
+        for (const JsonValue& b : list->array) {
+            const JsonValue* w = b.find("workload");
+            const JsonValue* e = b.find("entry");
+            if (w && e && w->string == r.workload && e->string == r.entry) {
+                base = &b;
+                break;
+            }
+        }
+        if (!base) {
+            std::printf("%-16s %-18s %9.0f %9s %7s %8.2f %8s  new\n", r.workload.c_str(),
+                        r.entry.c_str(), r.nsPerTx, "-", "-", r.allocsPerTx, "-");
+            continue;
+        }
+        double baseNs = numberOr(*base, "ns_per_tx", 0);
+        double baseAllocs = numberOr(*base, "allocs_per_tx", 0);
+        double delta = baseNs > 0 ? (r.nsPerTx / baseNs - 1) * 100 : 0;
+        // Allocation counts are deterministic per call; half an allocation
+        // per transaction absorbs amortized buffer growth.
+        bool slower = delta > tolerancePct;
+        bool allocates = r.allocsPerTx > baseAllocs + 0.5;
+        const char* status = slower && allocates ? "SLOWER+ALLOCS"
+                             : slower            ? "SLOWER"
+                             : allocates         ? "ALLOCS"
+                             : delta < -tolerancePct ? "faster"
+                                                     : "ok";
+        if (slower || allocates) ++regressions;
+        std::printf("%-16s %-18s %9.0f %9.0f %+6.1f%% %8.2f %8.2f  %s\n", r.workload.c_str(),
+                    r.entry.c_str(), r.nsPerTx, baseNs, delta, r.allocsPerTx, baseAllocs, status);
+    }
+    return regressions;
+}
+
+void usage() {
+    std::cerr << "usage: bench-suite [--filter TEXT] [--txs N] [--min-ms MS] [--save FILE]\n"
+                 "                   [--compare FILE] [--tolerance PCT]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string filter;
+    std::string savePath;
+    std::string comparePath;
+    std::size_t txs = 2000;
+    double minMs = 100;
+    double tolerance = 10;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (arg == "--filter") filter = value;
+        else if (arg == "--txs") txs = std::max<std::size_t>(1, std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--min-ms") minMs = std::strtod(value.c_str(), nullptr);
+        else if (arg == "--save") savePath = value;
+        else if (arg == "--compare") comparePath = value;
+        else if (arg == "--tolerance") tolerance = std::strtod(value.c_str(), nullptr);
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    TagEngine engine;
+    ThreadPool pool;
+    std::vector<Result> results;
+    std::printf("%-16s %-18s %9s %9s %8s %9s %9s\n", "workload", "entry", "ns/tx", "MB/s",
+                "allocs", "p50 ns", "p99 ns");
+    std::uint32_t seed = 0x6a09e667;
+    for (const Shape& shape : kShapes) {
+        run(makeCorpus(shape.name, shape.make, txs, seed++, engine), engine, pool, minMs / 1e3,
+            filter, results);
+    }
+    run(makeCorpus("mix", mixTx, txs, seed, engine), engine, pool, minMs / 1e3, filter, results);
+
+    if (!savePath.empty()) {
+        if (!save(savePath, results)) {
+            std::cerr << "cannot write " << savePath << "\n";
+            return 2;
+        }
+        std::printf("baseline written to %s\n", savePath.c_str());
+    }
+    if (!comparePath.empty()) {
+        int regressions = compare(comparePath, results, tolerance);
+        if (regressions < 0) return 2;
+        std::printf("%d regression(s) at %.1f%% tolerance\n", regressions, tolerance);
+        return regressions ? 1 : 0;
+    }
+    return 0;
+}
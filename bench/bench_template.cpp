@@ -0,0 +1,110 @@
+// Benchmark: block template construction from a synthetic mempool.
+//
+//   g++ -std=c++17 -O2 -Isrc bench/bench_template.cpp src/buds_template.cpp -o bench-template
+//   ./bench-template [transactions]    (default 300000)
+//
+// The generator mimics a congested mempool: weights skewed towards small
+// payments with a tail of large inscription-style transactions, a third of
+// transactions spending 1-3 recent unconfirmed parents (chains and CPFP),
+// and ARBDA tiers / labels drawn from a fixed mix.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "buds_template.h"
+
+using namespace buds;
+
+namespace {
+
+std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void generateMempool(TemplateBuilder& b, std::size_t count, std::uint32_t seed) {
+    b.clear();
+    b.reserve(count, count / 2);
+    std::uint32_t parents[3];
+    for (std::uint32_t i = 0; i < count; ++i) {
+        TemplateCandidate c;
+        c.id.bytes[0] = static_cast<std::uint8_t>(i);
+        c.id.bytes[1] = static_cast<std::uint8_t>(i >> 8);
+        c.id.bytes[2] = static_cast<std::uint8_t>(i >> 16);
+
+        std::uint32_t kind = nextRand(seed) % 100;
+        if (kind < 70) {            // payments, T1
+            c.weight = 400 + nextRand(seed) % 800;
+            c.arbda = Tier::T1;
+            c.labelMask = 1u << label::PayStandard;
+        } else if (kind < 85) {     // OP_RETURN / small ordinals, T2
+            c.weight = 600 + nextRand(seed) % 2000;
+            c.arbda = Tier::T2;
+            c.labelMask = (1u << label::PayStandard) | (1u << label::MetaOrdinal);
+        } else if (kind < 95) {     // inscriptions, T2
+            c.weight = 4000 + nextRand(seed) % 60000;
+            c.arbda = Tier::T2;
+            c.labelMask = 1u << label::MetaInscription;
+        } else {                    // opaque blobs, T3
+            c.weight = 2000 + nextRand(seed) % 40000;
+            c.arbda = Tier::T3;
+            c.labelMask = 1u << label::DaObfuscated;
+        }
+        double feerate = 1.0 + (nextRand(seed) % 20000) / 100.0;
+        c.score = feerate * (c.arbda == Tier::T3 ? 0.5 : 1.0);
+        c.fee = static_cast<std::uint64_t>(feerate * c.weight / 4);
+
+        std::size_t np = 0;
+        if (i > 100 && nextRand(seed) % 3 == 0) {
+            np = 1 + nextRand(seed) % 3;
+            for (std::size_t k = 0; k < np; ++k) parents[k] = i - 1 - nextRand(seed) % 100;
+        }
+        b.add(c, parents, np);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 300000;
+    TemplateBuilder builder;
+
+    auto t0 = std::chrono::steady_clock::now();
+    generateMempool(builder, count, 0x9e3779b9);
+    auto t1 = std::chrono::steady_clock::now();
+    builder.computeAncestorScores();
+    auto t2 = std::chrono::steady_clock::now();
+
+    TemplateLimits limits;
+    limits.tierShare[static_cast<std::size_t>(Tier::T3)] = 0.05;
+    limits.labelShare.push_back({label::MetaInscription, 0.25});
+
+    std::printf("mempool: %zu txs (generated in %.1f ms, ancestor scores %.1f ms)\n", count,
+                std::chrono::duration<double, std::milli>(t1 - t0).count(),
+                std::chrono::duration<double, std::milli>(t2 - t1).count());
+    std::printf("%-14s %10s %8s %12s %10s %10s %10s\n", "pass", "ms", "txs", "weight",
+                "T1 WU", "T2 WU", "T3 WU");
+
+    for (bool improve : {false, true}) {
+        limits.improve = improve;
+        // Best of a few runs to keep allocator warm-up out of the number.
+        BlockTemplate best;
+        best.seconds = 1e9;
+        for (int run = 0; run < 5; ++run) {
+            BlockTemplate t = builder.build(limits);
+            if (t.seconds < best.seconds) best = t;
+        }
+        std::printf("%-14s %10.2f %8zu %12llu %10llu %10llu %10llu\n",
+                    improve ? "greedy+swap" : "greedy", best.seconds * 1e3, best.txs.size(),
+                    static_cast<unsigned long long>(best.weight),
+                    static_cast<unsigned long long>(best.tierWeight[1]),
+                    static_cast<unsigned long long>(best.tierWeight[2]),
+                    static_cast<unsigned long long>(best.tierWeight[3]));
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Benchmark: transactions per second for the ARBDA verdict alone (triage)
+// versus the full evaluate / classify paths, on a flood-like mix of
+// payments, OP_RETURN spam and inscriptions.
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/bench_triage.cpp src/buds_tagger.cpp src/buds_tx.cpp
+//       src/buds_hex.cpp src/buds_labels.cpp src/buds_script.cpp src/buds_threadpool.cpp
+//       src/buds_registry.cpp src/buds_json.cpp src/buds_entropy.cpp -o bench-triage
+//   ./bench-triage [transactions]    (default 20000)
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "buds_tagger.h"
+
+using namespace buds;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void putLE(std::vector<std::uint8_t>& out, std::uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+void putVarInt(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    if (v < 0xfd) {
+        out.push_back(static_cast<std::uint8_t>(v));
+    } else {
+        out.push_back(0xfd);
+        putLE(out, v, 2);
+    }
+}
+
+void putBytes(std::vector<std::uint8_t>& out, const std::vector<std::uint8_t>& bytes) {
+    putVarInt(out, bytes.size());
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+std::vector<std::uint8_t> randomBytes(std::size_t n, std::uint32_t& seed) {
+    std::vector<std::uint8_t> out(n);
+    for (auto& b : out) b = static_cast<std::uint8_t>(nextRand(seed) >> 5);
+    return out;
+}
+
+// One-input segwit transaction.
+std::vector<std::uint8_t> makeTx(const std::vector<std::vector<std::uint8_t>>& outputs,
+                                 const std::vector<std::vector<std::uint8_t>>& witness) {
+    std::vector<std::uint8_t> tx;
+    putLE(tx, 2, 4);
+    tx.push_back(0x00);
+    tx.push_back(0x01);
+    putVarInt(tx, 1);
+    tx.insert(tx.end(), 36, 0x22);
+    putVarInt(tx, 0);
+    putLE(tx, 0xfffffffd, 4);
+    putVarInt(tx, outputs.size());
+    for (const auto& spk : outputs) {
+        putLE(tx, 546, 8);
+        putBytes(tx, spk);
+    }
+    putVarInt(tx, witness.size());
+    for (const auto& item : witness) putBytes(tx, item);
+    putLE(tx, 0, 4);
+    return tx;
+}
+
+std::vector<std::vector<std::uint8_t>> makeFlood(std::size_t n) {
+    std::uint32_t seed = 0xa54ff53a;
+    std::vector<std::uint8_t> p2tr(34, 0x5a);
+    p2tr[0] = 0x51;
+    p2tr[1] = 0x20;
+    std::vector<std::vector<std::uint8_t>> txs;
+    txs.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint32_t kind = nextRand(seed) % 10;
+        if (kind < 5) {
+            // Key-path payment: one 64-byte signature.
+            txs.push_back(makeTx({p2tr, p2tr}, {randomBytes(64, seed)}));
+        } else if (kind < 7) {
+            std::vector<std::uint8_t> spam = {0x6a, 0x4c, 80};
+            std::vector<std::uint8_t> payload = randomBytes(80, seed);
+            spam.insert(spam.end(), payload.begin(), payload.end());
+            txs.push_back(makeTx({spam, p2tr}, {randomBytes(64, seed)}));
+        } else {
+            // Script-path reveal: signature, inscription tapscript, control block.
+            std::vector<std::uint8_t> script = {0x20};
+            std::vector<std::uint8_t> key = randomBytes(32, seed);
+            script.insert(script.end(), key.begin(), key.end());
+            script.insert(script.end(), {0xac, 0x00, 0x63, 0x03, 'o', 'r', 'd', 0x00, 0x4d, 0x00, 0x02});
+            std::vector<std::uint8_t> body = randomBytes(512, seed);
+            script.insert(script.end(), body.begin(), body.end());
+            script.push_back(0x68);
+            txs.push_back(makeTx({p2tr}, {randomBytes(64, seed), script, randomBytes(33, seed)}));
+        }
+    }
+    return txs;
+}
+
+template <typename Fn>
+double txPerSecond(std::size_t n, Fn&& fn) {
+    auto t0 = Clock::now();
+    fn();
+    return static_cast<double>(n) / std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+volatile int sink;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    std::vector<std::vector<std::uint8_t>> txs = makeFlood(n);
+    TagEngine engine;
+
+    double triage = txPerSecond(n, [&] {
+        for (const auto& tx : txs) sink = static_cast<int>(engine.triage(ByteSpan(tx)).arbda);
+    });
+    double evaluate = txPerSecond(n, [&] {
+        for (const auto& tx : txs) sink = static_cast<int>(engine.evaluate(ByteSpan(tx), 1.0, 1.0).arbda);
+    });
+    Classification c;
+    double classify = txPerSecond(n, [&] {
+        for (const auto& tx : txs) {
+            engine.classify(ByteSpan(tx), c);
+            sink = static_cast<int>(c.tags.size());
+        }
+    });
+
+    std::printf("%zu transactions\n", n);
+    std::printf("  triage    %10.0f tx/s\n", triage);
+    std::printf("  evaluate  %10.0f tx/s\n", evaluate);
+    std::printf("  classify  %10.0f tx/s\n", classify);
+    return 0;
+}
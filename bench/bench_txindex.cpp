@@ -0,0 +1,107 @@
+// Benchmark: txid index bulk-build rate and warm point-lookup latency
+// (hits and misses), for an index of N transactions.
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/bench_txindex.cpp src/buds_txindex.cpp
+//       src/buds_tx.cpp -o bench-txindex
+//   ./bench-txindex [transactions]    (default 2000000)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+#include "buds_txindex.h"
+
+using namespace buds;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+std::uint64_t nextRand(std::uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Txids are digests; random bytes have the same distribution and are
+// cheaper to make in bulk.
+Hash256 randomTxid(std::uint64_t& state) {
+    Hash256 h;
+    for (std::size_t i = 0; i < 32; i += 8) {
+        std::uint64_t v = nextRand(state);
+        for (std::size_t j = 0; j < 8; ++j) h.bytes[i + j] = static_cast<std::uint8_t>(v >> (8 * j));
+    }
+    return h;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "bench_txindex";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::string path = (dir / "tx").string();
+
+    std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+    std::vector<Hash256> txids(n);
+    for (auto& t : txids) t = randomTxid(seed);
+
+    TxIndex index;
+    if (!index.open(path)) return 1;
+    auto t0 = Clock::now();
+    index.reserve(n);
+    TxIndexEntry e;
+    e.compact.labelCount = 1;
+    for (std::size_t i = 0; i < n; ++i) {
+        e.txid = txids[i];
+        e.height = static_cast<std::uint32_t>(i / 3000);
+        index.append(e);
+    }
+    index.sync();
+    double build = secondsSince(t0);
+    std::printf("built %zu entries in %.2f s (%.2f M tx/s), table %llu slots\n", n, build,
+                n / build / 1e6, static_cast<unsigned long long>(index.stats().capacity));
+
+    t0 = Clock::now();
+    index.close();
+    if (!index.open(path)) return 1;
+    std::printf("reopen: %.3f ms\n", secondsSince(t0) * 1e3);
+
+    // Random order so successive lookups do not share cache lines.
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = i;
+    for (std::size_t i = n; i > 1; --i) std::swap(order[i - 1], order[nextRand(seed) % i]);
+
+    std::size_t probes = std::min<std::size_t>(n, 1000000);
+    for (std::size_t i = 0; i < probes; ++i) index.find(txids[order[i]], e); // warm
+
+    std::size_t found = 0;
+    t0 = Clock::now();
+    for (std::size_t i = 0; i < probes; ++i) found += index.find(txids[order[i]], e) ? 1 : 0;
+    double hit = secondsSince(t0);
+
+    std::vector<Hash256> absent(probes);
+    for (auto& t : absent) t = randomTxid(seed);
+    std::size_t falsePositives = 0;
+    t0 = Clock::now();
+    for (const auto& t : absent) falsePositives += index.find(t, e) ? 1 : 0;
+    double miss = secondsSince(t0);
+
+    std::printf("warm hit:  %.0f ns/lookup (%zu/%zu found)\n", hit / probes * 1e9, found, probes);
+    std::printf("warm miss: %.0f ns/lookup (%zu false positives)\n", miss / probes * 1e9,
+                falsePositives);
+
+    index.close();
+    std::filesystem::remove_all(dir);
+    return 0;
+}
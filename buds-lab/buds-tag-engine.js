@@ -44,7 +44,7 @@ let BUDS_LABEL_TIER = {
  * {
  *   "version": 2,
  *   "labels": [
- *     { "label": "pay.standard", "suggested_category": "T1", ... },
+ *     { "label": "pay.standard", "suggested_tier": "T1", ... },
  *     ...
  *   ]
  * }
@@ -60,7 +60,8 @@ function budsSetRegistryFromJson(registryJson) {
     registryJson.labels.forEach((entry) => {
       if (!entry || !entry.label) return;
       const label = String(entry.label);
-      const tier = entry.suggested_category || "T3";
+      // v2 files use "suggested_tier"; v1 used "suggested_category".
+      const tier = entry.suggested_tier || entry.suggested_category || "T3";
       nextMap[label] = tier;
     });
 
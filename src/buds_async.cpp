@@ -0,0 +1,265 @@
+#include "buds_async.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+namespace buds {
+
+const char* laneName(Lane lane) {
+    switch (lane) {
+        case Lane::Block: return "block";
+        case Lane::Relay: return "relay";
+    }
+    return "unknown";
+}
+
+const char* submitStatusName(SubmitStatus s) {
+    switch (s) {
+        case SubmitStatus::Accepted: return "accepted";
+        case SubmitStatus::Backlogged: return "backlogged";
+        case SubmitStatus::Full: return "full";
+        case SubmitStatus::Closed: return "closed";
+    }
+    return "unknown";
+}
+
+AsyncRejected::AsyncRejected(SubmitStatus s)
+    : std::runtime_error(std::string("buds: async submission rejected (") + submitStatusName(s) + ")"),
+      status_(s) {}
+
+AsyncClassifier::AsyncClassifier(const TagEngine& engine, ThreadPool& pool, AsyncOptions options)
+    : engine_(engine), pool_(pool), options_(options) {
+    options_.batchTxs = std::max<std::size_t>(options_.batchTxs, 1);
+    maxInFlight_ = options_.maxInFlight ? options_.maxInFlight : 2 * pool_.size();
+    for (auto& lane : lanes_) lane.reset(new MpscRing<Job>(options_.capacity));
+    double hw = std::min(std::max(options_.highWater, 0.0), 1.0);
+    highWaterDepth_ = static_cast<std::size_t>(hw * static_cast<double>(lanes_[0]->capacity()));
+    dispatcher_ = std::thread([this] { dispatchLoop(); });
+}
+
+AsyncClassifier::~AsyncClassifier() {
+    close();
+}
+
+// ---------- producers ----------
+
+SubmitStatus AsyncClassifier::push(Job& job, Lane lane) {
+    std::size_t l = static_cast<std::size_t>(lane);
+    Counters& c = counters_[l];
+    // Announce the submission before checking closed_; close() waits for
+    // producers_ to reach zero, so nothing lands after the final drain.
+    producers_.fetch_add(1, std::memory_order_seq_cst);
+    if (closed_.load(std::memory_order_seq_cst)) {
+        producers_.fetch_sub(1, std::memory_order_release);
+        return SubmitStatus::Closed;
+    }
+    job.lane = lane;
+    if (!lanes_[l]->tryPush(job)) {
+        producers_.fetch_sub(1, std::memory_order_release);
+        c.rejected.fetch_add(1, std::memory_order_relaxed);
+        return SubmitStatus::Full;
+    }
+
+    // Pairs with the fence in dispatchLoop: either the dispatcher sees the
+    // new job before sleeping, or this thread sees idle_ and wakes it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (idle_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_.notify_one();
+    }
+    producers_.fetch_sub(1, std::memory_order_release);
+
+    c.submitted.fetch_add(1, std::memory_order_relaxed);
+    std::size_t depth = lanes_[l]->sizeApprox();
+    std::size_t seen = c.maxDepth.load(std::memory_order_relaxed);
+    while (depth > seen && !c.maxDepth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {
+    }
+    if (depth > highWaterDepth_) {
+        c.backlogged.fetch_add(1, std::memory_order_relaxed);
+        return SubmitStatus::Backlogged;
+    }
+    return SubmitStatus::Accepted;
+}
+
+SubmitStatus AsyncClassifier::trySubmit(std::vector<std::uint8_t>& rawTx, Lane lane, AsyncCallback done) {
+    Job job;
+    job.raw = std::move(rawTx);
+    job.done = std::move(done);
+    SubmitStatus s = push(job, lane);
+    if (!accepted(s)) rawTx = std::move(job.raw);
+    return s;
+}
+
+SubmitStatus AsyncClassifier::trySubmit(Tx& tx, Lane lane, AsyncCallback done) {
+    Job job;
+    job.tx = std::move(tx);
+    job.decoded = true;
+    job.done = std::move(done);
+    SubmitStatus s = push(job, lane);
+    if (!accepted(s)) tx = std::move(job.tx);
+    return s;
+}
+
+namespace {
+
+AsyncCallback fulfil(const std::shared_ptr<std::promise<Classification>>& promise) {
+    return [promise](AsyncResult&& r) {
+        if (r.error) {
+            promise->set_exception(r.error);
+        } else {
+            promise->set_value(std::move(r.classification));
+        }
+    };
+}
+
+} // namespace
+
+std::future<Classification> AsyncClassifier::submit(std::vector<std::uint8_t> rawTx, Lane lane,
+                                                    SubmitStatus* status) {
+    auto promise = std::make_shared<std::promise<Classification>>();
+    std::future<Classification> result = promise->get_future();
+    SubmitStatus s = trySubmit(rawTx, lane, fulfil(promise));
+    if (status) *status = s;
+    return accepted(s) ? std::move(result) : std::future<Classification>();
+}
+
+std::future<Classification> AsyncClassifier::submit(Tx tx, Lane lane, SubmitStatus* status) {
+    auto promise = std::make_shared<std::promise<Classification>>();
+    std::future<Classification> result = promise->get_future();
+    SubmitStatus s = trySubmit(tx, lane, fulfil(promise));
+    if (status) *status = s;
+    return accepted(s) ? std::move(result) : std::future<Classification>();
+}
+
+// ---------- dispatcher ----------
+
+std::size_t AsyncClassifier::jobBytes(const Job& job) {
+    if (!job.decoded) return job.raw.size();
+    std::size_t hex = 0;
+    for (const auto& out : job.tx.vout) hex += out.spk.hex.size();
+    for (const auto& w : job.tx.witness) {
+        for (const auto& item : w.stack) hex += item.hex.size();
+    }
+    return hex / 2;
+}
+
+bool AsyncClassifier::lanesEmpty() const {
+    for (const auto& lane : lanes_) {
+        if (lane->sizeApprox() != 0) return false;
+    }
+    return true;
+}
+
+void AsyncClassifier::dispatchLoop() {
+    Job job;
+    for (;;) {
+        // Backpressure: leave work in the lanes while the pool is saturated.
+        if (inFlight_.load(std::memory_order_acquire) >= maxInFlight_) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return inFlight_.load(std::memory_order_acquire) < maxInFlight_; });
+            continue;
+        }
+
+        // Drain lanes in priority order into one batch of small
+        // transactions; large ones go out on their own.
+        std::vector<Job> batch;
+        bool found = false;
+        for (std::size_t l = 0; l < kLaneCount && batch.size() < options_.batchTxs;) {
+            if (!lanes_[l]->tryPop(job)) {
+                ++l;
+                continue;
+            }
+            found = true;
+            if (jobBytes(job) <= options_.smallTxBytes) {
+                batch.push_back(std::move(job));
+                continue;
+            }
+            std::vector<Job> single;
+            single.push_back(std::move(job));
+            dispatch(std::move(single));
+            if (inFlight_.load(std::memory_order_acquire) >= maxInFlight_) break;
+        }
+        if (!batch.empty()) dispatch(std::move(batch));
+        if (found) continue;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopping_ && lanesEmpty()) break;
+        idle_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // Producers notify after publishing; the timeout is only a backstop.
+        if (!stopping_ && lanesEmpty()) wake_.wait_for(lock, std::chrono::milliseconds(10));
+        idle_.store(false, std::memory_order_relaxed);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    drained_.wait(lock, [this] { return inFlight_.load(std::memory_order_acquire) == 0; });
+}
+
+void AsyncClassifier::dispatch(std::vector<Job>&& batch) {
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    if (batch.size() > 1) batchedTxs_.fetch_add(batch.size(), std::memory_order_relaxed);
+    inFlight_.fetch_add(1, std::memory_order_acq_rel);
+    auto work = std::make_shared<std::vector<Job>>(std::move(batch));
+    pool_.submit([this, work] { runBatch(*work); });
+}
+
+void AsyncClassifier::runBatch(std::vector<Job>& batch) {
+    for (Job& job : batch) {
+        AsyncResult r;
+        try {
+            if (job.decoded) {
+                engine_.classify(job.tx, r.classification);
+            } else {
+                engine_.classify(ByteSpan(job.raw), r.classification);
+            }
+        } catch (...) {
+            r.classification = Classification();
+            r.error = std::current_exception();
+        }
+        job.done(std::move(r));
+        counters_[static_cast<std::size_t>(job.lane)].completed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The count changes under the mutex so a throttled or draining
+    // dispatcher cannot miss it, and so *this stays alive until this
+    // worker has let go of it.
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t prev = inFlight_.fetch_sub(1, std::memory_order_acq_rel);
+    if (prev == maxInFlight_) wake_.notify_one();
+    if (prev == 1) drained_.notify_all();
+}
+
+// ---------- lifecycle ----------
+
+void AsyncClassifier::close() {
+    std::call_once(closeOnce_, [this] {
+        closed_.store(true, std::memory_order_seq_cst);
+        while (producers_.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        dispatcher_.join();
+    });
+}
+
+AsyncStats AsyncClassifier::stats() const {
+    AsyncStats s;
+    for (std::size_t l = 0; l < kLaneCount; ++l) {
+        const Counters& c = counters_[l];
+        LaneStats& out = s.lanes[l];
+        out.submitted = c.submitted.load(std::memory_order_relaxed);
+        out.backlogged = c.backlogged.load(std::memory_order_relaxed);
+        out.rejected = c.rejected.load(std::memory_order_relaxed);
+        out.completed = c.completed.load(std::memory_order_relaxed);
+        out.depth = lanes_[l]->sizeApprox();
+        out.maxDepth = c.maxDepth.load(std::memory_order_relaxed);
+    }
+    s.batches = batches_.load(std::memory_order_relaxed);
+    s.batchedTxs = batchedTxs_.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace buds
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "buds_tagger.h"
+#include "buds_threadpool.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define BUDS_HAS_COROUTINES 1
+#endif
+
+namespace buds {
+
+// Bounded lock-free multi-producer / single-consumer ring (Vyukov's
+// sequence-numbered cells). Producers claim a slot with one CAS on the tail;
+// the consumer never writes shared state other than the cell it frees, so
+// producers and the consumer do not contend on a common cache line.
+// tryPop must only ever be called from one thread at a time.
+template <typename T>
+class MpscRing {
+public:
+    // Capacity is rounded up to a power of two (minimum 2).
+    explicit MpscRing(std::size_t capacity) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        cells_.reset(new Cell[cap]);
+        mask_ = cap - 1;
+        for (std::size_t i = 0; i < cap; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    // False if the ring is full; `value` is left untouched then.
+    bool tryPush(T& value) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            std::size_t seq = cell.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // False if the next slot has not been published yet (the ring is empty,
+    // or its oldest producer is still writing).
+    bool tryPop(T& out) {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        Cell& cell = cells_[pos & mask_];
+        if (cell.seq.load(std::memory_order_acquire) != pos + 1) return false;
+        out = std::move(cell.value);
+        cell.value = T();
+        cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+        head_.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Claimed slots not yet popped; exact only when producers are quiet.
+    std::size_t sizeApprox() const {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};   // producers
+    alignas(64) std::atomic<std::size_t> head_{0};   // consumer (read by sizeApprox)
+};
+
+// Priority lanes. The dispatcher always drains Block before Relay, so
+// block-connect work overtakes any backlog of relayed transactions.
+enum class Lane : std::uint8_t {
+    Block,
+    Relay
+};
+constexpr std::size_t kLaneCount = 2;
+
+const char* laneName(Lane lane);   // "block", "relay"
+
+enum class SubmitStatus : std::uint8_t {
+    Accepted,
+    Backlogged,   // accepted, but the lane is above its high-water mark: slow down
+    Full,         // rejected: the lane is at capacity
+    Closed        // rejected: close() was called
+};
+
+const char* submitStatusName(SubmitStatus s);
+
+inline bool accepted(SubmitStatus s) {
+    return s == SubmitStatus::Accepted || s == SubmitStatus::Backlogged;
+}
+
+// Outcome of one asynchronous classification. `error` holds the exception a
+// synchronous classify() would have thrown (e.g. std::invalid_argument for
+// a malformed raw transaction); `classification` is empty then.
+struct AsyncResult {
+    Classification classification;
+    std::exception_ptr error;
+};
+
+// Runs on a pool worker. Must not throw and should return quickly: it
+// delays the rest of its batch.
+using AsyncCallback = std::function<void(AsyncResult&&)>;
+
+struct AsyncOptions {
+    std::size_t capacity{4096};        // per lane, rounded up to a power of two
+    double highWater{0.75};            // Backlogged above this fraction of capacity
+    std::size_t batchTxs{32};          // most transactions handed to a worker at once
+    std::size_t smallTxBytes{4096};    // larger transactions are dispatched alone
+    std::size_t maxInFlight{0};        // batches queued or running on the pool; 0 = 2 * pool size
+};
+
+// Counters since construction. depth is a momentary reading.
+struct LaneStats {
+    std::uint64_t submitted{0};   // accepted
+    std::uint64_t backlogged{0};  // accepted above the high-water mark
+    std::uint64_t rejected{0};    // Full
+    std::uint64_t completed{0};
+    std::size_t depth{0};
+    std::size_t maxDepth{0};
+};
+
+struct AsyncStats {
+    LaneStats lanes[kLaneCount];
+    std::uint64_t batches{0};
+    std::uint64_t batchedTxs{0};   // transactions that shared a batch with another
+};
+
+// Non-blocking front end to TagEngine::classify for network threads.
+// Producers enqueue raw transactions (or decoded Tx) into a bounded lane and
+// return immediately; one dispatcher thread drains the lanes in priority
+// order, groups consecutive small transactions into batches, and hands each
+// batch to the pool. The number of batches on the pool is capped, so a
+// saturated pool pushes back into the lanes, where it surfaces to producers
+// as Backlogged and then Full instead of unbounded queueing.
+//
+// Results are delivered on pool workers, through a callback or a future.
+// The engine and the pool must outlive the AsyncClassifier.
+class AsyncClassifier {
+public:
+    AsyncClassifier(const TagEngine& engine, ThreadPool& pool, AsyncOptions options = {});
+    ~AsyncClassifier();   // close()
+
+    AsyncClassifier(const AsyncClassifier&) = delete;
+    AsyncClassifier& operator=(const AsyncClassifier&) = delete;
+
+    // Callback form. `done` is called exactly once if the status is
+    // Accepted or Backlogged, and never otherwise. A rejected `rawTx` or
+    // `tx` is left intact so the caller can retry or shed it.
+    SubmitStatus trySubmit(std::vector<std::uint8_t>& rawTx, Lane lane, AsyncCallback done);
+    SubmitStatus trySubmit(Tx& tx, Lane lane, AsyncCallback done);
+
+    // Future form. On rejection the returned future is invalid (valid() is
+    // false) and `status`, if given, says why. A malformed transaction makes
+    // the future's get() throw.
+    std::future<Classification> submit(std::vector<std::uint8_t> rawTx, Lane lane = Lane::Relay,
+                                       SubmitStatus* status = nullptr);
+    std::future<Classification> submit(Tx tx, Lane lane = Lane::Relay, SubmitStatus* status = nullptr);
+
+    // Stops accepting work (later submissions return Closed), classifies
+    // everything already accepted, and waits for the last callback to
+    // return. Idempotent. Must not be called from a callback.
+    void close();
+
+    AsyncStats stats() const;
+    const AsyncOptions& options() const { return options_; }
+
+#ifdef BUDS_HAS_COROUTINES
+    class Awaitable;
+    // co_await classifyAsync(raw, lane): resumes on a pool worker with the
+    // classification. Throws AsyncRejected if the lane was full or closed,
+    // or whatever classify() threw.
+    Awaitable classifyAsync(std::vector<std::uint8_t> rawTx, Lane lane = Lane::Relay);
+#endif
+
+private:
+    struct Job {
+        std::vector<std::uint8_t> raw;
+        Tx tx;
+        bool decoded{false};   // tx is set; raw is empty
+        Lane lane{Lane::Relay};
+        AsyncCallback done;
+    };
+    struct Counters {
+        std::atomic<std::uint64_t> submitted{0};
+        std::atomic<std::uint64_t> backlogged{0};
+        std::atomic<std::uint64_t> rejected{0};
+        std::atomic<std::uint64_t> completed{0};
+        std::atomic<std::size_t> maxDepth{0};
+    };
+
+    const TagEngine& engine_;
+    ThreadPool& pool_;
+    AsyncOptions options_;
+    std::size_t highWaterDepth_;
+    std::size_t maxInFlight_;
+    std::unique_ptr<MpscRing<Job>> lanes_[kLaneCount];
+    Counters counters_[kLaneCount];
+    std::atomic<std::uint64_t> batches_{0};
+    std::atomic<std::uint64_t> batchedTxs_{0};
+
+    // Lifecycle. closed_ rejects new work; producers_ counts submissions in
+    // progress so close() can wait for them before the final drain.
+    std::atomic<bool> closed_{false};
+    std::atomic<std::size_t> producers_{0};
+    std::atomic<std::size_t> inFlight_{0};
+
+    // Dispatcher sleep / wake. Producers only take the mutex when the
+    // dispatcher has announced it is about to sleep.
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable drained_;
+    std::atomic<bool> idle_{false};
+    bool stopping_{false};   // guarded by mutex_
+    std::once_flag closeOnce_;
+    std::thread dispatcher_;
+
+    SubmitStatus push(Job& job, Lane lane);
+    void dispatchLoop();
+    bool lanesEmpty() const;
+    void dispatch(std::vector<Job>&& batch);
+    void runBatch(std::vector<Job>& batch);
+    static std::size_t jobBytes(const Job& job);
+};
+
+// Thrown by the coroutine interface when a submission is rejected.
+class AsyncRejected : public std::runtime_error {
+public:
+    explicit AsyncRejected(SubmitStatus s);
+    SubmitStatus status() const { return status_; }
+
+private:
+    SubmitStatus status_;
+};
+
+#ifdef BUDS_HAS_COROUTINES
+
+class AsyncClassifier::Awaitable {
+public:
+    Awaitable(AsyncClassifier& owner, std::vector<std::uint8_t> rawTx, Lane lane)
+        : owner_(owner), raw_(std::move(rawTx)), lane_(lane) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        SubmitStatus s = owner_.trySubmit(raw_, lane_, [this, h](AsyncResult&& r) {
+            result_ = std::move(r);
+            h.resume();
+        });
+        // Once accepted, the callback may already have resumed (and
+        // destroyed) the coroutine, so *this must not be touched again.
+        if (accepted(s)) return true;
+        status_ = s;
+        return false;
+    }
+
+    Classification await_resume() {
+        if (!accepted(status_)) throw AsyncRejected(status_);
+        if (result_.error) std::rethrow_exception(result_.error);
+        return std::move(result_.classification);
+    }
+
+private:
+    AsyncClassifier& owner_;
+    std::vector<std::uint8_t> raw_;
+    Lane lane_;
+    SubmitStatus status_{SubmitStatus::Accepted};
+    AsyncResult result_;
+};
+
+inline AsyncClassifier::Awaitable AsyncClassifier::classifyAsync(std::vector<std::uint8_t> rawTx, Lane lane) {
+    return Awaitable(*this, std::move(rawTx), lane);
+}
+
+#endif
+
+} // namespace buds
@@ -0,0 +1,333 @@
+#include "buds_blockscan.h"
+
+#include "buds_mmap.h"
+#include "buds_threadpool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace buds {
+
+namespace {
+
+std::uint32_t readLE32(const std::uint8_t* p) {
+    return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) |
+           (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+}
+
+// ---------- checkpoint serialization ----------
+
+const char kCheckpointMagic[8] = {'B', 'U', 'D', 'S', 'S', 'C', 'N', '1'};
+
+void put32(std::FILE* f, std::uint32_t v) {
+    std::uint8_t b[4] = {std::uint8_t(v), std::uint8_t(v >> 8), std::uint8_t(v >> 16), std::uint8_t(v >> 24)};
+    std::fwrite(b, 1, 4, f);
+}
+
+void put64(std::FILE* f, std::uint64_t v) {
+    put32(f, static_cast<std::uint32_t>(v));
+    put32(f, static_cast<std::uint32_t>(v >> 32));
+}
+
+bool get32(std::FILE* f, std::uint32_t& v) {
+    std::uint8_t b[4];
+    if (std::fread(b, 1, 4, f) != 4) return false;
+    v = readLE32(b);
+    return true;
+}
+
+bool get64(std::FILE* f, std::uint64_t& v) {
+    std::uint32_t lo = 0, hi = 0;
+    if (!get32(f, lo) || !get32(f, hi)) return false;
+    v = (std::uint64_t(hi) << 32) | lo;
+    return true;
+}
+
+void putStats(std::FILE* f, const BlockStats& s) {
+    put32(f, s.height);
+    std::fwrite(s.hash.bytes.data(), 1, 32, f);
+    put32(f, s.time);
+    put32(f, s.txCount);
+    put32(f, s.size);
+    put32(f, static_cast<std::uint32_t>(s.regions.T0));
+    put32(f, static_cast<std::uint32_t>(s.regions.T1));
+    put32(f, static_cast<std::uint32_t>(s.regions.T2));
+    put32(f, static_cast<std::uint32_t>(s.regions.T3));
+    for (auto v : s.arbda) put32(f, v);
+}
+
+bool getStats(std::FILE* f, BlockStats& s) {
+    std::uint32_t t[4];
+    bool ok = get32(f, s.height) && std::fread(s.hash.bytes.data(), 1, 32, f) == 32 &&
+              get32(f, s.time) && get32(f, s.txCount) && get32(f, s.size) &&
+              get32(f, t[0]) && get32(f, t[1]) && get32(f, t[2]) && get32(f, t[3]);
+    for (auto& v : s.arbda) ok = ok && get32(f, v);
+    s.regions.T0 = static_cast<int>(t[0]);
+    s.regions.T1 = static_cast<int>(t[1]);
+    s.regions.T2 = static_cast<int>(t[2]);
+    s.regions.T3 = static_cast<int>(t[3]);
+    return ok;
+}
+
+} // namespace
+
+BlockScanner::BlockScanner(const TagEngine& engine, ThreadPool& pool, ScanOptions options)
+    : engine_(engine), pool_(pool), options_(std::move(options)) {
+    loadXorKey();
+    loadCheckpoint();
+}
+
+std::string BlockScanner::blockFilePath(std::uint32_t n) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "blk%05u.dat", static_cast<unsigned>(n));
+    return (std::filesystem::path(options_.blocksDir) / name).string();
+}
+
+void BlockScanner::loadXorKey() {
+    // Bitcoin Core 28+ obfuscates block files with the 8-byte key in xor.dat.
+    std::ifstream in(std::filesystem::path(options_.blocksDir) / "xor.dat", std::ios::binary);
+    if (!in) return;
+    in.read(reinterpret_cast<char*>(xorKey_.data()), xorKey_.size());
+    if (in.gcount() != static_cast<std::streamsize>(xorKey_.size())) return;
+    for (auto b : xorKey_) obfuscated_ = obfuscated_ || b != 0;
+}
+
+bool BlockScanner::loadCheckpoint() {
+    if (options_.checkpointPath.empty()) return false;
+    std::FILE* f = std::fopen(options_.checkpointPath.c_str(), "rb");
+    if (!f) return false;
+
+    char magic[8];
+    std::uint64_t nKnown = 0, nPending = 0;
+    bool ok = std::fread(magic, 1, 8, f) == 8 && std::memcmp(magic, kCheckpointMagic, 8) == 0 &&
+              get32(f, nextFile_) && get64(f, resumeToken_) && get32(f, bestHeight_) &&
+              get64(f, nKnown);
+    for (std::uint64_t i = 0; ok && i < nKnown; ++i) {
+        Hash256 h;
+        std::uint32_t height = 0;
+        ok = std::fread(h.bytes.data(), 1, 32, f) == 32 && get32(f, height);
+        if (ok) heights_[h] = height;
+    }
+    ok = ok && get64(f, nPending);
+    for (std::uint64_t i = 0; ok && i < nPending; ++i) {
+        Hash256 prev;
+        BlockStats s;
+        ok = std::fread(prev.bytes.data(), 1, 32, f) == 32 && getStats(f, s);
+        if (ok) pending_[prev].push_back(s);
+    }
+    std::fclose(f);
+
+    if (!ok) {
+        // A torn checkpoint is never produced (writes go through a rename),
+        // so treat anything unreadable as "start from scratch".
+        nextFile_ = 0;
+        resumeToken_ = 0;
+        bestHeight_ = 0;
+        heights_.clear();
+        pending_.clear();
+    }
+    return ok;
+}
+
+void BlockScanner::saveCheckpoint(std::uint64_t token) const {
+    if (options_.checkpointPath.empty()) return;
+    std::string tmp = options_.checkpointPath + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return;
+
+    std::uint32_t floor = bestHeight_ > options_.checkpointDepth ? bestHeight_ - options_.checkpointDepth : 0;
+    std::uint64_t nKnown = 0;
+    for (const auto& kv : heights_) nKnown += kv.second >= floor ? 1 : 0;
+
+    std::fwrite(kCheckpointMagic, 1, 8, f);
+    put32(f, nextFile_);
+    put64(f, token);
+    put32(f, bestHeight_);
+    put64(f, nKnown);
+    for (const auto& kv : heights_) {
+        if (kv.second < floor) continue;
+        std::fwrite(kv.first.bytes.data(), 1, 32, f);
+        put32(f, kv.second);
+    }
+    put64(f, pendingCount());
+    for (const auto& kv : pending_) {
+        for (const auto& s : kv.second) {
+            std::fwrite(kv.first.bytes.data(), 1, 32, f);
+            putStats(f, s);
+        }
+    }
+    std::fflush(f);
+#ifndef _WIN32
+    fsync(fileno(f));
+#endif
+    std::fclose(f);
+    std::error_code ec;
+    std::filesystem::rename(tmp, options_.checkpointPath, ec);
+}
+
+std::size_t BlockScanner::pendingCount() const {
+    std::size_t n = 0;
+    for (const auto& kv : pending_) n += kv.second.size();
+    return n;
+}
+
+void BlockScanner::link(const Hash256& prev, BlockStats stats, const Sink& sink,
+                        ScanSummary& summary) {
+    static const Hash256 kNull{};
+    if (prev != kNull) {
+        auto it = heights_.find(prev);
+        if (it == heights_.end()) {
+            pending_[prev].push_back(std::move(stats));
+            return;
+        }
+        stats.height = it->second + 1;
+    } else {
+        stats.height = 0;
+    }
+
+    // Emit this block, then any descendants that were waiting on it.
+    std::vector<BlockStats> ready;
+    ready.push_back(std::move(stats));
+    while (!ready.empty()) {
+        BlockStats s = std::move(ready.back());
+        ready.pop_back();
+        for (auto& tx : s.txs) tx.height = s.height;
+        heights_[s.hash] = s.height;
+        if (s.height > bestHeight_) bestHeight_ = s.height;
+
+        ++summary.blocks;
+        summary.txs += s.txCount;
+        summary.bytes += s.size;
+        for (std::size_t t = 0; t < kTierCount; ++t) summary.arbda[t] += s.arbda[t];
+        if (sink) sink(s);
+
+        auto waiting = pending_.find(s.hash);
+        if (waiting == pending_.end()) continue;
+        for (auto& child : waiting->second) {
+            child.height = s.height + 1;
+            ready.push_back(std::move(child));
+        }
+        pending_.erase(waiting);
+    }
+}
+
+TierCounts BlockScanner::classifyKept(const TxView& tx, BlockStats& s) const {
+    TxIndexEntry e;
+    if (options_.keepTags) {
+        // One detector pass serves both outputs: the digest is read off the tags.
+        thread_local Classification c;
+        engine_.classify(tx, c);
+        engine_.classifyCompact(c, e.compact);
+        s.tags.insert(s.tags.end(), c.tags.begin(), c.tags.end());
+    } else {
+        engine_.classifyCompact(tx, e.compact);
+    }
+    if (options_.keepTxs) {
+        e.txid = tx.txid();
+        e.arbda = engine_.arbdaTier(e.compact.counts);
+        s.txs.push_back(e);   // height is set when the block is linked
+    }
+    return e.compact.counts;
+}
+
+ScanSummary BlockScanner::run(const Sink& sink, const Flush& flush) {
+    auto t0 = std::chrono::steady_clock::now();
+    ScanSummary summary;
+
+    for (;; ++nextFile_) {
+        std::string path = blockFilePath(nextFile_);
+        if (!std::filesystem::exists(path)) break;
+
+        // Obfuscated files are mapped as stored: only record headers are
+        // de-XORed while framing, and each block is de-XORed into a worker's
+        // buffer when it is classified, so no page is copied up front.
+        MappedFile file;
+        if (!file.open(path)) break;
+        ByteSpan data = file.bytes();
+        const std::uint8_t* key = obfuscated_ ? xorKey_.data() : nullptr;
+
+        // Frame records: <magic:4><size:4><block:size>. Zeroed tails come
+        // from pre-allocation; unknown bytes are skipped to the next magic.
+        std::vector<ByteSpan> blocks;
+        std::size_t pos = 0;
+        while (pos + 8 <= data.size()) {
+            std::uint8_t header[8];
+            if (key) {
+                xorDecode(header, data.data() + pos, 8, key, pos);
+            } else {
+                std::memcpy(header, data.data() + pos, 8);
+            }
+            std::uint32_t magic = readLE32(header);
+            if (magic == 0) break;
+            if (magic != options_.networkMagic) {
+                ++pos;
+                continue;
+            }
+            std::uint32_t size = readLE32(header + 4);
+            if (size > data.size() - pos - 8) break;
+            blocks.push_back(data.subspan(pos + 8, size));
+            pos += 8 + size;
+        }
+
+        // Classify every block in parallel, then link heights in file order.
+        std::vector<BlockStats> stats(blocks.size());
+        std::vector<Hash256> prevs(blocks.size());
+        std::vector<std::uint8_t> ok(blocks.size(), 0);
+        pool_.parallelFor(blocks.size(), [&](std::size_t i) {
+            thread_local BlockView block;
+            thread_local std::vector<std::uint8_t> plain;
+            ByteSpan bytes = blocks[i];
+            if (key) {
+                plain.resize(bytes.size());
+                xorDecode(plain.data(), bytes.data(), bytes.size(), key,
+                          static_cast<std::uint64_t>(bytes.data() - data.data()));
+                bytes = ByteSpan(plain.data(), plain.size());
+            }
+            if (!parseBlock(bytes, block)) return;
+            BlockStats& s = stats[i];
+            s.hash = block.hash();
+            prevs[i] = block.prevHash();
+            s.time = block.time();
+            s.txCount = static_cast<std::uint32_t>(block.txs.size());
+            s.size = static_cast<std::uint32_t>(bytes.size());
+            bool keep = options_.keepTags || options_.keepTxs;
+            for (const auto& tx : block.txs) {
+                TierCounts counts = keep ? classifyKept(tx, s) : engine_.countTiers(tx);
+                s.regions.T0 += counts.T0;
+                s.regions.T1 += counts.T1;
+                s.regions.T2 += counts.T2;
+                s.regions.T3 += counts.T3;
+                ++s.arbda[static_cast<std::size_t>(engine_.arbdaTier(counts))];
+            }
+            ok[i] = 1;
+        }, 1);
+
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            if (!ok[i]) {
+                ++summary.malformed;
+                continue;
+            }
+            link(prevs[i], std::move(stats[i]), sink, summary);
+        }
+        ++summary.files;
+
+        std::uint64_t token = flush ? flush() : 0;
+        ++nextFile_;
+        saveCheckpoint(token);
+        --nextFile_; // the loop increment moves past this file
+    }
+
+    summary.unlinked = pendingCount();
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return summary;
+}
+
+} // namespace buds
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buds_tagger.h"
+#include "buds_tx.h"
+#include "buds_txindex.h"
+
+namespace buds {
+
+class ThreadPool;
+
+// Per-block BUDS summary emitted by the scanner.
+struct BlockStats {
+    std::uint32_t height{0};
+    Hash256 hash;
+    std::uint32_t time{0};
+    std::uint32_t txCount{0};
+    std::uint32_t size{0};                            // serialized block bytes
+    TierCounts regions;                               // tiers over every tagged region
+    std::array<std::uint32_t, kTierCount> arbda{};    // transactions per ARBDA tier
+    std::vector<Tag> tags;                            // every region, with ScanOptions::keepTags
+    std::vector<TxIndexEntry> txs;                    // every transaction, with ScanOptions::keepTxs
+};
+
+struct ScanOptions {
+    std::string blocksDir;                // directory holding blk*.dat (and xor.dat)
+    std::string checkpointPath;           // empty disables checkpoint / resume
+    std::uint32_t networkMagic{0xd9b4bef9}; // mainnet message start, read little-endian
+    std::uint32_t checkpointDepth{10000}; // hash -> height entries kept below the tip
+    bool keepTags{false};                 // fill BlockStats::tags (e.g. for a ColumnarWriter)
+    bool keepTxs{false};                  // fill BlockStats::txs (e.g. for a TxIndex)
+                                          // neither list is saved in checkpoints
+};
+
+struct ScanSummary {
+    std::size_t files{0};
+    std::size_t blocks{0};        // blocks linked to the chain and emitted
+    std::size_t txs{0};
+    std::size_t bytes{0};         // block bytes classified
+    std::size_t malformed{0};     // records that failed to parse
+    std::size_t unlinked{0};      // blocks still waiting for their parent
+    std::array<std::size_t, kTierCount> arbda{};
+    double seconds{0.0};
+};
+
+// Streams Bitcoin Core blk*.dat files: each file is memory-mapped (or
+// de-obfuscated into a private copy-on-write mapping when xor.dat holds a
+// non-zero key), its blocks are classified in parallel and then linked to
+// their parents so every emitted BlockStats carries its height. Blocks may
+// appear out of order on disk; they are held back until the parent is seen.
+//
+// With a checkpoint path set, progress is saved after each completed file
+// (atomic rename) and the next run resumes from the first unfinished file.
+class BlockScanner {
+public:
+    using Sink = std::function<void(const BlockStats&)>;
+    // Called before each checkpoint is written; should make the caller's
+    // output durable and return a token (e.g. output byte offset) that is
+    // stored in the checkpoint.
+    using Flush = std::function<std::uint64_t()>;
+
+    BlockScanner(const TagEngine& engine, ThreadPool& pool, ScanOptions options);
+
+    // Token saved by the checkpoint this scanner resumed from (0 if none).
+    std::uint64_t resumeToken() const { return resumeToken_; }
+    std::uint32_t nextFile() const { return nextFile_; }
+
+    // Scans from the resume point until the first missing blkNNNNN.dat.
+    ScanSummary run(const Sink& sink, const Flush& flush = Flush());
+
+private:
+    const TagEngine& engine_;
+    ThreadPool& pool_;
+    ScanOptions options_;
+    std::array<std::uint8_t, 8> xorKey_{};
+    bool obfuscated_{false};
+
+    std::uint32_t nextFile_{0};
+    std::uint64_t resumeToken_{0};
+    std::uint32_t bestHeight_{0};
+    std::unordered_map<Hash256, std::uint32_t, Hash256Hasher> heights_;
+    std::unordered_map<Hash256, std::vector<BlockStats>, Hash256Hasher> pending_; // keyed by parent
+
+    std::string blockFilePath(std::uint32_t n) const;
+    void loadXorKey();
+    bool loadCheckpoint();
+    void saveCheckpoint(std::uint64_t token) const;
+    TierCounts classifyKept(const TxView& tx, BlockStats& s) const;
+    void link(const Hash256& prev, BlockStats stats, const Sink& sink, ScanSummary& summary);
+    std::size_t pendingCount() const;
+};
+
+} // namespace buds
@@ -0,0 +1,159 @@
+#include "buds_cache.h"
+
+#include <cstring>
+
+namespace buds {
+
+std::size_t ClassificationCache::bytesPerEntry() {
+    // Slot, plus an unordered_map node (key, value, next pointer, cached
+    // hash) and its bucket pointer.
+    return sizeof(Slot) + sizeof(Hash256) + sizeof(std::uint32_t) + 3 * sizeof(void*);
+}
+
+ClassificationCache::ClassificationCache(std::size_t memoryBudgetBytes, std::size_t shards) {
+    if (shards == 0) shards = 1;
+    std::size_t total = memoryBudgetBytes / bytesPerEntry();
+    std::size_t perShard = total / shards;
+    if (perShard == 0) perShard = 1;
+
+    shards_.reserve(shards);
+    for (std::size_t i = 0; i < shards; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->slots.resize(perShard);
+        shard->index.reserve(perShard);
+        shards_.push_back(std::move(shard));
+    }
+}
+
+ClassificationCache::Shard& ClassificationCache::shardFor(const Hash256& wtxid) {
+    // Index buckets use the low word (Hash256Hasher); shards use the high
+    // bytes so the two stay independent.
+    std::uint32_t hi;
+    std::memcpy(&hi, wtxid.bytes.data() + 28, sizeof(hi));
+    return *shards_[hi % shards_.size()];
+}
+
+std::size_t ClassificationCache::capacity() const {
+    return shards_.size() * shards_[0]->slots.size();
+}
+
+bool ClassificationCache::lookup(const Hash256& wtxid, std::uint64_t generation,
+                                 CompactClassification& out) {
+    Shard& shard = shardFor(wtxid);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(wtxid);
+    // An entry from other rules stays until the caller's insert replaces it.
+    if (it == shard.index.end() || shard.slots[it->second].generation != generation) {
+        ++shard.misses;
+        return false;
+    }
+    Slot& slot = shard.slots[it->second];
+    slot.referenced = true;
+    out = slot.value;
+    ++shard.hits;
+    return true;
+}
+
+void ClassificationCache::insertLocked(Shard& shard, const Hash256& wtxid, std::uint64_t generation,
+                                       const CompactClassification& c) {
+    auto it = shard.index.find(wtxid);
+    if (it != shard.index.end()) {
+        shard.slots[it->second].value = c;
+        shard.slots[it->second].generation = generation;
+        return;
+    }
+
+    // CLOCK: sweep, clearing reference bits, until a free or unreferenced
+    // slot comes up. Terminates within two revolutions.
+    const std::size_t n = shard.slots.size();
+    for (;;) {
+        Slot& slot = shard.slots[shard.hand];
+        if (!slot.used || !slot.referenced) break;
+        slot.referenced = false;
+        shard.hand = (shard.hand + 1) % n;
+    }
+
+    Slot& victim = shard.slots[shard.hand];
+    if (victim.used) {
+        shard.index.erase(victim.key);
+        ++shard.evictions;
+    } else {
+        ++shard.size;
+    }
+    victim.key = wtxid;
+    victim.value = c;
+    victim.generation = generation;
+    victim.used = true;
+    victim.referenced = false;
+    shard.index.emplace(wtxid, static_cast<std::uint32_t>(shard.hand));
+    shard.hand = (shard.hand + 1) % n;
+    ++shard.insertions;
+}
+
+void ClassificationCache::insert(const Hash256& wtxid, std::uint64_t generation,
+                                 const CompactClassification& c) {
+    Shard& shard = shardFor(wtxid);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    insertLocked(shard, wtxid, generation, c);
+}
+
+bool ClassificationCache::erase(const Hash256& wtxid) {
+    Shard& shard = shardFor(wtxid);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(wtxid);
+    if (it == shard.index.end()) return false;
+    Slot& slot = shard.slots[it->second];
+    slot.used = false;
+    slot.referenced = false;
+    shard.index.erase(it);
+    --shard.size;
+    return true;
+}
+
+void ClassificationCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (auto& slot : shard->slots) slot = Slot();
+        shard->index.clear();
+        shard->hand = 0;
+        shard->size = 0;
+    }
+}
+
+Evaluation ClassificationCache::evaluate(const TagEngine& engine, const TxView& tx,
+                                         double baseMinFeerate, double txFeerate) {
+    return evaluate(engine, tx.wtxid(), tx, baseMinFeerate, txFeerate);
+}
+
+Evaluation ClassificationCache::evaluate(const TagEngine& engine, const Hash256& wtxid,
+                                         const TxView& tx, double baseMinFeerate,
+                                         double txFeerate) {
+    // Read before classifying: if the rules change in between, the entry is
+    // filed under the older generation and the next lookup misses.
+    std::uint64_t generation = engine.config()->generation;
+    CompactClassification c;
+    if (!lookup(wtxid, generation, c)) {
+        // Classify outside the shard lock; a concurrent miss on the same
+        // wtxid computes the same digest and the second insert is a no-op.
+        engine.classifyCompact(tx, c);
+        insert(wtxid, generation, c);
+    }
+    return engine.evaluate(c, baseMinFeerate, txFeerate);
+}
+
+CacheStats ClassificationCache::stats() const {
+    CacheStats s;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        s.hits += shard->hits;
+        s.misses += shard->misses;
+        s.insertions += shard->insertions;
+        s.evictions += shard->evictions;
+        s.entries += shard->size;
+        s.capacity += shard->slots.size();
+    }
+    s.bytes = s.capacity * bytesPerEntry();
+    return s;
+}
+
+} // namespace buds
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buds_tagger.h"
+#include "buds_tx.h"
+
+namespace buds {
+
+// Counters for sizing the cache. Snapshot; not atomic across shards.
+struct CacheStats {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t insertions{0};
+    std::uint64_t evictions{0};
+    std::size_t entries{0};
+    std::size_t capacity{0};
+    std::size_t bytes{0};       // estimated resident bytes at full capacity
+
+    double hitRate() const {
+        std::uint64_t total = hits + misses;
+        return total ? static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+    }
+};
+
+// Bounded concurrent cache of CompactClassification keyed by wtxid, so RBF
+// attempts, template rebuilds and reorg re-adds can skip the detectors
+// entirely. A wtxid's classification only changes with the engine's rules
+// (a registry reload or a new EngineConfig), so every entry records the
+// EngineConfig::generation it was computed under and a lookup under any
+// other generation is a miss. Policy is not cached: it is recomputed from
+// the cached labels on every lookup, so a profile change on the engine
+// takes effect immediately without invalidating entries.
+//
+// The key space is split into independently locked shards, each a fixed
+// slot array with CLOCK (second-chance) eviction. Capacity is derived from
+// the memory budget.
+class ClassificationCache {
+public:
+    explicit ClassificationCache(std::size_t memoryBudgetBytes = 64u << 20,
+                                 std::size_t shards = 16);
+
+    ClassificationCache(const ClassificationCache&) = delete;
+    ClassificationCache& operator=(const ClassificationCache&) = delete;
+
+    // `generation` is the EngineConfig::generation the value belongs to.
+    bool lookup(const Hash256& wtxid, std::uint64_t generation, CompactClassification& out);
+    void insert(const Hash256& wtxid, std::uint64_t generation, const CompactClassification& c);
+    bool erase(const Hash256& wtxid);
+    void clear();
+
+    // Cached evaluate: classifies on a miss, then applies the engine's
+    // current policy. The first overload hashes the transaction for its
+    // wtxid; pass the wtxid when the caller already has it.
+    Evaluation evaluate(const TagEngine& engine, const TxView& tx,
+                        double baseMinFeerate, double txFeerate);
+    Evaluation evaluate(const TagEngine& engine, const Hash256& wtxid, const TxView& tx,
+                        double baseMinFeerate, double txFeerate);
+
+    CacheStats stats() const;
+    std::size_t capacity() const;
+
+    // Approximate bytes charged per entry (slot plus index node).
+    static std::size_t bytesPerEntry();
+
+private:
+    struct Slot {
+        Hash256 key;
+        CompactClassification value;
+        std::uint64_t generation{0};
+        bool used{false};
+        bool referenced{false};
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Slot> slots;
+        std::unordered_map<Hash256, std::uint32_t, Hash256Hasher> index;
+        std::size_t hand{0};
+        std::size_t size{0};
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+        std::uint64_t insertions{0};
+        std::uint64_t evictions{0};
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    Shard& shardFor(const Hash256& wtxid);
+    static void insertLocked(Shard& shard, const Hash256& wtxid, std::uint64_t generation,
+                             const CompactClassification& c);
+};
+
+} // namespace buds
@@ -0,0 +1,470 @@
+#include "buds_columnar.h"
+
+#include "buds_threadpool.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace buds {
+
+namespace {
+
+const char kColumnarMagic[8] = {'B', 'U', 'D', 'S', 'C', 'O', 'L', '1'};
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+constexpr std::uint32_t kColumnarVersion = 1;
+constexpr std::size_t kHeaderSize = 16;    // magic, byte order, version
+constexpr std::size_t kTrailerSize = 16;   // footer offset, magic
+constexpr std::size_t kChunkInfoSize = 40;
+
+std::uint64_t align8(std::uint64_t n) { return (n + 7) & ~std::uint64_t(7); }
+
+std::uint32_t packLabelSet(const LabelSet& labels) {
+    std::uint32_t key = static_cast<std::uint32_t>(labels.size());
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+        key |= static_cast<std::uint32_t>(labels[i] & 0xff) << (8 * (i + 1));
+    }
+    return key;
+}
+
+void putVarint(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+// Bounded: a truncated varint yields what was read so far.
+std::uint64_t getVarint(const std::uint8_t*& p, const std::uint8_t* end) {
+    std::uint64_t v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        std::uint8_t b = *p++;
+        v |= std::uint64_t(b & 0x7f) << shift;
+        if (!(b & 0x80)) break;
+    }
+    return v;
+}
+
+// Sequential reader over the mapped footer.
+class FooterCursor {
+public:
+    FooterCursor(const std::uint8_t* p, const std::uint8_t* end) : p_(p), end_(end) {}
+
+    template <typename T>
+    bool get(T& v) {
+        if (static_cast<std::size_t>(end_ - p_) < sizeof(T)) return false;
+        std::memcpy(&v, p_, sizeof(T));
+        p_ += sizeof(T);
+        return true;
+    }
+    const std::uint8_t* take(std::size_t n) {
+        if (static_cast<std::size_t>(end_ - p_) < n) return nullptr;
+        const std::uint8_t* at = p_;
+        p_ += n;
+        return at;
+    }
+
+private:
+    const std::uint8_t* p_;
+    const std::uint8_t* end_;
+};
+
+bool fail(std::string* error, const char* what) {
+    if (error) *error = what;
+    return false;
+}
+
+} // namespace
+
+// ---------- writer ----------
+
+ColumnarWriter::ColumnarWriter(const Registry& registry, std::size_t chunkRows)
+    : chunkRows_(std::max<std::size_t>(chunkRows, 1)) {
+    for (LabelId id = 0; id < kLabelCount; ++id) tiers_[id] = registry.tier(id);
+}
+
+ColumnarWriter::~ColumnarWriter() {
+    if (file_) close();
+}
+
+bool ColumnarWriter::open(const std::string& path, std::string* error) {
+    if (file_) close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    ok_ = true;
+    offset_ = 0;
+    rows_ = 0;
+    dictIndex_.clear();
+    dict_.clear();
+    chunks_.clear();
+    current_ = ChunkInfo();
+    lastHeight_ = 0;
+
+    write(kColumnarMagic, sizeof(kColumnarMagic));
+    write(&kByteOrderMark, 4);
+    write(&kColumnarVersion, 4);
+    return ok_;
+}
+
+std::uint16_t ColumnarWriter::labelSetIndex(const LabelSet& labels) {
+    std::uint32_t key = packLabelSet(labels);
+    auto it = dictIndex_.find(key);
+    if (it != dictIndex_.end()) return it->second;
+    // At most 17 * 16 * 15 ordered sets of three, so 16 bits always suffice.
+    auto index = static_cast<std::uint16_t>(dict_.size());
+    dict_.push_back(labels);
+    dictIndex_.emplace(key, index);
+    return index;
+}
+
+void ColumnarWriter::append(std::uint32_t height, const Tag* tags, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const Tag& tag = tags[i];
+        std::uint8_t worst = 0;
+        for (LabelId label : tag.labels) {
+            Tier tier = label < kLabelCount ? tiers_[label] : Tier::T3;
+            worst = std::max(worst, static_cast<std::uint8_t>(tier));
+        }
+
+        std::int64_t delta = std::int64_t(height) - std::int64_t(lastHeight_);
+        putVarint(heights_, (static_cast<std::uint64_t>(delta) << 1) ^
+                                static_cast<std::uint64_t>(delta >> 63));
+        lastHeight_ = height;
+        tierCol_.push_back(worst);
+        labelCol_.push_back(labelSetIndex(tag.labels));
+        startCol_.push_back(tag.start);
+        endCol_.push_back(tag.end);
+
+        if (current_.rows == 0) {
+            current_.minHeight = current_.maxHeight = height;
+            current_.minTier = current_.maxTier = worst;
+        } else {
+            current_.minHeight = std::min(current_.minHeight, height);
+            current_.maxHeight = std::max(current_.maxHeight, height);
+            current_.minTier = std::min(current_.minTier, worst);
+            current_.maxTier = std::max(current_.maxTier, worst);
+        }
+        current_.bytes += tag.end >= tag.start ? tag.end - tag.start : 0;
+        ++current_.rows;
+        ++rows_;
+        if (current_.rows == chunkRows_) flushChunk();
+    }
+}
+
+void ColumnarWriter::write(const void* data, std::size_t size) {
+    if (!file_ || !ok_ || size == 0) return;
+    if (std::fwrite(data, 1, size, file_) != size) ok_ = false;
+    offset_ += size;
+}
+
+void ColumnarWriter::writeColumn(const void* data, std::size_t size) {
+    static const std::uint8_t zeros[8] = {};
+    write(data, size);
+    write(zeros, align8(offset_) - offset_);
+}
+
+void ColumnarWriter::flushChunk() {
+    if (current_.rows == 0) return;
+    current_.offset = offset_;
+    current_.heightBytes = heights_.size();
+    writeColumn(heights_.data(), heights_.size());
+    writeColumn(tierCol_.data(), tierCol_.size());
+    writeColumn(labelCol_.data(), labelCol_.size() * sizeof(std::uint16_t));
+    writeColumn(startCol_.data(), startCol_.size() * sizeof(std::uint32_t));
+    writeColumn(endCol_.data(), endCol_.size() * sizeof(std::uint32_t));
+    chunks_.push_back(current_);
+
+    current_ = ChunkInfo();
+    lastHeight_ = 0;
+    heights_.clear();
+    tierCol_.clear();
+    labelCol_.clear();
+    startCol_.clear();
+    endCol_.clear();
+}
+
+bool ColumnarWriter::close(std::string* error) {
+    if (!file_) return ok_ || fail(error, "columnar write failed");
+    flushChunk();
+
+    std::uint64_t footer = offset_;
+    auto labelCount = static_cast<std::uint32_t>(kLabelCount);
+    write(&labelCount, 4);
+    for (LabelId id = 0; id < kLabelCount; ++id) {
+        const char* name = labelName(id);
+        std::uint8_t head[2] = {static_cast<std::uint8_t>(tiers_[id]),
+                                static_cast<std::uint8_t>(std::strlen(name))};
+        write(head, 2);
+        write(name, head[1]);
+    }
+
+    auto dictCount = static_cast<std::uint32_t>(dict_.size());
+    write(&dictCount, 4);
+    for (const auto& set : dict_) {
+        std::uint8_t entry[4] = {static_cast<std::uint8_t>(set.size()), 0, 0, 0};
+        for (std::size_t i = 0; i < set.size(); ++i) entry[i + 1] = static_cast<std::uint8_t>(set[i]);
+        write(entry, 4);
+    }
+
+    std::uint64_t chunkCount = chunks_.size();
+    write(&chunkCount, 8);
+    for (const auto& c : chunks_) {
+        std::uint8_t info[kChunkInfoSize] = {};
+        std::memcpy(info, &c.offset, 8);
+        std::memcpy(info + 8, &c.heightBytes, 8);
+        std::memcpy(info + 16, &c.bytes, 8);
+        std::memcpy(info + 24, &c.rows, 4);
+        std::memcpy(info + 28, &c.minHeight, 4);
+        std::memcpy(info + 32, &c.maxHeight, 4);
+        info[36] = c.minTier;
+        info[37] = c.maxTier;
+        write(info, sizeof(info));
+    }
+
+    write(&footer, 8);
+    write(kColumnarMagic, sizeof(kColumnarMagic));
+
+    if (std::fflush(file_) != 0) ok_ = false;
+    if (std::fclose(file_) != 0) ok_ = false;
+    file_ = nullptr;
+    return ok_ || fail(error, "columnar write failed");
+}
+
+// ---------- reader ----------
+
+void ColumnAggregate::add(const ColumnAggregate& o) {
+    regions += o.regions;
+    bytes += o.bytes;
+    for (std::size_t t = 0; t < kTierCount; ++t) tiers[t] += o.tiers[t];
+    for (std::size_t l = 0; l < kLabelCount; ++l) {
+        labelRegions[l] += o.labelRegions[l];
+        labelBytes[l] += o.labelBytes[l];
+    }
+    chunksRead += o.chunksRead;
+    chunksSkipped += o.chunksSkipped;
+}
+
+bool ColumnarReader::open(const std::string& path, std::string* error) {
+    chunks_.clear();
+    dict_.clear();
+    rows_ = 0;
+    minHeight_ = maxHeight_ = 0;
+    if (!file_.open(path, nullptr, false)) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+
+    ByteSpan data = file_.bytes();
+    const std::uint8_t* base = data.data();
+    std::size_t size = data.size();
+    if (size < kHeaderSize + kTrailerSize ||
+        std::memcmp(base, kColumnarMagic, 8) != 0 ||
+        std::memcmp(base + size - 8, kColumnarMagic, 8) != 0) {
+        return fail(error, "not a columnar file");
+    }
+    std::uint32_t mark = 0, version = 0;
+    std::memcpy(&mark, base + 8, 4);
+    std::memcpy(&version, base + 12, 4);
+    if (mark != kByteOrderMark) return fail(error, "columnar file has the other byte order");
+    if (version != kColumnarVersion) return fail(error, "unsupported columnar version");
+
+    std::uint64_t footer = 0;
+    std::memcpy(&footer, base + size - kTrailerSize, 8);
+    if (footer < kHeaderSize || footer > size - kTrailerSize) return fail(error, "bad footer offset");
+    FooterCursor in(base + footer, base + size - kTrailerSize);
+
+    std::uint32_t labelCount = 0;
+    if (!in.get(labelCount) || labelCount != kLabelCount) {
+        return fail(error, "label vocabulary mismatch");
+    }
+    for (LabelId id = 0; id < kLabelCount; ++id) {
+        std::uint8_t tier = 0, len = 0;
+        const std::uint8_t* name = nullptr;
+        if (!in.get(tier) || !in.get(len) || !(name = in.take(len))) {
+            return fail(error, "truncated footer");
+        }
+        if (tier >= kTierCount) return fail(error, "bad tier in footer");
+        if (std::strlen(labelName(id)) != len || std::memcmp(name, labelName(id), len) != 0) {
+            return fail(error, "label vocabulary mismatch");
+        }
+        tiers_[id] = static_cast<Tier>(tier);
+    }
+
+    std::uint32_t dictCount = 0;
+    if (!in.get(dictCount) || dictCount > 0x10000) return fail(error, "bad label-set dictionary");
+    dict_.resize(dictCount);
+    for (auto& set : dict_) {
+        const std::uint8_t* entry = in.take(4);
+        if (!entry || entry[0] > LabelSet::kCapacity) return fail(error, "bad label-set dictionary");
+        for (std::size_t i = 0; i < entry[0]; ++i) {
+            if (entry[i + 1] >= kLabelCount) return fail(error, "bad label-set dictionary");
+            set.insert(entry[i + 1]);
+        }
+    }
+
+    std::uint64_t chunkCount = 0;
+    if (!in.get(chunkCount) || chunkCount > (size / kChunkInfoSize)) {
+        return fail(error, "bad chunk directory");
+    }
+    chunks_.reserve(static_cast<std::size_t>(chunkCount));
+    for (std::uint64_t k = 0; k < chunkCount; ++k) {
+        const std::uint8_t* info = in.take(kChunkInfoSize);
+        if (!info) return fail(error, "truncated footer");
+        std::uint64_t offset = 0, heightBytes = 0;
+        Chunk c;
+        std::memcpy(&offset, info, 8);
+        std::memcpy(&heightBytes, info + 8, 8);
+        std::memcpy(&c.rows, info + 24, 4);
+        std::memcpy(&c.minHeight, info + 28, 4);
+        std::memcpy(&c.maxHeight, info + 32, 4);
+        c.minTier = info[36];
+        c.maxTier = info[37];
+
+        // Columns follow one another, each 8-byte aligned; all must end
+        // before the footer. Sizes are bounded by the file, so no overflow.
+        if (offset % 8 != 0 || offset < kHeaderSize || offset > footer ||
+            heightBytes > footer - offset) {
+            return fail(error, "chunk out of bounds");
+        }
+        std::uint64_t rows = c.rows;
+        std::uint64_t tiersAt = align8(offset + heightBytes);
+        std::uint64_t labelsAt = align8(tiersAt + rows);
+        std::uint64_t startsAt = align8(labelsAt + rows * 2);
+        std::uint64_t endsAt = align8(startsAt + rows * 4);
+        if (rows > footer || endsAt + rows * 4 > footer) return fail(error, "chunk out of bounds");
+
+        c.heights = base + offset;
+        c.heightsEnd = c.heights + heightBytes;
+        c.tiers = base + tiersAt;
+        c.labels = reinterpret_cast<const std::uint16_t*>(base + labelsAt);
+        c.starts = reinterpret_cast<const std::uint32_t*>(base + startsAt);
+        c.ends = reinterpret_cast<const std::uint32_t*>(base + endsAt);
+
+        if (c.rows) {
+            minHeight_ = rows_ ? std::min(minHeight_, c.minHeight) : c.minHeight;
+            maxHeight_ = rows_ ? std::max(maxHeight_, c.maxHeight) : c.maxHeight;
+        }
+        rows_ += c.rows;
+        chunks_.push_back(c);
+    }
+    return true;
+}
+
+namespace {
+
+bool selects(std::uint32_t rows, std::uint32_t minHeight, std::uint32_t maxHeight,
+             std::uint8_t maxTier, const ColumnQuery& q) {
+    return rows != 0 && maxHeight >= q.minHeight && minHeight <= q.maxHeight &&
+           maxTier >= static_cast<std::uint8_t>(q.minTier);
+}
+
+// Same rule as the writer's chunk byte count: an inverted range (the writer
+// stores tags as given) counts as empty rather than wrapping.
+inline std::uint32_t rangeBytes(std::uint32_t start, std::uint32_t end) {
+    return end >= start ? end - start : 0;
+}
+
+} // namespace
+
+void ColumnarReader::scanChunk(const Chunk& c, const ColumnQuery& q, std::uint64_t* regions,
+                               std::uint64_t* bytes) const {
+    const std::size_t dictSize = dict_.size();
+    const auto minTier = static_cast<std::uint8_t>(q.minTier);
+    bool allHeights = q.minHeight <= c.minHeight && c.maxHeight <= q.maxHeight;
+    bool allTiers = minTier <= c.minTier;
+
+    if (allHeights && allTiers) {
+        // Whole chunk selected: labels and byte ranges only.
+        for (std::uint32_t i = 0; i < c.rows; ++i) {
+            std::uint16_t d = c.labels[i];
+            if (d >= dictSize) continue;
+            ++regions[d];
+            bytes[d] += rangeBytes(c.starts[i], c.ends[i]);
+        }
+        return;
+    }
+    if (allHeights) {
+        for (std::uint32_t i = 0; i < c.rows; ++i) {
+            std::uint16_t d = c.labels[i];
+            if (c.tiers[i] < minTier || d >= dictSize) continue;
+            ++regions[d];
+            bytes[d] += rangeBytes(c.starts[i], c.ends[i]);
+        }
+        return;
+    }
+
+    const std::uint8_t* p = c.heights;
+    std::uint32_t height = 0;
+    for (std::uint32_t i = 0; i < c.rows; ++i) {
+        std::uint64_t zz = getVarint(p, c.heightsEnd);
+        auto delta = static_cast<std::int64_t>(zz >> 1) ^ -static_cast<std::int64_t>(zz & 1);
+        height = static_cast<std::uint32_t>(static_cast<std::int64_t>(height) + delta);
+        std::uint16_t d = c.labels[i];
+        if (height < q.minHeight || height > q.maxHeight || c.tiers[i] < minTier ||
+            d >= dictSize) {
+            continue;
+        }
+        ++regions[d];
+        bytes[d] += rangeBytes(c.starts[i], c.ends[i]);
+    }
+}
+
+void ColumnarReader::expand(const std::vector<std::uint64_t>& regions,
+                            const std::vector<std::uint64_t>& bytes, ColumnAggregate& out) const {
+    for (std::size_t d = 0; d < dict_.size(); ++d) {
+        if (regions[d] == 0) continue;
+        out.regions += regions[d];
+        out.bytes += bytes[d];
+        for (LabelId label : dict_[d]) {
+            out.labelRegions[label] += regions[d];
+            out.labelBytes[label] += bytes[d];
+            out.tiers[static_cast<std::size_t>(tiers_[label])] += regions[d];
+        }
+    }
+}
+
+ColumnAggregate ColumnarReader::aggregate(const ColumnQuery& query) const {
+    ColumnAggregate out;
+    std::vector<std::uint64_t> regions(dict_.size()), bytes(dict_.size());
+    for (const auto& c : chunks_) {
+        if (!selects(c.rows, c.minHeight, c.maxHeight, c.maxTier, query)) {
+            ++out.chunksSkipped;
+            continue;
+        }
+        ++out.chunksRead;
+        scanChunk(c, query, regions.data(), bytes.data());
+    }
+    expand(regions, bytes, out);
+    return out;
+}
+
+ColumnAggregate ColumnarReader::aggregate(const ColumnQuery& query, ThreadPool& pool) const {
+    // A few slices per worker; each keeps its own per-entry counters.
+    std::size_t slices = std::min(chunks_.size(), pool.size() * 4 + 1);
+    if (slices <= 1) return aggregate(query);
+    std::vector<ColumnAggregate> partial(slices);
+    pool.parallelFor(slices, [&](std::size_t s) {
+        std::vector<std::uint64_t> regions(dict_.size()), bytes(dict_.size());
+        std::size_t first = chunks_.size() * s / slices;
+        std::size_t last = chunks_.size() * (s + 1) / slices;
+        for (std::size_t k = first; k < last; ++k) {
+            const Chunk& c = chunks_[k];
+            if (!selects(c.rows, c.minHeight, c.maxHeight, c.maxTier, query)) {
+                ++partial[s].chunksSkipped;
+                continue;
+            }
+            ++partial[s].chunksRead;
+            scanChunk(c, query, regions.data(), bytes.data());
+        }
+        expand(regions, bytes, partial[s]);
+    }, 1);
+
+    ColumnAggregate out;
+    for (const auto& p : partial) out.add(p);
+    return out;
+}
+
+} // namespace buds
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buds_mmap.h"
+#include "buds_tagger.h"
+
+namespace buds {
+
+class ThreadPool;
+
+// Columnar region file ("BUDSCOL1"): one row per tagged region, written in
+// chunks of up to chunkRows rows. Each chunk stores its columns back to
+// back, every column 8-byte aligned:
+//
+//   height   zigzag varint of the delta to the previous row (first: to 0)
+//   tier     u8, worst tier among the region's labels
+//   labels   u16 index into the file's label-set dictionary
+//   start    u32 byte offset within the surface
+//   end      u32 end offset (exclusive)
+//
+// The footer holds the label vocabulary with the tier each label had when
+// the file was written, the label-set dictionary, and per-chunk stats
+// (row count, min/max height, min/max tier, region bytes) followed by the
+// footer offset and the magic. Integers are stored in host byte order; the
+// header records it and readers refuse a mismatch.
+class ColumnarWriter {
+public:
+    static constexpr std::size_t kDefaultChunkRows = 1 << 16;
+
+    // Tiers are taken from `registry` once, so a registry switch on the
+    // engine while the file is being written does not mix tier tables.
+    explicit ColumnarWriter(const Registry& registry = Registry(),
+                            std::size_t chunkRows = kDefaultChunkRows);
+    ~ColumnarWriter();
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    bool open(const std::string& path, std::string* error = nullptr);
+
+    // One row per tag, all at `height`.
+    void append(std::uint32_t height, const Tag* tags, std::size_t count);
+    void append(std::uint32_t height, const Classification& c) {
+        append(height, c.tags.data(), c.tags.size());
+    }
+
+    // Flushes the last chunk and writes the footer. The file is unreadable
+    // until this returns true; the destructor calls it if needed.
+    bool close(std::string* error = nullptr);
+
+    std::uint64_t rows() const { return rows_; }
+
+private:
+    struct ChunkInfo {
+        std::uint64_t offset{0};        // file offset of the height column
+        std::uint64_t heightBytes{0};
+        std::uint64_t bytes{0};         // sum of end - start
+        std::uint32_t rows{0};
+        std::uint32_t minHeight{0};
+        std::uint32_t maxHeight{0};
+        std::uint8_t minTier{0};
+        std::uint8_t maxTier{0};
+    };
+
+    std::array<Tier, kLabelCount> tiers_{};
+    std::size_t chunkRows_;
+    std::FILE* file_{nullptr};
+    bool ok_{true};
+    std::uint64_t offset_{0};
+    std::uint64_t rows_{0};
+
+    std::unordered_map<std::uint32_t, std::uint16_t> dictIndex_; // packed LabelSet -> index
+    std::vector<LabelSet> dict_;
+    std::vector<ChunkInfo> chunks_;
+
+    // Current chunk.
+    std::vector<std::uint8_t> heights_;
+    std::vector<std::uint8_t> tierCol_;
+    std::vector<std::uint16_t> labelCol_;
+    std::vector<std::uint32_t> startCol_;
+    std::vector<std::uint32_t> endCol_;
+    ChunkInfo current_;
+    std::uint32_t lastHeight_{0};
+
+    std::uint16_t labelSetIndex(const LabelSet& labels);
+    void write(const void* data, std::size_t size);
+    void writeColumn(const void* data, std::size_t size);
+    void flushChunk();
+};
+
+struct ColumnQuery {
+    std::uint32_t minHeight{0};
+    std::uint32_t maxHeight{UINT32_MAX};   // inclusive
+    Tier minTier{Tier::T0};                // only regions whose worst tier is at least this
+};
+
+// Totals over the rows a query selects. `tiers` counts label occurrences
+// per tier, like TierCounts, using the tiers recorded in the file.
+struct ColumnAggregate {
+    std::uint64_t regions{0};
+    std::uint64_t bytes{0};
+    std::array<std::uint64_t, kTierCount> tiers{};
+    std::array<std::uint64_t, kLabelCount> labelRegions{};
+    std::array<std::uint64_t, kLabelCount> labelBytes{};
+    std::size_t chunksRead{0};
+    std::size_t chunksSkipped{0};    // excluded by chunk stats, no column touched
+
+    void add(const ColumnAggregate& o);
+};
+
+// Memory-mapped reader for ColumnarWriter files. A query reads only the
+// chunks whose stats overlap it, and within a chunk only the columns it
+// needs: the height column is decoded only for chunks that straddle the
+// height range, and the tier column only when filtering by tier. Label
+// totals are accumulated per dictionary entry and expanded at the end.
+class ColumnarReader {
+public:
+    // Validates the header, footer and chunk bounds; false with a reason
+    // on anything malformed or written with a different label vocabulary.
+    bool open(const std::string& path, std::string* error = nullptr);
+
+    std::uint64_t rows() const { return rows_; }
+    std::size_t chunkCount() const { return chunks_.size(); }
+    std::uint32_t minHeight() const { return minHeight_; }
+    std::uint32_t maxHeight() const { return maxHeight_; }
+    Tier tierForLabel(LabelId id) const { return id < kLabelCount ? tiers_[id] : Tier::T3; }
+
+    ColumnAggregate aggregate(const ColumnQuery& query = ColumnQuery()) const;
+    // Same result; chunks are spread across `pool`.
+    ColumnAggregate aggregate(const ColumnQuery& query, ThreadPool& pool) const;
+
+private:
+    struct Chunk {
+        const std::uint8_t* heights{nullptr};
+        const std::uint8_t* heightsEnd{nullptr};
+        const std::uint8_t* tiers{nullptr};
+        const std::uint16_t* labels{nullptr};
+        const std::uint32_t* starts{nullptr};
+        const std::uint32_t* ends{nullptr};
+        std::uint32_t rows{0};
+        std::uint32_t minHeight{0};
+        std::uint32_t maxHeight{0};
+        std::uint8_t minTier{0};
+        std::uint8_t maxTier{0};
+    };
+
+    MappedFile file_;
+    std::vector<Chunk> chunks_;
+    std::vector<LabelSet> dict_;
+    std::array<Tier, kLabelCount> tiers_{};
+    std::uint64_t rows_{0};
+    std::uint32_t minHeight_{0};
+    std::uint32_t maxHeight_{0};
+
+    // Adds the chunk's selected rows to per-dictionary-entry counters.
+    void scanChunk(const Chunk& chunk, const ColumnQuery& query, std::uint64_t* regions,
+                   std::uint64_t* bytes) const;
+    void expand(const std::vector<std::uint64_t>& regions, const std::vector<std::uint64_t>& bytes,
+                ColumnAggregate& out) const;
+};
+
+} // namespace buds
@@ -0,0 +1,68 @@
+#include "buds_entropy.h"
+
+#include "buds_hex.h"
+
+#include <cmath>
+
+namespace buds {
+
+ByteStats analyzeBytes(ByteSpan data, const EntropyOptions& options) {
+    ByteStats stats;
+    stats.size = static_cast<std::uint32_t>(data.size());
+    if (data.empty()) return stats;
+
+    std::uint32_t hist[256] = {};
+    const std::size_t span = options.sampleBlock * options.sampleBlocks;
+    if (data.size() > options.sampleAbove && options.sampleBlocks > 1 && span < data.size()) {
+        // Evenly spaced blocks keep the cost flat for multi-hundred-KB items
+        // while still covering both ends, where headers and trailers live.
+        const std::size_t stride = (data.size() - options.sampleBlock) / (options.sampleBlocks - 1);
+        for (std::size_t b = 0; b < options.sampleBlocks; ++b) {
+            byteHistogram(data.data() + b * stride, options.sampleBlock, hist);
+        }
+        stats.sampled = static_cast<std::uint32_t>(span);
+    } else {
+        byteHistogram(data.data(), data.size(), hist);
+        stats.sampled = stats.size;
+    }
+
+    const double n = stats.sampled;
+    const double expected = n / 256.0;
+    double entropy = 0.0;
+    double chi = 0.0;
+    std::uint32_t distinct = 0;
+    for (std::size_t v = 0; v < 256; ++v) {
+        const double c = hist[v];
+        const double d = c - expected;
+        chi += d * d;
+        if (hist[v]) {
+            ++distinct;
+            entropy -= c * std::log2(c / n);
+        }
+    }
+    stats.distinct = distinct;
+    stats.entropy = entropy / n;
+    stats.chiSquare = chi / expected;
+    return stats;
+}
+
+double expectedUniformEntropy(std::size_t n) {
+    if (n == 0) return 0.0;
+    // With D = expected distinct values among n uniform bytes, log2(D) is
+    // tight while most bins are still empty and the Miller-Madow bias
+    // 8 - (D - 1) / (2n ln 2) once they fill up; the smaller of the two is
+    // within ~0.2 bits of the true mean at every n.
+    const double dn = static_cast<double>(n);
+    const double distinct = 256.0 * (1.0 - std::pow(255.0 / 256.0, dn));
+    const double sparse = std::log2(distinct);
+    const double dense = 8.0 - (distinct - 1.0) / (2.0 * dn * std::log(2.0));
+    return sparse < dense ? sparse : dense;
+}
+
+bool looksUniform(const ByteStats& stats, const EntropyOptions& options) {
+    if (stats.size < options.minBytes || stats.sampled == 0) return false;
+    if (stats.chiSquare > options.maxChiSquare) return false;
+    return stats.entropy >= expectedUniformEntropy(stats.sampled) - options.entropySlack;
+}
+
+} // namespace buds
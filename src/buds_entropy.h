@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "buds_tx.h"
+
+namespace buds {
+
+// Byte-distribution statistics for one region.
+struct ByteStats {
+    std::uint32_t size{0};       // region bytes
+    std::uint32_t sampled{0};    // bytes histogrammed (== size unless sampled)
+    std::uint32_t distinct{0};   // byte values seen
+    double entropy{0.0};         // Shannon entropy of the sample, bits per byte
+    double chiSquare{0.0};       // Pearson chi-square against uniform, 255 dof
+};
+
+struct EntropyOptions {
+    // Regions shorter than this are never judged by their distribution:
+    // signatures (64-73 bytes) and keys are uniform-looking by design.
+    std::size_t minBytes{96};
+    // Above `sampleAbove` bytes, `sampleBlocks` evenly spaced blocks of
+    // `sampleBlock` bytes (first and last included) are histogrammed
+    // instead of the whole region.
+    std::size_t sampleAbove{64 * 1024};
+    std::size_t sampleBlock{4096};
+    std::size_t sampleBlocks{16};
+    // Uniform data has E[chi2] = 255 with standard deviation ~22.6 at any
+    // sample size; 400 is beyond six sigma. Text, scripts with repeated
+    // opcodes and padding land far above it.
+    double maxChiSquare{400.0};
+    // Allowed shortfall against the entropy expected of uniform data of the
+    // same sample size (the plug-in estimate is biased low for short input).
+    double entropySlack{0.5};
+};
+
+ByteStats analyzeBytes(ByteSpan data, const EntropyOptions& options = EntropyOptions());
+
+// Expected plug-in entropy of n uniformly random bytes (bits per byte).
+double expectedUniformEntropy(std::size_t n);
+
+// True if `stats` is consistent with uniformly random bytes: encrypted,
+// compressed or otherwise deliberately opaque data.
+bool looksUniform(const ByteStats& stats, const EntropyOptions& options = EntropyOptions());
+
+} // namespace buds
@@ -0,0 +1,313 @@
+#include "buds_hex.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define BUDS_HEX_X86 1
+#include <immintrin.h>
+#endif
+
+namespace buds {
+
+namespace {
+
+inline int nibble(unsigned char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+#ifdef BUDS_HEX_X86
+
+// Per-lane nibble values for 16 characters plus an all-ones mask where the
+// character was a valid hex digit.
+__attribute__((target("sse2")))
+inline __m128i nibblesSse2(__m128i c, __m128i& valid) {
+    const __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    const __m128i isDigit = _mm_and_si128(
+        _mm_cmpeq_epi8(_mm_max_epu8(c, _mm_set1_epi8('0')), c),
+        _mm_cmpeq_epi8(_mm_min_epu8(c, _mm_set1_epi8('9')), c));
+    const __m128i isAlpha = _mm_and_si128(
+        _mm_cmpeq_epi8(_mm_max_epu8(lower, _mm_set1_epi8('a')), lower),
+        _mm_cmpeq_epi8(_mm_min_epu8(lower, _mm_set1_epi8('f')), lower));
+    valid = _mm_or_si128(isDigit, isAlpha);
+    const __m128i digitVal = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    const __m128i alphaVal = _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10));
+    return _mm_or_si128(_mm_and_si128(isDigit, digitVal),
+                        _mm_andnot_si128(isDigit, alphaVal));
+}
+
+// Folds (hi, lo) nibble pairs in 16-bit lanes into one byte per lane.
+__attribute__((target("sse2")))
+inline __m128i pairsSse2(__m128i n) {
+    const __m128i hi = _mm_and_si128(_mm_slli_epi16(n, 4), _mm_set1_epi16(0x00f0));
+    const __m128i lo = _mm_srli_epi16(n, 8);
+    return _mm_or_si128(hi, lo);
+}
+
+__attribute__((target("sse2")))
+std::size_t hexDecodeSse2(const char* hex, std::size_t len, std::uint8_t* out) {
+    std::size_t i = 0;
+    std::size_t n = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m128i v0, v1;
+        __m128i a = nibblesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + i)), v0);
+        __m128i b = nibblesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + i + 16)), v1);
+        if (_mm_movemask_epi8(_mm_and_si128(v0, v1)) != 0xffff) {
+            // Rare: invalid digits in this block, let the scalar path skip them.
+            n += hexDecodeScalar(hex + i, 32, out + n);
+            continue;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + n),
+                         _mm_packus_epi16(pairsSse2(a), pairsSse2(b)));
+        n += 16;
+    }
+    return n + hexDecodeScalar(hex + i, len - i, out + n);
+}
+
+__attribute__((target("sse2")))
+std::size_t countPrintableSse2(const std::uint8_t* data, std::size_t len) {
+    const __m128i lo = _mm_set1_epi8(0x20);
+    const __m128i hi = _mm_set1_epi8(0x7e);
+    std::size_t total = 0;
+    std::size_t i = 0;
+    while (i + 16 <= len) {
+        // Byte lanes count up to 255 matches before they must be flushed.
+        __m128i acc = _mm_setzero_si128();
+        std::size_t blockEnd = i + 255 * 16 < len ? i + 255 * 16 : len;
+        for (; i + 16 <= blockEnd; i += 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i ok = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(x, lo), x),
+                                       _mm_cmpeq_epi8(_mm_min_epu8(x, hi), x));
+            acc = _mm_sub_epi8(acc, ok);
+        }
+        __m128i sums = _mm_sad_epu8(acc, _mm_setzero_si128());
+        total += static_cast<std::size_t>(_mm_cvtsi128_si32(sums)) +
+                 static_cast<std::size_t>(_mm_extract_epi16(sums, 4));
+    }
+    return total + countPrintableScalar(data + i, len - i);
+}
+
+// Candidate positions are where both the first and the last needle byte
+// match; only those get a full compare. Requires m >= 2.
+__attribute__((target("sse2")))
+const std::uint8_t* findBytesSse2(const std::uint8_t* data, std::size_t len,
+                                  const std::uint8_t* needle, std::size_t m) {
+    const __m128i first = _mm_set1_epi8(static_cast<char>(needle[0]));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(needle[m - 1]));
+    std::size_t i = 0;
+    for (; i + m - 1 + 16 <= len; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + m - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        while (mask) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (std::memcmp(data + i + bit + 1, needle + 1, m - 2) == 0) return data + i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return findBytesScalar(data + i, len - i, needle, m);
+}
+
+__attribute__((target("avx2")))
+inline __m256i nibblesAvx2(__m256i c, __m256i& valid) {
+    const __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+    const __m256i isDigit = _mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_max_epu8(c, _mm256_set1_epi8('0')), c),
+        _mm256_cmpeq_epi8(_mm256_min_epu8(c, _mm256_set1_epi8('9')), c));
+    const __m256i isAlpha = _mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_max_epu8(lower, _mm256_set1_epi8('a')), lower),
+        _mm256_cmpeq_epi8(_mm256_min_epu8(lower, _mm256_set1_epi8('f')), lower));
+    valid = _mm256_or_si256(isDigit, isAlpha);
+    const __m256i digitVal = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    const __m256i alphaVal = _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10));
+    return _mm256_or_si256(_mm256_and_si256(isDigit, digitVal),
+                           _mm256_andnot_si256(isDigit, alphaVal));
+}
+
+__attribute__((target("avx2")))
+inline __m256i pairsAvx2(__m256i n) {
+    const __m256i hi = _mm256_and_si256(_mm256_slli_epi16(n, 4), _mm256_set1_epi16(0x00f0));
+    const __m256i lo = _mm256_srli_epi16(n, 8);
+    return _mm256_or_si256(hi, lo);
+}
+
+__attribute__((target("avx2")))
+std::size_t hexDecodeAvx2(const char* hex, std::size_t len, std::uint8_t* out) {
+    std::size_t i = 0;
+    std::size_t n = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m256i v0, v1;
+        __m256i a = nibblesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + i)), v0);
+        __m256i b = nibblesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + i + 32)), v1);
+        if (_mm256_movemask_epi8(_mm256_and_si256(v0, v1)) != -1) {
+            n += hexDecodeScalar(hex + i, 64, out + n);
+            continue;
+        }
+        // packus interleaves 128-bit lanes; restore byte order afterwards.
+        __m256i packed = _mm256_packus_epi16(pairsAvx2(a), pairsAvx2(b));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + n),
+                            _mm256_permute4x64_epi64(packed, 0xd8));
+        n += 32;
+    }
+    return n + hexDecodeSse2(hex + i, len - i, out + n);
+}
+
+__attribute__((target("avx2")))
+std::size_t countPrintableAvx2(const std::uint8_t* data, std::size_t len) {
+    const __m256i lo = _mm256_set1_epi8(0x20);
+    const __m256i hi = _mm256_set1_epi8(0x7e);
+    std::size_t total = 0;
+    std::size_t i = 0;
+    while (i + 32 <= len) {
+        __m256i acc = _mm256_setzero_si256();
+        std::size_t blockEnd = i + 255 * 32 < len ? i + 255 * 32 : len;
+        for (; i + 32 <= blockEnd; i += 32) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i ok = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(x, lo), x),
+                                          _mm256_cmpeq_epi8(_mm256_min_epu8(x, hi), x));
+            acc = _mm256_sub_epi8(acc, ok);
+        }
+        __m256i sums = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+        total += static_cast<std::size_t>(_mm256_extract_epi64(sums, 0)) +
+                 static_cast<std::size_t>(_mm256_extract_epi64(sums, 1)) +
+                 static_cast<std::size_t>(_mm256_extract_epi64(sums, 2)) +
+                 static_cast<std::size_t>(_mm256_extract_epi64(sums, 3));
+    }
+    return total + countPrintableSse2(data + i, len - i);
+}
+
+__attribute__((target("avx2")))
+const std::uint8_t* findBytesAvx2(const std::uint8_t* data, std::size_t len,
+                                  const std::uint8_t* needle, std::size_t m) {
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(needle[0]));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(needle[m - 1]));
+    std::size_t i = 0;
+    for (; i + m - 1 + 32 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + m - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        while (mask) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (std::memcmp(data + i + bit + 1, needle + 1, m - 2) == 0) return data + i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return findBytesSse2(data + i, len - i, needle, m);
+}
+
+#endif // BUDS_HEX_X86
+
+struct Kernels {
+    std::size_t (*decode)(const char*, std::size_t, std::uint8_t*);
+    std::size_t (*printable)(const std::uint8_t*, std::size_t);
+    const std::uint8_t* (*find)(const std::uint8_t*, std::size_t, const std::uint8_t*, std::size_t);
+    const char* name;
+};
+
+Kernels selectKernels() {
+#ifdef BUDS_HEX_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {hexDecodeAvx2, countPrintableAvx2, findBytesAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {hexDecodeSse2, countPrintableSse2, findBytesSse2, "sse2"};
+    }
+#endif
+    return {hexDecodeScalar, countPrintableScalar, findBytesScalar, "scalar"};
+}
+
+const Kernels& kernels() {
+    static const Kernels k = selectKernels();
+    return k;
+}
+
+} // namespace
+
+std::size_t hexDecodeScalar(const char* hex, std::size_t len, std::uint8_t* out) {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i + 1 < len; i += 2) {
+        int hi = nibble(static_cast<unsigned char>(hex[i]));
+        int lo = nibble(static_cast<unsigned char>(hex[i + 1]));
+        if (hi < 0 || lo < 0) continue;
+        out[n++] = static_cast<std::uint8_t>((hi << 4) | lo);
+    }
+    return n;
+}
+
+std::size_t countPrintableScalar(const std::uint8_t* data, std::size_t len) {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < len; ++i) {
+        n += (data[i] >= 0x20 && data[i] <= 0x7e) ? 1 : 0;
+    }
+    return n;
+}
+
+const std::uint8_t* findBytesScalar(const std::uint8_t* data, std::size_t len,
+                                    const std::uint8_t* needle, std::size_t m) {
+    if (m == 0) return data;
+    if (m > len) return nullptr;
+    const std::uint8_t* end = data + len - m + 1;
+    for (const std::uint8_t* p = data; p < end; ++p) {
+        p = static_cast<const std::uint8_t*>(std::memchr(p, needle[0], static_cast<std::size_t>(end - p)));
+        if (!p) return nullptr;
+        if (std::memcmp(p + 1, needle + 1, m - 1) == 0) return p;
+    }
+    return nullptr;
+}
+
+void byteHistogramScalar(const std::uint8_t* data, std::size_t len, std::uint32_t* hist) {
+    for (std::size_t i = 0; i < len; ++i) ++hist[data[i]];
+}
+
+void byteHistogram(const std::uint8_t* data, std::size_t len, std::uint32_t* hist) {
+    if (len < 256) return byteHistogramScalar(data, len, hist);
+
+    // There is no scatter-increment on SSE2/AVX2, so the speedup comes from
+    // breaking the store-to-load chains instead: four tables, each fed one
+    // byte lane of every 32-bit word. The merge is a vectorizable loop.
+    std::uint32_t sub[4][256] = {};
+    std::size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        std::uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        ++sub[0][w & 0xff];
+        ++sub[1][(w >> 8) & 0xff];
+        ++sub[2][(w >> 16) & 0xff];
+        ++sub[3][(w >> 24) & 0xff];
+        ++sub[0][(w >> 32) & 0xff];
+        ++sub[1][(w >> 40) & 0xff];
+        ++sub[2][(w >> 48) & 0xff];
+        ++sub[3][w >> 56];
+    }
+    for (; i < len; ++i) ++sub[0][data[i]];
+    for (std::size_t v = 0; v < 256; ++v) hist[v] += sub[0][v] + sub[1][v] + sub[2][v] + sub[3][v];
+}
+
+// Short inputs (hints, pubkeys) stay on the scalar path: the dispatch and
+// vector tails cost more than they save below a couple of vector widths.
+std::size_t hexDecode(const char* hex, std::size_t len, std::uint8_t* out) {
+    if (len < 64) return hexDecodeScalar(hex, len, out);
+    return kernels().decode(hex, len, out);
+}
+
+std::size_t countPrintable(const std::uint8_t* data, std::size_t len) {
+    if (len < 32) return countPrintableScalar(data, len);
+    return kernels().printable(data, len);
+}
+
+const std::uint8_t* findBytes(const std::uint8_t* data, std::size_t len,
+                              const std::uint8_t* needle, std::size_t m) {
+    if (m < 2 || len < 64) return findBytesScalar(data, len, needle, m);
+    return kernels().find(data, len, needle, m);
+}
+
+const char* hexKernelName() {
+    return kernels().name;
+}
+
+} // namespace buds
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace buds {
+
+// Hex / byte-scanning kernels shared by the hex adapter and the ASCII
+// heuristic. On x86 the SSE2 / AVX2 variants are selected once at runtime;
+// every other target uses the scalar code.
+
+// Decodes `len` hex characters into `out` (which must hold len / 2 bytes) and
+// returns the number of bytes written. Pairs containing a non-hex digit are
+// skipped; a trailing odd nibble is ignored.
+std::size_t hexDecode(const char* hex, std::size_t len, std::uint8_t* out);
+
+// Number of bytes in [0x20, 0x7e].
+std::size_t countPrintable(const std::uint8_t* data, std::size_t len);
+
+// First occurrence of needle[0 .. m) in data[0 .. len), or nullptr (memmem).
+// The vector kernels filter candidates on the needle's first and last byte.
+const std::uint8_t* findBytes(const std::uint8_t* data, std::size_t len,
+                              const std::uint8_t* needle, std::size_t m);
+
+// Adds the byte-value counts of data[0 .. len) to hist[0 .. 256). Counts
+// go to four interleaved sub-histograms (64-bit loads, one byte lane each)
+// so consecutive equal bytes do not serialize on one counter, then merge.
+void byteHistogram(const std::uint8_t* data, std::size_t len, std::uint32_t* hist);
+
+// Portable reference implementations (used by tests and benchmarks).
+std::size_t hexDecodeScalar(const char* hex, std::size_t len, std::uint8_t* out);
+std::size_t countPrintableScalar(const std::uint8_t* data, std::size_t len);
+void byteHistogramScalar(const std::uint8_t* data, std::size_t len, std::uint32_t* hist);
+const std::uint8_t* findBytesScalar(const std::uint8_t* data, std::size_t len,
+                                    const std::uint8_t* needle, std::size_t m);
+
+// "avx2", "sse2" or "scalar".
+const char* hexKernelName();
+
+} // namespace buds
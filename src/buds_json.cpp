@@ -0,0 +1,422 @@
+#include "buds_json.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace buds {
+
+const JsonValue* JsonValue::find(const std::string& key) const {
+    if (type != Type::Object) return nullptr;
+    for (const auto& member : object) {
+        if (member.first == key) return &member.second;
+    }
+    return nullptr;
+}
+
+namespace {
+
+// Nesting beyond this is rejected rather than risking deep recursion on
+// hostile input; real configuration files stay in single digits.
+constexpr int kMaxDepth = 64;
+
+class Parser {
+public:
+    explicit Parser(const std::string& text) : s_(text.data()), n_(text.size()) {}
+
+    bool document(JsonValue& out) {
+        skipSpace();
+        if (!value(out, 0)) return false;
+        skipSpace();
+        return pos_ == n_ || fail("trailing characters");
+    }
+
+    const std::string& error() const { return error_; }
+
+private:
+    const char* s_;
+    std::size_t n_;
+    std::size_t pos_{0};
+    std::string error_;
+
+    bool fail(const char* what) {
+        if (error_.empty()) error_ = std::string(what) + " at offset " + std::to_string(pos_);
+        return false;
+    }
+
+    void skipSpace() {
+        while (pos_ < n_ && (s_[pos_] == ' ' || s_[pos_] == '\t' || s_[pos_] == '\n' || s_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool literal(const char* word) {
+        std::size_t len = std::strlen(word);
+        if (n_ - pos_ < len || std::memcmp(s_ + pos_, word, len) != 0) return fail("invalid literal");
+        pos_ += len;
+        return true;
+    }
+
+    bool value(JsonValue& out, int depth) {
+        if (pos_ >= n_) return fail("unexpected end of input");
+        out = JsonValue();
+        switch (s_[pos_]) {
+        case '{': return object(out, depth);
+        case '[': return array(out, depth);
+        case '"': out.type = JsonValue::Type::String; return string(out.string);
+        case 't': out.type = JsonValue::Type::Bool; out.boolean = true; return literal("true");
+        case 'f': out.type = JsonValue::Type::Bool; return literal("false");
+        case 'n': return literal("null");
+        default:  return number(out);
+        }
+    }
+
+    bool object(JsonValue& out, int depth) {
+        if (depth >= kMaxDepth) return fail("nesting too deep");
+        out.type = JsonValue::Type::Object;
+        ++pos_; // '{'
+        skipSpace();
+        if (pos_ < n_ && s_[pos_] == '}') {
+            ++pos_;
+            return true;
+        }
+        for (;;) {
+            skipSpace();
+            if (pos_ >= n_ || s_[pos_] != '"') return fail("expected member name");
+            out.object.emplace_back();
+            if (!string(out.object.back().first)) return false;
+            skipSpace();
+            if (pos_ >= n_ || s_[pos_] != ':') return fail("expected ':'");
+            ++pos_;
+            skipSpace();
+            if (!value(out.object.back().second, depth + 1)) return false;
+            skipSpace();
+            if (pos_ < n_ && s_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            if (pos_ < n_ && s_[pos_] == '}') {
+                ++pos_;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    bool array(JsonValue& out, int depth) {
+        if (depth >= kMaxDepth) return fail("nesting too deep");
+        out.type = JsonValue::Type::Array;
+        ++pos_; // '['
+        skipSpace();
+        if (pos_ < n_ && s_[pos_] == ']') {
+            ++pos_;
+            return true;
+        }
+        for (;;) {
+            skipSpace();
+            out.array.emplace_back();
+            if (!value(out.array.back(), depth + 1)) return false;
+            skipSpace();
+            if (pos_ < n_ && s_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            if (pos_ < n_ && s_[pos_] == ']') {
+                ++pos_;
+                return true;
+            }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    bool hex4(unsigned& out) {
+        if (n_ - pos_ < 4) return fail("truncated \\u escape");
+        out = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = s_[pos_++];
+            unsigned v;
+            if (c >= '0' && c <= '9') v = static_cast<unsigned>(c - '0');
+            else if (c >= 'a' && c <= 'f') v = static_cast<unsigned>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') v = static_cast<unsigned>(c - 'A' + 10);
+            else return fail("invalid \\u escape");
+            out = (out << 4) | v;
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, unsigned cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xc0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xe0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        }
+    }
+
+    bool string(std::string& out) {
+        ++pos_; // opening quote
+        for (;;) {
+            // Copy the run of plain characters in one go.
+            std::size_t run = pos_;
+            while (run < n_ && s_[run] != '"' && s_[run] != '\\' &&
+                   static_cast<unsigned char>(s_[run]) >= 0x20) {
+                ++run;
+            }
+            out.append(s_ + pos_, run - pos_);
+            pos_ = run;
+            if (pos_ >= n_) return fail("unterminated string");
+            char c = s_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') return fail("control character in string");
+            if (pos_ >= n_) return fail("unterminated string");
+            switch (s_[pos_++]) {
+            case '"':  out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/'; break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                unsigned cp = 0;
+                if (!hex4(cp)) return false;
+                if (cp >= 0xd800 && cp < 0xdc00) {
+                    unsigned lo = 0;
+                    if (n_ - pos_ < 2 || s_[pos_] != '\\' || s_[pos_ + 1] != 'u') {
+                        return fail("unpaired surrogate");
+                    }
+                    pos_ += 2;
+                    if (!hex4(lo)) return false;
+                    if (lo < 0xdc00 || lo >= 0xe000) return fail("unpaired surrogate");
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                } else if (cp >= 0xdc00 && cp < 0xe000) {
+                    return fail("unpaired surrogate");
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default:
+                return fail("invalid escape");
+            }
+        }
+    }
+
+    bool number(JsonValue& out) {
+        // Validate the RFC 8259 grammar, then let strtod do the conversion.
+        std::size_t start = pos_;
+        if (pos_ < n_ && s_[pos_] == '-') ++pos_;
+        if (pos_ >= n_ || s_[pos_] < '0' || s_[pos_] > '9') return fail("invalid value");
+        if (s_[pos_] == '0') {
+            ++pos_;
+        } else {
+            while (pos_ < n_ && s_[pos_] >= '0' && s_[pos_] <= '9') ++pos_;
+        }
+        if (pos_ < n_ && s_[pos_] == '.') {
+            ++pos_;
+            if (pos_ >= n_ || s_[pos_] < '0' || s_[pos_] > '9') return fail("invalid number");
+            while (pos_ < n_ && s_[pos_] >= '0' && s_[pos_] <= '9') ++pos_;
+        }
+        if (pos_ < n_ && (s_[pos_] == 'e' || s_[pos_] == 'E')) {
+            ++pos_;
+            if (pos_ < n_ && (s_[pos_] == '+' || s_[pos_] == '-')) ++pos_;
+            if (pos_ >= n_ || s_[pos_] < '0' || s_[pos_] > '9') return fail("invalid number");
+            while (pos_ < n_ && s_[pos_] >= '0' && s_[pos_] <= '9') ++pos_;
+        }
+        out.type = JsonValue::Type::Number;
+        out.number = std::strtod(std::string(s_ + start, pos_ - start).c_str(), nullptr);
+        return true;
+    }
+};
+
+} // namespace
+
+bool parseJson(const std::string& text, JsonValue& out, std::string* error) {
+    Parser parser(text);
+    if (parser.document(out)) return true;
+    if (error) *error = parser.error();
+    return false;
+}
+
+// ---------- JsonCursor ----------
+
+namespace {
+
+// Offset of the first '"' or '\\' in s[0 .. n), or n. SWAR: a byte equal to
+// c leaves a zero in v ^ (c * 0x01..01), found with the haszero trick.
+std::size_t findQuoteOrEscape(const char* s, std::size_t n) {
+    constexpr std::uint64_t kOnes = 0x0101010101010101ull;
+    constexpr std::uint64_t kHigh = 0x8080808080808080ull;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t v;
+        std::memcpy(&v, s + i, 8);
+        std::uint64_t q = v ^ (kOnes * '"');
+        std::uint64_t b = v ^ (kOnes * '\\');
+        std::uint64_t hit = ((q - kOnes) & ~q & kHigh) | ((b - kOnes) & ~b & kHigh);
+        if (hit) break;
+    }
+    while (i < n && s[i] != '"' && s[i] != '\\') ++i;
+    return i;
+}
+
+} // namespace
+
+bool JsonCursor::Str::equals(const char* literal) const {
+    std::size_t len = std::strlen(literal);
+    return !escaped && len == size && std::memcmp(data, literal, len) == 0;
+}
+
+void JsonCursor::skipSpace() {
+    while (pos_ < n_ && (s_[pos_] == ' ' || s_[pos_] == '\t' || s_[pos_] == '\n' || s_[pos_] == '\r')) {
+        ++pos_;
+    }
+}
+
+bool JsonCursor::atEnd() {
+    skipSpace();
+    return pos_ == n_;
+}
+
+JsonCursor::Kind JsonCursor::peek() {
+    skipSpace();
+    if (failed_ || pos_ >= n_) return Kind::Invalid;
+    switch (s_[pos_]) {
+    case '{': return Kind::Object;
+    case '[': return Kind::Array;
+    case '"': return Kind::String;
+    case 't':
+    case 'f': return Kind::Bool;
+    case 'n': return Kind::Null;
+    default:
+        return (s_[pos_] == '-' || (s_[pos_] >= '0' && s_[pos_] <= '9')) ? Kind::Number : Kind::Invalid;
+    }
+}
+
+bool JsonCursor::open(char c) {
+    skipSpace();
+    if (failed_ || pos_ >= n_ || s_[pos_] != c || depth_ >= kMaxDepth) return fail();
+    ++pos_;
+    first_[depth_++] = true;
+    return true;
+}
+
+bool JsonCursor::beginObject() { return open('{'); }
+bool JsonCursor::beginArray() { return open('['); }
+
+bool JsonCursor::next(char close) {
+    if (failed_ || depth_ == 0) return fail();
+    skipSpace();
+    if (pos_ >= n_) return fail();
+    if (s_[pos_] == close) {
+        ++pos_;
+        --depth_;
+        return false;
+    }
+    if (!first_[depth_ - 1]) {
+        if (s_[pos_] != ',') return fail();
+        ++pos_;
+        skipSpace();
+    }
+    first_[depth_ - 1] = false;
+    return true;
+}
+
+bool JsonCursor::nextMember(Str& key) {
+    if (!next('}')) return false;
+    if (!readString(key)) return false;
+    skipSpace();
+    if (pos_ >= n_ || s_[pos_] != ':') return fail();
+    ++pos_;
+    return true;
+}
+
+bool JsonCursor::nextElement() { return next(']'); }
+
+bool JsonCursor::readString(Str& out) {
+    skipSpace();
+    if (failed_ || pos_ >= n_ || s_[pos_] != '"') return fail();
+    std::size_t start = ++pos_;
+    out.escaped = false;
+    for (;;) {
+        pos_ += findQuoteOrEscape(s_ + pos_, n_ - pos_);
+        if (pos_ >= n_) return fail();
+        if (s_[pos_] == '"') break;
+        out.escaped = true;
+        if (n_ - pos_ < 2) return fail();
+        pos_ += 2;   // backslash and the escaped character
+    }
+    out.data = s_ + start;
+    out.size = pos_ - start;
+    ++pos_;
+    return true;
+}
+
+bool JsonCursor::skipString() {
+    Str ignored;
+    return readString(ignored);
+}
+
+bool JsonCursor::readNumber(double& out) {
+    skipSpace();
+    std::size_t start = pos_;
+    while (pos_ < n_ && ((s_[pos_] >= '0' && s_[pos_] <= '9') || s_[pos_] == '-' || s_[pos_] == '+' ||
+                         s_[pos_] == '.' || s_[pos_] == 'e' || s_[pos_] == 'E')) {
+        ++pos_;
+    }
+    char buf[64];
+    std::size_t len = pos_ - start;
+    if (failed_ || len == 0 || len >= sizeof(buf)) return fail();
+    std::memcpy(buf, s_ + start, len);
+    buf[len] = '\0';
+    char* end = nullptr;
+    out = std::strtod(buf, &end);
+    return end == buf + len || fail();
+}
+
+bool JsonCursor::skipValue() {
+    switch (peek()) {
+    case Kind::String:
+        return skipString();
+    case Kind::Number: {
+        double ignored;
+        return readNumber(ignored);
+    }
+    case Kind::Null:
+    case Kind::Bool: {
+        const char* word = s_[pos_] == 'n' ? "null" : s_[pos_] == 't' ? "true" : "false";
+        std::size_t len = std::strlen(word);
+        if (n_ - pos_ < len || std::memcmp(s_ + pos_, word, len) != 0) return fail();
+        pos_ += len;
+        return true;
+    }
+    case Kind::Object: {
+        beginObject();
+        Str key;
+        while (nextMember(key)) {
+            if (!skipValue()) return false;
+        }
+        return !failed_;
+    }
+    case Kind::Array:
+        beginArray();
+        while (nextElement()) {
+            if (!skipValue()) return false;
+        }
+        return !failed_;
+    case Kind::Invalid:
+    default:
+        return fail();
+    }
+}
+
+} // namespace buds
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace buds {
+
+// Minimal JSON document model for configuration files (registries, policy
+// profiles). Objects keep their members in file order; duplicate keys are
+// kept and find() returns the first.
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type{Type::Null};
+    bool boolean{false};
+    double number{0.0};
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    bool isNull() const { return type == Type::Null; }
+    bool isBool() const { return type == Type::Bool; }
+    bool isNumber() const { return type == Type::Number; }
+    bool isString() const { return type == Type::String; }
+    bool isArray() const { return type == Type::Array; }
+    bool isObject() const { return type == Type::Object; }
+
+    // Member lookup on objects; nullptr if absent or not an object.
+    const JsonValue* find(const std::string& key) const;
+};
+
+// Parses a complete RFC 8259 document (surrounding whitespace allowed).
+// \u escapes are decoded to UTF-8. On failure returns false and, if
+// `error` is set, describes the problem with its byte offset.
+bool parseJson(const std::string& text, JsonValue& out, std::string* error = nullptr);
+
+// Forward-only, non-allocating reader for hot paths (one JSON-lines record
+// per transaction). Nothing is decoded up front: strings come back as spans
+// into the input with escapes left in place, and unwanted values are
+// skipped without being materialized. String bodies are scanned 8 bytes at
+// a time for a quote or backslash.
+//
+// After beginObject(), call nextMember(key) until it returns false; after
+// beginArray(), nextElement() likewise. Each true return must be followed
+// by reading or skipping exactly one value. A false return means the
+// container ended, or the input is malformed if failed() is set.
+class JsonCursor {
+public:
+    struct Str {
+        const char* data{nullptr};
+        std::size_t size{0};
+        bool escaped{false};   // contains backslash escapes (raw form returned)
+
+        bool equals(const char* literal) const;
+    };
+
+    enum class Kind { Null, Bool, Number, String, Array, Object, Invalid };
+
+    JsonCursor(const char* data, std::size_t len) : s_(data), n_(len) {}
+
+    Kind peek();
+    bool beginObject();
+    bool nextMember(Str& key);
+    bool beginArray();
+    bool nextElement();
+    bool readString(Str& out);
+    bool readNumber(double& out);
+    bool skipValue();
+    // True once only whitespace remains.
+    bool atEnd();
+
+    bool failed() const { return failed_; }
+    std::size_t offset() const { return pos_; }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    const char* s_;
+    std::size_t n_;
+    std::size_t pos_{0};
+    int depth_{0};
+    bool failed_{false};
+    bool first_[kMaxDepth]{};   // no member / element read yet at this depth
+
+    bool fail() {
+        failed_ = true;
+        return false;
+    }
+    void skipSpace();
+    bool open(char c);
+    bool next(char close);
+    bool skipString();
+};
+
+} // namespace buds
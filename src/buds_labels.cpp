@@ -0,0 +1,108 @@
+#include "buds_labels.h"
+
+#include <cstring>
+
+namespace buds {
+
+namespace {
+
+const char* const kLabelNames[kLabelCount] = {
+    "consensus.sig",
+    "consensus.script",
+    "consensus.taproot_prog",
+    "pay.standard",
+    "pay.channel_open",
+    "pay.channel_update",
+    "contracts.vault",
+    "commitment.rollup_root",
+    "meta.pool_tag",
+    "da.op_return_embed",
+    "meta.inscription",
+    "meta.ordinal",
+    "meta.indexer_hint",
+    "da.embed_misc",
+    "da.unknown",
+    "da.obfuscated",
+    "da.unregistered_vendor",
+};
+
+} // namespace
+
+const char* tierName(Tier tier) {
+    switch (tier) {
+    case Tier::T0: return "T0";
+    case Tier::T1: return "T1";
+    case Tier::T2: return "T2";
+    case Tier::T3:
+    default:       return "T3";
+    }
+}
+
+Tier tierFromName(const std::string& name) {
+    if (name == "T0") return Tier::T0;
+    if (name == "T1") return Tier::T1;
+    if (name == "T2") return Tier::T2;
+    return Tier::T3;
+}
+
+// ---------- LabelIndex ----------
+
+std::uint64_t LabelIndex::hash(const char* s, std::size_t n, std::uint64_t seed) {
+    // FNV-1a with a seeded offset basis and a final avalanche step.
+    std::uint64_t h = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+    for (std::size_t i = 0; i < n; ++i) {
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+LabelIndex::LabelIndex(std::vector<std::string> names) : names_(std::move(names)) {
+    std::size_t tableSize = 4;
+    while (tableSize < names_.size() * 2) tableSize *= 2;
+
+    // Search seeds until every name lands in its own slot; grow the table if
+    // a size turns out to be unlucky. Terminates quickly for label-sized sets.
+    for (;;) {
+        mask_ = tableSize - 1;
+        for (seed_ = 0; seed_ < 1024; ++seed_) {
+            slots_.assign(tableSize, kInvalidLabel);
+            bool ok = true;
+            for (std::size_t id = 0; id < names_.size() && ok; ++id) {
+                const std::string& n = names_[id];
+                LabelId& slot = slots_[hash(n.data(), n.size(), seed_) & mask_];
+                if (slot != kInvalidLabel) {
+                    ok = names_[slot] == n; // duplicate names keep the first ID
+                } else {
+                    slot = static_cast<LabelId>(id);
+                }
+            }
+            if (ok) return;
+        }
+        tableSize *= 2;
+    }
+}
+
+LabelId LabelIndex::find(const char* s, std::size_t n) const {
+    LabelId id = slots_[hash(s, n, seed_) & mask_];
+    if (id == kInvalidLabel) return kInvalidLabel;
+    const std::string& candidate = names_[id];
+    if (candidate.size() != n || std::memcmp(candidate.data(), s, n) != 0) return kInvalidLabel;
+    return id;
+}
+
+// ---------- vocabulary ----------
+
+const char* labelName(LabelId id) {
+    return id < kLabelCount ? kLabelNames[id] : "";
+}
+
+LabelId labelIdFromName(const std::string& name) {
+    static const LabelIndex index(std::vector<std::string>(kLabelNames, kLabelNames + kLabelCount));
+    return index.find(name);
+}
+
+} // namespace buds
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace buds {
+
+// Dense IDs for the BUDS v2 label vocabulary, in registry-v2.json order.
+// Tables indexed by LabelId (policy, tiers) are plain arrays of kLabelCount.
+using LabelId = std::uint16_t;
+
+namespace label {
+constexpr LabelId ConsensusSig          = 0;
+constexpr LabelId ConsensusScript       = 1;
+constexpr LabelId ConsensusTaprootProg  = 2;
+constexpr LabelId PayStandard           = 3;
+constexpr LabelId PayChannelOpen        = 4;
+constexpr LabelId PayChannelUpdate      = 5;
+constexpr LabelId ContractsVault        = 6;
+constexpr LabelId CommitmentRollupRoot  = 7;
+constexpr LabelId MetaPoolTag           = 8;
+constexpr LabelId DaOpReturnEmbed       = 9;
+constexpr LabelId MetaInscription       = 10;
+constexpr LabelId MetaOrdinal           = 11;
+constexpr LabelId MetaIndexerHint       = 12;
+constexpr LabelId DaEmbedMisc           = 13;
+constexpr LabelId DaUnknown             = 14;
+constexpr LabelId DaObfuscated          = 15;
+constexpr LabelId DaUnregisteredVendor  = 16;
+} // namespace label
+
+constexpr std::size_t kLabelCount = 17;
+constexpr LabelId kInvalidLabel = 0xffff;
+
+enum class Tier : std::uint8_t { T0 = 0, T1 = 1, T2 = 2, T3 = 3 };
+
+constexpr std::size_t kTierCount = 4;
+
+const char* tierName(Tier tier);   // "T0".."T3"
+
+// Unknown strings map to T3, the conservative default used everywhere else.
+Tier tierFromName(const std::string& name);
+
+// Collision-free hash over a fixed set of label names; the position of each
+// name in the constructor argument is its LabelId. A lookup is one hash, one
+// table probe and one string compare.
+class LabelIndex {
+public:
+    explicit LabelIndex(std::vector<std::string> names);
+
+    LabelId find(const char* s, std::size_t n) const;
+    LabelId find(const std::string& s) const { return find(s.data(), s.size()); }
+
+    std::size_t size() const { return names_.size(); }
+    const std::string& name(LabelId id) const { return names_[id]; }
+
+private:
+    std::vector<std::string> names_;
+    std::vector<LabelId> slots_;   // power-of-two sized, kInvalidLabel = empty
+    std::uint64_t seed_{0};
+    std::uint64_t mask_{0};
+
+    static std::uint64_t hash(const char* s, std::size_t n, std::uint64_t seed);
+};
+
+// Canonical name ("pay.standard", ...); "" for IDs outside the vocabulary.
+const char* labelName(LabelId id);
+
+// Reverse lookup; kInvalidLabel when the name is not a v2 label.
+LabelId labelIdFromName(const std::string& name);
+
+} // namespace buds
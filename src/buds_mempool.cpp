@@ -0,0 +1,104 @@
+#include "buds_mempool.h"
+
+#include <cmath>
+
+namespace buds {
+
+bool MempoolIndex::add(const Hash256& id, const Evaluation& eval, std::uint32_t vsize,
+                       double feerate) {
+    MempoolEntry entry;
+    entry.id = id;
+    entry.vsize = vsize;
+    entry.feerate = feerate;
+    entry.arbda = eval.arbda;
+    entry.policy = eval.policy;
+    return add(entry);
+}
+
+namespace {
+
+bool finiteKeys(const MempoolEntry& e) {
+    return std::isfinite(e.feerate) && std::isfinite(e.policy.score);
+}
+
+} // namespace
+
+bool MempoolIndex::add(const MempoolEntry& entry) {
+    if (!finiteKeys(entry)) return false;
+    auto inserted = entries_.emplace(entry.id, entry);
+    if (!inserted.second) return false;
+    const MempoolEntry* e = &inserted.first->second;
+
+    std::size_t tier = static_cast<std::size_t>(e->arbda);
+    byScore_.emplace(e->policy.score, e);
+    byFeerate_[tier].emplace(e->feerate, e);
+    ++totals_.count[tier];
+    totals_.vbytes[tier] += e->vsize;
+    totalVbytes_ += e->vsize;
+    return true;
+}
+
+bool MempoolIndex::remove(const Hash256& id) {
+    auto it = entries_.find(id);
+    if (it == entries_.end()) return false;
+    const MempoolEntry* e = &it->second;
+
+    std::size_t tier = static_cast<std::size_t>(e->arbda);
+    byScore_.erase(Key(e->policy.score, e));
+    byFeerate_[tier].erase(Key(e->feerate, e));
+    --totals_.count[tier];
+    totals_.vbytes[tier] -= e->vsize;
+    totalVbytes_ -= e->vsize;
+    entries_.erase(it);
+    return true;
+}
+
+bool MempoolIndex::replace(const Hash256& replaced, const MempoolEntry& entry) {
+    if (!finiteKeys(entry) || (entry.id != replaced && entries_.count(entry.id))) return false;
+    remove(replaced);
+    return add(entry);
+}
+
+const MempoolEntry* MempoolIndex::find(const Hash256& id) const {
+    auto it = entries_.find(id);
+    return it == entries_.end() ? nullptr : &it->second;
+}
+
+void MempoolIndex::clear() {
+    byScore_.clear();
+    for (auto& set : byFeerate_) set.clear();
+    entries_.clear();
+    totals_ = TierTotals();
+    totalVbytes_ = 0;
+}
+
+std::vector<const MempoolEntry*> MempoolIndex::topByScore(std::size_t k) const {
+    std::vector<const MempoolEntry*> out;
+    out.reserve(k < byScore_.size() ? k : byScore_.size());
+    for (auto it = byScore_.rbegin(); it != byScore_.rend() && out.size() < k; ++it) {
+        out.push_back(it->second);
+    }
+    return out;
+}
+
+std::vector<const MempoolEntry*> MempoolIndex::bottomByScore(std::size_t k) const {
+    std::vector<const MempoolEntry*> out;
+    out.reserve(k < byScore_.size() ? k : byScore_.size());
+    for (auto it = byScore_.begin(); it != byScore_.end() && out.size() < k; ++it) {
+        out.push_back(it->second);
+    }
+    return out;
+}
+
+std::vector<const MempoolEntry*> MempoolIndex::belowFeerate(Tier tier, double feerate,
+                                                            std::size_t limit) const {
+    std::vector<const MempoolEntry*> out;
+    const auto& set = byFeerate_[static_cast<std::size_t>(tier)];
+    for (auto it = set.begin(); it != set.end() && it->first < feerate; ++it) {
+        if (limit && out.size() == limit) break;
+        out.push_back(it->second);
+    }
+    return out;
+}
+
+} // namespace buds
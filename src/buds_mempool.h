@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "buds_tagger.h"
+#include "buds_tx.h"
+
+namespace buds {
+
+// One indexed transaction: the engine's verdict plus the size and fee data
+// the policy questions are asked about.
+struct MempoolEntry {
+    Hash256 id;                 // txid or wtxid, as chosen by the caller
+    std::uint32_t vsize{0};
+    double feerate{0.0};        // sat/vB, before BUDS adjustments
+    Tier arbda{Tier::T0};
+    PolicyResult policy;
+};
+
+// Running aggregates, indexed by ARBDA tier.
+struct TierTotals {
+    std::array<std::size_t, kTierCount> count{};
+    std::array<std::uint64_t, kTierCount> vbytes{};
+};
+
+// Incremental mempool view over TagEngine outputs (docs/policy-interface.md
+// §2.1). add / remove / replace are O(log n) and keep per-tier counts and
+// vbytes current, so congestion-time questions ("how much is T3?", "which
+// T3 transactions pay less than X?", "what scores highest?") never rescan
+// the pool.
+class MempoolIndex {
+public:
+    // Returns false (and changes nothing) if `id` is already indexed, or if
+    // the feerate or policy score is not finite: a NaN key (e.g. fee / 0
+    // vsize) would break the ordering of the score and feerate indexes.
+    bool add(const Hash256& id, const Evaluation& eval, std::uint32_t vsize, double feerate);
+    bool add(const MempoolEntry& entry);
+
+    // Returns false if `id` is not indexed.
+    bool remove(const Hash256& id);
+
+    // RBF: removes `replaced` (if present) and adds the replacement.
+    // Returns false, leaving `replaced` indexed, if `entry.id` is already
+    // indexed or `entry` would be rejected by add().
+    bool replace(const Hash256& replaced, const MempoolEntry& entry);
+
+    const MempoolEntry* find(const Hash256& id) const;
+    std::size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    void clear();
+
+    const TierTotals& totals() const { return totals_; }
+    std::uint64_t totalVbytes() const { return totalVbytes_; }
+
+    // Highest PolicyResult::score first (ties by id); at most k entries.
+    std::vector<const MempoolEntry*> topByScore(std::size_t k) const;
+
+    // Lowest score first; the eviction candidates. At most k entries.
+    std::vector<const MempoolEntry*> bottomByScore(std::size_t k) const;
+
+    // Entries with the given ARBDA tier and feerate strictly below
+    // `feerate`, cheapest first; at most `limit` entries (0 = no limit).
+    std::vector<const MempoolEntry*> belowFeerate(Tier tier, double feerate,
+                                                  std::size_t limit = 0) const;
+
+private:
+    // Ordered keys point back into entries_; unordered_map nodes are stable.
+    using Key = std::pair<double, const MempoolEntry*>;
+    struct KeyLess {
+        bool operator()(const Key& a, const Key& b) const {
+            if (a.first != b.first) return a.first < b.first;
+            return a.second->id < b.second->id;
+        }
+    };
+
+    std::unordered_map<Hash256, MempoolEntry, Hash256Hasher> entries_;
+    std::set<Key, KeyLess> byScore_;
+    std::array<std::set<Key, KeyLess>, kTierCount> byFeerate_;
+    TierTotals totals_;
+    std::uint64_t totalVbytes_{0};
+};
+
+} // namespace buds
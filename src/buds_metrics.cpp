@@ -0,0 +1,286 @@
+#include "buds_metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace buds {
+
+const char* detectorName(Detector d) {
+    switch (d) {
+        case Detector::ScriptTemplate: return "script_template";
+        case Detector::OrdinalEnvelope: return "ordinal_envelope";
+        case Detector::Printable: return "printable";
+        case Detector::ScriptShape: return "script_shape";
+        case Detector::Entropy: return "entropy";
+    }
+    return "unknown";
+}
+
+const char* entryPointName(EntryPoint e) {
+    switch (e) {
+        case EntryPoint::Classify: return "classify";
+        case EntryPoint::ClassifyBatch: return "classify_batch";
+        case EntryPoint::Evaluate: return "evaluate";
+        case EntryPoint::Triage: return "triage";
+        case EntryPoint::CountTiers: return "count_tiers";
+        case EntryPoint::ClassifyCompact: return "classify_compact";
+    }
+    return "unknown";
+}
+
+// ---------- histogram ----------
+
+std::size_t LatencyHistogram::bucketFor(std::uint64_t ns) {
+    constexpr std::uint64_t kSub = 1u << kSubBits;
+    if (ns < kSub) return static_cast<std::size_t>(ns);
+    unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(ns));
+    if (msb >= kMaxBits) return kBuckets - 1;
+    std::size_t group = msb - kSubBits + 1;
+    return (group << kSubBits) + static_cast<std::size_t>((ns >> (msb - kSubBits)) & (kSub - 1));
+}
+
+std::uint64_t LatencyHistogram::bucketLow(std::size_t bucket) {
+    constexpr std::size_t kSub = std::size_t(1) << kSubBits;
+    if (bucket < kSub) return bucket;
+    unsigned msb = static_cast<unsigned>(bucket >> kSubBits) + kSubBits - 1;
+    return static_cast<std::uint64_t>(kSub + (bucket & (kSub - 1))) << (msb - kSubBits);
+}
+
+std::uint64_t LatencyHistogram::bucketHigh(std::size_t bucket) {
+    constexpr std::size_t kSub = std::size_t(1) << kSubBits;
+    if (bucket < kSub) return bucket;
+    unsigned msb = static_cast<unsigned>(bucket >> kSubBits) + kSubBits - 1;
+    return bucketLow(bucket) + (std::uint64_t(1) << (msb - kSubBits)) - 1;
+}
+
+void LatencyHistogram::add(std::size_t bucket, std::uint64_t count, std::uint64_t sumNs) {
+    counts_[std::min(bucket, kBuckets - 1)] += count;
+    count_ += count;
+    sum_ += sumNs;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (std::size_t b = 0; b < kBuckets; ++b) counts_[b] += other.counts_[b];
+    count_ += other.count_;
+    sum_ += other.sum_;
+}
+
+std::uint64_t LatencyHistogram::countBelow(std::uint64_t ns) const {
+    std::uint64_t n = 0;
+    for (std::size_t b = 0; b < kBuckets && bucketHigh(b) < ns; ++b) n += counts_[b];
+    return n;
+}
+
+std::uint64_t LatencyHistogram::quantile(double q) const {
+    if (count_ == 0) return 0;
+    double rank = std::ceil(std::min(std::max(q, 0.0), 1.0) * static_cast<double>(count_));
+    std::uint64_t target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(rank));
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < kBuckets; ++b) {
+        seen += counts_[b];
+        if (seen >= target) return bucketHigh(b);
+    }
+    return bucketHigh(kBuckets - 1);
+}
+
+// ---------- per-thread blocks ----------
+
+#ifdef BUDS_ENABLE_METRICS
+
+namespace {
+
+using metrics::detail::ThreadMetrics;
+
+struct MetricsRegistry {
+    std::mutex mutex;
+    std::vector<ThreadMetrics*> live;
+    MetricsSnapshot retired;   // totals of threads that have exited
+};
+
+// Leaked on purpose: threads may exit during static destruction.
+MetricsRegistry& registry() {
+    static MetricsRegistry* r = new MetricsRegistry();
+    return *r;
+}
+
+std::uint64_t read(const metrics::detail::Counter& c) {
+    return c.load(std::memory_order_relaxed);
+}
+
+void addTo(MetricsSnapshot& s, const ThreadMetrics& m) {
+    for (std::size_t i = 0; i < kLabelCount; ++i) s.labels[i] += read(m.labels[i]);
+    for (std::size_t i = 0; i < kTierCount; ++i) {
+        s.tiers[i] += read(m.tiers[i]);
+        s.arbda[i] += read(m.arbda[i]);
+    }
+    for (std::size_t i = 0; i < kDetectorCount; ++i) {
+        s.detectorCalls[i] += read(m.detectorCalls[i]);
+        s.detectorBytes[i] += read(m.detectorBytes[i]);
+    }
+    for (std::size_t e = 0; e < kEntryPointCount; ++e) {
+        s.calls[e] += read(m.calls[e]);
+        LatencyHistogram& h = s.latency[e];
+        for (std::size_t b = 0; b < LatencyHistogram::kBuckets; ++b) {
+            if (std::uint64_t n = read(m.latency[e][b])) h.add(b, n, 0);
+        }
+        h.add(0, 0, read(m.latencySumNs[e]));
+    }
+}
+
+// Owns the calling thread's block; on thread exit folds it into the
+// retired totals.
+struct Registration {
+    ThreadMetrics* metrics;
+
+    Registration() : metrics(new ThreadMetrics()) {
+        MetricsRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(metrics);
+    }
+    ~Registration() {
+        MetricsRegistry& r = registry();
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            addTo(r.retired, *metrics);
+            r.live.erase(std::find(r.live.begin(), r.live.end(), metrics));
+        }
+        metrics::detail::current = nullptr;
+        delete metrics;
+    }
+};
+
+} // namespace
+
+namespace metrics {
+namespace detail {
+
+ThreadMetrics& registerThread() {
+    thread_local Registration registration;
+    current = registration.metrics;
+    return *current;
+}
+
+} // namespace detail
+} // namespace metrics
+
+MetricsSnapshot metricsSnapshot() {
+    MetricsRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    MetricsSnapshot s = r.retired;
+    for (const ThreadMetrics* m : r.live) addTo(s, *m);
+    return s;
+}
+
+#else
+
+MetricsSnapshot metricsSnapshot() { return MetricsSnapshot(); }
+
+#endif
+
+// ---------- export ----------
+
+namespace {
+
+void appendf(std::string& out, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+void appendf(std::string& out, const char* fmt, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = std::vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n > 0) out.append(buf, std::min<std::size_t>(static_cast<std::size_t>(n), sizeof(buf) - 1));
+}
+
+void header(std::string& out, const char* name, const char* type, const char* help) {
+    appendf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+unsigned long long ull(std::uint64_t v) { return static_cast<unsigned long long>(v); }
+
+} // namespace
+
+std::string MetricsSnapshot::toPrometheus() const {
+    std::string out;
+    out.reserve(16 * 1024);
+
+    header(out, "buds_metrics_enabled", "gauge", "1 if the build records metrics (BUDS_ENABLE_METRICS).");
+    appendf(out, "buds_metrics_enabled %d\n", kMetricsEnabled ? 1 : 0);
+
+    header(out, "buds_labels_total", "counter", "Classified regions carrying each label.");
+    for (LabelId id = 0; id < kLabelCount; ++id) {
+        appendf(out, "buds_labels_total{label=\"%s\"} %llu\n", labelName(id), ull(labels[id]));
+    }
+    header(out, "buds_tiers_total", "counter", "Region labels by registry tier.");
+    for (std::size_t t = 0; t < kTierCount; ++t) {
+        appendf(out, "buds_tiers_total{tier=\"%s\"} %llu\n", tierName(static_cast<Tier>(t)), ull(tiers[t]));
+    }
+    header(out, "buds_arbda_total", "counter", "Transactions by ARBDA tier (evaluate and triage).");
+    for (std::size_t t = 0; t < kTierCount; ++t) {
+        appendf(out, "buds_arbda_total{tier=\"%s\"} %llu\n", tierName(static_cast<Tier>(t)), ull(arbda[t]));
+    }
+
+    header(out, "buds_detector_calls_total", "counter", "Detector invocations.");
+    for (std::size_t d = 0; d < kDetectorCount; ++d) {
+        appendf(out, "buds_detector_calls_total{detector=\"%s\"} %llu\n",
+                detectorName(static_cast<Detector>(d)), ull(detectorCalls[d]));
+    }
+    header(out, "buds_detector_bytes_total", "counter", "Bytes handed to each detector.");
+    for (std::size_t d = 0; d < kDetectorCount; ++d) {
+        appendf(out, "buds_detector_bytes_total{detector=\"%s\"} %llu\n",
+                detectorName(static_cast<Detector>(d)), ull(detectorBytes[d]));
+    }
+
+    header(out, "buds_calls_total", "counter", "TagEngine entry point calls.");
+    for (std::size_t e = 0; e < kEntryPointCount; ++e) {
+        appendf(out, "buds_calls_total{entry=\"%s\"} %llu\n", entryPointName(static_cast<EntryPoint>(e)),
+                ull(calls[e]));
+    }
+
+    // Cumulative buckets at powers of two from 128 ns to ~34 s.
+    header(out, "buds_call_duration_seconds", "histogram", "Sampled TagEngine call latency.");
+    for (std::size_t e = 0; e < kEntryPointCount; ++e) {
+        const char* name = entryPointName(static_cast<EntryPoint>(e));
+        const LatencyHistogram& h = latency[e];
+        for (unsigned k = 7; k <= 35; ++k) {
+            std::uint64_t le = std::uint64_t(1) << k;
+            appendf(out, "buds_call_duration_seconds_bucket{entry=\"%s\",le=\"%.9g\"} %llu\n", name,
+                    static_cast<double>(le) * 1e-9, ull(h.countBelow(le)));
+        }
+        appendf(out, "buds_call_duration_seconds_bucket{entry=\"%s\",le=\"+Inf\"} %llu\n", name,
+                ull(h.count()));
+        appendf(out, "buds_call_duration_seconds_sum{entry=\"%s\"} %.9g\n", name,
+                static_cast<double>(h.sumNs()) * 1e-9);
+        appendf(out, "buds_call_duration_seconds_count{entry=\"%s\"} %llu\n", name, ull(h.count()));
+    }
+    header(out, "buds_call_duration_quantile_seconds", "gauge",
+           "Sampled TagEngine call latency quantiles (upper bound, 12.5% resolution).");
+    for (std::size_t e = 0; e < kEntryPointCount; ++e) {
+        const char* name = entryPointName(static_cast<EntryPoint>(e));
+        for (double q : {0.5, 0.9, 0.99, 0.999}) {
+            appendf(out, "buds_call_duration_quantile_seconds{entry=\"%s\",quantile=\"%g\"} %.9g\n",
+                    name, q, static_cast<double>(latency[e].quantile(q)) * 1e-9);
+        }
+    }
+    return out;
+}
+
+bool writeMetricsFile(const std::string& path, std::string* error) {
+    std::string text = metricsSnapshot().toPrometheus();
+    std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    bool ok = f && std::fwrite(text.data(), 1, text.size(), f) == text.size();
+    if (f) ok = std::fclose(f) == 0 && ok;
+    if (ok) ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+    if (!ok) {
+        if (error) *error = "cannot write metrics to " + path;
+        std::remove(tmp.c_str());
+    }
+    return ok;
+}
+
+} // namespace buds
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "buds_labels.h"
+
+namespace buds {
+
+// Hot-path instrumentation for TagEngine, compiled in only when the whole
+// build defines BUDS_ENABLE_METRICS (mixing the two in one program breaks
+// the one-definition rule). Without it every hook below is an empty inline
+// function and the snapshot API reports zeros, so callers need no #ifdefs.
+//
+// Each thread writes its own block of counters with plain relaxed stores
+// (no locked instructions, no shared cache lines); a snapshot sums the
+// blocks of live threads and those folded in by threads that have exited.
+#ifdef BUDS_ENABLE_METRICS
+constexpr bool kMetricsEnabled = true;
+#else
+constexpr bool kMetricsEnabled = false;
+#endif
+
+// Byte-level detectors run on each region.
+enum class Detector : std::uint8_t {
+    ScriptTemplate,    // analyzeScriptPubKey on an output script
+    OrdinalEnvelope,   // findOrdinalEnvelope on a witness item
+    Printable,         // ASCII ratio on a short witness item
+    ScriptShape,       // looksLikeScript on a witness item
+    Entropy            // byte histogram / entropy on a witness item
+};
+constexpr std::size_t kDetectorCount = 5;
+
+// Timed TagEngine entry points. Latency covers the classification work of
+// the call; raw-byte overloads parse before entering it.
+enum class EntryPoint : std::uint8_t {
+    Classify,          // classify(), budgeted or not
+    ClassifyBatch,     // one classifyBatch() call, whatever its size
+    Evaluate,          // evaluate() from a transaction
+    Triage,
+    CountTiers,
+    ClassifyCompact
+};
+constexpr std::size_t kEntryPointCount = 6;
+
+const char* detectorName(Detector d);       // "script_template", ...
+const char* entryPointName(EntryPoint e);   // "classify", ...
+
+// Log-linear (HDR-style) histogram of nanosecond values: 8 sub-buckets per
+// power of two, so any recorded value is reported within 12.5%, from 1 ns up
+// to 2^40 ns (about 18 minutes; larger values land in the last bucket).
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBits = 3;
+    static constexpr unsigned kMaxBits = 40;
+    static constexpr std::size_t kBuckets = std::size_t(kMaxBits - kSubBits + 1) << kSubBits;
+
+    static std::size_t bucketFor(std::uint64_t ns);
+    static std::uint64_t bucketLow(std::size_t bucket);
+    static std::uint64_t bucketHigh(std::size_t bucket);
+
+    void record(std::uint64_t ns) { add(bucketFor(ns), 1, ns); }
+    void add(std::size_t bucket, std::uint64_t count, std::uint64_t sumNs);
+    void merge(const LatencyHistogram& other);
+
+    std::uint64_t count() const { return count_; }
+    std::uint64_t sumNs() const { return sum_; }
+    std::uint64_t bucketCount(std::size_t bucket) const { return counts_[bucket]; }
+    // Values below `ns`, to within the bucket resolution.
+    std::uint64_t countBelow(std::uint64_t ns) const;
+    // Upper bound of the bucket holding the q-th value (0 < q <= 1); 0 if empty.
+    std::uint64_t quantile(double q) const;
+
+private:
+    std::array<std::uint64_t, kBuckets> counts_{};
+    std::uint64_t count_{0};
+    std::uint64_t sum_{0};
+};
+
+// Process-wide totals at one instant. Counters are monotonic, as Prometheus
+// expects; they are never reset.
+struct MetricsSnapshot {
+    std::array<std::uint64_t, kLabelCount> labels{};      // regions carrying each label
+    std::array<std::uint64_t, kTierCount> tiers{};        // region labels by registry tier
+    std::array<std::uint64_t, kTierCount> arbda{};        // evaluate / triage verdicts
+    std::array<std::uint64_t, kDetectorCount> detectorCalls{};
+    std::array<std::uint64_t, kDetectorCount> detectorBytes{};
+    std::array<std::uint64_t, kEntryPointCount> calls{};  // every call
+    // One call in kLatencySampleEvery per thread and entry point is timed
+    // (every classifyBatch call is), so histogram counts trail `calls`.
+    std::array<LatencyHistogram, kEntryPointCount> latency{};
+
+    // Prometheus text exposition format (version 0.0.4).
+    std::string toPrometheus() const;
+};
+
+MetricsSnapshot metricsSnapshot();
+
+// Writes metricsSnapshot().toPrometheus() to `path` through a temporary
+// file and a rename, so a scraper (e.g. node_exporter's textfile collector)
+// never reads a partial file.
+bool writeMetricsFile(const std::string& path, std::string* error = nullptr);
+
+// --- hooks called by TagEngine ---
+
+namespace metrics {
+
+// Timing a call costs two clock reads; sampling keeps that under 1% of even
+// the cheapest instrumented call. Must be a power of two.
+constexpr std::uint32_t kLatencySampleEvery = 64;
+
+#ifdef BUDS_ENABLE_METRICS
+
+namespace detail {
+
+using Counter = std::atomic<std::uint64_t>;
+
+// Written only by its owning thread; read by snapshots.
+struct ThreadMetrics {
+    Counter labels[kLabelCount];
+    Counter tiers[kTierCount];
+    Counter arbda[kTierCount];
+    Counter detectorCalls[kDetectorCount];
+    Counter detectorBytes[kDetectorCount];
+    Counter calls[kEntryPointCount];
+    Counter latency[kEntryPointCount][LatencyHistogram::kBuckets];
+    Counter latencySumNs[kEntryPointCount];
+    std::uint32_t ticks[kEntryPointCount];   // owner only: sampling phase
+};
+
+ThreadMetrics& registerThread();
+
+inline thread_local ThreadMetrics* current = nullptr;
+
+inline ThreadMetrics& local() {
+    ThreadMetrics* m = current;
+    return m ? *m : registerThread();
+}
+
+// Single writer, so a plain load and store suffice; the atomic type only
+// keeps concurrent snapshot reads well-defined.
+inline void bump(Counter& c, std::uint64_t n = 1) {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+inline void countDetector(Detector d, std::size_t bytes) {
+    detail::ThreadMetrics& m = detail::local();
+    detail::bump(m.detectorCalls[static_cast<std::size_t>(d)]);
+    detail::bump(m.detectorBytes[static_cast<std::size_t>(d)], bytes);
+}
+
+inline void countLabel(LabelId id, Tier tier) {
+    detail::ThreadMetrics& m = detail::local();
+    if (id < kLabelCount) detail::bump(m.labels[id]);
+    detail::bump(m.tiers[static_cast<std::size_t>(tier)]);
+}
+
+inline void countArbda(Tier tier) {
+    detail::bump(detail::local().arbda[static_cast<std::size_t>(tier)]);
+}
+
+// Counts one call and times it if it is the sampled one. A call that
+// returns an ARBDA verdict registers it with countArbdaAtExit, so every
+// return path is counted; `tier` must outlive the ScopedCall.
+class ScopedCall {
+public:
+    explicit ScopedCall(EntryPoint e) : m_(detail::local()), entry_(static_cast<std::size_t>(e)) {
+        detail::bump(m_.calls[entry_]);
+        sampled_ = e == EntryPoint::ClassifyBatch ||
+                   (m_.ticks[entry_]++ & (kLatencySampleEvery - 1)) == 0;
+        if (sampled_) start_ = std::chrono::steady_clock::now();
+    }
+    ~ScopedCall() {
+        if (arbda_) detail::bump(m_.arbda[static_cast<std::size_t>(*arbda_)]);
+        if (!sampled_) return;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start_).count();
+        std::uint64_t v = ns > 0 ? static_cast<std::uint64_t>(ns) : 0;
+        detail::bump(m_.latency[entry_][LatencyHistogram::bucketFor(v)]);
+        detail::bump(m_.latencySumNs[entry_], v);
+    }
+    ScopedCall(const ScopedCall&) = delete;
+    ScopedCall& operator=(const ScopedCall&) = delete;
+
+    void countArbdaAtExit(const Tier& tier) { arbda_ = &tier; }
+
+private:
+    detail::ThreadMetrics& m_;
+    std::size_t entry_;
+    bool sampled_;
+    const Tier* arbda_{nullptr};
+    std::chrono::steady_clock::time_point start_{};
+};
+
+#else
+
+inline void countDetector(Detector, std::size_t) {}
+inline void countLabel(LabelId, Tier) {}
+inline void countArbda(Tier) {}
+
+class ScopedCall {
+public:
+    explicit ScopedCall(EntryPoint) {}
+    ScopedCall(const ScopedCall&) = delete;
+    ScopedCall& operator=(const ScopedCall&) = delete;
+
+    void countArbdaAtExit(const Tier&) {}
+};
+
+#endif
+
+} // namespace metrics
+
+} // namespace buds
@@ -0,0 +1,84 @@
+#include "buds_mmap.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace buds {
+
+void xorDecode(std::uint8_t* dst, const std::uint8_t* src, std::size_t n,
+               const std::uint8_t* key, std::uint64_t offset) {
+    // The key rotated to this phase. Going through memcpy keeps byte j of
+    // `word` paired with src[i + j] (i a multiple of 8) on either byte order.
+    std::uint8_t phased[8];
+    for (std::size_t j = 0; j < 8; ++j) phased[j] = key[(offset + j) % 8];
+    std::uint64_t word;
+    std::memcpy(&word, phased, 8);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t v;
+        std::memcpy(&v, src + i, 8);
+        v ^= word;
+        std::memcpy(dst + i, &v, 8);
+    }
+    for (; i < n; ++i) dst[i] = src[i] ^ phased[i % 8];
+}
+
+MappedFile::~MappedFile() { close(); }
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (map_) munmap(map_, size_);
+    map_ = nullptr;
+#else
+    buffer_.clear();
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool MappedFile::open(const std::string& path, const std::uint8_t* xorKey, bool sequential) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ == 0) {
+        ::close(fd);
+        return true;
+    }
+    int prot = xorKey ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* p = mmap(nullptr, size_, prot, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        size_ = 0;
+        return false;
+    }
+    map_ = p;
+    madvise(map_, size_, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    data_ = static_cast<std::uint8_t*>(map_);
+#else
+    (void)sequential;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    size_ = buffer_.size();
+    data_ = reinterpret_cast<std::uint8_t*>(buffer_.data());
+#endif
+    if (xorKey) xorDecode(data_, data_, size_, xorKey, 0);
+    return true;
+}
+
+} // namespace buds
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "buds_tx.h"
+
+namespace buds {
+
+// XORs `n` bytes of `src` with the repeating 8-byte `key` into `dst`
+// (which may be `src`), a word at a time. `offset` is the position of
+// src[0] in the obfuscated file and sets the key phase.
+void xorDecode(std::uint8_t* dst, const std::uint8_t* src, std::size_t n,
+               const std::uint8_t* key, std::uint64_t offset);
+
+// Read-only view of a whole file. On POSIX the file is mmapped; elsewhere
+// it is read into memory. With a key, open() de-XORs the whole file in a
+// private writable mapping before returning, which copies every page;
+// callers that only need parts of a large file should map it without a key
+// and xorDecode the ranges they read. The mapping starts on a page
+// boundary, so offsets aligned in the file are aligned in memory.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    // `xorKey` (8 bytes) de-obfuscates the contents; nullptr maps as is.
+    // `sequential` hints that the file will be read front to back once.
+    // Any previous mapping is released first.
+    bool open(const std::string& path, const std::uint8_t* xorKey = nullptr,
+              bool sequential = true);
+    void close();
+
+    ByteSpan bytes() const { return ByteSpan(data_, size_); }
+    std::size_t size() const { return size_; }
+
+private:
+    std::uint8_t* data_{nullptr};
+    std::size_t size_{0};
+#ifndef _WIN32
+    void* map_{nullptr};
+#else
+    std::vector<char> buffer_;
+#endif
+};
+
+} // namespace buds
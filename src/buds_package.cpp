@@ -0,0 +1,191 @@
+#include "buds_package.h"
+
+#include <algorithm>
+
+namespace buds {
+
+void PackageAggregate::add(const PackageAggregate& o) {
+    count += o.count;
+    vsize += o.vsize;
+    fee += o.fee;
+    regions.T0 += o.regions.T0;
+    regions.T1 += o.regions.T1;
+    regions.T2 += o.regions.T2;
+    regions.T3 += o.regions.T3;
+    for (std::size_t i = 0; i < kLabelCount; ++i) labels[i] += o.labels[i];
+}
+
+void PackageAggregate::subtract(const PackageAggregate& o) {
+    count -= o.count;
+    vsize -= o.vsize;
+    fee -= o.fee;
+    regions.T0 -= o.regions.T0;
+    regions.T1 -= o.regions.T1;
+    regions.T2 -= o.regions.T2;
+    regions.T3 -= o.regions.T3;
+    for (std::size_t i = 0; i < kLabelCount; ++i) labels[i] -= o.labels[i];
+}
+
+PackageGraph::PackageGraph(std::size_t maxAncestors) : maxAncestors_(maxAncestors) {}
+
+void PackageGraph::collect(std::uint32_t start, bool up) {
+    // Epoch marks make each walk linear in the package size.
+    if (++epoch_ == 0) {
+        for (auto& node : nodes_) node.mark = 0;
+        epoch_ = 1;
+    }
+    visit_.clear();
+    stack_.assign(1, start);
+    nodes_[start].mark = epoch_;
+    while (!stack_.empty()) {
+        std::uint32_t v = stack_.back();
+        stack_.pop_back();
+        for (std::uint32_t w : up ? nodes_[v].parents : nodes_[v].children) {
+            if (nodes_[w].mark == epoch_) continue;
+            nodes_[w].mark = epoch_;
+            visit_.push_back(w);
+            stack_.push_back(w);
+        }
+    }
+}
+
+bool PackageGraph::add(const Hash256& txid, const CompactClassification& c, std::uint32_t vsize,
+                       std::uint64_t fee, const std::vector<Hash256>& parents) {
+    if (index_.count(txid)) return false;
+
+    std::uint32_t n;
+    if (!free_.empty()) {
+        n = free_.back();
+        free_.pop_back();
+    } else {
+        n = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    Node& node = nodes_[n];
+    node.id = txid;
+    node.parents.clear();
+    node.children.clear();
+    node.self = PackageAggregate();
+    node.self.count = 1;
+    node.self.vsize = vsize;
+    node.self.fee = fee;
+    node.self.regions = c.counts;
+    for (std::size_t i = 0; i < c.labelCount; ++i) node.self.labels[c.labels[i]] = 1;
+
+    for (const auto& p : parents) {
+        auto it = index_.find(p);
+        if (it == index_.end()) continue; // confirmed or unknown
+        if (std::find(node.parents.begin(), node.parents.end(), it->second) == node.parents.end()) {
+            node.parents.push_back(it->second);
+        }
+    }
+
+    collect(n, true);
+    if (visit_.size() + 1 > maxAncestors_) {
+        node.parents.clear();
+        free_.push_back(n);
+        return false;
+    }
+
+    node.live = true;
+    node.anc = node.self;
+    node.desc = node.self;
+    for (std::uint32_t a : visit_) {
+        node.anc.add(nodes_[a].self);
+        nodes_[a].desc.add(node.self);
+    }
+    for (std::uint32_t p : node.parents) nodes_[p].children.push_back(n);
+    index_.emplace(txid, n);
+    return true;
+}
+
+void PackageGraph::unlink(std::uint32_t n) {
+    Node& node = nodes_[n];
+    for (std::uint32_t p : node.parents) {
+        auto& siblings = nodes_[p].children;
+        siblings.erase(std::find(siblings.begin(), siblings.end(), n));
+    }
+    for (std::uint32_t c : node.children) {
+        auto& coParents = nodes_[c].parents;
+        coParents.erase(std::find(coParents.begin(), coParents.end(), n));
+    }
+    node.parents.clear();
+    node.children.clear();
+    node.live = false;
+    index_.erase(node.id);
+    free_.push_back(n);
+}
+
+bool PackageGraph::removeConfirmed(const Hash256& txid) {
+    auto it = index_.find(txid);
+    if (it == index_.end()) return false;
+    std::uint32_t n = it->second;
+    if (!nodes_[n].parents.empty()) return false;
+
+    collect(n, false);
+    for (std::uint32_t d : visit_) nodes_[d].anc.subtract(nodes_[n].self);
+    unlink(n);
+    return true;
+}
+
+std::size_t PackageGraph::removeWithDescendants(const Hash256& txid) {
+    auto it = index_.find(txid);
+    if (it == index_.end()) return 0;
+    std::uint32_t n = it->second;
+
+    collect(n, false);
+    std::vector<std::uint32_t> doomed(visit_);
+    doomed.push_back(n);
+
+    // Every surviving ancestor loses exactly the doomed members below it;
+    // walking up from each doomed tx covers that without double counting.
+    for (std::uint32_t d : doomed) nodes_[d].live = false;
+    for (std::uint32_t d : doomed) {
+        collect(d, true);
+        for (std::uint32_t a : visit_) {
+            if (nodes_[a].live) nodes_[a].desc.subtract(nodes_[d].self);
+        }
+    }
+    for (std::uint32_t d : doomed) unlink(d);
+    return doomed.size();
+}
+
+const PackageAggregate* PackageGraph::ancestors(const Hash256& txid) const {
+    auto it = index_.find(txid);
+    return it == index_.end() ? nullptr : &nodes_[it->second].anc;
+}
+
+const PackageAggregate* PackageGraph::descendants(const Hash256& txid) const {
+    auto it = index_.find(txid);
+    return it == index_.end() ? nullptr : &nodes_[it->second].desc;
+}
+
+void PackageGraph::evaluate(const TagEngine& engine, const PackageAggregate& agg,
+                            double baseMinFeerate, PackageEvaluation& out) {
+    CompactClassification c;
+    c.counts = agg.regions;
+    for (std::size_t i = 0; i < kLabelCount; ++i) {
+        if (agg.labels[i]) c.labels[c.labelCount++] = static_cast<std::uint8_t>(i);
+    }
+    out.members = agg;
+    out.feerate = agg.feerate();
+    out.eval = engine.evaluate(c, baseMinFeerate, out.feerate);
+}
+
+bool PackageGraph::evaluateAncestors(const TagEngine& engine, const Hash256& txid,
+                                     double baseMinFeerate, PackageEvaluation& out) const {
+    const PackageAggregate* agg = ancestors(txid);
+    if (!agg) return false;
+    evaluate(engine, *agg, baseMinFeerate, out);
+    return true;
+}
+
+bool PackageGraph::evaluateDescendants(const TagEngine& engine, const Hash256& txid,
+                                       double baseMinFeerate, PackageEvaluation& out) const {
+    const PackageAggregate* agg = descendants(txid);
+    if (!agg) return false;
+    evaluate(engine, *agg, baseMinFeerate, out);
+    return true;
+}
+
+} // namespace buds
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "buds_labels.h"
+#include "buds_tagger.h"
+#include "buds_tx.h"
+
+namespace buds {
+
+// Sums over a set of transactions (a tx plus its in-mempool ancestors, or
+// plus its descendants). Everything here is invertible, so aggregates are
+// updated by adding and subtracting members rather than re-walking chains.
+struct PackageAggregate {
+    std::uint32_t count{0};
+    std::uint64_t vsize{0};
+    std::uint64_t fee{0};                                // sat
+    TierCounts regions;                                  // region tiers, summed
+    std::array<std::uint32_t, kLabelCount> labels{};     // members carrying each label
+
+    void add(const PackageAggregate& o);
+    void subtract(const PackageAggregate& o);
+
+    double feerate() const { return vsize ? static_cast<double>(fee) / static_cast<double>(vsize) : 0.0; }
+};
+
+// Package verdict. The package is scored as if it were one transaction whose
+// regions are the union of its members' regions:
+//   - tier counts add up, so the ARBDA tier is the worst member's tier
+//     (a T3 child drags its clean parents down, and vice versa);
+//   - the multiplier is the maximum over every label present;
+//   - each distinct label's boost counts once, clamped as in computePolicy;
+//   - the feerate is total fee / total vsize (CPFP).
+struct PackageEvaluation {
+    PackageAggregate members;
+    double feerate{0.0};
+    Evaluation eval;            // eval.policy.score uses the package feerate
+};
+
+// Incremental ancestor / descendant index over in-mempool transactions.
+// add() walks the new transaction's ancestors once (bounded by the
+// ancestor limit, 25 by default as in Bitcoin Core) and updates their
+// descendant aggregates; removals subtract from the affected side only.
+class PackageGraph {
+public:
+    explicit PackageGraph(std::size_t maxAncestors = 25);
+
+    // `parents` may name confirmed transactions; those are ignored. Returns
+    // false if the txid is already present or the ancestor limit would be
+    // exceeded.
+    bool add(const Hash256& txid, const CompactClassification& c, std::uint32_t vsize,
+             std::uint64_t fee, const std::vector<Hash256>& parents);
+
+    // Block inclusion: the transaction must have no in-mempool parents.
+    // Its children keep their other ancestors. Returns false otherwise.
+    bool removeConfirmed(const Hash256& txid);
+
+    // Eviction / RBF: removes the transaction and all of its descendants.
+    // Returns the number of transactions removed.
+    std::size_t removeWithDescendants(const Hash256& txid);
+
+    bool contains(const Hash256& txid) const { return index_.count(txid) != 0; }
+    std::size_t size() const { return index_.size(); }
+
+    // Aggregates include the transaction itself; nullptr if unknown.
+    const PackageAggregate* ancestors(const Hash256& txid) const;
+    const PackageAggregate* descendants(const Hash256& txid) const;
+
+    // Package policy under `engine`'s current profile. The ancestor form is
+    // the CPFP / mining view; the descendant form is the eviction view.
+    bool evaluateAncestors(const TagEngine& engine, const Hash256& txid,
+                           double baseMinFeerate, PackageEvaluation& out) const;
+    bool evaluateDescendants(const TagEngine& engine, const Hash256& txid,
+                             double baseMinFeerate, PackageEvaluation& out) const;
+
+private:
+    struct Node {
+        Hash256 id;
+        PackageAggregate self;
+        PackageAggregate anc;
+        PackageAggregate desc;
+        std::vector<std::uint32_t> parents;
+        std::vector<std::uint32_t> children;
+        std::uint32_t mark{0};
+        bool live{false};
+    };
+
+    std::size_t maxAncestors_;
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> free_;
+    std::unordered_map<Hash256, std::uint32_t, Hash256Hasher> index_;
+    std::uint32_t epoch_{0};
+    std::vector<std::uint32_t> stack_;
+    std::vector<std::uint32_t> visit_;
+
+    // Collects the strict ancestors (or descendants) of `start` into visit_.
+    void collect(std::uint32_t start, bool up);
+    void unlink(std::uint32_t n);
+    static void evaluate(const TagEngine& engine, const PackageAggregate& agg,
+                         double baseMinFeerate, PackageEvaluation& out);
+};
+
+} // namespace buds
@@ -0,0 +1,136 @@
+// buds-query: read the files buds-scan writes.
+//
+//   buds-query FILE [--from HEIGHT] [--to HEIGHT] [--min-tier T0..T3] [--threads N]
+//   buds-query --index PATH TXID ...
+//
+// The first form aggregates a columnar region file (--columns): region and
+// byte totals, label occurrences per tier, and per-label region counts and
+// bytes for the selected heights (inclusive). Only the chunks overlapping
+// the range are read. The second looks transactions up in a txid index
+// (--index) and prints one JSON line per txid.
+#include "buds_columnar.h"
+#include "buds_threadpool.h"
+#include "buds_txindex.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void usage() {
+    std::cerr << "usage: buds-query FILE [--from HEIGHT] [--to HEIGHT] [--min-tier T0..T3]"
+                 " [--threads N]\n"
+                 "       buds-query --index PATH TXID ...\n";
+}
+
+int lookup(int argc, char** argv) {
+    using namespace buds;
+
+    // open() creates a missing index; a lookup should not.
+    std::string path = argv[2];
+    std::error_code ec;
+    if (!std::filesystem::exists(path + ".log", ec)) {
+        std::cerr << "no txid index at " << path << "\n";
+        return 1;
+    }
+    TxIndex index;
+    std::string error;
+    if (!index.open(path, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    int missing = 0;
+    for (int i = 3; i < argc; ++i) {
+        Hash256 txid;
+        TxIndexEntry e;
+        if (!Hash256::fromHex(argv[i], txid) || !index.find(txid, e)) {
+            std::printf("{\"txid\":\"%s\",\"found\":false}\n", argv[i]);
+            ++missing;
+            continue;
+        }
+        std::printf("{\"txid\":\"%s\",\"found\":true,\"height\":", e.txid.toHex().c_str());
+        if (e.height == kNoHeight) std::printf("null");
+        else std::printf("%u", e.height);
+        std::printf(",\"arbda\":\"%s\",\"tiers\":{\"T0\":%d,\"T1\":%d,\"T2\":%d,\"T3\":%d},"
+                    "\"labels\":[",
+                    tierName(e.arbda), e.compact.counts.T0, e.compact.counts.T1,
+                    e.compact.counts.T2, e.compact.counts.T3);
+        for (std::size_t l = 0; l < e.compact.labelCount; ++l) {
+            std::printf("%s\"%s\"", l ? "," : "", labelName(e.compact.labels[l]));
+        }
+        std::printf("]}\n");
+    }
+    return missing ? 3 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace buds;
+
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    if (std::string(argv[1]) == "--index") {
+        if (argc < 4) {
+            usage();
+            return 2;
+        }
+        return lookup(argc, argv);
+    }
+    std::string path = argv[1];
+    ColumnQuery query;
+    std::size_t threads = 0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (arg == "--from") query.minHeight = static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--to") query.maxHeight = static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--min-tier") query.minTier = tierFromName(value);
+        else if (arg == "--threads") threads = std::strtoul(value.c_str(), nullptr, 10);
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    ColumnarReader reader;
+    std::string error;
+    if (!reader.open(path, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    ThreadPool pool(threads);
+
+    auto t0 = std::chrono::steady_clock::now();
+    ColumnAggregate a = reader.aggregate(query, pool);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("file: %llu regions in %zu chunks, heights %u..%u\n",
+                static_cast<unsigned long long>(reader.rows()), reader.chunkCount(),
+                reader.minHeight(), reader.maxHeight());
+    std::printf("selected: %llu regions, %llu bytes (chunks read %zu, skipped %zu)\n",
+                static_cast<unsigned long long>(a.regions), static_cast<unsigned long long>(a.bytes),
+                a.chunksRead, a.chunksSkipped);
+    std::printf("tiers: T0=%llu T1=%llu T2=%llu T3=%llu\n",
+                static_cast<unsigned long long>(a.tiers[0]), static_cast<unsigned long long>(a.tiers[1]),
+                static_cast<unsigned long long>(a.tiers[2]), static_cast<unsigned long long>(a.tiers[3]));
+    std::printf("%-26s %4s %14s %16s\n", "label", "tier", "regions", "bytes");
+    for (LabelId id = 0; id < kLabelCount; ++id) {
+        if (a.labelRegions[id] == 0) continue;
+        std::printf("%-26s %4s %14llu %16llu\n", labelName(id), tierName(reader.tierForLabel(id)),
+                    static_cast<unsigned long long>(a.labelRegions[id]),
+                    static_cast<unsigned long long>(a.labelBytes[id]));
+    }
+    std::cerr << "query: " << seconds << " s\n";
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "buds_registry.h"
+
+#include "buds_json.h"
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace buds {
+
+Registry::Registry() {
+    tiers_.fill(Tier::T3);
+    // T0
+    tiers_[label::ConsensusSig] = Tier::T0;
+    tiers_[label::ConsensusScript] = Tier::T0;
+    tiers_[label::ConsensusTaprootProg] = Tier::T0;
+
+    // T1
+    tiers_[label::PayStandard] = Tier::T1;
+    tiers_[label::PayChannelOpen] = Tier::T1;
+    tiers_[label::PayChannelUpdate] = Tier::T1;
+    tiers_[label::ContractsVault] = Tier::T1;
+    tiers_[label::CommitmentRollupRoot] = Tier::T1;
+    tiers_[label::MetaPoolTag] = Tier::T1;
+
+    // T2
+    tiers_[label::DaOpReturnEmbed] = Tier::T2;
+    tiers_[label::MetaInscription] = Tier::T2;
+    tiers_[label::MetaOrdinal] = Tier::T2;
+    tiers_[label::MetaIndexerHint] = Tier::T2;
+    tiers_[label::DaEmbedMisc] = Tier::T2;
+
+    // T3
+    tiers_[label::DaUnknown] = Tier::T3;
+    tiers_[label::DaObfuscated] = Tier::T3;
+    tiers_[label::DaUnregisteredVendor] = Tier::T3;
+}
+
+bool Registry::fromJson(const std::string& text, Registry& out, std::string* error) {
+    auto failWith = [error](std::string what) {
+        if (error) *error = std::move(what);
+        return false;
+    };
+
+    JsonValue doc;
+    std::string parseError;
+    if (!parseJson(text, doc, &parseError)) return failWith("registry: " + parseError);
+    if (!doc.isObject()) return failWith("registry: top level is not an object");
+
+    const JsonValue* labels = doc.find("labels");
+    if (!labels || !labels->isArray() || labels->array.empty()) {
+        return failWith("registry: missing or empty \"labels\" array");
+    }
+
+    Registry r;
+    r.tiers_.fill(Tier::T3);
+    const JsonValue* version = doc.find("version");
+    if (version) {
+        // Checked before the cast: an out-of-range double to int is undefined.
+        double v = version->isNumber() ? version->number : -1.0;
+        if (!(v >= 0.0 && v <= static_cast<double>(std::numeric_limits<int>::max())) ||
+            v != std::floor(v)) {
+            return failWith("registry: \"version\" is not a non-negative integer");
+        }
+        r.version_ = static_cast<int>(v);
+    }
+
+    for (const JsonValue& entry : labels->array) {
+        const JsonValue* name = entry.find("label");
+        if (!name || !name->isString()) return failWith("registry: entry without a \"label\" string");
+
+        const JsonValue* tier = entry.find("suggested_tier");
+        if (!tier) tier = entry.find("suggested_category");
+
+        LabelId id = labelIdFromName(name->string);
+        if (id == kInvalidLabel) {
+            ++r.ignoredLabels_;
+            continue;
+        }
+        r.tiers_[id] = tier && tier->isString() ? tierFromName(tier->string) : Tier::T3;
+    }
+
+    out = r;
+    return true;
+}
+
+bool Registry::loadFile(const std::string& path, Registry& out, std::string* error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        if (error) *error = "registry: cannot open " + path;
+        return false;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    return fromJson(text.str(), out, error);
+}
+
+} // namespace buds
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+#include "buds_labels.h"
+
+namespace buds {
+
+// Compiled label -> tier map: a flat array indexed by LabelId, immutable
+// once built. The default instance is the BUDS v2 registry as shipped in
+// registry/registry-v2.json.
+class Registry {
+public:
+    Registry();
+
+    // Builds from registry JSON ({"version": N, "labels": [{"label": ...,
+    // "suggested_tier": "T1"}, ...]}). v1 files name the field
+    // "suggested_category"; both are accepted. Vocabulary labels the file
+    // does not list, and unrecognised tier strings, map to T3. Labels
+    // outside the v2 vocabulary are counted in ignoredLabels(), since the
+    // engine can never emit them. Returns false (leaving `out` untouched) on
+    // malformed JSON or a missing / empty labels array.
+    static bool fromJson(const std::string& text, Registry& out, std::string* error = nullptr);
+    static bool loadFile(const std::string& path, Registry& out, std::string* error = nullptr);
+
+    Tier tier(LabelId id) const { return id < kLabelCount ? tiers_[id] : Tier::T3; }
+
+    int version() const { return version_; }
+    std::size_t ignoredLabels() const { return ignoredLabels_; }
+
+    bool operator==(const Registry& o) const { return tiers_ == o.tiers_; }
+    bool operator!=(const Registry& o) const { return !(*this == o); }
+
+private:
+    std::array<Tier, kLabelCount> tiers_{};
+    int version_{2};
+    std::size_t ignoredLabels_{0};
+};
+
+} // namespace buds
@@ -0,0 +1,157 @@
+// buds-scan: classify every block in a Bitcoin Core blocks directory.
+//
+//   buds-scan BLOCKSDIR [--out FILE] [--checkpoint FILE] [--threads N] [--magic HEX]
+//             [--registry FILE] [--columns FILE] [--index PATH]
+//
+// Writes one CSV row per block (in height-linked order) and a summary to
+// stderr. With --checkpoint, an interrupted scan resumes after the last
+// completed blk file and the output is truncated back to match it.
+// --columns also writes every tagged region to a columnar file for
+// buds_columnar.h queries; --index adds every transaction to a txid index
+// (PATH.log / PATH.idx). Neither can be resumed, so both exclude --checkpoint.
+#include "buds_blockscan.h"
+#include "buds_columnar.h"
+#include "buds_tagger.h"
+#include "buds_threadpool.h"
+#include "buds_txindex.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+void usage() {
+    std::cerr << "usage: buds-scan BLOCKSDIR [--out FILE] [--checkpoint FILE]"
+                 " [--threads N] [--magic HEX] [--registry FILE] [--columns FILE]"
+                 " [--index PATH]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace buds;
+
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    ScanOptions options;
+    options.blocksDir = argv[1];
+    std::string outPath;
+    std::string registryPath;
+    std::string columnsPath;
+    std::string indexPath;
+    std::size_t threads = 0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        if (arg == "--out") outPath = argv[++i];
+        else if (arg == "--checkpoint") options.checkpointPath = argv[++i];
+        else if (arg == "--threads") threads = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--registry") registryPath = argv[++i];
+        else if (arg == "--columns") columnsPath = argv[++i];
+        else if (arg == "--index") indexPath = argv[++i];
+        else if (arg == "--magic") options.networkMagic = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 16));
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    if ((!columnsPath.empty() || !indexPath.empty()) && !options.checkpointPath.empty()) {
+        std::cerr << "--columns and --index cannot be combined with --checkpoint\n";
+        return 2;
+    }
+    options.keepTags = !columnsPath.empty();
+    options.keepTxs = !indexPath.empty();
+
+    TagEngine engine;
+    std::string error;
+    if (!registryPath.empty() && !engine.loadRegistry(registryPath, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    ColumnarWriter columns(engine.config()->registry);
+    if (!columnsPath.empty() && !columns.open(columnsPath, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    TxIndex index;
+    if (!indexPath.empty() && !index.open(indexPath, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    ThreadPool pool(threads);
+    BlockScanner scanner(engine, pool, options);
+
+    std::FILE* out = stdout;
+    if (!outPath.empty()) {
+        // Drop rows written after the checkpoint we resume from.
+        std::uint64_t keep = scanner.resumeToken();
+        std::error_code ec;
+        if (scanner.nextFile() > 0 && std::filesystem::exists(outPath, ec)) {
+            std::filesystem::resize_file(outPath, keep, ec);
+            out = std::fopen(outPath.c_str(), "ab");
+        } else {
+            out = std::fopen(outPath.c_str(), "wb");
+        }
+        if (!out) {
+            std::cerr << "cannot open " << outPath << "\n";
+            return 1;
+        }
+    }
+    if (scanner.nextFile() == 0 || out == stdout) {
+        std::fputs("height,hash,time,txs,size,t0,t1,t2,t3,arbda_t0,arbda_t1,arbda_t2,arbda_t3\n", out);
+    }
+
+    auto sink = [&](const BlockStats& s) {
+        char hash[65];
+        s.hash.toHex(hash);
+        hash[64] = '\0';
+        std::fprintf(out, "%u,%s,%u,%u,%u,%d,%d,%d,%d,%u,%u,%u,%u\n",
+                     s.height, hash, s.time, s.txCount, s.size,
+                     s.regions.T0, s.regions.T1, s.regions.T2, s.regions.T3,
+                     s.arbda[0], s.arbda[1], s.arbda[2], s.arbda[3]);
+        if (options.keepTags) columns.append(s.height, s.tags.data(), s.tags.size());
+        for (const auto& tx : s.txs) index.append(tx);
+    };
+    auto flush = [&]() -> std::uint64_t {
+        std::fflush(out);
+#ifndef _WIN32
+        if (out != stdout) fsync(fileno(out));
+#endif
+        long pos = out == stdout ? -1 : std::ftell(out);
+        return pos < 0 ? 0 : static_cast<std::uint64_t>(pos);
+    };
+
+    ScanSummary summary = scanner.run(sink, flush);
+    if (out != stdout) std::fclose(out);
+    if (options.keepTags && !columns.close(&error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    if (options.keepTxs && !index.sync()) {
+        std::cerr << "txid index write failed\n";
+        return 1;
+    }
+
+    double mb = static_cast<double>(summary.bytes) / (1024.0 * 1024.0);
+    std::cerr << "files=" << summary.files << " blocks=" << summary.blocks
+              << " txs=" << summary.txs << " malformed=" << summary.malformed
+              << " unlinked=" << summary.unlinked << "\n";
+    std::cerr << "throughput: " << (summary.seconds > 0 ? mb / summary.seconds : 0.0)
+              << " MB/s over " << summary.seconds << " s\n";
+    std::cerr << "arbda: T0=" << summary.arbda[0] << " T1=" << summary.arbda[1]
+              << " T2=" << summary.arbda[2] << " T3=" << summary.arbda[3] << "\n";
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include "buds_script.h"
+
+#include "buds_hex.h"
+
+#include <array>
+
+namespace buds {
+
+bool readScriptOp(ByteSpan script, std::size_t& pos, ScriptOp& out) {
+    const std::size_t size = script.size();
+    if (pos >= size) return false;
+
+    out.offset = static_cast<std::uint32_t>(pos);
+    out.opcode = script[pos++];
+    out.push = ByteSpan();
+    if (out.opcode > op::PushData4) return true;
+
+    std::size_t len = out.opcode;
+    std::size_t width = 0;
+    if (out.opcode == op::PushData1) width = 1;
+    else if (out.opcode == op::PushData2) width = 2;
+    else if (out.opcode == op::PushData4) width = 4;
+    if (width) {
+        if (size - pos < width) return false;
+        len = 0;
+        for (std::size_t i = 0; i < width; ++i) len |= std::size_t(script[pos + i]) << (8 * i);
+        pos += width;
+    }
+    if (size - pos < len) return false;
+    out.push = script.subspan(pos, len);
+    pos += len;
+    return true;
+}
+
+bool looksLikeScript(ByteSpan script) {
+    std::size_t pos = 0;
+    std::size_t executable = 0;
+    std::size_t depth = 0; // open OP_IF / OP_NOTIF
+    ScriptOp o;
+    while (pos < script.size()) {
+        if (!readScriptOp(script, pos, o)) return false;
+        if (o.isPushLike()) continue;
+        switch (o.opcode) {
+        case 0x50: // OP_RESERVED
+        case 0x62: // OP_VER
+        case 0x65: // OP_VERIF
+        case 0x66: // OP_VERNOTIF
+        case 0x89: // OP_RESERVED1
+        case 0x8a: // OP_RESERVED2
+            return false;
+        case op::If:
+        case op::NotIf:
+            ++depth;
+            break;
+        case op::Else:
+            if (depth == 0) return false;
+            break;
+        case op::EndIf:
+            if (depth == 0) return false;
+            --depth;
+            break;
+        default:
+            if (o.opcode > op::CheckSigAdd) return false;
+        }
+        ++executable;
+    }
+    // Unbalanced conditionals fail at execution, so no valid script has them.
+    return executable > 0 && depth == 0;
+}
+
+// ---------- scriptPubKey templates ----------
+
+namespace {
+
+// A fixed-length template: every byte not listed in `fixed` is payload
+// (hash / key). Templates are bucketed by first byte at startup.
+struct ScriptTemplate {
+    ScriptType type;
+    std::uint8_t length;
+    std::uint8_t fixedCount;
+    struct { std::uint8_t pos, value; } fixed[5];
+};
+
+const ScriptTemplate kTemplates[] = {
+    {ScriptType::P2PKH,  25, 5, {{0, op::Dup}, {1, op::Hash160}, {2, 0x14}, {23, op::EqualVerify}, {24, op::CheckSig}}},
+    {ScriptType::P2SH,   23, 3, {{0, op::Hash160}, {1, 0x14}, {22, op::Equal}}},
+    {ScriptType::P2WPKH, 22, 2, {{0, 0x00}, {1, 0x14}}},
+    {ScriptType::P2WSH,  34, 2, {{0, 0x00}, {1, 0x20}}},
+    {ScriptType::P2TR,   34, 2, {{0, 0x51}, {1, 0x20}}},
+    {ScriptType::P2PK,   35, 2, {{0, 0x21}, {34, op::CheckSig}}},
+    {ScriptType::P2PK,   67, 2, {{0, 0x41}, {66, op::CheckSig}}},
+};
+
+bool matchesTemplate(const ScriptTemplate& t, ByteSpan script) {
+    for (std::size_t i = 0; i < t.fixedCount; ++i) {
+        if (script[t.fixed[i].pos] != t.fixed[i].value) return false;
+    }
+    return true;
+}
+
+struct TemplateIndex {
+    // Up to two templates share a first byte (P2WPKH / P2WSH).
+    std::array<std::array<std::int8_t, 2>, 256> byFirst;
+
+    TemplateIndex() {
+        for (auto& slot : byFirst) slot = {-1, -1};
+        for (std::size_t i = 0; i < sizeof(kTemplates) / sizeof(kTemplates[0]); ++i) {
+            auto& slot = byFirst[kTemplates[i].fixed[0].value];
+            slot[slot[0] < 0 ? 0 : 1] = static_cast<std::int8_t>(i);
+        }
+    }
+};
+
+void analyzeNullData(ByteSpan script, ScriptInfo& info) {
+    info.type = ScriptType::NullData;
+    std::size_t pos = 1;
+    ScriptOp o;
+    bool pushOnly = true;
+    while (pos < script.size()) {
+        if (!readScriptOp(script, pos, o) || !o.isPush()) {
+            pushOnly = false;
+            break;
+        }
+        if (info.pushCount == 0) info.firstPushSize = static_cast<std::uint32_t>(o.push.size());
+        if (!o.push.empty()) {
+            std::uint32_t at = static_cast<std::uint32_t>(o.push.data() - script.data());
+            if (info.payloadSize == 0) info.payloadStart = at;
+            info.payloadEnd = at + static_cast<std::uint32_t>(o.push.size());
+        }
+        info.payloadSize += static_cast<std::uint32_t>(o.push.size());
+        info.payloadPrintable += static_cast<std::uint32_t>(countPrintable(o.push.data(), o.push.size()));
+        ++info.pushCount;
+    }
+    info.pushOnly = pushOnly;
+
+    if (!pushOnly) {
+        ByteSpan tail = script.subspan(1);
+        info.payloadStart = 1;
+        info.payloadEnd = static_cast<std::uint32_t>(script.size());
+        info.payloadSize = static_cast<std::uint32_t>(tail.size());
+        info.payloadPrintable = static_cast<std::uint32_t>(countPrintable(tail.data(), tail.size()));
+    } else if (info.payloadSize == 0) {
+        info.payloadStart = info.payloadEnd = static_cast<std::uint32_t>(script.size());
+    }
+}
+
+} // namespace
+
+ScriptInfo analyzeScriptPubKey(ByteSpan script) {
+    static const TemplateIndex index;
+    ScriptInfo info;
+    if (script.empty()) return info;
+
+    if (script[0] == op::Return) {
+        analyzeNullData(script, info);
+        return info;
+    }
+    for (std::int8_t i : index.byFirst[script[0]]) {
+        if (i < 0) break;
+        const ScriptTemplate& t = kTemplates[i];
+        if (script.size() == t.length && matchesTemplate(t, script)) {
+            info.type = t.type;
+            break;
+        }
+    }
+    return info;
+}
+
+const char* scriptTypeName(ScriptType type) {
+    switch (type) {
+    case ScriptType::P2PK:     return "p2pk";
+    case ScriptType::P2PKH:    return "p2pkh";
+    case ScriptType::P2SH:     return "p2sh";
+    case ScriptType::P2WPKH:   return "p2wpkh";
+    case ScriptType::P2WSH:    return "p2wsh";
+    case ScriptType::P2TR:     return "p2tr";
+    case ScriptType::NullData: return "nulldata";
+    case ScriptType::NonStandard:
+    default:                   return "nonstandard";
+    }
+}
+
+// ---------- ordinal envelopes ----------
+
+namespace {
+
+const std::uint8_t kEnvelopeHeader[] = {op::False, op::If, 0x03, 'o', 'r', 'd'};
+
+// Parses the envelope whose header starts at `at`.
+bool parseEnvelope(ByteSpan script, std::size_t at, OrdinalEnvelope& out) {
+    out = OrdinalEnvelope();
+    out.start = static_cast<std::uint32_t>(at);
+
+    std::size_t pos = at + sizeof(kEnvelopeHeader);
+    ScriptOp tag, value;
+    bool inBody = false;
+    for (;;) {
+        if (!readScriptOp(script, pos, tag)) return false; // unterminated
+        if (tag.opcode == op::EndIf) break;
+        if (!tag.isPushLike()) return false;
+        if (inBody) {
+            out.bodySize += tag.push.size();
+            continue;
+        }
+        if (tag.opcode == op::False) {
+            inBody = true;
+            continue;
+        }
+        if (!readScriptOp(script, pos, value) || !value.isPushLike()) return false;
+        bool isContentType = (tag.push.size() == 1 && tag.push[0] == 1) || tag.opcode == op::One;
+        if (isContentType && out.contentType.empty()) out.contentType = value.push;
+    }
+    out.end = static_cast<std::uint32_t>(pos);
+    return true;
+}
+
+} // namespace
+
+bool findOrdinalEnvelope(ByteSpan script, OrdinalEnvelope& out) {
+    const std::uint8_t* data = script.data();
+    const std::size_t size = script.size();
+    std::size_t pos = 0;
+    ScriptOp skip;
+
+    for (;;) {
+        const std::uint8_t* hit = findBytes(data + pos, size - pos, kEnvelopeHeader, sizeof(kEnvelopeHeader));
+        if (!hit) return false;
+        const std::size_t at = static_cast<std::size_t>(hit - data);
+
+        // Only accept headers that begin on an opcode boundary.
+        while (pos < at) {
+            if (!readScriptOp(script, pos, skip)) return false;
+        }
+        if (pos == at) {
+            if (parseEnvelope(script, at, out)) return true;
+            readScriptOp(script, pos, skip); // step over this OP_FALSE
+        }
+        // Otherwise the match sat inside push data; resume after that push.
+    }
+}
+
+} // namespace buds
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "buds_tx.h"
+
+namespace buds {
+
+// Opcodes the detectors care about.
+namespace op {
+constexpr std::uint8_t False = 0x00;
+constexpr std::uint8_t PushData1 = 0x4c;
+constexpr std::uint8_t PushData2 = 0x4d;
+constexpr std::uint8_t PushData4 = 0x4e;
+constexpr std::uint8_t OneNegate = 0x4f;
+constexpr std::uint8_t One = 0x51;
+constexpr std::uint8_t Sixteen = 0x60;
+constexpr std::uint8_t If = 0x63;
+constexpr std::uint8_t NotIf = 0x64;
+constexpr std::uint8_t Else = 0x67;
+constexpr std::uint8_t EndIf = 0x68;
+constexpr std::uint8_t Return = 0x6a;
+constexpr std::uint8_t Dup = 0x76;
+constexpr std::uint8_t Equal = 0x87;
+constexpr std::uint8_t EqualVerify = 0x88;
+constexpr std::uint8_t Hash160 = 0xa9;
+constexpr std::uint8_t CheckSig = 0xac;
+constexpr std::uint8_t CheckSigAdd = 0xba;  // highest assigned opcode (tapscript)
+} // namespace op
+
+// One script element. For push opcodes (OP_0 .. OP_PUSHDATA4) `push` spans
+// the pushed bytes inside the script; it is empty for every other opcode.
+struct ScriptOp {
+    std::uint8_t opcode{0};
+    std::uint32_t offset{0};   // position of the opcode byte
+    ByteSpan push;
+
+    bool isPush() const { return opcode <= op::PushData4; }
+    // Pushes plus OP_1NEGATE and OP_1 .. OP_16.
+    bool isPushLike() const {
+        return isPush() || opcode == op::OneNegate || (opcode >= op::One && opcode <= op::Sixteen);
+    }
+};
+
+// Reads the element at `pos` and advances past it. Returns false at the end
+// of the script or when a push length runs past the end.
+bool readScriptOp(ByteSpan script, std::size_t& pos, ScriptOp& out);
+
+// True if `script` reads as executable script rather than data: it
+// tokenizes to the end, contains at least one non-push opcode, balances its
+// OP_IF / OP_NOTIF / OP_ELSE / OP_ENDIF, and uses no unassigned or reserved
+// opcode (OP_RESERVED, OP_VER, OP_VERIF, OP_VERNOTIF, OP_RESERVED1/2,
+// anything above OP_CHECKSIGADD). Random bytes almost never pass; large
+// multisig and covenant scripts do.
+bool looksLikeScript(ByteSpan script);
+
+enum class ScriptType : std::uint8_t {
+    NonStandard,
+    P2PK,
+    P2PKH,
+    P2SH,
+    P2WPKH,
+    P2WSH,
+    P2TR,
+    NullData     // starts with OP_RETURN
+};
+
+// Result of one pass over a scriptPubKey.
+struct ScriptInfo {
+    ScriptType type{ScriptType::NonStandard};
+
+    // NullData only. The payload is the data of the pushes that follow
+    // OP_RETURN, in order; [payloadStart, payloadEnd) spans the first to the
+    // last pushed byte (both at the script end when nothing was pushed).
+    // When the tail is not push-only (or a push is truncated) the raw bytes
+    // after OP_RETURN are the payload instead.
+    std::uint32_t payloadStart{0};
+    std::uint32_t payloadEnd{0};
+    std::uint32_t payloadSize{0};      // pushed bytes, excluding opcodes
+    std::uint32_t payloadPrintable{0}; // bytes of the payload in [0x20, 0x7e]
+    std::uint32_t pushCount{0};
+    bool pushOnly{false};
+    std::uint32_t firstPushSize{0};    // for single-commitment detection
+};
+
+// Classifies a scriptPubKey. Fixed templates are matched by a table keyed on
+// (first byte, length); OP_RETURN outputs are tokenized once.
+ScriptInfo analyzeScriptPubKey(ByteSpan script);
+
+const char* scriptTypeName(ScriptType type);
+
+// Ordinal inscription envelope inside a tapscript:
+//   OP_FALSE OP_IF "ord" [<tag> <value>]* [OP_0 <body push>*] OP_ENDIF
+struct OrdinalEnvelope {
+    std::uint32_t start{0};    // offset of OP_FALSE
+    std::uint32_t end{0};      // one past OP_ENDIF
+    ByteSpan contentType;      // value of tag 1; empty if absent
+    std::size_t bodySize{0};   // total bytes of the body pushes
+};
+
+// Finds the first well-formed envelope that starts on an opcode boundary.
+// A vector substring scan for the envelope header rejects most items before
+// any opcode walking; "ord" bytes inside push data or in non-script items
+// do not match.
+bool findOrdinalEnvelope(ByteSpan script, OrdinalEnvelope& out);
+
+} // namespace buds
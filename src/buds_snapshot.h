@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace buds {
+
+namespace detail {
+
+// Stable per-thread stripe index, handed out round-robin on first use.
+inline std::size_t snapshotStripe() {
+    static std::atomic<std::size_t> next{0};
+    thread_local std::size_t stripe = next.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+}
+
+} // namespace detail
+
+// Holds one immutable T that readers pin without locks and a writer can
+// replace at any time. Reclamation follows the sleepable-RCU pattern:
+// readers bump a counter in their own cache-line stripe under the current
+// parity, and publish() swaps the pointer, flips the parity and waits for
+// both parities to drain before freeing the old value. Readers never wait;
+// a pin costs two uncontended atomic adds, so pin once per unit of work
+// (a transaction, a batch), not per lookup.
+template <typename T>
+class SnapshotCell {
+public:
+    // Pins the snapshot current at construction for its whole lifetime.
+    class Reader {
+    public:
+        Reader(Reader&& o) noexcept : counter_(o.counter_), value_(o.value_) { o.counter_ = nullptr; }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        Reader& operator=(Reader&&) = delete;
+        ~Reader() {
+            if (counter_) counter_->fetch_sub(1, std::memory_order_release);
+        }
+
+        const T& operator*() const { return *value_; }
+        const T* operator->() const { return value_; }
+        const T* get() const { return value_; }
+
+    private:
+        friend class SnapshotCell;
+        Reader(std::atomic<std::uint32_t>* counter, const T* value) : counter_(counter), value_(value) {}
+
+        std::atomic<std::uint32_t>* counter_;
+        const T* value_;
+    };
+
+    explicit SnapshotCell(std::unique_ptr<const T> initial) : current_(initial.release()) {}
+    explicit SnapshotCell(T initial) : SnapshotCell(std::unique_ptr<const T>(new T(std::move(initial)))) {}
+    ~SnapshotCell() { delete current_.load(std::memory_order_relaxed); }
+
+    SnapshotCell(const SnapshotCell&) = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+    Reader read() const {
+        Stripe& stripe = stripes_[detail::snapshotStripe() % kStripes];
+        // seq_cst on the increment and the pointer load pairs with publish():
+        // either the writer sees this reader's count, or the reader sees the
+        // new pointer.
+        unsigned parity = parity_.load(std::memory_order_seq_cst);
+        stripe.count[parity].fetch_add(1, std::memory_order_seq_cst);
+        return Reader(&stripe.count[parity], current_.load(std::memory_order_seq_cst));
+    }
+
+    // Replaces the snapshot. Returns once no reader can still hold the old
+    // one, which is then destroyed. Concurrent writers are serialized.
+    // Must not be called while the calling thread holds a Reader.
+    void publish(std::unique_ptr<const T> next) {
+        std::lock_guard<std::mutex> lock(writer_);
+        publishLocked(std::move(next));
+    }
+    void publish(T next) { publish(std::unique_ptr<const T>(new T(std::move(next)))); }
+
+    // Read-copy-update: publishes fn(copy of current). Serialized with
+    // publish(), so concurrent updates never lose each other's changes.
+    template <typename Fn>
+    void update(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(writer_);
+        std::unique_ptr<T> next(new T(*current_.load(std::memory_order_acquire)));
+        fn(*next);
+        publishLocked(std::move(next));
+    }
+
+    // Number of completed publish() / update() calls.
+    std::uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+private:
+    static constexpr std::size_t kStripes = 64;
+
+    struct alignas(64) Stripe {
+        std::atomic<std::uint32_t> count[2] = {{0}, {0}};
+    };
+
+    mutable Stripe stripes_[kStripes];
+    std::atomic<const T*> current_;
+    std::atomic<unsigned> parity_{0};
+    std::atomic<std::uint64_t> generation_{0};
+    std::mutex writer_;
+
+    void publishLocked(std::unique_ptr<const T> next) {
+        std::unique_ptr<const T> old(current_.exchange(next.release(), std::memory_order_seq_cst));
+        unsigned parity = parity_.load(std::memory_order_relaxed);
+        // Stragglers that read the parity before the previous flip but
+        // pinned after it are counted under the other parity: drain those
+        // first, then flip so new readers stop joining `parity`.
+        drain(parity ^ 1u);
+        parity_.store(parity ^ 1u, std::memory_order_seq_cst);
+        drain(parity);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+
+    void drain(unsigned parity) const {
+        for (std::size_t i = 0; i < kStripes; ++i) {
+            for (unsigned spins = 0; stripes_[i].count[parity].load(std::memory_order_seq_cst) != 0; ++spins) {
+                if (spins >= 64) std::this_thread::yield();
+            }
+        }
+    }
+};
+
+} // namespace buds
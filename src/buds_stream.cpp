@@ -0,0 +1,486 @@
+#include "buds_stream.h"
+
+#include "buds_hex.h"
+#include "buds_json.h"
+#include "buds_threadpool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace buds {
+
+void StreamStats::add(const StreamStats& o) {
+    lines += o.lines;
+    txs += o.txs;
+    errors += o.errors;
+    bytes += o.bytes;
+    for (std::size_t t = 0; t < kTierCount; ++t) arbda[t] += o.arbda[t];
+    writeFailed = writeFailed || o.writeFailed;
+}
+
+void TxRecord::clear() {
+    hasRaw = false;
+    raw.clear();
+    tx.txid.clear();
+    tx.vout.clear();
+    tx.witness.clear();
+    feeSats = -1.0;
+    vsize = 0.0;
+}
+
+// ---------- line decoding ----------
+
+namespace {
+
+bool setError(std::string* error, const char* what) {
+    if (error) error->assign(what);
+    return false;
+}
+
+bool decodeHex(const char* hex, std::size_t len, std::vector<std::uint8_t>& out) {
+    if (len == 0 || len % 2 != 0) return false;
+    out.resize(len / 2);
+    return hexDecode(hex, len, out.data()) == len / 2;
+}
+
+bool readHexString(JsonCursor& cur, std::string& out) {
+    JsonCursor::Str s;
+    if (!cur.readString(s) || s.escaped) return false;
+    out.assign(s.data, s.size);
+    return true;
+}
+
+// "vout": [{"scriptPubKey": {"asm": ..., "hex": ...}, ...}, ...]
+bool readOutputs(JsonCursor& cur, Tx& tx) {
+    if (!cur.beginArray()) return false;
+    while (cur.nextElement()) {
+        tx.vout.emplace_back();
+        ScriptPubKey& spk = tx.vout.back().spk;
+        JsonCursor::Str key;
+        if (!cur.beginObject()) return false;
+        while (cur.nextMember(key)) {
+            if (!key.equals("scriptPubKey")) {
+                if (!cur.skipValue()) return false;
+                continue;
+            }
+            if (!cur.beginObject()) return false;
+            while (cur.nextMember(key)) {
+                if (key.equals("hex")) {
+                    if (!readHexString(cur, spk.hex)) return false;
+                } else if (key.equals("asm")) {
+                    // Only the OP_RETURN prefix is used as a hint.
+                    JsonCursor::Str asmText;
+                    if (!cur.readString(asmText)) return false;
+                    if (asmText.size >= 9 && std::memcmp(asmText.data, "OP_RETURN", 9) == 0) {
+                        spk.asm_repr = "OP_RETURN";
+                    }
+                } else if (!cur.skipValue()) {
+                    return false;
+                }
+            }
+            if (cur.failed()) return false;
+        }
+        if (cur.failed()) return false;
+    }
+    return !cur.failed();
+}
+
+// "vin": [{"txinwitness": ["hex", ...], ...}, ...]
+bool readInputs(JsonCursor& cur, Tx& tx) {
+    if (!cur.beginArray()) return false;
+    while (cur.nextElement()) {
+        tx.witness.emplace_back();
+        Witness& w = tx.witness.back();
+        JsonCursor::Str key;
+        if (!cur.beginObject()) return false;
+        while (cur.nextMember(key)) {
+            if (!key.equals("txinwitness")) {
+                if (!cur.skipValue()) return false;
+                continue;
+            }
+            if (!cur.beginArray()) return false;
+            while (cur.nextElement()) {
+                w.stack.emplace_back();
+                if (!readHexString(cur, w.stack.back().hex)) return false;
+            }
+            if (cur.failed()) return false;
+        }
+        if (cur.failed()) return false;
+    }
+    return !cur.failed();
+}
+
+bool parseTxObject(const char* line, std::size_t len, TxRecord& out, std::string* error) {
+    // First pass over the top-level members: note where the interesting
+    // ones are and skip the rest, so "hex" (usually last) wins without
+    // building a Tx from vin / vout first.
+    JsonCursor cur(line, len);
+    JsonCursor::Str key, hex;
+    std::size_t vinAt = 0, voutAt = 0;
+    bool haveHex = false, haveVin = false, haveVout = false;
+    if (!cur.beginObject()) return setError(error, "invalid JSON");
+    while (cur.nextMember(key)) {
+        bool ok = true;
+        if (key.equals("hex")) {
+            ok = cur.readString(hex) && !hex.escaped;
+            haveHex = true;
+        } else if (key.equals("txid")) {
+            JsonCursor::Str txid;
+            ok = cur.readString(txid);
+            // Kept in its JSON form; escapes stay valid when written back.
+            if (ok) out.tx.txid.assign(txid.data, txid.size);
+        } else if (key.equals("fee")) {
+            double btc = 0.0;
+            ok = cur.readNumber(btc);
+            if (ok) out.feeSats = btc * 1e8;
+        } else if (key.equals("vsize")) {
+            ok = cur.readNumber(out.vsize);
+        } else if (key.equals("vin")) {
+            vinAt = cur.offset();
+            haveVin = true;
+            ok = cur.skipValue();
+        } else if (key.equals("vout")) {
+            voutAt = cur.offset();
+            haveVout = true;
+            ok = cur.skipValue();
+        } else {
+            ok = cur.skipValue();
+        }
+        if (!ok) return setError(error, "invalid JSON");
+    }
+    if (cur.failed() || !cur.atEnd()) return setError(error, "invalid JSON");
+
+    if (haveHex) {
+        if (!decodeHex(hex.data, hex.size, out.raw)) return setError(error, "invalid hex");
+        out.hasRaw = true;
+        return true;
+    }
+    if (!haveVin && !haveVout) return setError(error, "no hex, vin or vout");
+    if (haveVout) {
+        JsonCursor vout(line + voutAt, len - voutAt);
+        if (!readOutputs(vout, out.tx)) return setError(error, "invalid vout");
+    }
+    if (haveVin) {
+        JsonCursor vin(line + vinAt, len - vinAt);
+        if (!readInputs(vin, out.tx)) return setError(error, "invalid vin");
+    }
+    return true;
+}
+
+} // namespace
+
+bool parseTxLine(const char* line, std::size_t len, TxRecord& out, std::string* error) {
+    out.clear();
+    while (len > 0 && (line[0] == ' ' || line[0] == '\t')) {
+        ++line;
+        --len;
+    }
+    while (len > 0 && (line[len - 1] == ' ' || line[len - 1] == '\t' || line[len - 1] == '\r')) --len;
+    if (len == 0) return setError(error, "empty line");
+
+    if (line[0] == '{') return parseTxObject(line, len, out, error);
+    if (line[0] == '"') {
+        JsonCursor cur(line, len);
+        JsonCursor::Str s;
+        if (!cur.readString(s) || s.escaped || !cur.atEnd()) return setError(error, "invalid JSON");
+        line = s.data;
+        len = s.size;
+    }
+    if (!decodeHex(line, len, out.raw)) return setError(error, "invalid hex");
+    out.hasRaw = true;
+    return true;
+}
+
+const char* csvHeader() {
+    return "line,txid,arbda,T0,T1,T2,T3,labels,feerate,required,score,error\n";
+}
+
+// ---------- formatting ----------
+
+namespace {
+
+void appendf(std::string& out, const char* fmt, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = std::vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n > 0) out.append(buf, static_cast<std::size_t>(n) < sizeof(buf) ? static_cast<std::size_t>(n) : sizeof(buf) - 1);
+}
+
+void appendCsvField(std::string& out, const std::string& field) {
+    if (field.find_first_of(",\"\n") == std::string::npos) {
+        out += field;
+        return;
+    }
+    out += '"';
+    for (char c : field) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+struct Result {
+    std::size_t line;
+    const std::string* txid;
+    Evaluation eval;
+    const CompactClassification* compact;
+    const Classification* tags;   // only with StreamOptions::tags
+    double feerate;               // negative if unknown
+};
+
+void formatJson(std::string& out, const Result& r) {
+    appendf(out, "{\"line\":%zu,\"txid\":\"", r.line);
+    out += *r.txid;
+    appendf(out, "\",\"arbda\":\"%s\",\"tiers\":{\"T0\":%d,\"T1\":%d,\"T2\":%d,\"T3\":%d},\"labels\":[",
+            tierName(r.eval.arbda), r.eval.counts.T0, r.eval.counts.T1, r.eval.counts.T2,
+            r.eval.counts.T3);
+    for (std::size_t i = 0; i < r.compact->labelCount; ++i) {
+        appendf(out, "%s\"%s\"", i ? "," : "", labelName(r.compact->labels[i]));
+    }
+    if (r.feerate >= 0) {
+        appendf(out, "],\"feerate\":%.10g,\"required\":%.10g,\"score\":%.10g", r.feerate,
+                r.eval.policy.required, r.eval.policy.score);
+    } else {
+        appendf(out, "],\"feerate\":null,\"required\":%.10g,\"score\":null", r.eval.policy.required);
+    }
+    if (r.tags) {
+        out += ",\"tags\":[";
+        char surface[48];
+        for (std::size_t i = 0; i < r.tags->tags.size(); ++i) {
+            const Tag& tag = r.tags->tags[i];
+            tag.formatSurface(surface, sizeof(surface));
+            appendf(out, "%s{\"surface\":\"%s\",\"start\":%u,\"end\":%u,\"labels\":[", i ? "," : "",
+                    surface, static_cast<unsigned>(tag.start), static_cast<unsigned>(tag.end));
+            for (std::size_t k = 0; k < tag.labels.size(); ++k) {
+                appendf(out, "%s\"%s\"", k ? "," : "", labelName(tag.labels[k]));
+            }
+            out += "]}";
+        }
+        out += ']';
+    }
+    out += "}\n";
+}
+
+void formatCsv(std::string& out, const Result& r) {
+    appendf(out, "%zu,", r.line);
+    appendCsvField(out, *r.txid);
+    appendf(out, ",%s,%d,%d,%d,%d,", tierName(r.eval.arbda), r.eval.counts.T0, r.eval.counts.T1,
+            r.eval.counts.T2, r.eval.counts.T3);
+    for (std::size_t i = 0; i < r.compact->labelCount; ++i) {
+        appendf(out, "%s%s", i ? ";" : "", labelName(r.compact->labels[i]));
+    }
+    if (r.feerate >= 0) {
+        appendf(out, ",%.10g,%.10g,%.10g,\n", r.feerate, r.eval.policy.required, r.eval.policy.score);
+    } else {
+        appendf(out, ",,%.10g,,\n", r.eval.policy.required);
+    }
+}
+
+void formatError(std::string& out, OutputFormat format, std::size_t line, const std::string& error) {
+    if (format == OutputFormat::Csv) {
+        appendf(out, "%zu,,,,,,,,,,,%s\n", line, error.c_str());
+    } else {
+        appendf(out, "{\"line\":%zu,\"error\":\"%s\"}\n", line, error.c_str());
+    }
+}
+
+struct Batch {
+    std::size_t firstLine{1};
+    std::string text;      // complete lines, '\n'-separated
+    std::string output;
+    StreamStats stats;
+    bool done{false};
+};
+
+void processLine(const char* line, std::size_t len, std::size_t lineNo, const TagEngine& engine,
+                 const StreamOptions& options, Batch& batch) {
+    thread_local TxRecord record;
+    thread_local TxView view;
+    thread_local CompactClassification compact;
+    thread_local Classification full;
+    thread_local std::string txid;
+    thread_local std::string error;
+
+    ++batch.stats.lines;
+    if (!parseTxLine(line, len, record, &error)) {
+        ++batch.stats.errors;
+        formatError(batch.output, options.format, lineNo, error);
+        return;
+    }
+
+    double vsize = record.vsize;
+    if (record.hasRaw) {
+        if (!parseTx(record.raw, view)) {
+            ++batch.stats.errors;
+            formatError(batch.output, options.format, lineNo, "malformed transaction");
+            return;
+        }
+        char hex[64];
+        view.txid().toHex(hex);
+        txid.assign(hex, sizeof(hex));
+        vsize = static_cast<double>(view.vsize());
+    } else {
+        txid = record.tx.txid.empty() ? "<no-txid>" : record.tx.txid;
+    }
+
+    bool withTags = options.tags && options.format == OutputFormat::JsonLines;
+    if (withTags) {
+        if (record.hasRaw) {
+            engine.classify(view, full);
+        } else {
+            engine.classify(record.tx, full);
+        }
+        engine.classifyCompact(full, compact);
+    } else if (record.hasRaw) {
+        engine.classifyCompact(view, compact);
+    } else {
+        engine.classifyCompact(record.tx, compact);
+    }
+
+    double feerate = record.feeSats >= 0 && vsize > 0 ? record.feeSats / vsize : -1.0;
+    Result r{lineNo, &txid, engine.evaluate(compact, options.baseMinFeerate, feerate < 0 ? 0.0 : feerate),
+             &compact, withTags ? &full : nullptr, feerate};
+    ++batch.stats.txs;
+    ++batch.stats.arbda[static_cast<std::size_t>(r.eval.arbda)];
+    if (options.format == OutputFormat::Csv) {
+        formatCsv(batch.output, r);
+    } else {
+        formatJson(batch.output, r);
+    }
+}
+
+void processBatch(Batch& batch, const TagEngine& engine, const StreamOptions& options) {
+    const char* p = batch.text.data();
+    const char* end = p + batch.text.size();
+    std::size_t lineNo = batch.firstLine;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        const char* stop = nl ? nl : end;
+        bool blank = true;
+        for (const char* c = p; c < stop && blank; ++c) blank = *c == ' ' || *c == '\t' || *c == '\r';
+        if (!blank) {
+            try {
+                processLine(p, static_cast<std::size_t>(stop - p), lineNo, engine, options, batch);
+            } catch (const std::exception& e) {
+                ++batch.stats.errors;
+                formatError(batch.output, options.format, lineNo, e.what());
+            }
+        }
+        ++lineNo;
+        p = nl ? nl + 1 : end;
+    }
+}
+
+} // namespace
+
+// ---------- pipeline ----------
+
+StreamStats classifyStream(std::FILE* in, std::FILE* out, const TagEngine& engine,
+                           ThreadPool& pool, const StreamOptions& options) {
+    auto t0 = std::chrono::steady_clock::now();
+    const std::size_t maxInFlight =
+        options.maxBatchesInFlight ? options.maxBatchesInFlight : 4 * pool.size();
+    const std::size_t batchLines = options.batchLines ? options.batchLines : 1;
+
+    StreamStats total;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::unique_ptr<Batch>> inFlight;   // in input order
+    bool readerDone = false;
+
+    // Stage 3: emit finished batches strictly in sequence.
+    std::thread writer([&] {
+        for (;;) {
+            std::unique_ptr<Batch> batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] {
+                    return (!inFlight.empty() && inFlight.front()->done) ||
+                           (readerDone && inFlight.empty());
+                });
+                if (inFlight.empty()) return;
+                batch = std::move(inFlight.front());
+                inFlight.pop_front();
+            }
+            changed.notify_all();   // room for the reader
+            if (!total.writeFailed && !batch->output.empty() &&
+                std::fwrite(batch->output.data(), 1, batch->output.size(), out) != batch->output.size()) {
+                total.writeFailed = true;
+            }
+            total.add(batch->stats);
+        }
+    });
+
+    // Stage 2 runs on the pool. Completion is signalled under the lock so
+    // the writer cannot finish (and this frame unwind) while a task still
+    // touches the condition variable.
+    auto submit = [&](std::unique_ptr<Batch> batch) {
+        Batch* b = batch.get();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return inFlight.size() < maxInFlight; });
+            inFlight.push_back(std::move(batch));
+        }
+        pool.submit([b, &engine, &options, &mutex, &changed] {
+            processBatch(*b, engine, options);
+            std::lock_guard<std::mutex> lock(mutex);
+            b->done = true;
+            changed.notify_all();
+        });
+    };
+
+    // Stage 1: cut the input into batches of whole lines.
+    std::vector<char> chunk(1 << 16);
+    std::size_t lineNo = 1;
+    std::size_t bytesRead = 0;
+    auto batch = std::make_unique<Batch>();
+    std::size_t lines = 0;
+    std::size_t scanned = 0;
+    for (;;) {
+        std::size_t n = std::fread(chunk.data(), 1, chunk.size(), in);
+        if (n == 0) break;
+        bytesRead += n;
+        batch->text.append(chunk.data(), n);
+        while (const char* nl = static_cast<const char*>(
+                   std::memchr(batch->text.data() + scanned, '\n', batch->text.size() - scanned))) {
+            scanned = static_cast<std::size_t>(nl - batch->text.data()) + 1;
+            ++lines;
+            if (lines < batchLines && scanned < options.batchBytes) continue;
+            auto next = std::make_unique<Batch>();
+            next->text.assign(batch->text, scanned, std::string::npos);
+            batch->text.resize(scanned);
+            batch->firstLine = lineNo;
+            lineNo += lines;
+            submit(std::move(batch));
+            batch = std::move(next);
+            lines = 0;
+            scanned = 0;
+        }
+    }
+    if (!batch->text.empty()) {
+        batch->firstLine = lineNo;
+        submit(std::move(batch));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        readerDone = true;
+    }
+    changed.notify_all();
+    writer.join();
+    if (std::fflush(out) != 0) total.writeFailed = true;
+
+    total.bytes = bytesRead;
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return total;
+}
+
+} // namespace buds
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "buds_tagger.h"
+
+namespace buds {
+
+class ThreadPool;
+
+enum class OutputFormat {
+    JsonLines,
+    Csv
+};
+
+struct StreamOptions {
+    OutputFormat format{OutputFormat::JsonLines};
+    bool tags{false};                    // per-region tags (JSON-lines only)
+    double baseMinFeerate{1.0};          // sat/vB, scaled by the policy multiplier
+    std::size_t batchLines{1024};        // lines per work unit
+    std::size_t batchBytes{1 << 20};     // ... or input bytes, whichever comes first
+    std::size_t maxBatchesInFlight{0};   // read-ahead bound; 0 = 4 per pool thread
+};
+
+struct StreamStats {
+    std::size_t lines{0};      // non-blank input lines
+    std::size_t txs{0};        // lines classified
+    std::size_t errors{0};     // lines that could not be decoded
+    std::size_t bytes{0};      // input bytes read
+    std::array<std::size_t, kTierCount> arbda{};
+    bool writeFailed{false};   // output stream reported an error
+    double seconds{0.0};
+
+    void add(const StreamStats& o);
+    double txPerSecond() const { return seconds > 0 ? txs / seconds : 0.0; }
+};
+
+// One decoded input line. `raw` holds the consensus serialization when the
+// line carried one (bare hex, a JSON string, or a verbose object's "hex");
+// otherwise `tx` holds the outputs and witness stacks from "vout" / "vin".
+struct TxRecord {
+    bool hasRaw{false};
+    std::vector<std::uint8_t> raw;
+    Tx tx;
+    double feeSats{-1.0};   // from "fee" (BTC); negative if absent
+    double vsize{0.0};      // from "vsize"; raw serializations use their own
+
+    void clear();
+};
+
+// Decodes one input line: raw transaction hex, a JSON string holding it, or
+// a bitcoind verbose transaction object (getrawtransaction <txid> true,
+// decoderawtransaction). Objects with a "hex" member take the raw path and
+// skip everything else. Returns false with a short reason on bad input.
+bool parseTxLine(const char* line, std::size_t len, TxRecord& out, std::string* error = nullptr);
+
+// Column names for OutputFormat::Csv, newline-terminated.
+const char* csvHeader();
+
+// Classifies every non-blank line of `in` and writes one result per line to
+// `out`, in input order; undecodable lines produce an error record instead.
+//
+// Three stages: the calling thread cuts the input into batches of lines,
+// pool workers decode, classify and format whole batches, and a writer
+// thread emits finished batches in sequence. At most maxBatchesInFlight
+// batches exist at once, so a slow sink stalls the reader rather than
+// buffering the input.
+StreamStats classifyStream(std::FILE* in, std::FILE* out, const TagEngine& engine,
+                           ThreadPool& pool, const StreamOptions& options = StreamOptions());
+
+} // namespace buds
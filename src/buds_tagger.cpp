@@ -1,237 +1,552 @@
 #include "buds_tagger.h"
 
+#include "buds_entropy.h"
+#include "buds_hex.h"
+#include "buds_metrics.h"
+#include "buds_script.h"
+#include "buds_threadpool.h"
+
 #include <algorithm>
-#include <cctype>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <stdexcept>
 
 namespace buds {
 
-TagEngine::TagEngine(PolicyProfile profile) : profile_(profile) {
-    buildRegistryV2();
+EngineConfig EngineConfig::forProfile(PolicyProfile profile) {
+    EngineConfig cfg;
+    cfg.profile = profile;
+    cfg.policy = PolicyTable::forProfile(profile);
+    return cfg;
+}
+
+namespace {
+
+std::atomic<std::uint64_t> gConfigGeneration{0};
+
+std::uint64_t nextGeneration() {
+    return gConfigGeneration.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+EngineConfig withNewGeneration(EngineConfig cfg) {
+    cfg.generation = nextGeneration();
+    return cfg;
+}
+
+} // namespace
+
+TagEngine::TagEngine(PolicyProfile profile)
+    : config_(withNewGeneration(EngineConfig::forProfile(profile))) {}
+
+TagEngine::TagEngine(const EngineConfig& config) : config_(withNewGeneration(config)) {}
+
+void TagEngine::setConfig(const EngineConfig& config) {
+    config_.publish(withNewGeneration(config));
 }
 
 void TagEngine::setPolicyProfile(PolicyProfile profile) {
-    profile_ = profile;
+    config_.update([profile](EngineConfig& cfg) {
+        cfg.profile = profile;
+        cfg.policy = PolicyTable::forProfile(profile);
+    });
+}
+
+void TagEngine::setPolicyTable(const PolicyTable& table) {
+    config_.update([&table](EngineConfig& cfg) { cfg.policy = table; });
+}
+
+void TagEngine::setBatchSplitBytes(std::size_t bytes) {
+    config_.update([bytes](EngineConfig& cfg) { cfg.batchSplitBytes = bytes; });
 }
 
 // ---------- tiny helpers ----------
 
-std::size_t TagEngine::hexByteLen(const std::string& hex) {
-    return hex.size() / 2;
+bool TagEngine::isMostlyAscii(ByteSpan bytes) {
+    return isMostlyAscii(countPrintable(bytes.data(), bytes.size()), bytes.size());
 }
 
-bool TagEngine::hexStartsWith(const std::string& hex, const std::string& prefix) {
-    if (hex.size() < prefix.size()) return false;
-    for (std::size_t i = 0; i < prefix.size(); ++i) {
-        char a = std::tolower(static_cast<unsigned char>(hex[i]));
-        char b = std::tolower(static_cast<unsigned char>(prefix[i]));
-        if (a != b) return false;
-    }
+bool TagEngine::isMostlyAscii(std::size_t printable, std::size_t total) {
+    if (total == 0) return false;
+    return (static_cast<double>(printable) / static_cast<double>(total)) >= 0.8;
+}
+
+// ---------- registry ----------
+
+void TagEngine::setRegistry(const Registry& registry) {
+    config_.update([&registry](EngineConfig& cfg) {
+        cfg.registry = registry;
+        cfg.generation = nextGeneration();
+    });
+}
+
+bool TagEngine::loadRegistry(const std::string& path, std::string* error) {
+    Registry registry;
+    if (!Registry::loadFile(path, registry, error)) return false;
+    setRegistry(registry);
     return true;
 }
 
-bool TagEngine::hexEndsWith(const std::string& hex, const std::string& suffix) {
-    if (hex.size() < suffix.size()) return false;
-    std::size_t offset = hex.size() - suffix.size();
-    for (std::size_t i = 0; i < suffix.size(); ++i) {
-        char a = std::tolower(static_cast<unsigned char>(hex[offset + i]));
-        char b = std::tolower(static_cast<unsigned char>(suffix[i]));
-        if (a != b) return false;
+// ---------- tags ----------
+
+static_assert(sizeof(Tag) <= 32, "Tag is meant to stay a compact POD record");
+
+std::size_t Tag::formatSurface(char* buf, std::size_t cap) const {
+    int n = 0;
+    if (kind == Surface::ScriptPubKey) {
+        n = std::snprintf(buf, cap, "scriptpubkey[%u]", static_cast<unsigned>(index));
+    } else {
+        n = std::snprintf(buf, cap, "witness.stack[%u:%u]",
+                          static_cast<unsigned>(index), static_cast<unsigned>(stackIndex));
     }
-    return true;
+    return n < 0 ? 0 : static_cast<std::size_t>(n);
 }
 
-bool TagEngine::isMostlyAscii(const std::string& hex) {
-    if (hex.empty()) return false;
-    std::size_t printable = 0;
-    std::size_t total = 0;
+std::string Tag::surface() const {
+    char buf[48];
+    std::size_t n = formatSurface(buf, sizeof(buf));
+    return std::string(buf, n);
+}
 
-    for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
-        unsigned int byte = 0;
-        try {
-            byte = static_cast<unsigned int>(std::stoul(hex.substr(i, 2), nullptr, 16));
-        } catch (...) {
-            continue;
+// ---------- core classification ----------
+
+namespace {
+
+// Runs one detector, counting the call and its input bytes when metrics are
+// compiled in.
+template <typename Fn>
+auto detect(Detector d, ByteSpan bytes, Fn&& fn) {
+    metrics::countDetector(d, bytes.size());
+    return fn();
+}
+
+// Labels and tiers of the regions [first, last) just classified.
+void countRegions(const Registry& registry, const Tag* first, const Tag* last) {
+    if (!kMetricsEnabled) return;
+    for (; first != last; ++first) {
+        for (LabelId id : first->labels) metrics::countLabel(id, registry.tier(id));
+    }
+}
+
+} // namespace
+
+Tag TagEngine::classifyScriptPubKey(std::size_t idx, ByteSpan script, bool asmOpReturn) {
+    Tag t;
+    t.kind = Surface::ScriptPubKey;
+    t.index = static_cast<std::uint32_t>(idx);
+    t.start = 0;
+    t.end = static_cast<std::uint32_t>(script.size());
+
+    ScriptInfo info = detect(Detector::ScriptTemplate, script, [&] { return analyzeScriptPubKey(script); });
+    if (info.type == ScriptType::NullData || asmOpReturn) {
+        if (info.type != ScriptType::NullData) {
+            // asm hint on a script without a leading OP_RETURN byte: the
+            // whole script is treated as payload.
+            info.payloadSize = static_cast<std::uint32_t>(script.size());
+            info.payloadPrintable = static_cast<std::uint32_t>(countPrintable(script.data(), script.size()));
+        } else {
+            t.start = info.payloadStart;
+            t.end = info.payloadEnd;
         }
-        ++total;
-        if (byte >= 0x20 && byte <= 0x7e) {
-            ++printable;
+
+        // A single 32-byte direct push, allowing a few trailing bytes.
+        bool rollupRoot = info.type == ScriptType::NullData && info.firstPushSize == 32 &&
+                          script[1] == 0x20 && script.size() <= 40;
+        if (rollupRoot) {
+            t.labels.insert(label::CommitmentRollupRoot);
+        } else {
+            std::size_t payloadLen = info.payloadSize;
+            bool asciiLike = isMostlyAscii(info.payloadPrintable, payloadLen);
+
+            if (payloadLen <= 8 && asciiLike) {
+                t.labels.insert(label::MetaIndexerHint);
+            } else if (payloadLen <= 32 && asciiLike) {
+                t.labels.insert(label::DaOpReturnEmbed);
+            } else if (payloadLen <= 80) {
+                t.labels.insert(label::DaOpReturnEmbed);
+            } else {
+                t.labels.insert(label::DaEmbedMisc);
+            }
         }
+    } else {
+        // Standard templates and unknown scripts alike stay in the economic lane.
+        t.labels.insert(label::PayStandard);
     }
-    if (total == 0) return false;
-    return (static_cast<double>(printable) / static_cast<double>(total)) >= 0.8;
-}
 
-std::string TagEngine::getOpReturnPayloadHex(const std::string& scriptHex) {
-    std::string h = scriptHex;
-    std::transform(h.begin(), h.end(), h.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
-    if (h.size() < 4) return "";
-    if (!hexStartsWith(h, "6a")) return h;
-    // crude but fine for demo: skip OP_RETURN (0x6a) + one push-length byte
-    return h.substr(4);
+    return t;
 }
 
-bool TagEngine::isLikelyOpReturn(const ScriptPubKey& spk) {
-    if (!spk.asm_repr.empty()) {
-        if (spk.asm_repr.rfind("OP_RETURN", 0) == 0) return true;
+Tag TagEngine::classifyWitnessItem(const EngineConfig& cfg, std::size_t vinIdx,
+                                   std::size_t stackIdx, ByteSpan item) {
+    std::size_t byteLen = item.size();
+    Tag t;
+    t.kind = Surface::WitnessStack;
+    t.index = static_cast<std::uint32_t>(vinIdx);
+    t.stackIndex = static_cast<std::uint32_t>(stackIdx);
+    t.start = 0;
+    t.end = static_cast<std::uint32_t>(byteLen);
+
+    OrdinalEnvelope envelope;
+    if (detect(Detector::OrdinalEnvelope, item, [&] { return findOrdinalEnvelope(item, envelope); })) {
+        // The tag covers the envelope itself, not the surrounding tapscript.
+        t.start = envelope.start;
+        t.end = envelope.end;
+        if (envelope.end - envelope.start > cfg.inscriptionThreshold) {
+            t.labels.insert(label::MetaInscription);
+        } else {
+            t.labels.insert(label::MetaOrdinal);
+        }
+    } else if (byteLen <= 128 && detect(Detector::Printable, item, [&] { return isMostlyAscii(item); })) {
+        t.labels.insert(label::DaUnregisteredVendor);
+    } else if (detect(Detector::ScriptShape, item, [&] { return looksLikeScript(item); })) {
+        // Executable script (a large multisig or covenant leaf, say) is not
+        // a blob, however big or key-heavy it is.
+        t.labels.insert(label::DaUnknown);
+    } else if ((cfg.largeBlobThreshold != 0 && byteLen > cfg.largeBlobThreshold) ||
+               (byteLen >= cfg.entropy.minBytes && detect(Detector::Entropy, item, [&] {
+                    return looksUniform(analyzeBytes(item, cfg.entropy), cfg.entropy);
+                }))) {
+        // Data whose byte distribution is indistinguishable from random
+        // (encrypted / compressed payloads), whatever its size; large text
+        // or padding stays da.unknown unless the size cutoff is configured.
+        t.labels.insert(label::DaObfuscated);
+    } else {
+        t.labels.insert(label::DaUnknown);
     }
-    if (hexStartsWith(spk.hex, "6a")) return true;
-    return false;
+
+    return t;
 }
 
-bool TagEngine::isLikelyP2PKH(const ScriptPubKey& spk) {
-    const std::string& hex = spk.hex;
-    if (hex.size() != 50) return false; // 25 bytes
-    if (!hexStartsWith(hex, "76a914")) return false;
-    if (!hexEndsWith(hex, "88ac")) return false;
-    return true;
+Tag TagEngine::unscannedRegion(Surface kind, std::size_t index, std::size_t stackIdx,
+                               std::size_t bytes) {
+    Tag t;
+    t.kind = kind;
+    t.index = static_cast<std::uint32_t>(index);
+    t.stackIndex = static_cast<std::uint32_t>(stackIdx);
+    t.end = static_cast<std::uint32_t>(bytes);
+    t.labels.insert(label::DaUnknown);
+    return t;
 }
 
-bool TagEngine::isLikelyP2WPKH(const ScriptPubKey& spk) {
-    const std::string& hex = spk.hex;
-    // 0 <20-byte-pubkeyhash> => 22 bytes => 44 hex chars
-    return hex.size() == 44 && hexStartsWith(hex, "0014");
+// ---------- work budget ----------
+
+class TagEngine::BudgetMeter {
+public:
+    explicit BudgetMeter(const WorkBudget& budget) : budget_(budget) {
+        if (budget_.maxTime.count() > 0) start_ = std::chrono::steady_clock::now();
+    }
+
+    // Charges one region of `bytes` before it is scanned. Once a region is
+    // refused every later one is too, so the unscanned regions form a
+    // suffix of the transaction.
+    bool admit(std::size_t bytes) {
+        if (truncated_) return false;
+        std::size_t cost = bytes + WorkBudget::kRegionCost;
+        if (budget_.maxBytes != 0 && cost > budget_.maxBytes - used_) {
+            truncated_ = true;
+        } else if (budget_.maxTime.count() > 0 &&
+                   std::chrono::steady_clock::now() - start_ >= budget_.maxTime) {
+            truncated_ = true;
+        } else {
+            used_ += cost;
+        }
+        return !truncated_;
+    }
+
+    bool truncated() const { return truncated_; }
+
+private:
+    WorkBudget budget_;
+    std::chrono::steady_clock::time_point start_{};
+    std::size_t used_{0};
+    bool truncated_{false};
+};
+
+std::size_t TagEngine::regionCount(const Tx& tx) {
+    std::size_t n = tx.vout.size();
+    for (const auto& wit : tx.witness) n += wit.stack.size();
+    return n;
 }
 
-bool TagEngine::isLikelyP2TR(const ScriptPubKey& spk) {
-    const std::string& hex = spk.hex;
-    // 1 <32-byte-xonly-pubkey> => 34 bytes => 68 hex chars
-    return hex.size() == 68 && hexStartsWith(hex, "5120");
+std::size_t TagEngine::regionCount(const TxView& tx) {
+    return tx.vout.size() + tx.witnessItems.size();
 }
 
-bool TagEngine::isLikelyRollupRootOpReturn(const ScriptPubKey& spk) {
-    const std::string& hex = spk.hex;
-    if (!hexStartsWith(hex, "6a20")) return false;
-    std::size_t byteLen = hexByteLen(hex);
-    // 34-byte script is ideal (OP_RETURN + len + 32); allow a small band
-    return byteLen >= 32 && byteLen <= 40;
+std::size_t TagEngine::regionBytes(const Tx& tx, std::size_t region) {
+    if (region < tx.vout.size()) return tx.vout[region].spk.hex.size() / 2;
+    region -= tx.vout.size();
+    for (const auto& wit : tx.witness) {
+        if (region < wit.stack.size()) return wit.stack[region].hex.size() / 2;
+        region -= wit.stack.size();
+    }
+    return 0;
 }
 
-bool TagEngine::witnessLooksLikeOrdinal(const std::string& hex) {
-    if (hex.empty()) return false;
-    std::string h = hex;
-    std::transform(h.begin(), h.end(), h.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
-    return h.find("6f7264") != std::string::npos; // "ord"
+std::size_t TagEngine::regionBytes(const TxView& tx, std::size_t region) {
+    if (region < tx.vout.size()) return tx.vout[region].scriptPubKey.size();
+    return tx.witnessItems[region - tx.vout.size()].size();
 }
 
-// ---------- registry ----------
+void TagEngine::classifyRegions(const EngineConfig& cfg, const Tx& tx, std::size_t first,
+                                std::size_t last, Tag* out, BudgetMeter* meter) {
+    // Thin adapter: decode each hex region into a per-thread scratch buffer
+    // and run the byte-level detectors over it.
+    thread_local std::vector<std::uint8_t> scratch;
+    auto decode = [&](const std::string& hex) {
+        if (scratch.size() < hex.size() / 2) scratch.resize(hex.size() / 2);
+        return ByteSpan(scratch.data(), hexDecode(hex.data(), hex.size(), scratch.data()));
+    };
+    const Tag* begin = out;
 
-void TagEngine::buildRegistryV2() {
-    registry_.clear();
-    // T0
-    registry_["consensus.sig"] = "T0";
-    registry_["consensus.script"] = "T0";
-    registry_["consensus.taproot_prog"] = "T0";
-
-    // T1
-    registry_["pay.standard"] = "T1";
-    registry_["pay.channel_open"] = "T1";
-    registry_["pay.channel_update"] = "T1";
-    registry_["contracts.vault"] = "T1";
-    registry_["commitment.rollup_root"] = "T1";
-    registry_["meta.pool_tag"] = "T1";
-
-    // T2
-    registry_["da.op_return_embed"] = "T2";
-    registry_["meta.inscription"] = "T2";
-    registry_["meta.ordinal"] = "T2";
-    registry_["meta.indexer_hint"] = "T2";
-    registry_["da.embed_misc"] = "T2";
-
-    // T3
-    registry_["da.unknown"] = "T3";
-    registry_["da.obfuscated"] = "T3";
-    registry_["da.unregistered_vendor"] = "T3";
+    std::size_t region = first;
+    for (; region < last && region < tx.vout.size(); ++region) {
+        const ScriptPubKey& spk = tx.vout[region].spk;
+        if (meter && !meter->admit(spk.hex.size() / 2)) {
+            *out++ = unscannedRegion(Surface::ScriptPubKey, region, 0, spk.hex.size() / 2);
+            continue;
+        }
+        bool asmOpReturn = spk.asm_repr.rfind("OP_RETURN", 0) == 0;
+        *out++ = classifyScriptPubKey(region, decode(spk.hex), asmOpReturn);
+    }
+
+    if (region == last) {
+        countRegions(cfg.registry, begin, out);
+        return;
+    }
+
+    // Locate the first requested witness item, then walk forward.
+    std::size_t skip = region - tx.vout.size();
+    std::size_t vinIdx = 0;
+    while (vinIdx < tx.witness.size() && skip >= tx.witness[vinIdx].stack.size()) {
+        skip -= tx.witness[vinIdx].stack.size();
+        ++vinIdx;
+    }
+    std::size_t stackIdx = skip;
+    for (; region < last && vinIdx < tx.witness.size(); ++region) {
+        const auto& stack = tx.witness[vinIdx].stack;
+        std::size_t bytes = stack[stackIdx].hex.size() / 2;
+        if (meter && !meter->admit(bytes)) {
+            *out++ = unscannedRegion(Surface::WitnessStack, vinIdx, stackIdx, bytes);
+        } else {
+            *out++ = classifyWitnessItem(cfg, vinIdx, stackIdx, decode(stack[stackIdx].hex));
+        }
+        if (++stackIdx == stack.size()) {
+            stackIdx = 0;
+            ++vinIdx;
+            while (vinIdx < tx.witness.size() && tx.witness[vinIdx].stack.empty()) ++vinIdx;
+        }
+    }
+    countRegions(cfg.registry, begin, out);
 }
 
-// ---------- core classification ----------
+void TagEngine::classifyRegions(const EngineConfig& cfg, const TxView& tx, std::size_t first,
+                                std::size_t last, Tag* out, BudgetMeter* meter) {
+    const Tag* begin = out;
+    std::size_t region = first;
+    for (; region < last && region < tx.vout.size(); ++region) {
+        ByteSpan script = tx.vout[region].scriptPubKey;
+        if (meter && !meter->admit(script.size())) {
+            *out++ = unscannedRegion(Surface::ScriptPubKey, region, 0, script.size());
+        } else {
+            *out++ = classifyScriptPubKey(region, script, false);
+        }
+    }
+    if (region == last) {
+        countRegions(cfg.registry, begin, out);
+        return;
+    }
+
+    std::size_t item = region - tx.vout.size();
+    std::size_t vinIdx = 0;
+    while (vinIdx < tx.vin.size() &&
+           item >= tx.vin[vinIdx].witnessBegin + tx.vin[vinIdx].witnessCount) {
+        ++vinIdx;
+    }
+    for (; region < last && vinIdx < tx.vin.size(); ++region, ++item) {
+        while (item >= tx.vin[vinIdx].witnessBegin + tx.vin[vinIdx].witnessCount) ++vinIdx;
+        std::size_t stackIdx = item - tx.vin[vinIdx].witnessBegin;
+        ByteSpan bytes = tx.witnessItems[item];
+        if (meter && !meter->admit(bytes.size())) {
+            *out++ = unscannedRegion(Surface::WitnessStack, vinIdx, stackIdx, bytes.size());
+        } else {
+            *out++ = classifyWitnessItem(cfg, vinIdx, stackIdx, bytes);
+        }
+    }
+    countRegions(cfg.registry, begin, out);
+}
 
 Classification TagEngine::classify(const Tx& tx) const {
     Classification c;
-    c.txid = tx.txid.empty() ? std::string("<no-txid>") : tx.txid;
-
-    // --- scriptPubKey classification ---
-    for (std::size_t idx = 0; idx < tx.vout.size(); ++idx) {
-        const auto& out = tx.vout[idx];
-        const ScriptPubKey& spk = out.spk;
-        std::string surface = "scriptpubkey[" + std::to_string(idx) + "]";
-        std::size_t scriptLenBytes = hexByteLen(spk.hex);
-        std::vector<std::string> labels;
-
-        if (isLikelyOpReturn(spk)) {
-            if (isLikelyRollupRootOpReturn(spk)) {
-                labels.push_back("commitment.rollup_root");
-            } else {
-                std::string payloadHex = getOpReturnPayloadHex(spk.hex);
-                std::size_t payloadLen = hexByteLen(payloadHex);
-                bool asciiLike = isMostlyAscii(payloadHex);
-
-                if (payloadLen <= 8 && asciiLike) {
-                    labels.push_back("meta.indexer_hint");
-                } else if (payloadLen <= 32 && asciiLike) {
-                    labels.push_back("da.op_return_embed");
-                } else if (payloadLen <= 80) {
-                    labels.push_back("da.op_return_embed");
-                } else {
-                    labels.push_back("da.embed_misc");
-                }
+    classify(tx, c);
+    return c;
+}
+
+void TagEngine::classify(const Tx& tx, Classification& c) const {
+    metrics::ScopedCall call(EntryPoint::Classify);
+    c.clear();
+    if (tx.txid.empty()) {
+        c.txid.assign("<no-txid>");
+    } else {
+        c.txid.assign(tx.txid);
+    }
+    c.tags.resize(regionCount(tx));
+    classifyRegions(*config_.read(), tx, 0, c.tags.size(), c.tags.data());
+}
+
+Classification TagEngine::classify(const TxView& tx) const {
+    Classification c;
+    classify(tx, c);
+    return c;
+}
+
+void TagEngine::classify(const TxView& tx, Classification& c) const {
+    metrics::ScopedCall call(EntryPoint::Classify);
+    c.clear();
+    char txid[64];
+    tx.txid().toHex(txid);
+    c.txid.assign(txid, sizeof(txid));
+    c.tags.resize(regionCount(tx));
+    classifyRegions(*config_.read(), tx, 0, c.tags.size(), c.tags.data());
+}
+
+Classification TagEngine::classify(ByteSpan rawTx) const {
+    Classification c;
+    classify(rawTx, c);
+    return c;
+}
+
+void TagEngine::classify(ByteSpan rawTx, Classification& c) const {
+    thread_local TxView view;
+    if (!parseTx(rawTx, view)) {
+        throw std::invalid_argument("buds: malformed transaction serialization");
+    }
+    classify(view, c);
+}
+
+void TagEngine::classify(const Tx& tx, const WorkBudget& budget, Classification& c) const {
+    metrics::ScopedCall call(EntryPoint::Classify);
+    c.clear();
+    c.txid.assign(tx.txid.empty() ? "<no-txid>" : tx.txid);
+    c.tags.resize(regionCount(tx));
+    BudgetMeter meter(budget);
+    classifyRegions(*config_.read(), tx, 0, c.tags.size(), c.tags.data(), &meter);
+    c.truncated = meter.truncated();
+}
+
+void TagEngine::classify(const TxView& tx, const WorkBudget& budget, Classification& c) const {
+    metrics::ScopedCall call(EntryPoint::Classify);
+    c.clear();
+    char txid[64];
+    tx.txid().toHex(txid);
+    c.txid.assign(txid, sizeof(txid));
+    c.tags.resize(regionCount(tx));
+    BudgetMeter meter(budget);
+    classifyRegions(*config_.read(), tx, 0, c.tags.size(), c.tags.data(), &meter);
+    c.truncated = meter.truncated();
+}
+
+// ---------- batch classification ----------
+
+template <typename TxT>
+std::vector<Classification> TagEngine::runBatch(const EngineConfig& cfg, const TxT* txs,
+                                                std::size_t count, ThreadPool& pool,
+                                                BatchStats& stats) {
+    std::vector<Classification> results(count);
+
+    // Every region yields exactly one tag, so each tx's tag array is sized
+    // up front and work units write disjoint slices of it.
+    struct Unit {
+        std::size_t tx;
+        std::size_t first;
+        std::size_t last;
+    };
+    std::vector<Unit> units;
+    units.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t regions = regionCount(txs[i]);
+        results[i].tags.resize(regions);
+        stats.regionCount += regions;
+
+        std::size_t first = 0;
+        std::size_t acc = 0;
+        for (std::size_t r = 0; r < regions; ++r) {
+            std::size_t bytes = regionBytes(txs[i], r);
+            stats.bytes += bytes;
+            acc += bytes;
+            if (acc >= cfg.batchSplitBytes && r + 1 < regions) {
+                units.push_back(Unit{i, first, r + 1});
+                first = r + 1;
+                acc = 0;
             }
-        } else if (isLikelyP2PKH(spk) || isLikelyP2WPKH(spk) || isLikelyP2TR(spk)) {
-            labels.push_back("pay.standard");
-        } else {
-            // Fallback: treat unknown spk as economic lane
-            labels.push_back("pay.standard");
         }
+        units.push_back(Unit{i, first, regions});
+    }
+    stats.workUnits = units.size();
+
+    pool.parallelFor(units.size(), [&](std::size_t u) {
+        const Unit& unit = units[u];
+        classifyRegions(cfg, txs[unit.tx], unit.first, unit.last,
+                        results[unit.tx].tags.data() + unit.first);
+    });
+    return results;
+}
 
-        Tag t;
-        t.surface = surface;
-        t.start = 0;
-        t.end = scriptLenBytes;
-        t.labels = std::move(labels);
-        c.tags.push_back(std::move(t));
-    }
-
-    // --- witness classification ---
-    constexpr std::size_t largeBlobThreshold = 512;
-
-    for (std::size_t vinIdx = 0; vinIdx < tx.witness.size(); ++vinIdx) {
-        const auto& wit = tx.witness[vinIdx];
-        for (std::size_t stackIdx = 0; stackIdx < wit.stack.size(); ++stackIdx) {
-            const auto& item = wit.stack[stackIdx];
-            std::string surface = "witness.stack[" + std::to_string(vinIdx) + ":" +
-                                  std::to_string(stackIdx) + "]";
-            std::size_t byteLen = hexByteLen(item.hex);
-            std::vector<std::string> labels;
-
-            if (witnessLooksLikeOrdinal(item.hex)) {
-                if (byteLen > 256) {
-                    labels.push_back("meta.inscription");
-                } else {
-                    labels.push_back("meta.ordinal");
-                }
-            } else {
-                bool asciiLike = isMostlyAscii(item.hex);
-                if (byteLen <= 128 && asciiLike) {
-                    labels.push_back("da.unregistered_vendor");
-                } else if (byteLen > largeBlobThreshold) {
-                    labels.push_back("da.obfuscated");
-                } else {
-                    labels.push_back("da.unknown");
-                }
-            }
+std::vector<Classification> TagEngine::classifyBatch(const Tx* txs, std::size_t count,
+                                                     ThreadPool& pool, BatchStats* stats) const {
+    metrics::ScopedCall call(EntryPoint::ClassifyBatch);
+    auto t0 = std::chrono::steady_clock::now();
+    BatchStats local;
+    local.txCount = count;
+
+    std::vector<Classification> results = runBatch(*config_.read(), txs, count, pool, local);
+    for (std::size_t i = 0; i < count; ++i) {
+        results[i].txid = txs[i].txid.empty() ? std::string("<no-txid>") : txs[i].txid;
+    }
+
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (stats) *stats = local;
+    return results;
+}
 
-            Tag t;
-            t.surface = surface;
-            t.start = 0;
-            t.end = byteLen;
-            t.labels = std::move(labels);
-            c.tags.push_back(std::move(t));
+std::vector<Classification> TagEngine::classifyBatch(const std::vector<Tx>& txs, ThreadPool& pool,
+                                                     BatchStats* stats) const {
+    return classifyBatch(txs.data(), txs.size(), pool, stats);
+}
+
+std::vector<Classification> TagEngine::classifyBatch(const std::vector<ByteSpan>& rawTxs,
+                                                     ThreadPool& pool, BatchStats* stats) const {
+    metrics::ScopedCall call(EntryPoint::ClassifyBatch);
+    auto t0 = std::chrono::steady_clock::now();
+    BatchStats local;
+    local.txCount = rawTxs.size();
+
+    // Parse and hash in parallel first; malformed inputs become empty views.
+    std::vector<TxView> views(rawTxs.size());
+    std::vector<std::string> txids(rawTxs.size());
+    pool.parallelFor(rawTxs.size(), [&](std::size_t i) {
+        if (parseTx(rawTxs[i], views[i])) {
+            txids[i] = views[i].txid().toHex();
+        } else {
+            views[i] = TxView();
+        }
+    });
+
+    std::vector<Classification> results =
+        runBatch(*config_.read(), views.data(), views.size(), pool, local);
+    for (std::size_t i = 0; i < views.size(); ++i) {
+        if (txids[i].empty()) {
+            results[i].txid = "<invalid>";
+            ++local.invalidCount;
+        } else {
+            results[i].txid = std::move(txids[i]);
         }
     }
 
-    return c;
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (stats) *stats = local;
+    return results;
 }
 
 // ---------- tiers / summary ----------
@@ -239,9 +554,9 @@ Classification TagEngine::classify(const Tx& tx) const {
 std::string TagEngine::getTierForLabel(const std::string& label) const {
     if (label.empty()) return "T3";
 
-    auto it = registry_.find(label);
-    if (it != registry_.end()) {
-        return it->second;
+    LabelId id = labelIdFromName(label);
+    if (id != kInvalidLabel) {
+        return tierName(tierForLabel(id));
     }
 
     // Fallback prefix rules for unknown labels
@@ -264,130 +579,440 @@ std::string TagEngine::getTierForLabel(const std::string& label) const {
 
 Summary TagEngine::summarizeTiers(const Classification& c) const {
     Summary s;
-    TierCounts counts;
-
-    auto addTier = [&](const std::string& tier) {
-        if (tier == "T0") ++counts.T0;
-        else if (tier == "T1") ++counts.T1;
-        else if (tier == "T2") ++counts.T2;
-        else ++counts.T3;
-    };
-
-    std::vector<std::string> present;
+    auto cfg = config_.read();
 
     for (const auto& tag : c.tags) {
-        for (const auto& label : tag.labels) {
-            std::string tier = getTierForLabel(label);
-            addTier(tier);
-            if (std::find(present.begin(), present.end(), tier) == present.end()) {
-                present.push_back(tier);
-            }
+        for (LabelId label : tag.labels) {
+            Tier tier = cfg->registry.tier(label);
+            s.counts.add(tier);
+            s.tiersPresent.insert(tier);
         }
     }
 
-    // sort tiers in order T0,T1,T2,T3 if present
-    auto tierRank = [](const std::string& tier) {
-        if (tier == "T0") return 0;
-        if (tier == "T1") return 1;
-        if (tier == "T2") return 2;
-        return 3;
-    };
-    std::sort(present.begin(), present.end(),
-              [&](const std::string& a, const std::string& b) {
-                  return tierRank(a) < tierRank(b);
-              });
-
-    s.tiersPresent = std::move(present);
-    s.counts = counts;
     return s;
 }
 
+template <typename TxT, typename Fn>
+std::size_t TagEngine::forEachTag(const EngineConfig& cfg, const TxT& tx, Fn&& fn,
+                                  BudgetMeter* meter) {
+    constexpr std::size_t kBlock = 16;
+    Tag block[kBlock];
+    const std::size_t n = regionCount(tx);
+    for (std::size_t first = 0; first < n; first += kBlock) {
+        std::size_t last = first + kBlock < n ? first + kBlock : n;
+        classifyRegions(cfg, tx, first, last, block, meter);
+        for (std::size_t i = 0; i < last - first; ++i) fn(block[i]);
+        if (meter && meter->truncated()) return last;
+    }
+    return n;
+}
+
+TierCounts TagEngine::countTiers(const TxView& tx) const {
+    metrics::ScopedCall call(EntryPoint::CountTiers);
+    TierCounts counts;
+    auto cfg = config_.read();
+    forEachTag(*cfg, tx, [&](const Tag& tag) {
+        for (LabelId label : tag.labels) counts.add(cfg->registry.tier(label));
+    });
+    return counts;
+}
+
+Tier TagEngine::arbdaTier(const TierCounts& counts) const {
+    if (counts.T3 > 0) return Tier::T3;
+    if (counts.T2 > 0) return Tier::T2;
+    if (counts.T1 > 0) return Tier::T1;
+    return Tier::T0;
+}
+
 std::string TagEngine::computeArbdaTierFromCounts(const TierCounts& counts) const {
-    if (counts.T3 > 0) return "T3";
-    if (counts.T2 > 0) return "T2";
-    if (counts.T1 > 0) return "T1";
-    return "T0";
+    return tierName(arbdaTier(counts));
 }
 
 // ---------- policy ----------
 
-std::unordered_map<std::string, TagEngine::PolicyEntry>
-TagEngine::getPolicyTableForProfile() const {
-    std::unordered_map<std::string, PolicyEntry> table;
+namespace {
+
+PolicyTable compileProfile(PolicyProfile profile) {
+    std::vector<PolicyRule> rules;
 
-    switch (profile_) {
+    switch (profile) {
     case PolicyProfile::Strict:
-        table["da.obfuscated"]       = {4.0,  -0.7};
-        table["da.unknown"]          = {3.0,  -0.4};
-        table["da.unregistered_vendor"] = {2.5, -0.3};
-        table["da.op_return_embed"]  = {2.0,  -0.2};
-        table["pay.standard"]        = {1.0,   0.0};
-        table["pay.channel_open"]    = {1.0,   0.2};
+        rules = {
+            {"da.obfuscated",          4.0, -0.7},
+            {"da.unknown",             3.0, -0.4},
+            {"da.unregistered_vendor", 2.5, -0.3},
+            {"da.op_return_embed",     2.0, -0.2},
+            {"pay.standard",           1.0,  0.0},
+            {"pay.channel_open",       1.0,  0.2},
+        };
         break;
 
     case PolicyProfile::Permissive:
-        table["da.obfuscated"]       = {2.0,  -0.3};
-        table["da.unknown"]          = {1.5,  -0.1};
-        table["da.unregistered_vendor"] = {1.3, -0.05};
-        table["da.op_return_embed"]  = {1.2,  -0.05};
-        table["pay.standard"]        = {1.0,   0.0};
-        table["pay.channel_open"]    = {1.0,   0.1};
+        rules = {
+            {"da.obfuscated",          2.0, -0.3},
+            {"da.unknown",             1.5, -0.1},
+            {"da.unregistered_vendor", 1.3, -0.05},
+            {"da.op_return_embed",     1.2, -0.05},
+            {"pay.standard",           1.0,  0.0},
+            {"pay.channel_open",       1.0,  0.1},
+        };
         break;
 
     case PolicyProfile::Neutral:
     default:
-        table["da.obfuscated"]       = {3.0,  -0.5};
-        table["da.unknown"]          = {2.0,  -0.2};
-        table["da.unregistered_vendor"] = {1.7, -0.15};
-        table["da.op_return_embed"]  = {1.5,  -0.1};
-        table["pay.standard"]        = {1.0,   0.0};
-        table["pay.channel_open"]    = {1.0,   0.2};
+        rules = {
+            {"da.obfuscated",          3.0, -0.5},
+            {"da.unknown",             2.0, -0.2},
+            {"da.unregistered_vendor", 1.7, -0.15},
+            {"da.op_return_embed",     1.5, -0.1},
+            {"pay.standard",           1.0,  0.0},
+            {"pay.channel_open",       1.0,  0.2},
+        };
         break;
     }
 
-    return table;
+    return PolicyTable::fromRules(rules);
+}
+
+} // namespace
+
+const PolicyTable& PolicyTable::forProfile(PolicyProfile profile) {
+    // Compiled once; profile switches only copy the flat array.
+    static const PolicyTable neutral = compileProfile(PolicyProfile::Neutral);
+    static const PolicyTable strict = compileProfile(PolicyProfile::Strict);
+    static const PolicyTable permissive = compileProfile(PolicyProfile::Permissive);
+
+    switch (profile) {
+    case PolicyProfile::Strict:     return strict;
+    case PolicyProfile::Permissive: return permissive;
+    case PolicyProfile::Neutral:
+    default:                        return neutral;
+    }
 }
 
-TagEngine::PolicyEntry TagEngine::getPolicyForLabel(const std::string& label) const {
-    auto table = getPolicyTableForProfile();
-    auto it = table.find(label);
-    if (it != table.end()) {
-        return it->second;
+PolicyTable PolicyTable::fromRules(const std::vector<PolicyRule>& rules) {
+    PolicyTable t;
+    for (const auto& rule : rules) {
+        LabelId id = labelIdFromName(rule.label);
+        if (id == kInvalidLabel) continue;
+        t.entries_[id] = PolicyEntry{rule.minMult, rule.boost};
     }
-    return PolicyEntry{1.0, 0.0};
+    return t;
 }
 
+namespace {
+
+// Running minimum multiplier and boost sum. Boosts count once per distinct
+// label, in first-seen order, so every caller sums them identically; labels
+// outside the vocabulary map to the neutral entry and contribute nothing.
+struct PolicyAccumulator {
+    const PolicyTable& table;
+    double mult{1.0};
+    double boostSum{0.0};
+    std::uint32_t seen{0};
+
+    void add(LabelId id) {
+        static_assert(kLabelCount <= 32, "seen-set must cover every label");
+        const PolicyEntry& p = table.entry(id);
+        if (p.minMult > mult) mult = p.minMult;
+        if (id < kLabelCount && !(seen & (1u << id))) {
+            seen |= 1u << id;
+            boostSum += p.boost;
+        }
+    }
+
+    PolicyResult finish(double baseMinFeerate, double txFeerate) const {
+        double boost = boostSum;
+        if (boost < -0.9) boost = -0.9;
+        if (boost > 1.0)  boost = 1.0;
+
+        PolicyResult r;
+        r.mult = mult;
+        r.boostSum = boost;
+        r.required = baseMinFeerate * mult;
+        r.score = txFeerate * (1.0 + boost);
+        return r;
+    }
+};
+
+} // namespace
+
 PolicyResult TagEngine::computePolicy(const Classification& c,
                                       double baseMinFeerate,
                                       double txFeerate) const {
-    double mult = 1.0;
-    double boostSum = 0.0;
-    std::vector<std::string> seen;
+    auto cfg = config_.read();
+    PolicyAccumulator acc{cfg->policy};
+    for (const auto& tag : c.tags) {
+        for (LabelId id : tag.labels) acc.add(id);
+    }
+    return acc.finish(baseMinFeerate, txFeerate);
+}
 
-    auto hasSeen = [&](const std::string& label) {
-        return std::find(seen.begin(), seen.end(), label) != seen.end();
-    };
+// ---------- fused evaluation ----------
+
+template <typename TxT>
+Evaluation TagEngine::evaluateImpl(const TxT& tx, double baseMinFeerate, double txFeerate,
+                                   const WorkBudget* budget) const {
+    Evaluation e;
+    metrics::ScopedCall call(EntryPoint::Evaluate);
+    call.countArbdaAtExit(e.arbda);
+    auto cfg = config_.read();
+    PolicyAccumulator acc{cfg->policy};
+    BudgetMeter meter(budget ? *budget : WorkBudget());
+    std::size_t visited = forEachTag(*cfg, tx, [&](const Tag& tag) {
+        for (LabelId id : tag.labels) {
+            e.counts.add(cfg->registry.tier(id));
+            acc.add(id);
+        }
+    }, budget ? &meter : nullptr);
+    if (meter.truncated()) {
+        // The unscanned tail is all da.unknown; account for it in one step
+        // so a transaction with many tiny regions stays cheap to refuse.
+        e.truncated = true;
+        std::size_t rest = regionCount(tx) - visited;
+        if (rest > 0) {
+            e.counts.add(cfg->registry.tier(label::DaUnknown), static_cast<int>(rest));
+            acc.add(label::DaUnknown);
+        }
+    }
+    e.arbda = arbdaTier(e.counts);
+    e.policy = acc.finish(baseMinFeerate, txFeerate);
+    return e;
+}
 
-    for (const auto& tag : c.tags) {
-        for (const auto& label : tag.labels) {
-            PolicyEntry p = getPolicyForLabel(label);
-            if (p.minMult > mult) mult = p.minMult;
-            if (!hasSeen(label)) {
-                seen.push_back(label);
-                boostSum += p.boost;
+Evaluation TagEngine::evaluate(const Tx& tx, double baseMinFeerate, double txFeerate) const {
+    return evaluateImpl(tx, baseMinFeerate, txFeerate);
+}
+
+Evaluation TagEngine::evaluate(const TxView& tx, double baseMinFeerate, double txFeerate) const {
+    return evaluateImpl(tx, baseMinFeerate, txFeerate);
+}
+
+Evaluation TagEngine::evaluate(ByteSpan rawTx, double baseMinFeerate, double txFeerate) const {
+    thread_local TxView view;
+    if (!parseTx(rawTx, view)) {
+        throw std::invalid_argument("buds: malformed transaction serialization");
+    }
+    return evaluateImpl(view, baseMinFeerate, txFeerate);
+}
+
+Evaluation TagEngine::evaluate(const Tx& tx, double baseMinFeerate, double txFeerate,
+                               const WorkBudget& budget) const {
+    return evaluateImpl(tx, baseMinFeerate, txFeerate, &budget);
+}
+
+Evaluation TagEngine::evaluate(const TxView& tx, double baseMinFeerate, double txFeerate,
+                               const WorkBudget& budget) const {
+    return evaluateImpl(tx, baseMinFeerate, txFeerate, &budget);
+}
+
+Evaluation TagEngine::evaluate(ByteSpan rawTx, double baseMinFeerate, double txFeerate,
+                               const WorkBudget& budget) const {
+    thread_local TxView view;
+    if (!parseTx(rawTx, view)) {
+        throw std::invalid_argument("buds: malformed transaction serialization");
+    }
+    return evaluateImpl(view, baseMinFeerate, txFeerate, &budget);
+}
+
+// ---------- compact classification ----------
+
+static_assert(kLabelCount <= 256, "compact label ids are stored as bytes");
+
+template <typename TxT>
+void TagEngine::classifyCompactImpl(const TxT& tx, CompactClassification& out) const {
+    metrics::ScopedCall call(EntryPoint::ClassifyCompact);
+    out = CompactClassification();
+    std::uint32_t seen = 0;
+    auto cfg = config_.read();
+    forEachTag(*cfg, tx, [&](const Tag& tag) {
+        for (LabelId id : tag.labels) {
+            out.counts.add(cfg->registry.tier(id));
+            if (id < kLabelCount && !(seen & (1u << id))) {
+                seen |= 1u << id;
+                out.labels[out.labelCount++] = static_cast<std::uint8_t>(id);
+            }
+        }
+    });
+}
+
+void TagEngine::classifyCompact(const TxView& tx, CompactClassification& out) const {
+    classifyCompactImpl(tx, out);
+}
+
+void TagEngine::classifyCompact(const Tx& tx, CompactClassification& out) const {
+    classifyCompactImpl(tx, out);
+}
+
+void TagEngine::classifyCompact(const Classification& c, CompactClassification& out) const {
+    out = CompactClassification();
+    std::uint32_t seen = 0;
+    auto cfg = config_.read();
+    for (const Tag& tag : c.tags) {
+        for (LabelId id : tag.labels) {
+            out.counts.add(cfg->registry.tier(id));
+            if (id < kLabelCount && !(seen & (1u << id))) {
+                seen |= 1u << id;
+                out.labels[out.labelCount++] = static_cast<std::uint8_t>(id);
             }
         }
     }
+}
 
-    if (boostSum < -0.9) boostSum = -0.9;
-    if (boostSum > 1.0)  boostSum = 1.0;
+Evaluation TagEngine::evaluate(const CompactClassification& c, double baseMinFeerate,
+                               double txFeerate) const {
+    Evaluation e;
+    e.counts = c.counts;
+    e.arbda = arbdaTier(c.counts);
+    metrics::countArbda(e.arbda);
+    auto cfg = config_.read();
+    PolicyAccumulator acc{cfg->policy};
+    for (std::size_t i = 0; i < c.labelCount; ++i) acc.add(c.labels[i]);
+    e.policy = acc.finish(baseMinFeerate, txFeerate);
+    return e;
+}
+
+// ---------- two-phase triage ----------
+
+namespace {
+
+constexpr int kMixedTier = -1;
 
-    PolicyResult r;
-    r.mult = mult;
-    r.boostSum = boostSum;
-    r.required = baseMinFeerate * mult;
-    r.score = txFeerate * (1.0 + boostSum);
-    return r;
+// The tier shared by every label in `ids`, or kMixedTier.
+int commonTier(const Registry& registry, std::initializer_list<LabelId> ids) {
+    int tier = kMixedTier;
+    for (LabelId id : ids) {
+        int t = static_cast<int>(registry.tier(id));
+        if (tier == kMixedTier) {
+            tier = t;
+        } else if (tier != t) {
+            return kMixedTier;
+        }
+    }
+    return tier;
+}
+
+Tier tagTier(const Registry& registry, const Tag& tag) {
+    Tier tier = Tier::T0;
+    for (LabelId id : tag.labels) tier = std::max(tier, registry.tier(id));
+    return tier;
+}
+
+} // namespace
+
+// Per-call view of which detector outcomes the registry can tell apart.
+// A group whose labels share one tier is settled without running the
+// detector that picks between them.
+struct TagEngine::TriageShortcuts {
+    int nonEnvelope;   // vendor / unknown / obfuscated witness items
+    int envelope;      // ordinal / inscription envelopes
+    int opReturn;      // rollup root / indexer hint / embeds
+
+    explicit TriageShortcuts(const Registry& registry)
+        : nonEnvelope(commonTier(registry, {label::DaUnregisteredVendor, label::DaUnknown,
+                                            label::DaObfuscated})),
+          envelope(commonTier(registry, {label::MetaOrdinal, label::MetaInscription})),
+          opReturn(commonTier(registry, {label::CommitmentRollupRoot, label::MetaIndexerHint,
+                                         label::DaOpReturnEmbed, label::DaEmbedMisc})) {}
+};
+
+Tier TagEngine::witnessTier(const EngineConfig& cfg, const TriageShortcuts& sc, ByteSpan item) {
+    OrdinalEnvelope envelope;
+    if (findOrdinalEnvelope(item, envelope)) {
+        if (sc.envelope != kMixedTier) return static_cast<Tier>(sc.envelope);
+    } else if (sc.nonEnvelope != kMixedTier) {
+        return static_cast<Tier>(sc.nonEnvelope);
+    }
+    return tagTier(cfg.registry, classifyWitnessItem(cfg, 0, 0, item));
+}
+
+Tier TagEngine::outputTier(const EngineConfig& cfg, const TriageShortcuts& sc, ByteSpan script,
+                           bool asmOpReturn) {
+    bool opReturn = asmOpReturn || (!script.empty() && script[0] == op::Return);
+    if (!opReturn) return cfg.registry.tier(label::PayStandard);
+    if (sc.opReturn != kMixedTier) return static_cast<Tier>(sc.opReturn);
+    return tagTier(cfg.registry, classifyScriptPubKey(0, script, asmOpReturn));
+}
+
+ArbdaVerdict TagEngine::triage(const TxView& tx) const {
+    ArbdaVerdict v;
+    metrics::ScopedCall call(EntryPoint::Triage);
+    call.countArbdaAtExit(v.arbda);
+    auto cfg = config_.read();
+    TriageShortcuts sc(cfg->registry);
+
+    // Witness items first: that is where T3 regions usually are.
+    for (ByteSpan item : tx.witnessItems) {
+        ++v.regionsExamined;
+        v.arbda = std::max(v.arbda, witnessTier(*cfg, sc, item));
+        if (v.arbda == Tier::T3) {
+            v.earlyExit = v.regionsExamined < regionCount(tx);
+            return v;
+        }
+    }
+    for (const auto& out : tx.vout) {
+        ++v.regionsExamined;
+        v.arbda = std::max(v.arbda, outputTier(*cfg, sc, out.scriptPubKey, false));
+        if (v.arbda == Tier::T3) {
+            v.earlyExit = v.regionsExamined < regionCount(tx);
+            return v;
+        }
+    }
+    return v;
+}
+
+ArbdaVerdict TagEngine::triage(const Tx& tx) const {
+    ArbdaVerdict v;
+    metrics::ScopedCall call(EntryPoint::Triage);
+    call.countArbdaAtExit(v.arbda);
+    auto cfg = config_.read();
+    TriageShortcuts sc(cfg->registry);
+    thread_local std::vector<std::uint8_t> scratch;
+    auto decode = [&](const std::string& hex) {
+        if (scratch.size() < hex.size() / 2) scratch.resize(hex.size() / 2);
+        return ByteSpan(scratch.data(), hexDecode(hex.data(), hex.size(), scratch.data()));
+    };
+    const std::size_t total = regionCount(tx);
+
+    for (const auto& wit : tx.witness) {
+        for (const auto& item : wit.stack) {
+            ++v.regionsExamined;
+            v.arbda = std::max(v.arbda, witnessTier(*cfg, sc, decode(item.hex)));
+            if (v.arbda == Tier::T3) {
+                v.earlyExit = v.regionsExamined < total;
+                return v;
+            }
+        }
+    }
+    for (const auto& out : tx.vout) {
+        ++v.regionsExamined;
+        bool asmOpReturn = out.spk.asm_repr.rfind("OP_RETURN", 0) == 0;
+        v.arbda = std::max(v.arbda, outputTier(*cfg, sc, decode(out.spk.hex), asmOpReturn));
+        if (v.arbda == Tier::T3) {
+            v.earlyExit = v.regionsExamined < total;
+            return v;
+        }
+    }
+    return v;
+}
+
+ArbdaVerdict TagEngine::triage(ByteSpan rawTx) const {
+    thread_local TxView view;
+    if (!parseTx(rawTx, view)) {
+        throw std::invalid_argument("buds: malformed transaction serialization");
+    }
+    return triage(view);
+}
+
+LazyClassification::LazyClassification(const TagEngine& engine, ByteSpan rawTx)
+    : engine_(&engine), raw_(rawTx), verdict_(engine.triage(rawTx)) {}
+
+const Classification& LazyClassification::classification() {
+    if (!full_) {
+        full_ = std::make_unique<Classification>();
+        engine_->classify(raw_, *full_);
+    }
+    return *full_;
 }
 
 } // namespace buds
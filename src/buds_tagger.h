@@ -1,10 +1,18 @@
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
-#include <unordered_map>
+
+#include "buds_entropy.h"
+#include "buds_labels.h"
+#include "buds_registry.h"
+#include "buds_snapshot.h"
+#include "buds_tx.h"
 
 namespace buds {
 
@@ -31,16 +39,80 @@ struct Tx {
     std::vector<Witness> witness;
 };
 
+enum class Surface : std::uint8_t {
+    ScriptPubKey,   // "scriptpubkey[index]"
+    WitnessStack    // "witness.stack[index:stackIndex]"
+};
+
+// Small inline set of labels; a region carries at most kCapacity labels.
+class LabelSet {
+public:
+    static constexpr std::size_t kCapacity = 3;
+
+    // Returns false if the set is full; duplicates are ignored.
+    bool insert(LabelId id) {
+        if (contains(id)) return true;
+        if (size_ == kCapacity) return false;
+        ids_[size_++] = id;
+        return true;
+    }
+    bool contains(LabelId id) const {
+        for (std::size_t i = 0; i < size_; ++i) {
+            if (ids_[i] == id) return true;
+        }
+        return false;
+    }
+    void clear() { size_ = 0; }
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+    LabelId operator[](std::size_t i) const { return ids_[i]; }
+    const LabelId* begin() const { return ids_; }
+    const LabelId* end() const { return ids_ + size_; }
+
+    bool operator==(const LabelSet& o) const {
+        if (size_ != o.size_) return false;
+        for (std::size_t i = 0; i < size_; ++i) {
+            if (ids_[i] != o.ids_[i]) return false;
+        }
+        return true;
+    }
+    bool operator!=(const LabelSet& o) const { return !(*this == o); }
+
+private:
+    LabelId ids_[kCapacity]{};
+    std::uint8_t size_{0};
+};
+
+// One tagged region. Plain data (28 bytes): the surface string is only
+// formatted when asked for.
 struct Tag {
-    std::string surface;   // e.g. "scriptpubkey[0]" or "witness.stack[0:1]"
-    std::size_t start;     // byte offset (always 0 in this simple engine)
-    std::size_t end;       // byte length
-    std::vector<std::string> labels;
+    Surface kind{Surface::ScriptPubKey};
+    std::uint32_t index{0};        // vout index, or vin index for witness
+    std::uint32_t stackIndex{0};   // witness stack position
+    std::uint32_t start{0};        // byte offset within the surface
+    std::uint32_t end{0};          // end offset (exclusive)
+    LabelSet labels;               // see labelName() for the string form
+
+    // e.g. "scriptpubkey[0]" or "witness.stack[0:1]"
+    std::string surface() const;
+
+    // Allocation-free variant; writes at most cap - 1 chars plus a NUL and
+    // returns the formatted length.
+    std::size_t formatSurface(char* buf, std::size_t cap) const;
 };
 
+// Contiguous array of region records. Pass the same object back into the
+// classify(..., Classification&) overloads to reuse its buffers.
 struct Classification {
     std::string txid;
     std::vector<Tag> tags;
+    bool truncated{false};   // budgeted classify ran out; see WorkBudget
+
+    void clear() {
+        txid.clear();
+        tags.clear();
+        truncated = false;
+    }
 };
 
 struct TierCounts {
@@ -48,10 +120,42 @@ struct TierCounts {
     int T1{0};
     int T2{0};
     int T3{0};
+
+    void add(Tier tier, int n = 1) {
+        switch (tier) {
+        case Tier::T0: T0 += n; break;
+        case Tier::T1: T1 += n; break;
+        case Tier::T2: T2 += n; break;
+        case Tier::T3: T3 += n; break;
+        }
+    }
+};
+
+// Set of tiers, iterated in T0..T3 order. Fixed-size, never allocates.
+class TierSet {
+public:
+    void insert(Tier tier) { mask_ |= static_cast<std::uint8_t>(1u << static_cast<int>(tier)); rebuild(); }
+    bool contains(Tier tier) const { return (mask_ >> static_cast<int>(tier)) & 1u; }
+    bool empty() const { return mask_ == 0; }
+    std::size_t size() const { return size_; }
+    const Tier* begin() const { return items_.data(); }
+    const Tier* end() const { return items_.data() + size_; }
+
+private:
+    std::uint8_t mask_{0};
+    std::uint8_t size_{0};
+    std::array<Tier, kTierCount> items_{};
+
+    void rebuild() {
+        size_ = 0;
+        for (int t = 0; t < static_cast<int>(kTierCount); ++t) {
+            if ((mask_ >> t) & 1u) items_[size_++] = static_cast<Tier>(t);
+        }
+    }
 };
 
 struct Summary {
-    std::vector<std::string> tiersPresent;
+    TierSet tiersPresent;
     TierCounts counts;
 };
 
@@ -68,54 +172,304 @@ struct PolicyResult {
     double boostSum{0.0};   // sum of boosts (clamped to [-0.9, 1.0])
 };
 
+// Output of TagEngine::evaluate: tier counts, ARBDA tier and policy for one
+// transaction, without the per-region tags.
+struct Evaluation {
+    TierCounts counts;
+    Tier arbda{Tier::T0};
+    PolicyResult policy;
+    bool truncated{false};   // budgeted evaluate ran out; see WorkBudget
+};
+
+// Per-transaction work limit for the budgeted entry points. Every detector
+// is a bounded number of linear passes over its region, so charging each
+// region its byte length (plus a fixed per-region cost) before scanning it
+// bounds the work of one call regardless of input shape. The time limit is
+// a backstop against preemption and cold caches, checked between regions.
+// Once either limit would be exceeded, that region and every later one is
+// tagged da.unknown without being scanned and the result is marked
+// truncated: the ARBDA tier becomes T3, the conservative answer.
+struct WorkBudget {
+    static constexpr std::size_t kRegionCost = 64;  // bytes charged per region on top of its length
+
+    std::size_t maxBytes{128 * 1024};      // 0 = no byte limit
+    std::chrono::nanoseconds maxTime{0};   // 0 = no time limit
+};
+
+// Phase-one result of TagEngine::triage: the ARBDA tier alone.
+struct ArbdaVerdict {
+    Tier arbda{Tier::T0};
+    std::uint32_t regionsExamined{0};
+    bool earlyExit{false};   // stopped at the first T3 region
+};
+
+// Profile-independent digest of one transaction's classification: tier
+// counts plus the distinct labels in first-seen order, which is everything
+// the policy step reads. Fixed size, so it can be cached per wtxid.
+struct CompactClassification {
+    TierCounts counts;
+    std::uint8_t labelCount{0};
+    std::array<std::uint8_t, kLabelCount> labels{}; // LabelIds
+};
+
+struct PolicyEntry {
+    double minMult{1.0};
+    double boost{0.0};
+};
+
+// Operator-supplied rule for a custom policy profile.
+struct PolicyRule {
+    std::string label;
+    double minMult{1.0};
+    double boost{0.0};
+};
+
+// Per-label policy compiled into a flat array indexed by LabelId. Labels
+// without a rule map to the neutral entry {1.0, 0.0}.
+class PolicyTable {
+public:
+    PolicyTable() = default;
+
+    static const PolicyTable& forProfile(PolicyProfile profile);
+
+    // Rules naming labels outside the v2 vocabulary are ignored, since the
+    // engine can never emit them.
+    static PolicyTable fromRules(const std::vector<PolicyRule>& rules);
+
+    const PolicyEntry& entry(LabelId id) const {
+        static const PolicyEntry neutral{};
+        return id < kLabelCount ? entries_[id] : neutral;
+    }
+
+private:
+    std::array<PolicyEntry, kLabelCount> entries_{};
+};
+
+// Everything a TagEngine reads while classifying. Immutable once published:
+// the engine holds the current config in a SnapshotCell and every call pins
+// it for its duration, so a switch never changes the rules halfway through
+// a transaction and readers never wait for a writer.
+struct EngineConfig {
+    PolicyProfile profile{PolicyProfile::Neutral};
+    PolicyTable policy{PolicyTable::forProfile(PolicyProfile::Neutral)};
+    Registry registry;
+    std::size_t largeBlobThreshold{0};      // 0 = off; else non-script items above it: da.obfuscated by size alone
+    EntropyOptions entropy;                 // non-script items: da.obfuscated if uniform-looking
+    std::size_t inscriptionThreshold{256};  // envelope bytes above this: meta.inscription
+    std::size_t batchSplitBytes{64 * 1024}; // region bytes above which a tx is split in batches
+    // Identifies the classification rules (registry and detector settings).
+    // Assigned by TagEngine on publish, unique across engines in a process;
+    // setters that only change policy or batching keep it, since they do not
+    // change what classification produces. Caches key results on it.
+    std::uint64_t generation{0};
+
+    static EngineConfig forProfile(PolicyProfile profile);
+};
+
+class ThreadPool;
+
+// Throughput report for one classifyBatch call.
+struct BatchStats {
+    std::size_t txCount{0};
+    std::size_t invalidCount{0};   // raw inputs that failed to parse
+    std::size_t regionCount{0};
+    std::size_t bytes{0};          // region payload bytes classified
+    std::size_t workUnits{0};      // tasks after splitting large transactions
+    double seconds{0.0};
+
+    double txPerSecond() const { return seconds > 0 ? txCount / seconds : 0.0; }
+    double bytesPerSecond() const { return seconds > 0 ? bytes / seconds : 0.0; }
+};
+
 class TagEngine {
 public:
     explicit TagEngine(PolicyProfile profile = PolicyProfile::Neutral);
+    explicit TagEngine(const EngineConfig& config);
+
+    // Configuration. All setters are safe while other threads classify
+    // through the same engine: each publishes a new EngineConfig snapshot
+    // and returns once no in-flight call still uses the previous one.
+    // Classification never blocks on a switch. Setters must not be called
+    // from inside a classification call (e.g. a classifyBatch task).
+    using ConfigRef = SnapshotCell<EngineConfig>::Reader;
+    ConfigRef config() const { return config_.read(); }
+    void setConfig(const EngineConfig& config);
 
     void setPolicyProfile(PolicyProfile profile);
 
+    // Replace the preset tables with a compiled operator-supplied profile.
+    void setPolicyTable(const PolicyTable& table);
+
+    // Label -> tier registry (BUDS v2 defaults until replaced).
+    void setRegistry(const Registry& registry);
+    bool loadRegistry(const std::string& path, std::string* error = nullptr);
+
     // Core API
     Classification classify(const Tx& tx) const;
+    void classify(const Tx& tx, Classification& out) const;
+
+    // Zero-copy entry points over consensus-serialized transactions. The
+    // ByteSpan overload parses in place and throws std::invalid_argument on
+    // malformed input.
+    Classification classify(const TxView& tx) const;
+    Classification classify(ByteSpan rawTx) const;
+    void classify(const TxView& tx, Classification& out) const;
+    void classify(ByteSpan rawTx, Classification& out) const;
+
+    // Batch entry points. Work fans out across `pool`; transactions whose
+    // witness data exceeds the split threshold are divided by witness item
+    // across several workers. Results are in input order. Malformed raw
+    // inputs yield txid "<invalid>" with no tags instead of throwing.
+    std::vector<Classification> classifyBatch(const Tx* txs, std::size_t count,
+                                              ThreadPool& pool,
+                                              BatchStats* stats = nullptr) const;
+    std::vector<Classification> classifyBatch(const std::vector<Tx>& txs, ThreadPool& pool,
+                                              BatchStats* stats = nullptr) const;
+    std::vector<Classification> classifyBatch(const std::vector<ByteSpan>& rawTxs,
+                                              ThreadPool& pool,
+                                              BatchStats* stats = nullptr) const;
+
+    // Region bytes above which one transaction is split across workers.
+    void setBatchSplitBytes(std::size_t bytes);
     Summary summarizeTiers(const Classification& c) const;
+
+    // Region tier counts for one transaction without building a
+    // Classification (no txid hashing; reuses per-thread buffers).
+    TierCounts countTiers(const TxView& tx) const;
     std::string computeArbdaTierFromCounts(const TierCounts& counts) const;
+    Tier arbdaTier(const TierCounts& counts) const;
     PolicyResult computePolicy(const Classification& c,
                                double baseMinFeerate,
                                double txFeerate) const;
 
-    // Tier lookup (T0/T1/T2/T3)
+    // Fused admission path: classify -> summarizeTiers -> arbdaTier ->
+    // computePolicy in one pass over the regions, with identical results
+    // and no heap allocation (the hex overload reuses a per-thread decode
+    // buffer). The ByteSpan overload throws std::invalid_argument on
+    // malformed input.
+    Evaluation evaluate(const Tx& tx, double baseMinFeerate, double txFeerate) const;
+    Evaluation evaluate(const TxView& tx, double baseMinFeerate, double txFeerate) const;
+    Evaluation evaluate(ByteSpan rawTx, double baseMinFeerate, double txFeerate) const;
+
+    // Budgeted forms for latency-bound callers (e.g. an admission thread).
+    // Results match the unbudgeted calls unless `truncated` is set. Parsing
+    // and txid hashing are linear in the serialized size and not charged.
+    Evaluation evaluate(const Tx& tx, double baseMinFeerate, double txFeerate,
+                        const WorkBudget& budget) const;
+    Evaluation evaluate(const TxView& tx, double baseMinFeerate, double txFeerate,
+                        const WorkBudget& budget) const;
+    Evaluation evaluate(ByteSpan rawTx, double baseMinFeerate, double txFeerate,
+                        const WorkBudget& budget) const;
+    void classify(const Tx& tx, const WorkBudget& budget, Classification& out) const;
+    void classify(const TxView& tx, const WorkBudget& budget, Classification& out) const;
+
+    // Phase one of two-phase classification: the ARBDA tier only, identical
+    // to evaluate(tx).arbda. Witness items are examined first and the walk
+    // stops at the first T3 region. A detector only runs when the registry
+    // maps its possible outcomes to different tiers; under the v2 defaults
+    // a non-envelope witness item is T3 after the envelope scan alone, while
+    // OP_RETURN payloads are still classified because rollup roots (T1)
+    // differ in tier from hints and embeds (T2). The ByteSpan overload
+    // throws std::invalid_argument on malformed input.
+    ArbdaVerdict triage(const Tx& tx) const;
+    ArbdaVerdict triage(const TxView& tx) const;
+    ArbdaVerdict triage(ByteSpan rawTx) const;
+
+    // Two-step form of evaluate for callers that cache per transaction: the
+    // compact digest does not depend on the policy profile, and evaluating
+    // it under the current profile gives the same result as evaluate(tx).
+    // The Classification overload digests tags already computed, for
+    // callers that keep both without running the detectors twice.
+    void classifyCompact(const TxView& tx, CompactClassification& out) const;
+    void classifyCompact(const Tx& tx, CompactClassification& out) const;
+    void classifyCompact(const Classification& c, CompactClassification& out) const;
+    Evaluation evaluate(const CompactClassification& c, double baseMinFeerate,
+                        double txFeerate) const;
+
+    // Tier lookup (T0/T1/T2/T3). The string overload is the API edge; the
+    // LabelId overload pins the config for one lookup. Loops should pin
+    // once with config() and call registry.tier, a single array load.
     std::string getTierForLabel(const std::string& label) const;
+    Tier tierForLabel(LabelId label) const { return config_.read()->registry.tier(label); }
 
     // Expose version string for bookkeeping
     std::string budsVersion() const { return "2.0"; }
 
 private:
-    PolicyProfile profile_;
-    std::unordered_map<std::string, std::string> registry_; // label -> tier "T0".."T3"
-
-    // --- helpers ---
-    static std::size_t hexByteLen(const std::string& hex);
-    static bool hexStartsWith(const std::string& hex, const std::string& prefix);
-    static bool hexEndsWith(const std::string& hex, const std::string& suffix);
-    static bool isMostlyAscii(const std::string& hex);
-    static std::string getOpReturnPayloadHex(const std::string& scriptHex);
-    static bool isLikelyOpReturn(const ScriptPubKey& spk);
-    static bool isLikelyP2PKH(const ScriptPubKey& spk);
-    static bool isLikelyP2WPKH(const ScriptPubKey& spk);
-    static bool isLikelyP2TR(const ScriptPubKey& spk);
-    static bool isLikelyRollupRootOpReturn(const ScriptPubKey& spk);
-    static bool witnessLooksLikeOrdinal(const std::string& hex);
-
-    // Policy helpers
-    struct PolicyEntry {
-        double minMult{1.0};
-        double boost{0.0};
-    };
-
-    std::unordered_map<std::string, PolicyEntry> getPolicyTableForProfile() const;
-    PolicyEntry getPolicyForLabel(const std::string& label) const;
-
-    // Internal registry init
-    void buildRegistryV2();
+    SnapshotCell<EngineConfig> config_;
+
+    // --- helpers (all detectors run on raw bytes) ---
+    static bool isMostlyAscii(ByteSpan bytes);
+    static bool isMostlyAscii(std::size_t printable, std::size_t total);
+
+    // Charges regions against a WorkBudget; defined in the .cpp.
+    class BudgetMeter;
+
+    // Regions are numbered outputs first, then witness items in vin order.
+    // classifyRegions writes regions [first, last) to out[0 .. last - first).
+    // With a meter, regions it refuses are tagged da.unknown unscanned.
+    static std::size_t regionCount(const Tx& tx);
+    static std::size_t regionCount(const TxView& tx);
+    static std::size_t regionBytes(const Tx& tx, std::size_t region);
+    static std::size_t regionBytes(const TxView& tx, std::size_t region);
+    static void classifyRegions(const EngineConfig& cfg, const Tx& tx, std::size_t first,
+                                std::size_t last, Tag* out, BudgetMeter* meter = nullptr);
+    static void classifyRegions(const EngineConfig& cfg, const TxView& tx, std::size_t first,
+                                std::size_t last, Tag* out, BudgetMeter* meter = nullptr);
+
+    // Calls fn(const Tag&) for every region in order, classifying a small
+    // stack-resident block of regions at a time. With a meter it stops after
+    // the block in which the budget ran out; returns the regions visited.
+    template <typename TxT, typename Fn>
+    static std::size_t forEachTag(const EngineConfig& cfg, const TxT& tx, Fn&& fn,
+                           BudgetMeter* meter = nullptr);
+    template <typename TxT>
+    Evaluation evaluateImpl(const TxT& tx, double baseMinFeerate, double txFeerate,
+                            const WorkBudget* budget = nullptr) const;
+    struct TriageShortcuts;
+    static Tier witnessTier(const EngineConfig& cfg, const TriageShortcuts& sc, ByteSpan item);
+    static Tier outputTier(const EngineConfig& cfg, const TriageShortcuts& sc, ByteSpan script,
+                           bool asmOpReturn);
+
+    template <typename TxT>
+    void classifyCompactImpl(const TxT& tx, CompactClassification& out) const;
+
+    template <typename TxT>
+    static std::vector<Classification> runBatch(const EngineConfig& cfg, const TxT* txs,
+                                                std::size_t count, ThreadPool& pool,
+                                                BatchStats& stats);
+
+    // Per-region classifiers shared by the hex and binary entry points.
+    // `asmOpReturn` carries the ScriptPubKey::asm_repr hint from the hex API.
+    static Tag classifyScriptPubKey(std::size_t idx, ByteSpan script, bool asmOpReturn);
+    static Tag classifyWitnessItem(const EngineConfig& cfg, std::size_t vinIdx,
+                                   std::size_t stackIdx, ByteSpan item);
+    static Tag unscannedRegion(Surface kind, std::size_t index, std::size_t stackIdx,
+                               std::size_t bytes);
+};
+
+// Phase two of two-phase classification. Construction parses the
+// transaction and runs TagEngine::triage; the full Classification is built
+// on the first call to classification() and kept. The serialized bytes
+// are not copied and must outlive this object. Materialization uses the
+// engine's configuration at that time, so a verdict taken before a
+// registry or profile switch may disagree with the tags built after it.
+// Not thread-safe: hand the object to one thread at a time.
+class LazyClassification {
+public:
+    LazyClassification(const TagEngine& engine, ByteSpan rawTx);
+
+    const ArbdaVerdict& verdict() const { return verdict_; }
+    Tier arbda() const { return verdict_.arbda; }
+
+    bool materialized() const { return full_ != nullptr; }
+    const Classification& classification();
+
+private:
+    const TagEngine* engine_;
+    ByteSpan raw_;
+    ArbdaVerdict verdict_;
+    std::unique_ptr<Classification> full_;
 };
 
 } // namespace buds
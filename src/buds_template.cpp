@@ -0,0 +1,347 @@
+#include "buds_template.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace buds {
+
+namespace {
+
+// Weight budget state shared by the greedy and fill passes.
+struct Budget {
+    std::uint64_t weight{0};
+    std::uint64_t maxWeight{0};
+    std::array<std::uint64_t, kTierCount> tier{};
+    std::array<std::uint64_t, kTierCount> tierMax{};
+    std::array<std::uint64_t, kLabelCount> label{};
+    std::array<std::uint64_t, kLabelCount> labelMax{};
+    std::uint32_t cappedLabels{0};
+
+    explicit Budget(const TemplateLimits& limits) {
+        maxWeight = limits.maxWeight;
+        for (std::size_t t = 0; t < kTierCount; ++t) {
+            tierMax[t] = static_cast<std::uint64_t>(limits.tierShare[t] * limits.maxWeight);
+        }
+        labelMax.fill(maxWeight);
+        for (const auto& cap : limits.labelShare) {
+            if (cap.first >= kLabelCount) continue;
+            labelMax[cap.first] = static_cast<std::uint64_t>(cap.second * limits.maxWeight);
+            cappedLabels |= 1u << cap.first;
+        }
+    }
+};
+
+// Weight a package adds, split the same way the budget is.
+struct PackageWeight {
+    std::uint64_t weight{0};
+    std::array<std::uint64_t, kTierCount> tier{};
+    std::array<std::uint64_t, kLabelCount> label{};
+    std::uint32_t labels{0};
+
+    void add(const TemplateCandidate& tx, std::uint32_t capped) {
+        weight += tx.weight;
+        tier[static_cast<std::size_t>(tx.arbda)] += tx.weight;
+        std::uint32_t m = tx.labelMask & capped;
+        labels |= m;
+        while (m) {
+            unsigned id = static_cast<unsigned>(__builtin_ctz(m));
+            label[id] += tx.weight;
+            m &= m - 1;
+        }
+    }
+
+    bool fits(const Budget& b) const {
+        if (b.weight + weight > b.maxWeight) return false;
+        for (std::size_t t = 0; t < kTierCount; ++t) {
+            if (tier[t] && b.tier[t] + tier[t] > b.tierMax[t]) return false;
+        }
+        std::uint32_t m = labels;
+        while (m) {
+            unsigned id = static_cast<unsigned>(__builtin_ctz(m));
+            if (b.label[id] + label[id] > b.labelMax[id]) return false;
+            m &= m - 1;
+        }
+        return true;
+    }
+
+    void commit(Budget& b) const {
+        b.weight += weight;
+        for (std::size_t t = 0; t < kTierCount; ++t) b.tier[t] += tier[t];
+        std::uint32_t m = labels;
+        while (m) {
+            unsigned id = static_cast<unsigned>(__builtin_ctz(m));
+            b.label[id] += label[id];
+            m &= m - 1;
+        }
+    }
+};
+
+} // namespace
+
+void TemplateBuilder::reserve(std::size_t txs, std::size_t parentLinks) {
+    txs_.reserve(txs);
+    parentBegin_.reserve(txs + 1);
+    parents_.reserve(parentLinks);
+}
+
+void TemplateBuilder::clear() {
+    txs_.clear();
+    parentBegin_.clear();
+    parents_.clear();
+}
+
+std::uint32_t TemplateBuilder::add(const TemplateCandidate& tx, const std::uint32_t* parents,
+                                   std::size_t parentCount) {
+    if (parentBegin_.empty()) parentBegin_.push_back(0);
+    std::uint32_t index = static_cast<std::uint32_t>(txs_.size());
+    txs_.push_back(tx);
+    if (txs_.back().ancestorScore == 0.0) txs_.back().ancestorScore = tx.score;
+    for (std::size_t i = 0; i < parentCount; ++i) {
+        if (parents[i] < index) parents_.push_back(parents[i]); // ignore forward links
+    }
+    parentBegin_.push_back(static_cast<std::uint32_t>(parents_.size()));
+    return index;
+}
+
+std::uint32_t TemplateBuilder::add(const Hash256& id, std::uint32_t weight, std::uint64_t fee,
+                                   const Evaluation& eval, const CompactClassification& labels,
+                                   const std::uint32_t* parents, std::size_t parentCount) {
+    TemplateCandidate c;
+    c.id = id;
+    c.weight = weight;
+    c.fee = fee;
+    c.score = eval.policy.score;
+    c.arbda = eval.arbda;
+    for (std::size_t i = 0; i < labels.labelCount; ++i) c.labelMask |= 1u << labels.labels[i];
+    return add(c, parents, parentCount);
+}
+
+void TemplateBuilder::computeAncestorScores() {
+    const std::size_t n = txs_.size();
+    std::vector<std::uint32_t> mark(n, 0);
+    std::vector<std::uint32_t> stack;
+    for (std::uint32_t i = 0; i < n; ++i) {
+        // Epoch-marked DFS over the ancestor set; i + 1 is never 0.
+        double num = 0.0;
+        double den = 0.0;
+        stack.assign(1, i);
+        mark[i] = i + 1;
+        while (!stack.empty()) {
+            std::uint32_t v = stack.back();
+            stack.pop_back();
+            num += txs_[v].score * txs_[v].weight;
+            den += txs_[v].weight;
+            for (std::uint32_t p = parentBegin_[v]; p < parentBegin_[v + 1]; ++p) {
+                std::uint32_t a = parents_[p];
+                if (mark[a] != i + 1) {
+                    mark[a] = i + 1;
+                    stack.push_back(a);
+                }
+            }
+        }
+        txs_[i].ancestorScore = den > 0 ? num / den : txs_[i].score;
+    }
+}
+
+BlockTemplate TemplateBuilder::build(const TemplateLimits& limits) const {
+    auto t0 = std::chrono::steady_clock::now();
+    BlockTemplate out;
+    const std::uint32_t n = static_cast<std::uint32_t>(txs_.size());
+    Budget budget(limits);
+
+    // Sort (score, index) pairs rather than indices into txs_: the keys stay
+    // contiguous, which matters at mempool sizes.
+    std::vector<std::pair<double, std::uint32_t>> keyed(n);
+    for (std::uint32_t i = 0; i < n; ++i) keyed[i] = {-txs_[i].ancestorScore, i};
+    std::sort(keyed.begin(), keyed.end());
+    std::vector<std::uint32_t> order(n);
+    for (std::uint32_t i = 0; i < n; ++i) order[i] = keyed[i].second;
+    keyed = {};
+
+    // state: 0 = unvisited, 1 = selected, 2 = rejected, 3 = evicted by the
+    // swap pass (never retried as a package root there). `mark` is a
+    // per-package epoch so ancestor walks never revisit a node.
+    std::vector<std::uint8_t> state(n, 0);
+    std::vector<std::uint32_t> mark(n, 0);
+    std::vector<std::uint32_t> package;
+    std::vector<std::uint32_t> stack;
+    std::uint32_t epoch = 0;
+
+    // Collects `root` plus its unselected ancestors into `package`.
+    auto gather = [&](std::uint32_t root, PackageWeight& pw) {
+        ++epoch;
+        package.clear();
+        stack.assign(1, root);
+        mark[root] = epoch;
+        while (!stack.empty()) {
+            std::uint32_t v = stack.back();
+            stack.pop_back();
+            package.push_back(v);
+            pw.add(txs_[v], budget.cappedLabels);
+            for (std::uint32_t p = parentBegin_[v]; p < parentBegin_[v + 1]; ++p) {
+                std::uint32_t a = parents_[p];
+                if (state[a] != 1 && mark[a] != epoch) {
+                    mark[a] = epoch;
+                    stack.push_back(a);
+                }
+            }
+        }
+        // Parents always have smaller indices, so ascending order is valid.
+        std::sort(package.begin(), package.end());
+    };
+
+    std::uint32_t minWeight = UINT32_MAX;
+    for (const auto& tx : txs_) minWeight = tx.weight < minWeight ? tx.weight : minWeight;
+
+    // Like Bitcoin Core's miner, stop after a run of failures once the block
+    // is nearly full; the tail rarely fits and dominates the running time.
+    constexpr std::size_t kMaxConsecutiveFailures = 1000;
+    constexpr std::uint64_t kNearlyFull = 4000;
+    std::size_t failures = 0;
+    for (std::uint32_t i : order) {
+        if (state[i] == 1) continue;
+        // Nothing else can fit once the gap is below the lightest candidate.
+        std::uint64_t gap = budget.maxWeight - budget.weight;
+        if (gap < minWeight) break;
+        if (failures > kMaxConsecutiveFailures && gap < kNearlyFull) break;
+        PackageWeight pw;
+        gather(i, pw);
+        if (!pw.fits(budget)) {
+            state[i] = 2;
+            ++failures;
+            continue;
+        }
+        failures = 0;
+        pw.commit(budget);
+        for (std::uint32_t v : package) {
+            state[v] = 1;
+            out.txs.push_back(v);
+        }
+    }
+    out.greedyCount = out.txs.size();
+
+    if (limits.improve && !out.txs.empty()) {
+        // Swap pass: a rejected package may be worth more than the cheapest
+        // selected leaves (selected txs with no selected children) that
+        // would have to go to make room. Value is score * weight. A tx is in
+        // the heap at most once; its entry goes stale when it gains a
+        // selected child or is evicted, and is skipped when popped.
+        std::vector<std::uint32_t> selectedChildren(n, 0);
+        for (std::uint32_t v : out.txs) {
+            for (std::uint32_t p = parentBegin_[v]; p < parentBegin_[v + 1]; ++p) {
+                ++selectedChildren[parents_[p]];
+            }
+        }
+        auto cheaper = [&](std::uint32_t a, std::uint32_t b) {
+            return txs_[a].score > txs_[b].score; // min-heap on score
+        };
+        std::vector<std::uint32_t> leaves;
+        std::vector<std::uint8_t> inHeap(n, 0);
+        for (std::uint32_t v : out.txs) {
+            if (selectedChildren[v] == 0) {
+                leaves.push_back(v);
+                inHeap[v] = 1;
+            }
+        }
+        std::make_heap(leaves.begin(), leaves.end(), cheaper);
+        auto pushLeaf = [&](std::uint32_t v) {
+            if (inHeap[v]) return;
+            inHeap[v] = 1;
+            leaves.push_back(v);
+            std::push_heap(leaves.begin(), leaves.end(), cheaper);
+        };
+
+        std::vector<std::uint32_t> evicted;
+        std::vector<std::uint32_t> kept;
+        std::size_t attempts = 0;
+        for (std::uint32_t i : order) {
+            if (attempts == limits.improveAttempts || leaves.empty()) break;
+            if (state[i] != 2) continue;
+            ++attempts;
+
+            PackageWeight in;
+            gather(i, in);
+            double gain = 0.0;
+            for (std::uint32_t v : package) gain += txs_[v].score * txs_[v].weight;
+            // Leaves that parent a package member must stay.
+            for (std::uint32_t v : package) {
+                for (std::uint32_t p = parentBegin_[v]; p < parentBegin_[v + 1]; ++p) {
+                    mark[parents_[p]] = epoch;
+                }
+            }
+
+            PackageWeight outW;
+            double loss = 0.0;
+            evicted.clear();
+            kept.clear();
+            while (!leaves.empty() && budget.weight - outW.weight + in.weight > budget.maxWeight) {
+                std::pop_heap(leaves.begin(), leaves.end(), cheaper);
+                std::uint32_t leaf = leaves.back();
+                leaves.pop_back();
+                inHeap[leaf] = 0;
+                if (state[leaf] != 1 || selectedChildren[leaf] != 0) continue;
+                if (mark[leaf] == epoch) {
+                    kept.push_back(leaf);
+                    continue;
+                }
+                evicted.push_back(leaf);
+                outW.add(txs_[leaf], budget.cappedLabels);
+                loss += txs_[leaf].score * txs_[leaf].weight;
+                if (loss >= gain) break;
+            }
+
+            // Apply tentatively, then check every cap.
+            Budget trial = budget;
+            trial.weight -= outW.weight;
+            for (std::size_t t = 0; t < kTierCount; ++t) trial.tier[t] -= outW.tier[t];
+            for (std::size_t l = 0; l < kLabelCount; ++l) trial.label[l] -= outW.label[l];
+            bool accept = loss < gain && in.fits(trial);
+
+            if (accept) {
+                in.commit(trial);
+                budget = trial;
+                for (std::uint32_t v : evicted) {
+                    state[v] = 3;
+                    for (std::uint32_t p = parentBegin_[v]; p < parentBegin_[v + 1]; ++p) {
+                        std::uint32_t a = parents_[p];
+                        // A parent left without selected children is a leaf now.
+                        if (--selectedChildren[a] == 0 && state[a] == 1) pushLeaf(a);
+                    }
+                }
+                for (std::uint32_t v : package) {
+                    state[v] = 1;
+                    out.txs.push_back(v);
+                    for (std::uint32_t p = parentBegin_[v]; p < parentBegin_[v + 1]; ++p) {
+                        ++selectedChildren[parents_[p]];
+                    }
+                }
+                pushLeaf(package.back()); // the root has no selected children
+            } else {
+                for (std::uint32_t v : evicted) pushLeaf(v);
+            }
+            for (std::uint32_t v : kept) pushLeaf(v);
+        }
+
+        // Drop evicted entries. An evicted tx can come back as the ancestor
+        // of a later package, so keep only the last occurrence of each: its
+        // parents were selected then and, having a selected child, could not
+        // be evicted afterwards, so the order is still parents-first.
+        ++epoch;
+        std::size_t w = out.txs.size();
+        for (std::size_t r = out.txs.size(); r-- > 0;) {
+            std::uint32_t v = out.txs[r];
+            if (state[v] != 1 || mark[v] == epoch) continue;
+            mark[v] = epoch;
+            out.txs[--w] = v;
+        }
+        out.txs.erase(out.txs.begin(), out.txs.begin() + static_cast<std::ptrdiff_t>(w));
+    }
+
+    for (std::uint32_t v : out.txs) out.fees += txs_[v].fee;
+    out.weight = budget.weight;
+    out.tierWeight = budget.tier;
+    out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return out;
+}
+
+} // namespace buds
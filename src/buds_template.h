@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "buds_labels.h"
+#include "buds_tagger.h"
+#include "buds_tx.h"
+
+namespace buds {
+
+// One mempool transaction offered to the template builder.
+struct TemplateCandidate {
+    Hash256 id;
+    std::uint32_t weight{0};        // weight units
+    std::uint64_t fee{0};           // sat
+    double score{0.0};              // PolicyResult::score
+    double ancestorScore{0.0};      // weight-weighted score of tx + unconfirmed ancestors;
+                                    // 0 means "use score"
+    Tier arbda{Tier::T0};
+    std::uint32_t labelMask{0};     // bit i set if label i appears in the tx
+};
+
+// Weight caps (docs/policy-interface.md §2.3). Shares are fractions of
+// maxWeight; a transaction counts against the cap of its ARBDA tier and of
+// every capped label it carries.
+struct TemplateLimits {
+    std::uint64_t maxWeight{4000000 - 4000};   // leave room for the coinbase
+    std::array<double, kTierCount> tierShare{{1.0, 1.0, 1.0, 1.0}};
+    std::vector<std::pair<LabelId, double>> labelShare;
+    bool improve{true};                        // run the swap pass after greedy
+    std::size_t improveAttempts{512};          // rejected packages it reconsiders
+};
+
+struct BlockTemplate {
+    std::vector<std::uint32_t> txs;            // candidate indices, parents first
+    std::uint64_t weight{0};
+    std::uint64_t fees{0};
+    std::array<std::uint64_t, kTierCount> tierWeight{};
+    std::size_t greedyCount{0};                // txs chosen before the swap pass
+    double seconds{0.0};
+};
+
+// Greedy package selection by ancestor score with per-tier and per-label
+// weight caps, followed by an optional swap pass.
+//
+// Candidates must be added parents-first; each names its in-mempool parents
+// by the index add() returned for them. build() walks candidates from the
+// highest ancestor score down, pulling in each one's not-yet-selected
+// ancestors as a package and keeping the package only if it fits every cap.
+// The swap pass then revisits the best rejected packages and admits one
+// when evicting the lowest-scoring selected leaves (txs with no selected
+// children) frees enough room for less total score * weight.
+class TemplateBuilder {
+public:
+    void reserve(std::size_t txs, std::size_t parentLinks = 0);
+    void clear();
+    std::size_t size() const { return txs_.size(); }
+
+    // Returns the candidate's index. Parent indices must be < that index.
+    std::uint32_t add(const TemplateCandidate& tx, const std::uint32_t* parents = nullptr,
+                      std::size_t parentCount = 0);
+
+    // Convenience: fills the candidate from engine outputs.
+    std::uint32_t add(const Hash256& id, std::uint32_t weight, std::uint64_t fee,
+                      const Evaluation& eval, const CompactClassification& labels,
+                      const std::uint32_t* parents = nullptr, std::size_t parentCount = 0);
+
+    // Fills ancestorScore for every candidate from its ancestor set. Callers
+    // that maintain ancestor aggregates themselves can skip this.
+    void computeAncestorScores();
+
+    const TemplateCandidate& candidate(std::uint32_t i) const { return txs_[i]; }
+
+    BlockTemplate build(const TemplateLimits& limits = TemplateLimits()) const;
+
+private:
+    std::vector<TemplateCandidate> txs_;
+    std::vector<std::uint32_t> parentBegin_;   // CSR offsets, size() + 1 entries
+    std::vector<std::uint32_t> parents_;
+};
+
+} // namespace buds
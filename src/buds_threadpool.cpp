@@ -0,0 +1,153 @@
+#include "buds_threadpool.h"
+
+#include <exception>
+
+namespace buds {
+
+namespace {
+
+// Index of the pool worker running on this thread, or SIZE_MAX.
+thread_local const ThreadPool* tlsPool = nullptr;
+thread_local std::size_t tlsWorker = SIZE_MAX;
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) workers_.push_back(std::make_unique<Worker>());
+    threads_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    std::size_t target = (tlsPool == this) ? tlsWorker
+                                           : nextQueue_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+        workers_[target]->tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    // Taking the sleep mutex orders this notify after a sleeper's predicate check.
+    bool helpers = false;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        helpers = helpersWaiting_ != 0;
+    }
+    wake_.notify_one();
+    if (helpers) helperWake_.notify_all();
+}
+
+bool ThreadPool::popOwn(std::size_t self, std::function<void()>& task) {
+    Worker& w = *workers_[self];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.tasks.empty()) return false;
+    task = std::move(w.tasks.back());
+    w.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(std::size_t self, std::function<void()>& task) {
+    const std::size_t n = workers_.size();
+    for (std::size_t k = 1; k <= n; ++k) {
+        std::size_t victim = (self + k) % n;
+        if (victim == self) continue;
+        Worker& w = *workers_[victim];
+        std::unique_lock<std::mutex> lock(w.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || w.tasks.empty()) continue;
+        task = std::move(w.tasks.front());
+        w.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::tryRunOne(std::size_t self) {
+    std::function<void()> task;
+    bool found = (self < workers_.size() && popOwn(self, task)) || steal(self, task);
+    if (!found) return false;
+    queued_.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(std::size_t self) {
+    tlsPool = this;
+    tlsWorker = self;
+    for (;;) {
+        if (tryRunOne(self)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] {
+            return stopping_ || queued_.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping_ && queued_.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t n, const std::function<void(std::size_t)>& fn,
+                             std::size_t grain) {
+    if (n == 0) return;
+    if (grain == 0) {
+        // Aim for ~8 chunks per worker so stealing can even out skew.
+        grain = n / (workers_.size() * 8);
+        if (grain == 0) grain = 1;
+    }
+    const std::size_t chunks = (n + grain - 1) / grain;
+
+    struct Group {
+        std::atomic<std::size_t> remaining;
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    } group;
+    group.remaining.store(chunks, std::memory_order_relaxed);
+
+    for (std::size_t c = 0; c < chunks; ++c) {
+        std::size_t begin = c * grain;
+        std::size_t end = begin + grain < n ? begin + grain : n;
+        submit([this, &group, &fn, begin, end] {
+            try {
+                for (std::size_t i = begin; i < end; ++i) fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(group.errorMutex);
+                if (!group.error) group.error = std::current_exception();
+            }
+            if (group.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            // Last chunk: `group` may be gone once the caller sees zero, so
+            // only pool members are touched from here on.
+            { std::lock_guard<std::mutex> lock(sleepMutex_); }
+            helperWake_.notify_all();
+        });
+    }
+
+    // Help out until our chunks are done. Once nothing is left to steal,
+    // sleep until the last chunk finishes or more work is submitted (a
+    // running chunk may fan out further).
+    std::size_t self = (tlsPool == this) ? tlsWorker : SIZE_MAX;
+    while (group.remaining.load(std::memory_order_acquire) > 0) {
+        if (tryRunOne(self == SIZE_MAX ? 0 : self)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        ++helpersWaiting_;
+        helperWake_.wait(lock, [this, &group] {
+            return group.remaining.load(std::memory_order_acquire) == 0 ||
+                   queued_.load(std::memory_order_acquire) > 0;
+        });
+        --helpersWaiting_;
+    }
+
+    if (group.error) std::rethrow_exception(group.error);
+}
+
+} // namespace buds
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace buds {
+
+// Fixed-size work-stealing thread pool. Each worker owns a deque: it pops
+// its own work LIFO (cache-warm) and steals FIFO from the others when idle.
+// Threads that wait on a parallelFor help run queued work, and sleep only
+// while there is none, so nested use cannot deadlock and a waiter does not
+// compete with the workers for a core.
+class ThreadPool {
+public:
+    // threads == 0 uses std::thread::hardware_concurrency().
+    explicit ThreadPool(std::size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers_.size(); }
+
+    // Fire-and-forget task. Tasks submitted from a worker land on that
+    // worker's own deque; others are spread round-robin. The task must not
+    // throw: an exception escaping it calls std::terminate.
+    void submit(std::function<void()> task);
+
+    // Runs fn(i) for every i in [0, n), split into chunks of at most `grain`
+    // indices (0 = pick automatically). Returns once all calls finished; the
+    // calling thread participates. Exceptions from fn are rethrown here.
+    void parallelFor(std::size_t n, const std::function<void(std::size_t)>& fn,
+                     std::size_t grain = 0);
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<std::size_t> nextQueue_{0};
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::condition_variable helperWake_;   // parallelFor callers with nothing to run
+    std::size_t helpersWaiting_{0};        // guarded by sleepMutex_
+    bool stopping_{false};
+
+    void workerLoop(std::size_t self);
+    bool tryRunOne(std::size_t self);
+    bool popOwn(std::size_t self, std::function<void()>& task);
+    bool steal(std::size_t self, std::function<void()>& task);
+};
+
+} // namespace buds
@@ -0,0 +1,345 @@
+#include "buds_tx.h"
+
+#include <cstring>
+
+namespace buds {
+
+namespace {
+
+// ---------- SHA256 (FIPS 180-4), streaming ----------
+
+class Sha256 {
+public:
+    Sha256() { reset(); }
+
+    void reset() {
+        static const std::uint32_t init[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        std::memcpy(s_, init, sizeof(s_));
+        bufLen_ = 0;
+        total_ = 0;
+    }
+
+    void write(const std::uint8_t* data, std::size_t len) {
+        total_ += len;
+        if (bufLen_ > 0) {
+            std::size_t take = 64 - bufLen_;
+            if (take > len) take = len;
+            std::memcpy(buf_ + bufLen_, data, take);
+            bufLen_ += take;
+            data += take;
+            len -= take;
+            if (bufLen_ < 64) return;
+            transform(buf_);
+            bufLen_ = 0;
+        }
+        while (len >= 64) {
+            transform(data);
+            data += 64;
+            len -= 64;
+        }
+        std::memcpy(buf_, data, len);
+        bufLen_ = len;
+    }
+
+    void finalize(std::uint8_t out[32]) {
+        static const std::uint8_t pad[64] = {0x80};
+        std::uint64_t bits = total_ * 8;
+        std::uint8_t lenBytes[8];
+        for (int i = 0; i < 8; ++i) lenBytes[i] = static_cast<std::uint8_t>(bits >> (56 - 8 * i));
+        write(pad, 1 + ((119 - (total_ % 64)) % 64));
+        write(lenBytes, 8);
+        for (int i = 0; i < 8; ++i) {
+            out[4 * i + 0] = static_cast<std::uint8_t>(s_[i] >> 24);
+            out[4 * i + 1] = static_cast<std::uint8_t>(s_[i] >> 16);
+            out[4 * i + 2] = static_cast<std::uint8_t>(s_[i] >> 8);
+            out[4 * i + 3] = static_cast<std::uint8_t>(s_[i]);
+        }
+    }
+
+private:
+    std::uint32_t s_[8];
+    std::uint8_t buf_[64];
+    std::size_t bufLen_{0};
+    std::uint64_t total_{0};
+
+    static std::uint32_t rotr(std::uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    void transform(const std::uint8_t* chunk) {
+        static const std::uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+        std::uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (std::uint32_t(chunk[4 * i]) << 24) | (std::uint32_t(chunk[4 * i + 1]) << 16) |
+                   (std::uint32_t(chunk[4 * i + 2]) << 8) | std::uint32_t(chunk[4 * i + 3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            std::uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            std::uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        std::uint32_t a = s_[0], b = s_[1], c = s_[2], d = s_[3];
+        std::uint32_t e = s_[4], f = s_[5], g = s_[6], h = s_[7];
+        for (int i = 0; i < 64; ++i) {
+            std::uint32_t S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+            std::uint32_t ch = (e & f) ^ (~e & g);
+            std::uint32_t t1 = h + S1 + ch + k[i] + w[i];
+            std::uint32_t S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+            std::uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            std::uint32_t t2 = S0 + maj;
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        s_[0] += a; s_[1] += b; s_[2] += c; s_[3] += d;
+        s_[4] += e; s_[5] += f; s_[6] += g; s_[7] += h;
+    }
+};
+
+Hash256 finishDouble(Sha256& inner) {
+    std::uint8_t first[32];
+    inner.finalize(first);
+    Sha256 outer;
+    outer.write(first, sizeof(first));
+    Hash256 h;
+    outer.finalize(h.bytes.data());
+    return h;
+}
+
+// ---------- serialization readers ----------
+
+struct Reader {
+    const std::uint8_t* p;
+    const std::uint8_t* end;
+
+    std::size_t remaining() const { return static_cast<std::size_t>(end - p); }
+
+    bool skip(std::size_t n) {
+        if (remaining() < n) return false;
+        p += n;
+        return true;
+    }
+
+    bool readU32(std::uint32_t& v) {
+        if (remaining() < 4) return false;
+        v = std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) |
+            (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+        p += 4;
+        return true;
+    }
+
+    bool readI64(std::int64_t& v) {
+        if (remaining() < 8) return false;
+        std::uint64_t u = 0;
+        for (int i = 7; i >= 0; --i) u = (u << 8) | p[i];
+        v = static_cast<std::int64_t>(u);
+        p += 8;
+        return true;
+    }
+
+    bool readCompactSize(std::uint64_t& v) {
+        if (remaining() < 1) return false;
+        std::uint8_t first = *p++;
+        if (first < 0xfd) {
+            v = first;
+            return true;
+        }
+        std::size_t width = first == 0xfd ? 2 : first == 0xfe ? 4 : 8;
+        if (remaining() < width) return false;
+        v = 0;
+        for (std::size_t i = width; i-- > 0;) v = (v << 8) | p[i];
+        p += width;
+        // Reject non-canonical encodings, as Bitcoin Core does.
+        std::uint64_t minimum = width == 2 ? 0xfd : width == 4 ? 0x10000 : 0x100000000ULL;
+        return v >= minimum;
+    }
+
+    bool readBytes(ByteSpan& out) {
+        std::uint64_t len = 0;
+        if (!readCompactSize(len) || len > remaining()) return false;
+        out = ByteSpan(p, static_cast<std::size_t>(len));
+        p += len;
+        return true;
+    }
+};
+
+} // namespace
+
+// ---------- Hash256 ----------
+
+void Hash256::toHex(char out[64]) const {
+    static const char digits[] = "0123456789abcdef";
+    for (std::size_t i = 0; i < 32; ++i) {
+        std::uint8_t b = bytes[31 - i];
+        out[2 * i] = digits[b >> 4];
+        out[2 * i + 1] = digits[b & 0x0f];
+    }
+}
+
+std::string Hash256::toHex() const {
+    char buf[64];
+    toHex(buf);
+    return std::string(buf, sizeof(buf));
+}
+
+bool Hash256::fromHex(const std::string& hex, Hash256& out) {
+    if (hex.size() != 64) return false;
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    for (std::size_t i = 0; i < 32; ++i) {
+        int hi = nibble(hex[2 * i]);
+        int lo = nibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out.bytes[31 - i] = static_cast<std::uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+Hash256 sha256d(ByteSpan data) {
+    Sha256 inner;
+    inner.write(data.data(), data.size());
+    return finishDouble(inner);
+}
+
+// ---------- TxView ----------
+
+Hash256 TxView::txid() const {
+    if (!segwit) return sha256d(raw);
+    // Non-witness serialization: version || body || locktime, skipping the
+    // marker/flag bytes and the witness section without copying.
+    Sha256 inner;
+    inner.write(raw.data(), 4);
+    inner.write(raw.data() + bodyBegin, bodyEnd - bodyBegin);
+    inner.write(raw.data() + raw.size() - 4, 4);
+    return finishDouble(inner);
+}
+
+Hash256 TxView::wtxid() const {
+    return sha256d(raw);
+}
+
+std::size_t TxView::baseSize() const {
+    return 4 + (bodyEnd - bodyBegin) + 4;
+}
+
+bool parseTx(ByteSpan in, TxView& out, std::size_t* consumed) {
+    out.vin.clear();
+    out.vout.clear();
+    out.witnessItems.clear();
+    out.segwit = false;
+
+    Reader r{in.data(), in.data() + in.size()};
+    const std::uint8_t* start = r.p;
+
+    std::uint32_t version = 0;
+    if (!r.readU32(version)) return false;
+    out.version = static_cast<std::int32_t>(version);
+
+    // BIP144: marker 0x00 followed by a non-zero flag byte.
+    if (r.remaining() >= 2 && r.p[0] == 0x00 && r.p[1] != 0x00) {
+        if (r.p[1] != 0x01) return false;
+        out.segwit = true;
+        r.p += 2;
+    }
+    out.bodyBegin = static_cast<std::size_t>(r.p - start);
+
+    std::uint64_t nIn = 0;
+    if (!r.readCompactSize(nIn)) return false;
+    // Each input needs at least 41 bytes; reject counts the buffer cannot hold.
+    if (nIn > r.remaining() / 41) return false;
+    out.vin.resize(static_cast<std::size_t>(nIn));
+    for (auto& txin : out.vin) {
+        txin.prevout = ByteSpan(r.p, 36);
+        if (!r.skip(36)) return false;
+        if (!r.readBytes(txin.scriptSig)) return false;
+        if (!r.readU32(txin.sequence)) return false;
+        txin.witnessBegin = 0;
+        txin.witnessCount = 0;
+    }
+
+    std::uint64_t nOut = 0;
+    if (!r.readCompactSize(nOut)) return false;
+    if (nOut > r.remaining() / 9) return false;
+    out.vout.resize(static_cast<std::size_t>(nOut));
+    for (auto& txout : out.vout) {
+        if (!r.readI64(txout.value)) return false;
+        if (!r.readBytes(txout.scriptPubKey)) return false;
+    }
+    out.bodyEnd = static_cast<std::size_t>(r.p - start);
+
+    if (out.segwit) {
+        for (auto& txin : out.vin) {
+            std::uint64_t nItems = 0;
+            if (!r.readCompactSize(nItems)) return false;
+            if (nItems > r.remaining()) return false;
+            txin.witnessBegin = out.witnessItems.size();
+            txin.witnessCount = static_cast<std::size_t>(nItems);
+            for (std::uint64_t i = 0; i < nItems; ++i) {
+                ByteSpan item;
+                if (!r.readBytes(item)) return false;
+                out.witnessItems.push_back(item);
+            }
+        }
+    }
+
+    if (!r.readU32(out.locktime)) return false;
+
+    std::size_t len = static_cast<std::size_t>(r.p - start);
+    if (consumed) {
+        *consumed = len;
+    } else if (len != in.size()) {
+        return false;
+    }
+    out.raw = ByteSpan(start, len);
+    return true;
+}
+
+// ---------- BlockView ----------
+
+Hash256 BlockView::prevHash() const {
+    Hash256 h;
+    std::memcpy(h.bytes.data(), header.data() + 4, 32);
+    return h;
+}
+
+std::uint32_t BlockView::time() const {
+    const std::uint8_t* p = header.data() + 68;
+    return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) |
+           (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+}
+
+bool parseBlock(ByteSpan in, BlockView& out) {
+    if (in.size() < 81) return false;
+    out.header = in.subspan(0, 80);
+
+    Reader r{in.data() + 80, in.data() + in.size()};
+    std::uint64_t nTx = 0;
+    if (!r.readCompactSize(nTx)) return false;
+    // The smallest possible transaction is 60 bytes.
+    if (nTx > r.remaining() / 60) return false;
+
+    // Keep previously allocated TxViews (and their vectors) alive for reuse.
+    if (out.txs.size() < nTx) out.txs.resize(static_cast<std::size_t>(nTx));
+    for (std::size_t i = 0; i < nTx; ++i) {
+        std::size_t used = 0;
+        if (!parseTx(ByteSpan(r.p, r.remaining()), out.txs[i], &used)) return false;
+        r.p += used;
+    }
+    out.txs.resize(static_cast<std::size_t>(nTx));
+    return r.p == r.end;
+}
+
+} // namespace buds
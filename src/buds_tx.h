@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace buds {
+
+// Non-owning view over a contiguous run of bytes (C++17 stand-in for
+// std::span<const uint8_t>).
+class ByteSpan {
+public:
+    ByteSpan() = default;
+    ByteSpan(const std::uint8_t* data, std::size_t size) : data_(data), size_(size) {}
+    ByteSpan(const std::vector<std::uint8_t>& v) : data_(v.data()), size_(v.size()) {}
+
+    const std::uint8_t* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const std::uint8_t* begin() const { return data_; }
+    const std::uint8_t* end() const { return data_ + size_; }
+    std::uint8_t operator[](std::size_t i) const { return data_[i]; }
+
+    ByteSpan subspan(std::size_t offset, std::size_t count = SIZE_MAX) const {
+        if (offset > size_) offset = size_;
+        std::size_t avail = size_ - offset;
+        return ByteSpan(data_ + offset, count < avail ? count : avail);
+    }
+
+private:
+    const std::uint8_t* data_{nullptr};
+    std::size_t size_{0};
+};
+
+// 32-byte double-SHA256 digest stored in internal (little-endian) byte order.
+struct Hash256 {
+    std::array<std::uint8_t, 32> bytes{};
+
+    // Display form used by Bitcoin Core (byte-reversed hex).
+    std::string toHex() const;
+    void toHex(char out[64]) const;
+    // Inverse of toHex; false unless `hex` is exactly 64 hex digits.
+    static bool fromHex(const std::string& hex, Hash256& out);
+
+    bool operator==(const Hash256& o) const { return bytes == o.bytes; }
+    bool operator!=(const Hash256& o) const { return bytes != o.bytes; }
+    bool operator<(const Hash256& o) const { return bytes < o.bytes; }
+};
+
+// Hash functor for unordered containers. Digests are uniformly distributed,
+// so the first word is already a good hash.
+struct Hash256Hasher {
+    std::size_t operator()(const Hash256& h) const {
+        std::size_t v;
+        std::memcpy(&v, h.bytes.data(), sizeof(v));
+        return v;
+    }
+};
+
+Hash256 sha256d(ByteSpan data);
+
+struct TxInView {
+    ByteSpan prevout;               // 32-byte txid + 4-byte index
+    ByteSpan scriptSig;
+    std::uint32_t sequence{0};
+    std::size_t witnessBegin{0};    // index into TxView::witnessItems
+    std::size_t witnessCount{0};
+};
+
+struct TxOutView {
+    std::int64_t value{0};          // satoshis
+    ByteSpan scriptPubKey;
+};
+
+// Zero-copy view over a consensus-serialized transaction. All spans point
+// into the buffer passed to parseTx, which must outlive the view.
+struct TxView {
+    ByteSpan raw;
+    std::int32_t version{0};
+    std::uint32_t locktime{0};
+    bool segwit{false};
+    std::vector<TxInView> vin;
+    std::vector<TxOutView> vout;
+    std::vector<ByteSpan> witnessItems;  // flattened, see TxInView::witnessBegin
+
+    ByteSpan witnessItem(std::size_t vinIdx, std::size_t stackIdx) const {
+        return witnessItems[vin[vinIdx].witnessBegin + stackIdx];
+    }
+
+    Hash256 txid() const;
+    Hash256 wtxid() const;
+
+    // Serialized sizes (BIP141): weight = 3 * base + total, vsize = ceil(weight / 4)
+    std::size_t baseSize() const;
+    std::size_t weight() const { return baseSize() * 3 + raw.size(); }
+    std::size_t vsize() const { return (weight() + 3) / 4; }
+
+    // Byte offsets of the non-witness body (vin count .. end of vout) within raw.
+    std::size_t bodyBegin{0};
+    std::size_t bodyEnd{0};
+};
+
+// Parses a segwit or legacy transaction in place. When `consumed` is null the
+// transaction must span the whole input; otherwise trailing bytes are allowed
+// and the parsed length is written to *consumed (used for block parsing).
+// Returns false on malformed input; `out` is reused to avoid reallocations.
+bool parseTx(ByteSpan in, TxView& out, std::size_t* consumed = nullptr);
+
+// Zero-copy view over a serialized block (80-byte header + transactions).
+struct BlockView {
+    ByteSpan header;
+    std::vector<TxView> txs;
+
+    Hash256 hash() const { return sha256d(header); }
+    Hash256 prevHash() const;
+    std::uint32_t time() const;
+};
+
+// Parses a whole block in place; `out` is reused across calls.
+bool parseBlock(ByteSpan in, BlockView& out);
+
+} // namespace buds
@@ -0,0 +1,438 @@
+#include "buds_txindex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace buds {
+
+namespace {
+
+const char kLogMagic[8] = {'B', 'U', 'D', 'S', 'T', 'X', 'L', '1'};
+const char kIdxMagic[8] = {'B', 'U', 'D', 'S', 'T', 'X', 'I', '1'};
+constexpr std::uint32_t kIndexVersion = 1;
+constexpr std::size_t kRecordSize = 80;
+constexpr std::size_t kLogHeader = 16;          // magic, version, record size
+constexpr std::size_t kIdxHeader = 64;          // magic, version, capacity, count, covered, dirty
+constexpr std::size_t kChecksumAt = kRecordSize - 4;
+constexpr std::size_t kFlushBytes = kRecordSize * 16384;
+constexpr std::size_t kLogReserve = std::size_t(1) << 30; // address space mapped ahead of the file
+constexpr std::uint64_t kMinCapacity = 1024;
+
+// Record layout: txid[32] height[4] T0..T3[4 each] arbda[1] labelCount[1]
+// labels[17] zero[5] checksum[4]; integers little-endian.
+static_assert(kLabelCount == 17, "TxIndex record layout assumes 17 labels");
+
+void putLE32(std::uint8_t* p, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+std::uint32_t getLE32(const std::uint8_t* p) {
+    return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) |
+           (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+}
+
+void putLE64(std::uint8_t* p, std::uint64_t v) {
+    putLE32(p, static_cast<std::uint32_t>(v));
+    putLE32(p + 4, static_cast<std::uint32_t>(v >> 32));
+}
+
+std::uint64_t getLE64(const std::uint8_t* p) {
+    return std::uint64_t(getLE32(p)) | (std::uint64_t(getLE32(p + 4)) << 32);
+}
+
+// FNV-1a; catches torn and zero-filled records, not tampering.
+std::uint32_t checksum(const std::uint8_t* p, std::size_t n) {
+    std::uint32_t h = 2166136261u;
+    for (std::size_t i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void encode(const TxIndexEntry& e, std::uint8_t* rec) {
+    std::memset(rec, 0, kRecordSize);
+    std::memcpy(rec, e.txid.bytes.data(), 32);
+    putLE32(rec + 32, e.height);
+    putLE32(rec + 36, static_cast<std::uint32_t>(e.compact.counts.T0));
+    putLE32(rec + 40, static_cast<std::uint32_t>(e.compact.counts.T1));
+    putLE32(rec + 44, static_cast<std::uint32_t>(e.compact.counts.T2));
+    putLE32(rec + 48, static_cast<std::uint32_t>(e.compact.counts.T3));
+    rec[52] = static_cast<std::uint8_t>(e.arbda);
+    rec[53] = e.compact.labelCount;
+    std::memcpy(rec + 54, e.compact.labels.data(), kLabelCount);
+    putLE32(rec + kChecksumAt, checksum(rec, kChecksumAt));
+}
+
+void decode(const std::uint8_t* rec, TxIndexEntry& e) {
+    std::memcpy(e.txid.bytes.data(), rec, 32);
+    e.height = getLE32(rec + 32);
+    e.compact.counts.T0 = static_cast<int>(getLE32(rec + 36));
+    e.compact.counts.T1 = static_cast<int>(getLE32(rec + 40));
+    e.compact.counts.T2 = static_cast<int>(getLE32(rec + 44));
+    e.compact.counts.T3 = static_cast<int>(getLE32(rec + 48));
+    e.arbda = static_cast<Tier>(rec[52] & 3);
+    e.compact.labelCount = std::min<std::uint8_t>(rec[53], kLabelCount);
+    std::memcpy(e.compact.labels.data(), rec + 54, kLabelCount);
+}
+
+bool recordValid(const std::uint8_t* rec) {
+    return getLE32(rec + kChecksumAt) == checksum(rec, kChecksumAt);
+}
+
+std::uint64_t txidTag(const std::uint8_t* txid) {
+    std::uint64_t v;
+    std::memcpy(&v, txid, sizeof(v));
+    return v;
+}
+
+// Smallest power of two keeping `entries` under a 0.7 load factor.
+std::uint64_t capacityFor(std::uint64_t entries) {
+    std::uint64_t cap = kMinCapacity;
+    while (cap * 7 < entries * 10 + 10) cap <<= 1;
+    return cap;
+}
+
+bool fail(std::string* error, const std::string& what) {
+    if (error) *error = what;
+    return false;
+}
+
+} // namespace
+
+TxIndex::~TxIndex() { close(); }
+
+std::uint64_t TxIndex::records() const {
+    return flushed_ + pending_.size() / kRecordSize;
+}
+
+const std::uint8_t* TxIndex::record(std::uint64_t n) const {
+    if (n < flushed_) return logMap_ + kLogHeader + n * kRecordSize;
+    return pending_.data() + (n - flushed_) * kRecordSize;
+}
+
+TxIndexStats TxIndex::stats() const {
+    TxIndexStats s;
+    s.records = records();
+    s.entries = count_;
+    s.capacity = capacity_;
+    s.replayed = replayed_;
+    s.droppedBytes = droppedBytes_;
+    return s;
+}
+
+#ifndef _WIN32
+
+bool TxIndex::open(const std::string& path, std::string* error) {
+    close();
+    std::string logPath = path + ".log";
+    idxPath_ = path + ".idx";
+
+    logFd_ = ::open(logPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (logFd_ < 0) return fail(error, "cannot open " + logPath);
+    struct stat st;
+    if (fstat(logFd_, &st) != 0) return fail(error, "cannot stat " + logPath);
+    auto fileBytes = static_cast<std::uint64_t>(st.st_size);
+
+    std::uint8_t head[kLogHeader] = {};
+    if (fileBytes == 0) {
+        std::memcpy(head, kLogMagic, 8);
+        putLE32(head + 8, kIndexVersion);
+        putLE32(head + 12, kRecordSize);
+        if (pwrite(logFd_, head, kLogHeader, 0) != static_cast<ssize_t>(kLogHeader)) {
+            return fail(error, "cannot write " + logPath);
+        }
+        fileBytes = kLogHeader;
+    } else if (fileBytes < kLogHeader ||
+               pread(logFd_, head, kLogHeader, 0) != static_cast<ssize_t>(kLogHeader) ||
+               std::memcmp(head, kLogMagic, 8) != 0 || getLE32(head + 8) != kIndexVersion ||
+               getLE32(head + 12) != kRecordSize) {
+        return fail(error, "not a txid index log: " + logPath);
+    }
+    if (!mapLog(fileBytes)) return fail(error, "cannot map " + logPath);
+
+    std::uint64_t onDisk = (fileBytes - kLogHeader) / kRecordSize;
+    std::uint64_t covered = 0;
+    if (!openTable(onDisk, covered)) return fail(error, "cannot create " + idxPath_);
+
+    // Re-index what the table does not cover; cut the log at the first
+    // record that did not make it to disk intact.
+    flushed_ = onDisk;
+    for (std::uint64_t r = covered; r < onDisk; ++r) {
+        if (!recordValid(record(r))) {
+            flushed_ = r;
+            break;
+        }
+        if (!insert(r, record(r))) return fail(error, "cannot grow " + idxPath_);
+        ++replayed_;
+    }
+    std::uint64_t keep = kLogHeader + flushed_ * kRecordSize;
+    if (keep < fileBytes) {
+        if (ftruncate(logFd_, static_cast<off_t>(keep)) != 0) {
+            return fail(error, "cannot truncate " + logPath);
+        }
+        droppedBytes_ = fileBytes - keep;
+    }
+
+    ok_ = true;
+    if ((replayed_ || droppedBytes_) && !sync()) return fail(error, "cannot sync " + idxPath_);
+    return true;
+}
+
+void TxIndex::close() {
+    if (ok_) sync();
+    ok_ = false;
+    if (logMap_) munmap(logMap_, logMapSize_);
+    if (idxMap_) munmap(idxMap_, idxMapSize_);
+    if (logFd_ >= 0) ::close(logFd_);
+    if (idxFd_ >= 0) ::close(idxFd_);
+    logFd_ = idxFd_ = -1;
+    logMap_ = idxMap_ = nullptr;
+    logMapSize_ = idxMapSize_ = 0;
+    slots_ = nullptr;
+    capacity_ = count_ = flushed_ = 0;
+    replayed_ = droppedBytes_ = 0;
+    dirty_ = false;
+    pending_.clear();
+}
+
+bool TxIndex::mapLog(std::uint64_t fileBytes) {
+    // Map more than the file holds so appends rarely need a remap; only
+    // bytes already written are ever read.
+    std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t want = std::max<std::size_t>(kLogReserve, static_cast<std::size_t>(fileBytes) * 2);
+    want = (want + page - 1) / page * page;
+    if (logMap_) munmap(logMap_, logMapSize_);
+    void* p = mmap(nullptr, want, PROT_READ, MAP_SHARED, logFd_, 0);
+    if (p == MAP_FAILED) {
+        logMap_ = nullptr;
+        logMapSize_ = 0;
+        return false;
+    }
+    logMap_ = static_cast<std::uint8_t*>(p);
+    logMapSize_ = want;
+    return true;
+}
+
+bool TxIndex::createTable(const std::string& path, std::uint64_t capacity, int& fd,
+                          std::uint8_t*& map, std::size_t& mapSize) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    mapSize = kIdxHeader + static_cast<std::size_t>(capacity) * sizeof(Slot);
+    if (ftruncate(fd, static_cast<off_t>(mapSize)) != 0) return false;
+    void* p = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return false;
+    map = static_cast<std::uint8_t*>(p);
+    std::memcpy(map, kIdxMagic, 8);
+    putLE32(map + 8, kIndexVersion);
+    putLE64(map + 16, capacity);
+    return true;
+}
+
+bool TxIndex::openTable(std::uint64_t records, std::uint64_t& covered) {
+    idxFd_ = ::open(idxPath_.c_str(), O_RDWR);
+    struct stat st;
+    if (idxFd_ >= 0 && fstat(idxFd_, &st) == 0 && static_cast<std::size_t>(st.st_size) >= kIdxHeader) {
+        idxMapSize_ = static_cast<std::size_t>(st.st_size);
+        void* p = mmap(nullptr, idxMapSize_, PROT_READ | PROT_WRITE, MAP_SHARED, idxFd_, 0);
+        if (p != MAP_FAILED) {
+            idxMap_ = static_cast<std::uint8_t*>(p);
+            std::uint64_t cap = getLE64(idxMap_ + 16);
+            covered = getLE64(idxMap_ + 32);
+            // A dirty table may hold slots repointed at records that never
+            // reached the log, hiding the durable ones; rebuild it.
+            bool valid = std::memcmp(idxMap_, kIdxMagic, 8) == 0 && getLE32(idxMap_ + 40) == 0 &&
+                         getLE32(idxMap_ + 8) == kIndexVersion && cap >= kMinCapacity &&
+                         (cap & (cap - 1)) == 0 && idxMapSize_ == kIdxHeader + cap * sizeof(Slot) &&
+                         covered <= records;
+            if (valid) {
+                capacity_ = cap;
+                count_ = getLE64(idxMap_ + 24);
+                slots_ = reinterpret_cast<Slot*>(idxMap_ + kIdxHeader);
+                return true;
+            }
+            munmap(idxMap_, idxMapSize_);
+            idxMap_ = nullptr;
+        }
+    }
+    if (idxFd_ >= 0) ::close(idxFd_);
+
+    // Missing or unusable: rebuild from the whole log.
+    covered = 0;
+    count_ = 0;
+    capacity_ = capacityFor(records);
+    if (!createTable(idxPath_, capacity_, idxFd_, idxMap_, idxMapSize_)) return false;
+    slots_ = reinterpret_cast<Slot*>(idxMap_ + kIdxHeader);
+    writeHeader(0);
+    return true;
+}
+
+bool TxIndex::grow(std::uint64_t capacity) {
+    std::string tmp = idxPath_ + ".tmp";
+    int fd = -1;
+    std::uint8_t* map = nullptr;
+    std::size_t mapSize = 0;
+    if (!createTable(tmp, capacity, fd, map, mapSize)) {
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+
+    Slot* slots = reinterpret_cast<Slot*>(map + kIdxHeader);
+    std::uint64_t mask = capacity - 1;
+    std::uint64_t live = records();
+    std::uint64_t count = 0;
+    for (std::uint64_t i = 0; i < capacity_; ++i) {
+        const Slot& s = slots_[i];
+        if (s.ref == 0 || s.ref - 1 >= live) continue;   // empty, or stale from a crash
+        std::uint64_t j = s.tag & mask;
+        while (slots[j].ref != 0) j = (j + 1) & mask;
+        slots[j] = s;
+        ++count;
+    }
+    // The new table covers what the old one did; it replaces it atomically.
+    putLE64(map + 24, count);
+    putLE64(map + 32, getLE64(idxMap_ + 32));
+    putLE32(map + 40, dirty_ ? 1 : 0);
+    msync(map, mapSize, MS_SYNC);
+    if (std::rename(tmp.c_str(), idxPath_.c_str()) != 0) {
+        munmap(map, mapSize);
+        ::close(fd);
+        return false;
+    }
+
+    munmap(idxMap_, idxMapSize_);
+    ::close(idxFd_);
+    idxFd_ = fd;
+    idxMap_ = map;
+    idxMapSize_ = mapSize;
+    slots_ = slots;
+    capacity_ = capacity;
+    count_ = count;
+    return true;
+}
+
+bool TxIndex::flushPending() {
+    std::size_t done = 0;
+    off_t at = static_cast<off_t>(kLogHeader + flushed_ * kRecordSize);
+    while (done < pending_.size()) {
+        ssize_t n = pwrite(logFd_, pending_.data() + done, pending_.size() - done,
+                           at + static_cast<off_t>(done));
+        if (n <= 0) return ok_ = false;
+        done += static_cast<std::size_t>(n);
+    }
+    flushed_ += pending_.size() / kRecordSize;
+    pending_.clear();
+    std::uint64_t fileBytes = kLogHeader + flushed_ * kRecordSize;
+    if (fileBytes > logMapSize_ && !mapLog(fileBytes)) return ok_ = false;
+    return true;
+}
+
+bool TxIndex::sync() {
+    if (!ok_ || !flushPending()) return false;
+    // Log first, then the slots, then the header that vouches for both.
+    if (fsync(logFd_) != 0) return ok_ = false;
+    msync(idxMap_, idxMapSize_, MS_SYNC);
+    writeHeader(records());
+    msync(idxMap_, kIdxHeader, MS_SYNC);
+    return true;
+}
+
+void TxIndex::markDirty() {
+    if (dirty_) return;
+    putLE32(idxMap_ + 40, 1);
+    msync(idxMap_, kIdxHeader, MS_SYNC);
+    dirty_ = true;
+}
+
+#else
+
+bool TxIndex::open(const std::string&, std::string* error) {
+    return fail(error, "TxIndex requires POSIX mmap");
+}
+void TxIndex::close() {}
+bool TxIndex::mapLog(std::uint64_t) { return false; }
+bool TxIndex::createTable(const std::string&, std::uint64_t, int&, std::uint8_t*&, std::size_t&) {
+    return false;
+}
+bool TxIndex::openTable(std::uint64_t, std::uint64_t&) { return false; }
+bool TxIndex::grow(std::uint64_t) { return false; }
+bool TxIndex::flushPending() { return false; }
+bool TxIndex::sync() { return false; }
+void TxIndex::markDirty() {}
+
+#endif
+
+// Also marks the table clean: callers write it once the slots are on disk.
+void TxIndex::writeHeader(std::uint64_t covered) {
+    putLE64(idxMap_ + 16, capacity_);
+    putLE64(idxMap_ + 24, count_);
+    putLE64(idxMap_ + 32, covered);
+    putLE32(idxMap_ + 40, 0);
+    dirty_ = false;
+}
+
+bool TxIndex::insert(std::uint64_t recordNo, const std::uint8_t* rec) {
+    markDirty();
+    if ((count_ + 1) * 10 > capacity_ * 7 && !grow(capacity_ * 2)) return false;
+    std::uint64_t tag = txidTag(rec);
+    std::uint64_t mask = capacity_ - 1;
+    std::uint64_t live = records();
+    for (std::uint64_t i = tag & mask;; i = (i + 1) & mask) {
+        Slot& s = slots_[i];
+        if (s.ref == 0) {
+            s.tag = tag;
+            s.ref = recordNo + 1;
+            ++count_;
+            return true;
+        }
+        if (s.tag == tag && s.ref - 1 < live && std::memcmp(record(s.ref - 1), rec, 32) == 0) {
+            if (s.ref - 1 < recordNo) s.ref = recordNo + 1;
+            return true;
+        }
+    }
+}
+
+bool TxIndex::append(const TxIndexEntry& entry) {
+    if (!ok_) return false;
+    std::size_t at = pending_.size();
+    pending_.resize(at + kRecordSize);
+    encode(entry, pending_.data() + at);
+    if (!insert(records() - 1, pending_.data() + at)) return ok_ = false;
+    if (pending_.size() >= kFlushBytes) flushPending();
+    return ok_;
+}
+
+bool TxIndex::reserve(std::uint64_t entries) {
+    std::uint64_t cap = capacityFor(entries);
+    if (!ok_ || cap <= capacity_) return ok_;
+    if (!grow(cap)) ok_ = false;
+    return ok_;
+}
+
+bool TxIndex::find(const Hash256& txid, TxIndexEntry& out) const {
+    if (!ok_) return false;
+    std::uint64_t tag = txidTag(txid.bytes.data());
+    std::uint64_t mask = capacity_ - 1;
+    std::uint64_t live = records();
+    std::uint64_t i = tag & mask;
+    for (std::uint64_t probes = 0; probes < capacity_; ++probes, i = (i + 1) & mask) {
+        const Slot& s = slots_[i];
+        if (s.ref == 0) return false;
+        if (s.tag != tag || s.ref - 1 >= live) continue;
+        const std::uint8_t* rec = record(s.ref - 1);
+        if (std::memcmp(rec, txid.bytes.data(), 32) != 0) continue;
+        decode(rec, out);
+        return true;
+    }
+    return false;
+}
+
+} // namespace buds
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "buds_tagger.h"
+#include "buds_tx.h"
+
+namespace buds {
+
+constexpr std::uint32_t kNoHeight = 0xffffffff;
+
+// What the index remembers about one transaction.
+struct TxIndexEntry {
+    Hash256 txid;
+    std::uint32_t height{kNoHeight};   // block height; kNoHeight if unconfirmed
+    Tier arbda{Tier::T0};
+    CompactClassification compact;     // tier counts and labels at write time
+};
+
+struct TxIndexStats {
+    std::uint64_t records{0};        // log records, including superseded ones
+    std::uint64_t entries{0};        // distinct txids
+    std::uint64_t capacity{0};       // hash table slots
+    std::uint64_t replayed{0};       // records re-indexed by the last open()
+    std::uint64_t droppedBytes{0};   // torn log tail removed by the last open()
+};
+
+// Persistent txid -> classification index: two files next to each other.
+//
+//   PATH.log  append-only log of fixed 80-byte records, each with a checksum
+//   PATH.idx  memory-mapped open-addressing hash table (linear probing) of
+//             {first 8 txid bytes, record number} slots, plus a header
+//             recording how many log records the table covers
+//
+// The log is the source of truth. sync() makes the log durable before the
+// table and writes the header last. Appending a txid that is already
+// present points its slot at the new record; the old one stays in the log.
+// Slots are written through the shared mapping before their records are
+// durable, so after a crash a repointed slot can reference a record past
+// the end of the log and hide the older, durable one. The header therefore
+// carries a dirty flag, set on disk before the first slot change after a
+// sync and cleared by the sync's header write: open() re-indexes only the
+// records past the covered count of a clean table (dropping a torn tail),
+// and rebuilds a dirty table from the whole log.
+//
+// Appends are buffered in memory (and visible to find() at once) until the
+// buffer fills or sync() is called. find() may run concurrently with other
+// find() calls; append, reserve and sync need exclusive access. POSIX only:
+// on other platforms open() fails.
+class TxIndex {
+public:
+    TxIndex() = default;
+    ~TxIndex();
+    TxIndex(const TxIndex&) = delete;
+    TxIndex& operator=(const TxIndex&) = delete;
+
+    bool open(const std::string& path, std::string* error = nullptr);
+    // Syncs and unmaps. Called by the destructor.
+    void close();
+
+    bool append(const TxIndexEntry& entry);
+    // Grows the table up front for a bulk build of about `entries` txids.
+    bool reserve(std::uint64_t entries);
+    bool sync();
+
+    bool find(const Hash256& txid, TxIndexEntry& out) const;
+
+    std::uint64_t size() const { return count_; }
+    TxIndexStats stats() const;
+
+private:
+    struct Slot {
+        std::uint64_t tag;   // first 8 bytes of the txid
+        std::uint64_t ref;   // record number + 1; 0 = empty
+    };
+
+    int logFd_{-1};
+    int idxFd_{-1};
+    std::string idxPath_;
+    std::uint8_t* logMap_{nullptr};
+    std::size_t logMapSize_{0};      // reserved mapping length, may exceed the file
+    std::uint64_t flushed_{0};       // records written to the log file
+    std::vector<std::uint8_t> pending_; // encoded records not yet written
+
+    std::uint8_t* idxMap_{nullptr};
+    std::size_t idxMapSize_{0};
+    Slot* slots_{nullptr};
+    std::uint64_t capacity_{0};
+    std::uint64_t count_{0};
+    std::uint64_t replayed_{0};
+    std::uint64_t droppedBytes_{0};
+    bool dirty_{false};              // header dirty flag is set on disk
+    bool ok_{false};
+
+    std::uint64_t records() const;
+    const std::uint8_t* record(std::uint64_t n) const;
+    bool mapLog(std::uint64_t fileBytes);
+    bool createTable(const std::string& path, std::uint64_t capacity, int& fd,
+                     std::uint8_t*& map, std::size_t& mapSize);
+    bool openTable(std::uint64_t records, std::uint64_t& covered);
+    bool grow(std::uint64_t capacity);
+    bool flushPending();
+    bool insert(std::uint64_t recordNo, const std::uint8_t* rec);
+    void writeHeader(std::uint64_t covered);
+    void markDirty();
+};
+
+} // namespace buds
@@ -0,0 +1,357 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buds_async.h"
+#include "buds_hex.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+// version 2, one input, outputs [P2PKH, OP_RETURN "ok"], witness ["0123456789", 010203]
+static const char* kSegwitTx =
+    "02000000000101000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "0100000000fdffffff02e8030000000000001976a91400112233445566778899aabbccddeeff00"
+    "11223388ac0000000000000000046a026f6b020a3031323334353637383903010203"
+    "00000000";
+
+static std::vector<std::uint8_t> fromHex(const std::string& hex) {
+    std::vector<std::uint8_t> out(hex.size() / 2);
+    out.resize(hexDecode(hex.data(), hex.size(), out.data()));
+    return out;
+}
+
+// Occupies every worker of a pool for the lifetime of the gate.
+class PoolGate {
+public:
+    explicit PoolGate(ThreadPool& pool) : workers_(pool.size()), pending_(pool.size()) {
+        for (std::size_t i = 0; i < pool.size(); ++i) {
+            pool.submit([this] {
+                std::unique_lock<std::mutex> lock(mutex_);
+                --pending_;
+                cv_.notify_all();
+                cv_.wait(lock, [this] { return open_; });
+                ++left_;
+                cv_.notify_all();
+            });
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return pending_ == 0; });
+    }
+    // Returns once every blocked worker has left the gate.
+    ~PoolGate() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        open_ = true;
+        cv_.notify_all();
+        cv_.wait(lock, [this] { return left_ == workers_; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::size_t workers_;
+    std::size_t pending_;
+    std::size_t left_{0};
+    bool open_{false};
+};
+
+template <typename Pred>
+static bool waitFor(Pred pred) {
+    for (int i = 0; i < 5000 && !pred(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return pred();
+}
+
+// --- Tests ---
+
+static bool test_mpsc_ring() {
+    std::cout << "[TEST] MPSC ring: bounded, FIFO per producer, nothing lost under contention\n";
+
+    MpscRing<int> small(3);
+    ASSERT_TRUE(small.capacity() == 4);
+    int v = 0;
+    ASSERT_TRUE(!small.tryPop(v));
+    for (int i = 0; i < 4; ++i) {
+        int x = i;
+        ASSERT_TRUE(small.tryPush(x));
+    }
+    int extra = 99;
+    ASSERT_TRUE(!small.tryPush(extra));
+    ASSERT_TRUE(extra == 99);
+    ASSERT_TRUE(small.sizeApprox() == 4);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(small.tryPop(v) && v == i);
+    }
+    ASSERT_TRUE(!small.tryPop(v));
+
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 20000;
+    MpscRing<std::uint64_t> ring(64);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&ring, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                std::uint64_t item = (std::uint64_t(p) << 32) | std::uint64_t(i);
+                while (!ring.tryPush(item)) std::this_thread::yield();
+            }
+        });
+    }
+    std::vector<int> next(kProducers, 0);
+    bool ordered = true;
+    for (int got = 0; got < kProducers * kPerProducer;) {
+        std::uint64_t item;
+        if (!ring.tryPop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int p = static_cast<int>(item >> 32);
+        int i = static_cast<int>(item & 0xffffffffu);
+        ordered = ordered && p < kProducers && next[p] == i;
+        if (p < kProducers) next[p] = i + 1;
+        ++got;
+    }
+    for (auto& t : producers) t.join();
+    ASSERT_TRUE(ordered);
+    for (int p = 0; p < kProducers; ++p) ASSERT_TRUE(next[p] == kPerProducer);
+    ASSERT_TRUE(ring.sizeApprox() == 0);
+    return true;
+}
+
+static bool test_futures_match_sync() {
+    std::cout << "[TEST] futures and callbacks match synchronous classify\n";
+
+    TagEngine engine;
+    ThreadPool pool(2);
+    std::vector<std::uint8_t> raw = fromHex(kSegwitTx);
+    Classification expected = engine.classify(ByteSpan(raw));
+
+    AsyncOptions opts;
+    opts.batchTxs = 4;
+    AsyncClassifier async(engine, pool, opts);
+
+    std::vector<std::future<Classification>> futures;
+    for (int i = 0; i < 100; ++i) {
+        SubmitStatus s;
+        futures.push_back(async.submit(raw, i % 3 ? Lane::Relay : Lane::Block, &s));
+        ASSERT_TRUE(accepted(s));
+        ASSERT_TRUE(futures.back().valid());
+    }
+    for (auto& f : futures) {
+        Classification c = f.get();
+        ASSERT_TRUE(c.tags.size() == expected.tags.size());
+        for (std::size_t r = 0; r < c.tags.size(); ++r) {
+            ASSERT_TRUE(c.tags[r].labels == expected.tags[r].labels);
+        }
+    }
+
+    // Decoded transactions and the callback form.
+    Tx tx;
+    tx.txid = "async";
+    tx.vout.push_back(TxOutput{ScriptPubKey{"", "6a026f6b"}});
+    Classification direct = engine.classify(tx);
+    std::promise<AsyncResult> done;
+    Tx copy = tx;
+    ASSERT_TRUE(accepted(async.trySubmit(copy, Lane::Block, [&done](AsyncResult&& r) {
+        done.set_value(std::move(r));
+    })));
+    AsyncResult r = done.get_future().get();
+    ASSERT_TRUE(!r.error);
+    ASSERT_TRUE(r.classification.txid == "async");
+    ASSERT_TRUE(r.classification.tags.size() == direct.tags.size());
+    ASSERT_TRUE(r.classification.tags[0].labels == direct.tags[0].labels);
+
+    // A malformed transaction fails its own future only.
+    std::vector<std::uint8_t> bad = {0x02, 0x00, 0x00};
+    std::future<Classification> fail = async.submit(bad);
+    std::future<Classification> ok = async.submit(raw);
+    bool threw = false;
+    try {
+        fail.get();
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    ASSERT_TRUE(ok.get().tags.size() == expected.tags.size());
+
+    async.close();
+    AsyncStats st = async.stats();
+    std::uint64_t submitted = st.lanes[0].submitted + st.lanes[1].submitted;
+    ASSERT_TRUE(submitted == 103);
+    ASSERT_TRUE(st.lanes[0].completed + st.lanes[1].completed == submitted);
+    ASSERT_TRUE(st.batches > 0 && st.batches <= submitted);
+    return true;
+}
+
+static bool test_backpressure() {
+    std::cout << "[TEST] bounded lanes report Backlogged, then Full, then Closed\n";
+
+    TagEngine engine;
+    ThreadPool pool(1);
+    std::vector<std::uint8_t> raw = fromHex(kSegwitTx);
+
+    AsyncOptions opts;
+    opts.capacity = 8;
+    opts.highWater = 0.5;
+    opts.batchTxs = 1;
+    opts.maxInFlight = 1;
+    AsyncClassifier async(engine, pool, opts);
+
+    std::atomic<int> completed{0};
+    auto count = [&completed](AsyncResult&&) { completed.fetch_add(1); };
+    {
+        PoolGate gate(pool);
+        // The dispatcher takes one job onto the blocked pool, then stalls.
+        std::vector<std::uint8_t> first = raw;
+        ASSERT_TRUE(async.trySubmit(first, Lane::Relay, count) == SubmitStatus::Accepted);
+        ASSERT_TRUE(waitFor([&] { return async.stats().lanes[1].depth == 0; }));
+
+        std::vector<SubmitStatus> seen;
+        for (int i = 0; i < 10; ++i) {
+            std::vector<std::uint8_t> copy = raw;
+            seen.push_back(async.trySubmit(copy, Lane::Relay, count));
+            if (!accepted(seen.back())) ASSERT_TRUE(copy == raw);
+        }
+        for (int i = 0; i < 4; ++i) ASSERT_TRUE(seen[i] == SubmitStatus::Accepted);
+        for (int i = 4; i < 8; ++i) ASSERT_TRUE(seen[i] == SubmitStatus::Backlogged);
+        for (int i = 8; i < 10; ++i) ASSERT_TRUE(seen[i] == SubmitStatus::Full);
+
+        // Lanes are independent: Block still has room.
+        std::vector<std::uint8_t> urgent = raw;
+        ASSERT_TRUE(async.trySubmit(urgent, Lane::Block, count) == SubmitStatus::Accepted);
+
+        AsyncStats st = async.stats();
+        ASSERT_TRUE(st.lanes[1].rejected == 2);
+        ASSERT_TRUE(st.lanes[1].backlogged == 4);
+        ASSERT_TRUE(st.lanes[1].maxDepth == 8);
+        ASSERT_TRUE(completed.load() == 0);
+    }
+
+    // close() drains everything that was accepted.
+    async.close();
+    ASSERT_TRUE(completed.load() == 10);
+    std::vector<std::uint8_t> late = raw;
+    ASSERT_TRUE(async.trySubmit(late, Lane::Block, count) == SubmitStatus::Closed);
+    SubmitStatus s = SubmitStatus::Accepted;
+    ASSERT_TRUE(!async.submit(raw, Lane::Relay, &s).valid());
+    ASSERT_TRUE(s == SubmitStatus::Closed);
+    return true;
+}
+
+static bool test_priority_and_batching() {
+    std::cout << "[TEST] Block lane overtakes queued Relay work; small txs are batched\n";
+
+    TagEngine engine;
+    ThreadPool pool(1);
+    std::vector<std::uint8_t> raw = fromHex(kSegwitTx);
+
+    AsyncOptions opts;
+    opts.batchTxs = 4;
+    opts.maxInFlight = 1;
+    AsyncClassifier async(engine, pool, opts);
+
+    std::mutex mutex;
+    std::vector<Lane> order;
+    auto record = [&](Lane lane) {
+        return [&mutex, &order, lane](AsyncResult&&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(lane);
+        };
+    };
+    {
+        PoolGate gate(pool);
+        std::vector<std::uint8_t> first = raw;
+        ASSERT_TRUE(accepted(async.trySubmit(first, Lane::Relay, record(Lane::Relay))));
+        ASSERT_TRUE(waitFor([&] { return async.stats().batches == 1; }));
+        for (int i = 0; i < 6; ++i) {
+            std::vector<std::uint8_t> copy = raw;
+            ASSERT_TRUE(accepted(async.trySubmit(copy, Lane::Relay, record(Lane::Relay))));
+        }
+        for (int i = 0; i < 5; ++i) {
+            std::vector<std::uint8_t> copy = raw;
+            ASSERT_TRUE(accepted(async.trySubmit(copy, Lane::Block, record(Lane::Block))));
+        }
+    }
+    async.close();
+
+    // The first relay tx was already on the pool; every block tx runs
+    // before the remaining relay backlog.
+    ASSERT_TRUE(order.size() == 12);
+    ASSERT_TRUE(order[0] == Lane::Relay);
+    for (std::size_t i = 1; i <= 5; ++i) ASSERT_TRUE(order[i] == Lane::Block);
+    for (std::size_t i = 6; i < 12; ++i) ASSERT_TRUE(order[i] == Lane::Relay);
+
+    // 1 + ceil(11 / 4) batches, all but the first shared.
+    AsyncStats st = async.stats();
+    ASSERT_TRUE(st.batches == 4);
+    ASSERT_TRUE(st.batchedTxs == 11);
+    return true;
+}
+
+#ifdef BUDS_HAS_COROUTINES
+
+// Minimal eager coroutine that publishes its result through a promise.
+struct Task {
+    struct promise_type {
+        std::promise<std::size_t> result;
+        Task get_return_object() { return Task{result.get_future()}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_value(std::size_t v) { result.set_value(v); }
+        void unhandled_exception() { result.set_exception(std::current_exception()); }
+    };
+    std::future<std::size_t> future;
+};
+
+static Task countRegions(AsyncClassifier& async, std::vector<std::uint8_t> raw) {
+    Classification c = co_await async.classifyAsync(std::move(raw), Lane::Block);
+    co_return c.tags.size();
+}
+
+static bool test_coroutine() {
+    std::cout << "[TEST] co_await classifyAsync\n";
+
+    TagEngine engine;
+    ThreadPool pool(2);
+    AsyncClassifier async(engine, pool);
+    ASSERT_TRUE(countRegions(async, fromHex(kSegwitTx)).future.get() == 4);
+
+    async.close();
+    bool rejected = false;
+    try {
+        countRegions(async, fromHex(kSegwitTx)).future.get();
+    } catch (const AsyncRejected& e) {
+        rejected = e.status() == SubmitStatus::Closed;
+    }
+    ASSERT_TRUE(rejected);
+    return true;
+}
+
+#endif
+
+int main() {
+    if (!test_mpsc_ring()) return 1;
+    if (!test_futures_match_sync()) return 1;
+    if (!test_backpressure()) return 1;
+    if (!test_priority_and_batching()) return 1;
+#ifdef BUDS_HAS_COROUTINES
+    if (!test_coroutine()) return 1;
+#endif
+
+    std::cout << "All BUDS async tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,273 @@
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buds_blockscan.h"
+#include "buds_mmap.h"
+#include "buds_tagger.h"
+#include "buds_threadpool.h"
+#include "buds_tx.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+static std::vector<std::uint8_t> fromHex(const std::string& hex) {
+    std::vector<std::uint8_t> out;
+    for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+        out.push_back(static_cast<std::uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    }
+    return out;
+}
+
+// Same fixture as test_buds_tx: outputs [P2PKH, OP_RETURN "ok"], two witness items.
+static const char* kSegwitTx =
+    "02000000000101000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "0100000000fdffffff02e8030000000000001976a91400112233445566778899aabbccddeeff00"
+    "11223388ac0000000000000000046a026f6b020a3031323334353637383903010203"
+    "00000000";
+
+static void putLE32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+// Block with a zero merkle root (not checked) holding `txCount` copies of kSegwitTx.
+static std::vector<std::uint8_t> makeBlock(const Hash256& prev, std::uint32_t time, std::uint8_t txCount) {
+    std::vector<std::uint8_t> block;
+    putLE32(block, 4);
+    block.insert(block.end(), prev.bytes.begin(), prev.bytes.end());
+    block.insert(block.end(), 32, 0);
+    putLE32(block, time);
+    putLE32(block, 0x1d00ffff);
+    putLE32(block, 0);
+    block.push_back(txCount);
+    std::vector<std::uint8_t> tx = fromHex(kSegwitTx);
+    for (std::uint8_t i = 0; i < txCount; ++i) block.insert(block.end(), tx.begin(), tx.end());
+    return block;
+}
+
+static Hash256 blockHash(const std::vector<std::uint8_t>& block) {
+    return sha256d(ByteSpan(block.data(), 80));
+}
+
+static void appendRecord(std::vector<std::uint8_t>& file, const std::vector<std::uint8_t>& block) {
+    putLE32(file, 0xd9b4bef9);
+    putLE32(file, static_cast<std::uint32_t>(block.size()));
+    file.insert(file.end(), block.begin(), block.end());
+}
+
+static void writeFile(const std::filesystem::path& path, std::vector<std::uint8_t> bytes,
+                      const std::uint8_t* key) {
+    if (key) {
+        for (std::size_t i = 0; i < bytes.size(); ++i) bytes[i] ^= key[i % 8];
+    }
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+// --- Tests ---
+
+static bool test_scan_out_of_order_and_resume() {
+    std::cout << "[TEST] scan obfuscated blk files out of order, then resume\n";
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "buds_blockscan_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    const std::uint8_t key[8] = {0x5a, 0x01, 0xff, 0x10, 0x22, 0x00, 0x80, 0x7e};
+    writeFile(dir / "xor.dat", std::vector<std::uint8_t>(key, key + 8), nullptr);
+
+    std::vector<std::uint8_t> b0 = makeBlock(Hash256{}, 1000, 1);
+    std::vector<std::uint8_t> b1 = makeBlock(blockHash(b0), 1001, 2);
+    std::vector<std::uint8_t> b2 = makeBlock(blockHash(b1), 1002, 3);
+    std::vector<std::uint8_t> b3 = makeBlock(blockHash(b2), 1003, 1);
+
+    // blk00000: children before parents, a junk byte run and a truncated record
+    // in between, and a zero-filled pre-allocated tail.
+    std::vector<std::uint8_t> file0;
+    appendRecord(file0, b2);
+    file0.insert(file0.end(), {0x01, 0x02, 0x03});
+    appendRecord(file0, b0);
+    putLE32(file0, 0xd9b4bef9);
+    putLE32(file0, 81);
+    file0.insert(file0.end(), 81, 0xee); // parses as nothing
+    appendRecord(file0, b1);
+    file0.insert(file0.end(), 64, 0);
+    writeFile(dir / "blk00000.dat", file0, key);
+
+    TagEngine engine;
+    ThreadPool pool(2);
+    ScanOptions options;
+    options.blocksDir = dir.string();
+    options.checkpointPath = (dir / "scan.ckpt").string();
+
+    std::vector<BlockStats> seen;
+    {
+        BlockScanner scanner(engine, pool, options);
+        ASSERT_TRUE(scanner.nextFile() == 0);
+        ScanSummary summary = scanner.run([&](const BlockStats& s) { seen.push_back(s); },
+                                          [&] { return static_cast<std::uint64_t>(seen.size()); });
+        ASSERT_TRUE(summary.files == 1);
+        ASSERT_TRUE(summary.blocks == 3);
+        ASSERT_TRUE(summary.txs == 6);
+        ASSERT_TRUE(summary.malformed == 1);
+        ASSERT_TRUE(summary.unlinked == 0);
+    }
+    ASSERT_TRUE(seen.size() == 3);
+    // b2 waits for b1, so emission order is b0, b1, b2.
+    for (std::uint32_t h = 0; h < 3; ++h) {
+        ASSERT_TRUE(seen[h].height == h);
+        ASSERT_TRUE(seen[h].txCount == h + 1);
+        ASSERT_TRUE(seen[h].time == 1000 + h);
+    }
+    ASSERT_TRUE(seen[2].hash == blockHash(b2));
+    ASSERT_TRUE(seen[2].size == b2.size());
+
+    // Each tx has four regions; the counts match single-tx classification.
+    Summary single = engine.summarizeTiers(engine.classify(ByteSpan(fromHex(kSegwitTx))));
+    ASSERT_TRUE(seen[1].regions.T0 == 2 * single.counts.T0);
+    ASSERT_TRUE(seen[1].regions.T3 == 2 * single.counts.T3);
+    ASSERT_TRUE(seen[1].regions.T0 + seen[1].regions.T1 + seen[1].regions.T2 + seen[1].regions.T3 == 8);
+    Tier tier = engine.arbdaTier(single.counts);
+    ASSERT_TRUE(seen[2].arbda[static_cast<std::size_t>(tier)] == 3);
+
+    // A second file appears; a fresh scanner resumes after blk00000.
+    std::vector<std::uint8_t> file1;
+    appendRecord(file1, b3);
+    writeFile(dir / "blk00001.dat", file1, key);
+
+    seen.clear();
+    {
+        BlockScanner scanner(engine, pool, options);
+        ASSERT_TRUE(scanner.nextFile() == 1);
+        ASSERT_TRUE(scanner.resumeToken() == 3);
+        ScanSummary summary = scanner.run([&](const BlockStats& s) { seen.push_back(s); });
+        ASSERT_TRUE(summary.files == 1);
+        ASSERT_TRUE(summary.blocks == 1);
+    }
+    ASSERT_TRUE(seen.size() == 1);
+    ASSERT_TRUE(seen[0].height == 3);
+    ASSERT_TRUE(seen[0].hash == blockHash(b3));
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+static bool test_scan_keep_tags() {
+    std::cout << "[TEST] scan with keepTags / keepTxs returns every region and tx\n";
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "buds_blockscan_tags";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::vector<std::uint8_t> b0 = makeBlock(Hash256{}, 1000, 2);
+    std::vector<std::uint8_t> b1 = makeBlock(blockHash(b0), 1001, 3);
+    std::vector<std::uint8_t> file0;
+    appendRecord(file0, b1);
+    appendRecord(file0, b0);
+    writeFile(dir / "blk00000.dat", file0, nullptr);
+
+    TagEngine engine;
+    ThreadPool pool(2);
+    ScanOptions options;
+    options.blocksDir = dir.string();
+    std::vector<BlockStats> plain, tagged;
+    BlockScanner(engine, pool, options).run([&](const BlockStats& s) { plain.push_back(s); });
+    options.keepTags = true;
+    options.keepTxs = true;
+    BlockScanner(engine, pool, options).run([&](const BlockStats& s) { tagged.push_back(s); });
+
+    std::vector<std::uint8_t> raw = fromHex(kSegwitTx);
+    Classification single = engine.classify(ByteSpan(raw));
+    TxView view;
+    ASSERT_TRUE(parseTx(ByteSpan(raw), view));
+    CompactClassification compact;
+    engine.classifyCompact(view, compact);
+    ASSERT_TRUE(plain.size() == 2 && tagged.size() == 2);
+    for (std::size_t i = 0; i < 2; ++i) {
+        ASSERT_TRUE(plain[i].tags.empty());
+        ASSERT_TRUE(tagged[i].height == plain[i].height);
+        ASSERT_TRUE(tagged[i].tags.size() == single.tags.size() * tagged[i].txCount);
+        ASSERT_TRUE(tagged[i].regions.T0 == plain[i].regions.T0);
+        ASSERT_TRUE(tagged[i].regions.T3 == plain[i].regions.T3);
+        ASSERT_TRUE(tagged[i].arbda == plain[i].arbda);
+        ASSERT_TRUE(tagged[i].tags.back().labels == single.tags.back().labels);
+        ASSERT_TRUE(plain[i].txs.empty());
+        ASSERT_TRUE(tagged[i].txs.size() == tagged[i].txCount);
+        for (const auto& tx : tagged[i].txs) {
+            ASSERT_TRUE(tx.height == tagged[i].height);
+            ASSERT_TRUE(tx.txid.toHex() == single.txid);
+            ASSERT_TRUE(tx.arbda == engine.arbdaTier(engine.summarizeTiers(single).counts));
+            // Digest read off the kept tags matches a standalone classifyCompact.
+            ASSERT_TRUE(tx.compact.labelCount == compact.labelCount && tx.compact.labels == compact.labels);
+            ASSERT_TRUE(tx.compact.counts.T0 == compact.counts.T0 && tx.compact.counts.T3 == compact.counts.T3);
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+static bool test_parse_block() {
+    std::cout << "[TEST] parse block in place\n";
+
+    std::vector<std::uint8_t> block = makeBlock(Hash256{}, 1234, 2);
+    BlockView view;
+    ASSERT_TRUE(parseBlock(block, view));
+    ASSERT_TRUE(view.txs.size() == 2);
+    ASSERT_TRUE(view.time() == 1234);
+    ASSERT_TRUE(view.prevHash() == Hash256{});
+    ASSERT_TRUE(view.txs[1].txid().toHex() ==
+                "ff2d8536ff0e9e9f969d2290a1a65de85933092a06a0bb2e0849b2a2a12010b9");
+
+    block.push_back(0);
+    ASSERT_TRUE(!parseBlock(block, view));
+    block.pop_back();
+    block[80] = 200; // more transactions than bytes could hold
+    ASSERT_TRUE(!parseBlock(block, view));
+
+    return true;
+}
+
+static bool test_xor_decode() {
+    std::cout << "[TEST] word-at-a-time de-XOR matches the byte loop at any phase\n";
+
+    const std::uint8_t key[8] = {0x5a, 0x01, 0xff, 0x10, 0x22, 0x00, 0x80, 0x7e};
+    std::vector<std::uint8_t> file(301);
+    for (std::size_t i = 0; i < file.size(); ++i) file[i] = static_cast<std::uint8_t>(i * 37 + 11);
+    for (std::size_t offset : {0, 1, 5, 8, 13}) {
+        for (std::size_t n : {0, 3, 8, 17, 250}) {
+            std::vector<std::uint8_t> out(n);
+            xorDecode(out.data(), file.data() + offset, n, key, offset);
+            for (std::size_t i = 0; i < n; ++i) {
+                ASSERT_TRUE(out[i] == (file[offset + i] ^ key[(offset + i) % 8]));
+            }
+        }
+    }
+    std::vector<std::uint8_t> inPlace = file;
+    xorDecode(inPlace.data(), inPlace.data(), inPlace.size(), key, 0);
+    xorDecode(inPlace.data(), inPlace.data(), inPlace.size(), key, 0);
+    ASSERT_TRUE(inPlace == file);
+    return true;
+}
+
+int main() {
+    if (!test_parse_block()) return 1;
+    if (!test_xor_decode()) return 1;
+    if (!test_scan_out_of_order_and_resume()) return 1;
+    if (!test_scan_keep_tags()) return 1;
+
+    std::cout << "All BUDS block scanner tests passed.\n";
+    return 0;
+}
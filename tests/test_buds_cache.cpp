@@ -0,0 +1,216 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buds_cache.h"
+#include "buds_tagger.h"
+#include "buds_tx.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+static std::vector<std::uint8_t> fromHex(const std::string& hex) {
+    std::vector<std::uint8_t> out;
+    for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+        out.push_back(static_cast<std::uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    }
+    return out;
+}
+
+// Same fixture as test_buds_tx: outputs [P2PKH, OP_RETURN "ok"], two witness items.
+static const char* kSegwitTx =
+    "02000000000101000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "0100000000fdffffff02e8030000000000001976a91400112233445566778899aabbccddeeff00"
+    "11223388ac0000000000000000046a026f6b020a3031323334353637383903010203"
+    "00000000";
+
+// `count` distinct transactions: the fixture with its prevout txid varied.
+static std::vector<std::vector<std::uint8_t>> makeTxs(std::size_t count) {
+    std::vector<std::vector<std::uint8_t>> txs;
+    std::vector<std::uint8_t> base = fromHex(kSegwitTx);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::vector<std::uint8_t> tx = base;
+        tx[7] = static_cast<std::uint8_t>(i);
+        tx[8] = static_cast<std::uint8_t>(i >> 8);
+        txs.push_back(tx);
+    }
+    return txs;
+}
+
+static bool sameEvaluation(const Evaluation& a, const Evaluation& b) {
+    return a.counts.T0 == b.counts.T0 && a.counts.T1 == b.counts.T1 &&
+           a.counts.T2 == b.counts.T2 && a.counts.T3 == b.counts.T3 &&
+           a.arbda == b.arbda && a.policy.mult == b.policy.mult &&
+           a.policy.boostSum == b.policy.boostSum && a.policy.required == b.policy.required &&
+           a.policy.score == b.policy.score;
+}
+
+// --- Tests ---
+
+static bool test_hit_miss_and_profile_change() {
+    std::cout << "[TEST] cache hits reuse digests; policy follows the profile\n";
+
+    std::vector<std::uint8_t> raw = fromHex(kSegwitTx);
+    TxView view;
+    ASSERT_TRUE(parseTx(raw, view));
+
+    TagEngine engine;
+    ClassificationCache cache(1 << 20, 4);
+
+    Evaluation first = cache.evaluate(engine, view, 1.0, 4.0);
+    Evaluation second = cache.evaluate(engine, view, 1.0, 4.0);
+    ASSERT_TRUE(sameEvaluation(first, engine.evaluate(view, 1.0, 4.0)));
+    ASSERT_TRUE(sameEvaluation(first, second));
+
+    CacheStats s = cache.stats();
+    ASSERT_TRUE(s.misses == 1 && s.hits == 1 && s.insertions == 1 && s.entries == 1);
+    ASSERT_TRUE(s.capacity > 0 && s.bytes <= (1u << 20));
+
+    // Switching profile changes policy without touching the cached entry.
+    engine.setPolicyProfile(PolicyProfile::Strict);
+    Evaluation strict = cache.evaluate(engine, view, 1.0, 4.0);
+    ASSERT_TRUE(sameEvaluation(strict, engine.evaluate(view, 1.0, 4.0)));
+    ASSERT_TRUE(strict.policy.mult != first.policy.mult);
+    ASSERT_TRUE(cache.stats().hits == 2);
+
+    ASSERT_TRUE(cache.erase(view.wtxid()));
+    ASSERT_TRUE(!cache.erase(view.wtxid()));
+    CompactClassification c;
+    ASSERT_TRUE(!cache.lookup(view.wtxid(), engine.config()->generation, c));
+
+    return true;
+}
+
+static bool test_registry_reload_invalidates() {
+    std::cout << "[TEST] registry reload and new configs invalidate cached classifications\n";
+
+    std::vector<std::uint8_t> raw = fromHex(kSegwitTx);
+    TxView view;
+    ASSERT_TRUE(parseTx(raw, view));
+
+    TagEngine engine;
+    ClassificationCache cache(1 << 20, 4);
+    Evaluation before = cache.evaluate(engine, view, 1.0, 4.0);
+    ASSERT_TRUE(sameEvaluation(before, engine.evaluate(view, 1.0, 4.0)));
+    std::uint64_t oldGeneration = engine.config()->generation;
+
+    // Moving pay.standard (and, unlisted, every other label) to T3 changes
+    // the tier counts of the same wtxid.
+    Registry registry;
+    ASSERT_TRUE(Registry::fromJson(
+        "{\"version\": 2, \"labels\": [{\"label\": \"pay.standard\", \"suggested_tier\": \"T3\"}]}",
+        registry));
+    engine.setRegistry(registry);
+    ASSERT_TRUE(engine.config()->generation != oldGeneration);
+    Evaluation after = cache.evaluate(engine, view, 1.0, 4.0);
+    Evaluation fresh = engine.evaluate(view, 1.0, 4.0);
+    ASSERT_TRUE(sameEvaluation(after, fresh));
+    ASSERT_TRUE(after.counts.T3 != before.counts.T3);
+    ASSERT_TRUE(cache.stats().misses == 2);
+
+    CompactClassification c;
+    ASSERT_TRUE(!cache.lookup(view.wtxid(), oldGeneration, c));
+    ASSERT_TRUE(cache.lookup(view.wtxid(), engine.config()->generation, c));
+    ASSERT_TRUE(cache.stats().entries == 1);
+
+    // setConfig publishes new rules too, even with identical settings.
+    EngineConfig same = *engine.config();
+    engine.setConfig(same);
+    cache.evaluate(engine, view, 1.0, 4.0);
+    ASSERT_TRUE(cache.stats().misses == 4);
+
+    // Two engines never share a generation.
+    TagEngine other;
+    ASSERT_TRUE(other.config()->generation != engine.config()->generation);
+
+    return true;
+}
+
+static bool test_clock_eviction() {
+    std::cout << "[TEST] CLOCK eviction respects the budget and second chances\n";
+
+    std::vector<std::vector<std::uint8_t>> txs = makeTxs(100);
+    std::vector<TxView> views(txs.size());
+    for (std::size_t i = 0; i < txs.size(); ++i) ASSERT_TRUE(parseTx(txs[i], views[i]));
+
+    TagEngine engine;
+    ClassificationCache cache(16 * ClassificationCache::bytesPerEntry(), 1);
+    ASSERT_TRUE(cache.capacity() == 16);
+
+    const Hash256 hot = views[0].wtxid();
+    const std::uint64_t gen = engine.config()->generation;
+    CompactClassification c;
+    for (std::size_t i = 0; i < views.size(); ++i) {
+        cache.evaluate(engine, views[i], 1.0, 1.0);
+        ASSERT_TRUE(cache.lookup(hot, gen, c)); // keeps the hot entry referenced
+    }
+
+    CacheStats s = cache.stats();
+    ASSERT_TRUE(s.entries == 16);
+    ASSERT_TRUE(s.insertions == 100);
+    ASSERT_TRUE(s.evictions == 100 - 16);
+    ASSERT_TRUE(!cache.lookup(views[1].wtxid(), gen, c));
+    ASSERT_TRUE(cache.lookup(views[99].wtxid(), gen, c));
+
+    cache.clear();
+    ASSERT_TRUE(cache.stats().entries == 0);
+    ASSERT_TRUE(!cache.lookup(hot, gen, c));
+
+    return true;
+}
+
+static bool test_concurrent_evaluate() {
+    std::cout << "[TEST] concurrent evaluate through shared cache\n";
+
+    std::vector<std::vector<std::uint8_t>> txs = makeTxs(300);
+    std::vector<TxView> views(txs.size());
+    for (std::size_t i = 0; i < txs.size(); ++i) ASSERT_TRUE(parseTx(txs[i], views[i]));
+
+    TagEngine engine;
+    // Smaller than the working set so eviction runs concurrently too.
+    ClassificationCache cache(128 * ClassificationCache::bytesPerEntry(), 8);
+    Evaluation expected = engine.evaluate(views[0], 1.0, 2.0);
+
+    const int kThreads = 4;
+    const int kRounds = 5;
+    std::vector<int> mismatches(kThreads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int r = 0; r < kRounds; ++r) {
+                for (std::size_t i = 0; i < views.size(); ++i) {
+                    Evaluation e = cache.evaluate(engine, views[(i + t * 37) % views.size()], 1.0, 2.0);
+                    if (!sameEvaluation(e, expected)) ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    for (int m : mismatches) ASSERT_TRUE(m == 0);
+    CacheStats s = cache.stats();
+    ASSERT_TRUE(s.hits + s.misses == static_cast<std::uint64_t>(kThreads * kRounds) * views.size());
+    ASSERT_TRUE(s.entries <= s.capacity);
+
+    return true;
+}
+
+int main() {
+    if (!test_hit_miss_and_profile_change()) return 1;
+    if (!test_registry_reload_invalidates()) return 1;
+    if (!test_clock_eviction()) return 1;
+    if (!test_concurrent_evaluate()) return 1;
+
+    std::cout << "All BUDS cache tests passed.\n";
+    return 0;
+}
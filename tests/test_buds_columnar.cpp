@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buds_columnar.h"
+#include "buds_tagger.h"
+#include "buds_threadpool.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+struct Row {
+    std::uint32_t height;
+    Tag tag;
+};
+
+// Tags drawn from a handful of label sets, heights mostly ascending with a
+// few steps back (as a reorg would produce), and a few inverted ranges.
+static std::vector<Row> makeRows(std::size_t count, std::uint32_t seed) {
+    static const LabelId kSets[][2] = {
+        {label::PayStandard, kInvalidLabel},
+        {label::ConsensusSig, kInvalidLabel},
+        {label::DaOpReturnEmbed, label::MetaIndexerHint},
+        {label::DaUnknown, label::DaUnregisteredVendor},
+        {label::MetaInscription, label::DaEmbedMisc},
+    };
+    std::mt19937 rng(seed);
+    std::vector<Row> rows;
+    std::uint32_t height = 100;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (rng() % 8 == 0) height += 1;
+        if (rng() % 500 == 0) height -= 3;
+        Row r{height, Tag()};
+        const LabelId* set = kSets[rng() % 5];
+        r.tag.labels.insert(set[0]);
+        if (set[1] != kInvalidLabel) r.tag.labels.insert(set[1]);
+        r.tag.start = rng() % 50;
+        r.tag.end = r.tag.start + rng() % 300;
+        if (rng() % 97 == 0) std::swap(r.tag.start, r.tag.end);
+        rows.push_back(r);
+    }
+    return rows;
+}
+
+static ColumnAggregate bruteForce(const std::vector<Row>& rows, const Registry& registry,
+                                  const ColumnQuery& q) {
+    ColumnAggregate out;
+    for (const auto& r : rows) {
+        Tier worst = Tier::T0;
+        for (LabelId l : r.tag.labels) {
+            if (registry.tier(l) > worst) worst = registry.tier(l);
+        }
+        if (r.height < q.minHeight || r.height > q.maxHeight || worst < q.minTier) continue;
+        std::uint64_t bytes = r.tag.end >= r.tag.start ? r.tag.end - r.tag.start : 0;
+        ++out.regions;
+        out.bytes += bytes;
+        for (LabelId l : r.tag.labels) {
+            ++out.tiers[static_cast<std::size_t>(registry.tier(l))];
+            ++out.labelRegions[l];
+            out.labelBytes[l] += bytes;
+        }
+    }
+    return out;
+}
+
+static bool sameTotals(const ColumnAggregate& a, const ColumnAggregate& b) {
+    return a.regions == b.regions && a.bytes == b.bytes && a.tiers == b.tiers &&
+           a.labelRegions == b.labelRegions && a.labelBytes == b.labelBytes;
+}
+
+// --- Tests ---
+
+static bool test_columnar_round_trip() {
+    std::cout << "[TEST] columnar write / aggregate matches a brute-force scan\n";
+
+    std::string path = (std::filesystem::temp_directory_path() / "buds_columnar_test.col").string();
+    Registry registry;
+    std::vector<Row> rows = makeRows(20000, 7);
+    {
+        ColumnarWriter writer(registry, 1000);
+        ASSERT_TRUE(writer.open(path));
+        // Group consecutive rows of one height into a single append, as a block sink does.
+        std::size_t i = 0;
+        std::vector<Tag> tags;
+        while (i < rows.size()) {
+            tags.clear();
+            std::uint32_t h = rows[i].height;
+            while (i < rows.size() && rows[i].height == h) tags.push_back(rows[i++].tag);
+            writer.append(h, tags.data(), tags.size());
+        }
+        ASSERT_TRUE(writer.rows() == rows.size());
+        ASSERT_TRUE(writer.close());
+    }
+
+    ColumnarReader reader;
+    std::string error;
+    ASSERT_TRUE(reader.open(path, &error));
+    ASSERT_TRUE(reader.rows() == rows.size());
+    ASSERT_TRUE(reader.chunkCount() == 20);
+    ASSERT_TRUE(reader.minHeight() <= 100);
+    ASSERT_TRUE(reader.tierForLabel(label::DaUnknown) == registry.tier(label::DaUnknown));
+
+    ThreadPool pool(3);
+    std::uint32_t top = reader.maxHeight();
+    const ColumnQuery queries[] = {
+        ColumnQuery(),
+        ColumnQuery{0, top / 2, Tier::T0},
+        ColumnQuery{top / 3, top / 3 + 400, Tier::T0},
+        ColumnQuery{0, UINT32_MAX, Tier::T3},
+        ColumnQuery{top / 2, top, Tier::T2},
+        ColumnQuery{top + 1, UINT32_MAX, Tier::T0},
+    };
+    for (const auto& q : queries) {
+        ColumnAggregate expect = bruteForce(rows, registry, q);
+        ColumnAggregate got = reader.aggregate(q);
+        ASSERT_TRUE(sameTotals(got, expect));
+        ASSERT_TRUE(got.chunksRead + got.chunksSkipped == reader.chunkCount());
+        ASSERT_TRUE(sameTotals(reader.aggregate(q, pool), expect));
+    }
+
+    // A narrow range touches only the chunks around it.
+    ColumnAggregate narrow = reader.aggregate(ColumnQuery{top / 3, top / 3, Tier::T0});
+    ASSERT_TRUE(narrow.regions > 0);
+    ASSERT_TRUE(narrow.chunksSkipped >= reader.chunkCount() - 3);
+    ColumnAggregate none = reader.aggregate(ColumnQuery{top + 1, UINT32_MAX, Tier::T0});
+    ASSERT_TRUE(none.chunksRead == 0);
+
+    std::remove(path.c_str());
+    return true;
+}
+
+static bool test_columnar_rejects_damage() {
+    std::cout << "[TEST] columnar reader rejects truncated or foreign files\n";
+
+    std::string path = (std::filesystem::temp_directory_path() / "buds_columnar_bad.col").string();
+    {
+        ColumnarWriter writer(Registry(), 64);
+        ASSERT_TRUE(writer.open(path));
+        std::vector<Row> rows = makeRows(300, 3);
+        for (const auto& r : rows) writer.append(r.height, &r.tag, 1);
+    } // destructor finishes the file
+
+    std::vector<char> good;
+    {
+        std::ifstream in(path, std::ios::binary);
+        good.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    ColumnarReader reader;
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_TRUE(reader.rows() == 300);
+    ASSERT_TRUE(reader.chunkCount() == 5);
+
+    auto rewrite = [&](const std::vector<char>& bytes) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    };
+    std::string error;
+
+    // Truncated: the trailer is gone.
+    rewrite(std::vector<char>(good.begin(), good.end() - 5));
+    ASSERT_TRUE(!reader.open(path, &error));
+
+    // A label renamed in the footer vocabulary.
+    std::vector<char> bad = good;
+    std::string name = labelName(label::PayStandard);
+    auto at = std::search(bad.begin(), bad.end(), name.begin(), name.end());
+    ASSERT_TRUE(at != bad.end());
+    *at = 'P';
+    rewrite(bad);
+    ASSERT_TRUE(!reader.open(path, &error));
+    ASSERT_TRUE(error == "label vocabulary mismatch");
+
+    // Footer offset pointing past the end.
+    bad = good;
+    bad[bad.size() - 16] = static_cast<char>(0xff);
+    bad[bad.size() - 10] = static_cast<char>(0x7f);
+    rewrite(bad);
+    ASSERT_TRUE(!reader.open(path, &error));
+
+    std::remove(path.c_str());
+    return true;
+}
+
+int main() {
+    if (!test_columnar_round_trip()) return 1;
+    if (!test_columnar_rejects_damage()) return 1;
+
+    std::cout << "All BUDS columnar tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buds_entropy.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+static std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static std::vector<std::uint8_t> randomBytes(std::size_t n, std::uint32_t& seed) {
+    std::vector<std::uint8_t> out(n);
+    for (auto& b : out) b = static_cast<std::uint8_t>(nextRand(seed) >> 11);
+    return out;
+}
+
+// --- Tests ---
+
+static bool test_uniform_vs_structured() {
+    std::cout << "[TEST] entropy / chi-square separate random from structured bytes\n";
+
+    std::uint32_t seed = 0x7f4a7c15;
+    for (std::size_t n : {96u, 128u, 300u, 512u, 4096u, 60000u}) {
+        for (int trial = 0; trial < 20; ++trial) {
+            std::vector<std::uint8_t> data = randomBytes(n, seed);
+            ByteStats s = analyzeBytes(data);
+            ASSERT_TRUE(s.size == n && s.sampled == n);
+            ASSERT_TRUE(s.entropy <= 8.0 && s.entropy > 5.5);
+            ASSERT_TRUE(looksUniform(s));
+        }
+    }
+
+    std::string text;
+    while (text.size() < 2000) text += "BUDS labels witness regions for local policy decisions. ";
+    ByteStats s = analyzeBytes(ByteSpan(reinterpret_cast<const std::uint8_t*>(text.data()), text.size()));
+    ASSERT_TRUE(s.entropy < 5.0 && s.chiSquare > 1000.0 && !looksUniform(s));
+
+    std::vector<std::uint8_t> zeros(1000, 0);
+    s = analyzeBytes(zeros);
+    ASSERT_TRUE(s.entropy == 0.0 && s.distinct == 1 && !looksUniform(s));
+
+    // Twenty 32-byte keys with their push and CHECKSIGADD opcodes: high
+    // entropy, but the repeated opcodes push chi-square out of range.
+    std::vector<std::uint8_t> multisig;
+    for (int k = 0; k < 20; ++k) {
+        multisig.push_back(0x20);
+        std::vector<std::uint8_t> key = randomBytes(32, seed);
+        multisig.insert(multisig.end(), key.begin(), key.end());
+        multisig.push_back(k ? 0xba : 0xac);
+    }
+    s = analyzeBytes(multisig);
+    ASSERT_TRUE(s.entropy > 7.0 && !looksUniform(s));
+
+    // Too short to judge, however random.
+    std::vector<std::uint8_t> sig = randomBytes(72, seed);
+    ASSERT_TRUE(!looksUniform(analyzeBytes(sig)));
+    ASSERT_TRUE(analyzeBytes(ByteSpan()).sampled == 0);
+
+    return true;
+}
+
+static bool test_sampling_large_items() {
+    std::cout << "[TEST] large items are sampled at both ends\n";
+
+    std::uint32_t seed = 0x1b873593;
+    std::vector<std::uint8_t> big = randomBytes(400000, seed);
+    EntropyOptions options;
+    ByteStats s = analyzeBytes(big, options);
+    ASSERT_TRUE(s.size == 400000);
+    ASSERT_TRUE(s.sampled == options.sampleBlock * options.sampleBlocks);
+    ASSERT_TRUE(looksUniform(s, options));
+
+    // Structure in the sampled blocks shows up; the last block is included.
+    std::vector<std::uint8_t> tail = big;
+    std::fill(tail.end() - options.sampleBlock, tail.end(), 0x00);
+    ASSERT_TRUE(!looksUniform(analyzeBytes(tail, options), options));
+
+    // Sampling off: the whole item is histogrammed.
+    options.sampleAbove = big.size();
+    s = analyzeBytes(big, options);
+    ASSERT_TRUE(s.sampled == big.size() && looksUniform(s, options));
+
+    return true;
+}
+
+int main() {
+    if (!test_uniform_vs_structured()) return 1;
+    if (!test_sampling_large_items()) return 1;
+
+    std::cout << "All BUDS entropy tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buds_hex.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+// Small deterministic generator so failures are reproducible.
+static std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// --- Tests ---
+
+static bool test_decode_matches_scalar() {
+    std::cout << "[TEST] hexDecode (" << hexKernelName() << ") matches scalar\n";
+
+    static const char alphabet[] = "0123456789abcdefABCDEF";
+    std::uint32_t seed = 0x12345678;
+
+    for (std::size_t len = 0; len < 300; ++len) {
+        std::string hex(len, '0');
+        for (auto& ch : hex) ch = alphabet[nextRand(seed) % 22];
+        // Sprinkle invalid digits into some inputs.
+        if (len > 0 && len % 7 == 0) hex[nextRand(seed) % len] = 'x';
+
+        std::vector<std::uint8_t> fast(len / 2 + 1), slow(len / 2 + 1);
+        std::size_t nFast = hexDecode(hex.data(), hex.size(), fast.data());
+        std::size_t nSlow = hexDecodeScalar(hex.data(), hex.size(), slow.data());
+        ASSERT_TRUE(nFast == nSlow);
+        for (std::size_t i = 0; i < nSlow; ++i) ASSERT_TRUE(fast[i] == slow[i]);
+    }
+
+    std::uint8_t out[4];
+    ASSERT_TRUE(hexDecode("6A026f6b", 8, out) == 4);
+    ASSERT_TRUE(out[0] == 0x6a && out[1] == 0x02 && out[2] == 0x6f && out[3] == 0x6b);
+    ASSERT_TRUE(hexDecode("zz41", 4, out) == 1 && out[0] == 0x41);
+    ASSERT_TRUE(hexDecode("414", 3, out) == 1);
+
+    return true;
+}
+
+static bool test_count_printable() {
+    std::cout << "[TEST] countPrintable matches scalar\n";
+
+    std::uint32_t seed = 0x9e3779b9;
+    // Cross the 255-iteration flush boundary of the vector accumulators.
+    for (std::size_t len : {0u, 1u, 15u, 16u, 31u, 33u, 4096u, 8161u, 70000u}) {
+        std::vector<std::uint8_t> data(len);
+        for (auto& b : data) b = static_cast<std::uint8_t>(nextRand(seed));
+        ASSERT_TRUE(countPrintable(data.data(), len) == countPrintableScalar(data.data(), len));
+    }
+
+    std::vector<std::uint8_t> ascii(10000, 'A');
+    ASSERT_TRUE(countPrintable(ascii.data(), ascii.size()) == ascii.size());
+    std::vector<std::uint8_t> edges = {0x1f, 0x20, 0x7e, 0x7f, 0x80, 0xff};
+    ASSERT_TRUE(countPrintable(edges.data(), edges.size()) == 2);
+
+    return true;
+}
+
+static bool test_find_bytes() {
+    std::cout << "[TEST] findBytes matches std::search\n";
+
+    std::uint32_t seed = 0x2545f491;
+    for (std::size_t len : {0u, 5u, 63u, 64u, 65u, 100u, 1000u, 5000u}) {
+        // A three-letter alphabet produces many near-miss candidates.
+        std::vector<std::uint8_t> data(len);
+        for (auto& b : data) b = static_cast<std::uint8_t>(nextRand(seed) % 3);
+        for (std::size_t m = 1; m <= 9; ++m) {
+            for (int trial = 0; trial < 8; ++trial) {
+                std::vector<std::uint8_t> needle(m);
+                if (len >= m && trial % 2 == 0) {
+                    std::size_t at = nextRand(seed) % (len - m + 1);
+                    needle.assign(data.begin() + at, data.begin() + at + m);
+                } else {
+                    for (auto& b : needle) b = static_cast<std::uint8_t>(nextRand(seed) % 3);
+                }
+                auto it = std::search(data.begin(), data.end(), needle.begin(), needle.end());
+                const std::uint8_t* expect = it == data.end() ? nullptr : data.data() + (it - data.begin());
+                ASSERT_TRUE(findBytes(data.data(), len, needle.data(), m) == expect);
+                ASSERT_TRUE(findBytesScalar(data.data(), len, needle.data(), m) == expect);
+            }
+        }
+    }
+
+    // A match straddling the final vector block is still found.
+    std::vector<std::uint8_t> hay(200, 0xaa);
+    const std::uint8_t ord[] = {0x00, 0x63, 0x03, 0x6f, 0x72, 0x64};
+    std::copy(ord, ord + 6, hay.end() - 6);
+    ASSERT_TRUE(findBytes(hay.data(), hay.size(), ord, 6) == hay.data() + 194);
+
+    return true;
+}
+
+static bool test_byte_histogram() {
+    std::cout << "[TEST] byteHistogram matches scalar and accumulates\n";
+
+    std::uint32_t seed = 0x85ebca6b;
+    for (std::size_t len : {0u, 7u, 255u, 256u, 257u, 1001u, 65543u}) {
+        std::vector<std::uint8_t> data(len + 3);
+        for (auto& b : data) b = static_cast<std::uint8_t>(nextRand(seed) % (len % 2 ? 256 : 5));
+        // Misaligned start.
+        std::uint32_t fast[256] = {}, slow[256] = {};
+        byteHistogram(data.data() + 3, len, fast);
+        byteHistogramScalar(data.data() + 3, len, slow);
+        ASSERT_TRUE(std::equal(fast, fast + 256, slow));
+        byteHistogram(data.data() + 3, len, fast); // adds on top
+        for (std::size_t v = 0; v < 256; ++v) ASSERT_TRUE(fast[v] == 2 * slow[v]);
+    }
+
+    return true;
+}
+
+int main() {
+    if (!test_decode_matches_scalar()) return 1;
+    if (!test_count_printable()) return 1;
+    if (!test_find_bytes()) return 1;
+    if (!test_byte_histogram()) return 1;
+
+    std::cout << "All BUDS hex kernel tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "buds_mempool.h"
+#include "buds_tagger.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+static std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static Hash256 makeId(std::uint32_t n) {
+    Hash256 h;
+    for (int i = 0; i < 4; ++i) h.bytes[i] = static_cast<std::uint8_t>(n >> (8 * i));
+    h.bytes[31] = static_cast<std::uint8_t>(n * 7);
+    return h;
+}
+
+static MempoolEntry randomEntry(std::uint32_t n, std::uint32_t& seed) {
+    MempoolEntry e;
+    e.id = makeId(n);
+    e.vsize = 100 + nextRand(seed) % 5000;
+    e.feerate = 1.0 + (nextRand(seed) % 400) / 4.0;  // plenty of ties
+    e.arbda = static_cast<Tier>(nextRand(seed) % kTierCount);
+    e.policy.score = e.feerate * (0.5 + (nextRand(seed) % 3) * 0.25);
+    return e;
+}
+
+// --- Tests ---
+
+static bool test_index_matches_brute_force() {
+    std::cout << "[TEST] MempoolIndex aggregates and queries match a full scan\n";
+
+    MempoolIndex index;
+    std::map<std::uint32_t, MempoolEntry> model;
+    std::uint32_t seed = 0xc0ffee11;
+
+    for (int step = 0; step < 4000; ++step) {
+        std::uint32_t n = nextRand(seed) % 600;
+        std::uint32_t op = nextRand(seed) % 4;
+        if (op <= 1) {
+            MempoolEntry e = randomEntry(n, seed);
+            bool fresh = model.count(n) == 0;
+            ASSERT_TRUE(index.add(e) == fresh);
+            if (fresh) model[n] = e;
+        } else if (op == 2) {
+            ASSERT_TRUE(index.remove(makeId(n)) == (model.erase(n) == 1));
+        } else {
+            // RBF: replace n by a new transaction id n + 1000.
+            MempoolEntry e = randomEntry(n + 1000, seed);
+            bool ok = model.count(n + 1000) == 0;
+            ASSERT_TRUE(index.replace(makeId(n), e) == ok);
+            if (ok) {
+                model.erase(n);
+                model[n + 1000] = e;
+            }
+        }
+
+        if (step % 97 != 0) continue;
+
+        ASSERT_TRUE(index.size() == model.size());
+        TierTotals expect;
+        std::uint64_t total = 0;
+        std::vector<const MempoolEntry*> all;
+        for (const auto& kv : model) {
+            std::size_t t = static_cast<std::size_t>(kv.second.arbda);
+            ++expect.count[t];
+            expect.vbytes[t] += kv.second.vsize;
+            total += kv.second.vsize;
+            all.push_back(&kv.second);
+        }
+        ASSERT_TRUE(index.totals().count == expect.count);
+        ASSERT_TRUE(index.totals().vbytes == expect.vbytes);
+        ASSERT_TRUE(index.totalVbytes() == total);
+
+        // Top-k: compare the score sequence (ids may tie-break differently).
+        std::sort(all.begin(), all.end(), [](const MempoolEntry* a, const MempoolEntry* b) {
+            return a->policy.score > b->policy.score;
+        });
+        std::vector<const MempoolEntry*> top = index.topByScore(25);
+        ASSERT_TRUE(top.size() == std::min<std::size_t>(25, all.size()));
+        for (std::size_t i = 0; i < top.size(); ++i) {
+            ASSERT_TRUE(top[i]->policy.score == all[i]->policy.score);
+        }
+        std::vector<const MempoolEntry*> bottom = index.bottomByScore(5);
+        for (std::size_t i = 0; i < bottom.size(); ++i) {
+            ASSERT_TRUE(bottom[i]->policy.score == all[all.size() - 1 - i]->policy.score);
+        }
+
+        std::size_t cheapT3 = 0;
+        for (const auto& kv : model) {
+            cheapT3 += (kv.second.arbda == Tier::T3 && kv.second.feerate < 30.0) ? 1 : 0;
+        }
+        std::vector<const MempoolEntry*> below = index.belowFeerate(Tier::T3, 30.0);
+        ASSERT_TRUE(below.size() == cheapT3);
+        for (std::size_t i = 0; i < below.size(); ++i) {
+            ASSERT_TRUE(below[i]->arbda == Tier::T3 && below[i]->feerate < 30.0);
+            if (i) ASSERT_TRUE(below[i - 1]->feerate <= below[i]->feerate);
+        }
+        ASSERT_TRUE(index.belowFeerate(Tier::T3, 30.0, 3).size() == std::min<std::size_t>(3, cheapT3));
+    }
+
+    index.clear();
+    ASSERT_TRUE(index.empty() && index.totalVbytes() == 0);
+    ASSERT_TRUE(index.topByScore(10).empty());
+
+    return true;
+}
+
+static bool test_add_from_evaluation() {
+    std::cout << "[TEST] MempoolIndex::add from TagEngine::evaluate\n";
+
+    Tx tx;
+    tx.txid = "idx";
+    Witness w;
+    w.stack.push_back(WitnessItem{std::string(2000, '0')}); // 1000 zero bytes -> da.unknown (T3)
+    tx.witness.push_back(w);
+
+    TagEngine engine;
+    Evaluation e = engine.evaluate(tx, 1.0, 10.0);
+
+    MempoolIndex index;
+    Hash256 id = makeId(1);
+    ASSERT_TRUE(index.add(id, e, 400, 10.0));
+    ASSERT_TRUE(!index.add(id, e, 400, 10.0));
+    const MempoolEntry* found = index.find(id);
+    ASSERT_TRUE(found && found->arbda == Tier::T3);
+    ASSERT_TRUE(found->policy.score == e.policy.score);
+    ASSERT_TRUE(index.totals().vbytes[static_cast<std::size_t>(Tier::T3)] == 400);
+    ASSERT_TRUE(index.belowFeerate(Tier::T3, 10.0).empty());
+    ASSERT_TRUE(index.belowFeerate(Tier::T3, 10.5).size() == 1);
+
+    return true;
+}
+
+static bool test_rejects_non_finite_keys() {
+    std::cout << "[TEST] MempoolIndex rejects NaN / infinite feerate and score\n";
+
+    MempoolIndex index;
+    std::uint32_t seed = 0x5eed;
+    for (std::uint32_t n = 0; n < 50; ++n) ASSERT_TRUE(index.add(randomEntry(n, seed)));
+
+    const double zero = 0.0;
+    MempoolEntry bad = randomEntry(100, seed);
+    bad.feerate = 1000.0 / zero * zero;   // fee / vsize with vsize 0: NaN
+    ASSERT_TRUE(!index.add(bad));
+    bad.feerate = 1000.0 / zero;
+    ASSERT_TRUE(!index.add(bad));
+    bad.feerate = 5.0;
+    bad.policy.score = 0.0 / zero;
+    ASSERT_TRUE(!index.add(bad));
+    Evaluation eval;
+    eval.policy.score = 0.0 / zero;
+    ASSERT_TRUE(!index.add(makeId(101), eval, 100, 5.0));
+    ASSERT_TRUE(!index.replace(makeId(7), bad));   // the replaced entry stays
+    ASSERT_TRUE(index.size() == 50 && index.find(makeId(7)) && !index.find(makeId(100)));
+
+    // The ordered indexes stay consistent: every entry can still be removed.
+    for (std::uint32_t n = 0; n < 50; ++n) ASSERT_TRUE(index.remove(makeId(n)));
+    ASSERT_TRUE(index.empty() && index.topByScore(10).empty() && index.totalVbytes() == 0);
+    return true;
+}
+
+int main() {
+    if (!test_index_matches_brute_force()) return 1;
+    if (!test_add_from_evaluation()) return 1;
+    if (!test_rejects_non_finite_keys()) return 1;
+
+    std::cout << "All BUDS mempool index tests passed.\n";
+    return 0;
+}
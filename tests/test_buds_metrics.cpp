@@ -0,0 +1,181 @@
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buds_hex.h"
+#include "buds_metrics.h"
+#include "buds_tagger.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+// version 2, one input, outputs [P2PKH, OP_RETURN "ok"], witness ["0123456789", 010203]
+static const char* kSegwitTx =
+    "02000000000101000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "0100000000fdffffff02e8030000000000001976a91400112233445566778899aabbccddeeff00"
+    "11223388ac0000000000000000046a026f6b020a3031323334353637383903010203"
+    "00000000";
+
+static std::vector<std::uint8_t> fromHex(const std::string& hex) {
+    std::vector<std::uint8_t> out(hex.size() / 2);
+    out.resize(hexDecode(hex.data(), hex.size(), out.data()));
+    return out;
+}
+
+static std::size_t at(EntryPoint e) { return static_cast<std::size_t>(e); }
+static std::size_t at(Detector d) { return static_cast<std::size_t>(d); }
+static std::size_t at(Tier t) { return static_cast<std::size_t>(t); }
+
+// --- Tests ---
+
+static bool test_histogram_buckets() {
+    std::cout << "[TEST] latency histogram bucket bounds and quantiles\n";
+
+    for (std::uint64_t v = 0; v < 8; ++v) ASSERT_TRUE(LatencyHistogram::bucketFor(v) == v);
+    ASSERT_TRUE(LatencyHistogram::bucketFor(8) == 8);
+    ASSERT_TRUE(LatencyHistogram::bucketFor(~0ull) == LatencyHistogram::kBuckets - 1);
+
+    // Every value lies inside its bucket, and a bucket spans at most 1/8 of
+    // its lower bound.
+    for (std::uint64_t v = 1; v < (1ull << 39); v = v * 3 / 2 + 1) {
+        std::size_t b = LatencyHistogram::bucketFor(v);
+        ASSERT_TRUE(b < LatencyHistogram::kBuckets);
+        std::uint64_t low = LatencyHistogram::bucketLow(b);
+        std::uint64_t high = LatencyHistogram::bucketHigh(b);
+        ASSERT_TRUE(low <= v && v <= high);
+        ASSERT_TRUE((high - low) * 8 <= low);
+        if (b + 1 < LatencyHistogram::kBuckets) {
+            ASSERT_TRUE(LatencyHistogram::bucketLow(b + 1) == high + 1);
+        }
+    }
+
+    LatencyHistogram h;
+    ASSERT_TRUE(h.quantile(0.5) == 0);
+    for (std::uint64_t v = 1; v <= 1000; ++v) h.record(v * 1000);
+    ASSERT_TRUE(h.count() == 1000);
+    ASSERT_TRUE(h.sumNs() == 500500000ull);
+    ASSERT_TRUE(h.quantile(0.5) >= 500000 && h.quantile(0.5) <= 562500);
+    ASSERT_TRUE(h.quantile(0.99) >= 990000 && h.quantile(0.99) <= 1113750);
+    ASSERT_TRUE(h.quantile(1.0) >= 1000000);
+    ASSERT_TRUE(h.countBelow(1) == 0);
+    ASSERT_TRUE(h.countBelow(1ull << 40) == 1000);
+
+    LatencyHistogram other;
+    other.record(5);
+    other.merge(h);
+    ASSERT_TRUE(other.count() == 1001);
+    ASSERT_TRUE(other.quantile(0.0001) == 5);
+    return true;
+}
+
+static bool test_counters_across_threads() {
+    std::cout << "[TEST] label, tier, detector and call counters across threads\n";
+
+    TagEngine engine;
+    std::vector<std::uint8_t> raw = fromHex(kSegwitTx);
+    MetricsSnapshot before = metricsSnapshot();
+
+    Classification c;
+    engine.classify(ByteSpan(raw), c);
+    Evaluation e = engine.evaluate(ByteSpan(raw), 1.0, 5.0);
+    ASSERT_TRUE(e.arbda == Tier::T3);
+    ASSERT_TRUE(engine.triage(ByteSpan(raw)).arbda == Tier::T3);
+    // A thread that exits before the snapshot still counts.
+    std::thread([&] { engine.classify(ByteSpan(raw)); }).join();
+
+    MetricsSnapshot after = metricsSnapshot();
+    if (!kMetricsEnabled) {
+        for (std::size_t e2 = 0; e2 < kEntryPointCount; ++e2) ASSERT_TRUE(after.calls[e2] == 0);
+        ASSERT_TRUE(after.labels[label::PayStandard] == 0);
+        return true;
+    }
+
+    auto delta = [](std::uint64_t a, std::uint64_t b) { return a - b; };
+    ASSERT_TRUE(delta(after.calls[at(EntryPoint::Classify)], before.calls[at(EntryPoint::Classify)]) == 2);
+    ASSERT_TRUE(delta(after.calls[at(EntryPoint::Evaluate)], before.calls[at(EntryPoint::Evaluate)]) == 1);
+    ASSERT_TRUE(delta(after.calls[at(EntryPoint::Triage)], before.calls[at(EntryPoint::Triage)]) == 1);
+    // Three classifications (two classify, one evaluate) of four regions.
+    ASSERT_TRUE(delta(after.labels[label::PayStandard], before.labels[label::PayStandard]) == 3);
+    ASSERT_TRUE(delta(after.labels[label::MetaIndexerHint], before.labels[label::MetaIndexerHint]) == 3);
+    ASSERT_TRUE(delta(after.labels[label::DaUnregisteredVendor], before.labels[label::DaUnregisteredVendor]) == 3);
+    ASSERT_TRUE(delta(after.labels[label::DaUnknown], before.labels[label::DaUnknown]) == 3);
+    ASSERT_TRUE(delta(after.tiers[at(Tier::T1)], before.tiers[at(Tier::T1)]) == 3);
+    ASSERT_TRUE(delta(after.tiers[at(Tier::T3)], before.tiers[at(Tier::T3)]) == 6);
+    ASSERT_TRUE(delta(after.arbda[at(Tier::T3)], before.arbda[at(Tier::T3)]) == 2);
+    ASSERT_TRUE(delta(after.detectorCalls[at(Detector::ScriptTemplate)],
+                      before.detectorCalls[at(Detector::ScriptTemplate)]) == 6);
+    ASSERT_TRUE(delta(after.detectorBytes[at(Detector::ScriptTemplate)],
+                      before.detectorBytes[at(Detector::ScriptTemplate)]) == 3 * (25 + 4));
+    ASSERT_TRUE(after.detectorCalls[at(Detector::OrdinalEnvelope)] >
+                before.detectorCalls[at(Detector::OrdinalEnvelope)]);
+    // Each thread times its first call.
+    ASSERT_TRUE(after.latency[at(EntryPoint::Classify)].count() > before.latency[at(EntryPoint::Classify)].count());
+    return true;
+}
+
+static bool test_prometheus_export() {
+    std::cout << "[TEST] Prometheus text export to a string and a file\n";
+
+    TagEngine engine;
+    std::vector<std::uint8_t> raw = fromHex(kSegwitTx);
+    engine.evaluate(ByteSpan(raw), 1.0, 5.0);
+
+    std::string text = metricsSnapshot().toPrometheus();
+    ASSERT_TRUE(text.find("# TYPE buds_labels_total counter\n") != std::string::npos);
+    ASSERT_TRUE(text.find("buds_labels_total{label=\"meta.indexer_hint\"} ") != std::string::npos);
+    ASSERT_TRUE(text.find("# TYPE buds_call_duration_seconds histogram\n") != std::string::npos);
+    ASSERT_TRUE(text.find("buds_call_duration_seconds_bucket{entry=\"evaluate\",le=\"+Inf\"} ") !=
+                std::string::npos);
+    ASSERT_TRUE(text.find("buds_detector_bytes_total{detector=\"entropy\"} ") != std::string::npos);
+    ASSERT_TRUE(text.find(kMetricsEnabled ? "buds_metrics_enabled 1\n" : "buds_metrics_enabled 0\n") !=
+                std::string::npos);
+    if (kMetricsEnabled) {
+        ASSERT_TRUE(text.find("buds_calls_total{entry=\"evaluate\"} 0\n") == std::string::npos);
+    }
+    // Every sample line is "name{labels} value" or "name value".
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::size_t space = line.rfind(' ');
+        ASSERT_TRUE(space != std::string::npos && space + 1 < line.size());
+        ASSERT_TRUE(line.compare(0, 5, "buds_") == 0);
+    }
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "buds_metrics_test.prom";
+    std::string error;
+    ASSERT_TRUE(writeMetricsFile(path.string(), &error));
+    std::ifstream in(path);
+    std::stringstream file;
+    file << in.rdbuf();
+    ASSERT_TRUE(file.str().find("# TYPE buds_calls_total counter\n") != std::string::npos);
+    ASSERT_TRUE(!std::filesystem::exists(path.string() + ".tmp"));
+    std::filesystem::remove(path);
+
+    ASSERT_TRUE(!writeMetricsFile("/nonexistent-dir/buds.prom", &error));
+    ASSERT_TRUE(!error.empty());
+    return true;
+}
+
+int main() {
+    if (!test_histogram_buckets()) return 1;
+    if (!test_counters_across_threads()) return 1;
+    if (!test_prometheus_export()) return 1;
+
+    std::cout << "All BUDS metrics tests passed.\n";
+    return 0;
+}
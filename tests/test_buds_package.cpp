@@ -0,0 +1,281 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "buds_package.h"
+#include "buds_tagger.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+static std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static Hash256 makeId(std::uint32_t n) {
+    Hash256 h;
+    for (int i = 0; i < 4; ++i) h.bytes[i] = static_cast<std::uint8_t>(n >> (8 * i));
+    h.bytes[31] = static_cast<std::uint8_t>(n * 7);
+    return h;
+}
+
+static CompactClassification compactOf(std::initializer_list<LabelId> labels, Tier tier) {
+    CompactClassification c;
+    for (LabelId l : labels) c.labels[c.labelCount++] = static_cast<std::uint8_t>(l);
+    switch (tier) {
+    case Tier::T0: c.counts.T0 = 1; break;
+    case Tier::T1: c.counts.T1 = 1; break;
+    case Tier::T2: c.counts.T2 = 1; break;
+    case Tier::T3: c.counts.T3 = 1; break;
+    }
+    return c;
+}
+
+struct ModelTx {
+    CompactClassification c;
+    std::uint32_t vsize{0};
+    std::uint64_t fee{0};
+    std::vector<std::uint32_t> parents;
+};
+
+static void walk(const std::map<std::uint32_t, ModelTx>& model, std::uint32_t start, bool up,
+                 std::set<std::uint32_t>& seen) {
+    std::vector<std::uint32_t> stack{start};
+    seen.insert(start);
+    while (!stack.empty()) {
+        std::uint32_t v = stack.back();
+        stack.pop_back();
+        for (const auto& kv : model) {
+            bool edge = false;
+            if (up) {
+                for (std::uint32_t p : model.at(v).parents) edge = edge || p == kv.first;
+            } else {
+                for (std::uint32_t p : kv.second.parents) edge = edge || p == v;
+            }
+            if (edge && seen.insert(kv.first).second) stack.push_back(kv.first);
+        }
+    }
+}
+
+static PackageAggregate bruteForce(const std::map<std::uint32_t, ModelTx>& model,
+                                   std::uint32_t id, bool up) {
+    std::set<std::uint32_t> seen;
+    walk(model, id, up, seen);
+    PackageAggregate agg;
+    for (std::uint32_t m : seen) {
+        const ModelTx& tx = model.at(m);
+        ++agg.count;
+        agg.vsize += tx.vsize;
+        agg.fee += tx.fee;
+        agg.regions.T0 += tx.c.counts.T0;
+        agg.regions.T1 += tx.c.counts.T1;
+        agg.regions.T2 += tx.c.counts.T2;
+        agg.regions.T3 += tx.c.counts.T3;
+        for (std::size_t i = 0; i < tx.c.labelCount; ++i) ++agg.labels[tx.c.labels[i]];
+    }
+    return agg;
+}
+
+static bool sameAggregate(const PackageAggregate& a, const PackageAggregate& b) {
+    return a.count == b.count && a.vsize == b.vsize && a.fee == b.fee &&
+           a.regions.T0 == b.regions.T0 && a.regions.T1 == b.regions.T1 &&
+           a.regions.T2 == b.regions.T2 && a.regions.T3 == b.regions.T3 && a.labels == b.labels;
+}
+
+// --- Tests ---
+
+static bool test_aggregates_match_brute_force() {
+    std::cout << "[TEST] incremental package aggregates match a full recompute\n";
+
+    PackageGraph graph(1000);
+    std::map<std::uint32_t, ModelTx> model;
+    std::uint32_t seed = 0x5eed1234;
+    std::uint32_t nextId = 0;
+
+    for (int step = 0; step < 3000; ++step) {
+        std::uint32_t op = nextRand(seed) % 10;
+        if (op < 6 || model.empty()) {
+            ModelTx tx;
+            std::uint32_t labels = 1 + nextRand(seed) % 3;
+            for (std::uint32_t i = 0; i < labels; ++i) {
+                std::uint8_t l = static_cast<std::uint8_t>(nextRand(seed) % kLabelCount);
+                bool dup = false;
+                for (std::size_t j = 0; j < tx.c.labelCount; ++j) dup = dup || tx.c.labels[j] == l;
+                if (!dup) tx.c.labels[tx.c.labelCount++] = l;
+            }
+            tx.c.counts.T0 = nextRand(seed) % 3;
+            tx.c.counts.T3 = nextRand(seed) % 2;
+            tx.vsize = 100 + nextRand(seed) % 900;
+            tx.fee = nextRand(seed) % 50000;
+
+            std::vector<Hash256> parents;
+            std::uint32_t want = model.empty() ? 0 : nextRand(seed) % 3;
+            for (std::uint32_t i = 0; i < want; ++i) {
+                auto it = model.begin();
+                std::advance(it, nextRand(seed) % model.size());
+                tx.parents.push_back(it->first);
+                parents.push_back(makeId(it->first));
+            }
+            parents.push_back(makeId(0xffffff)); // confirmed parent: ignored
+            std::uint32_t id = nextId++;
+            ASSERT_TRUE(graph.add(makeId(id), tx.c, tx.vsize, tx.fee, parents));
+            model[id] = tx;
+        } else if (op < 8) {
+            // Confirm a root.
+            for (const auto& kv : model) {
+                bool root = true;
+                for (std::uint32_t p : kv.second.parents) root = root && model.count(p) == 0;
+                ASSERT_TRUE(graph.removeConfirmed(makeId(kv.first)) == root);
+                if (root) {
+                    model.erase(kv.first);
+                    break;
+                }
+            }
+        } else {
+            auto it = model.begin();
+            std::advance(it, nextRand(seed) % model.size());
+            std::set<std::uint32_t> doomed;
+            walk(model, it->first, false, doomed);
+            ASSERT_TRUE(graph.removeWithDescendants(makeId(it->first)) == doomed.size());
+            for (std::uint32_t d : doomed) model.erase(d);
+        }
+
+        ASSERT_TRUE(graph.size() == model.size());
+        if (step % 37 != 0) continue;
+        for (const auto& kv : model) {
+            const PackageAggregate* anc = graph.ancestors(makeId(kv.first));
+            const PackageAggregate* desc = graph.descendants(makeId(kv.first));
+            ASSERT_TRUE(anc && desc);
+            ASSERT_TRUE(sameAggregate(*anc, bruteForce(model, kv.first, true)));
+            ASSERT_TRUE(sameAggregate(*desc, bruteForce(model, kv.first, false)));
+        }
+    }
+
+    ASSERT_TRUE(!graph.ancestors(makeId(0xffffff)));
+    ASSERT_TRUE(!graph.removeConfirmed(makeId(0xffffff)));
+    ASSERT_TRUE(graph.removeWithDescendants(makeId(0xffffff)) == 0);
+
+    return true;
+}
+
+static bool test_cpfp_package_policy() {
+    std::cout << "[TEST] package policy: CPFP feerate, worst tier and label union\n";
+
+    TagEngine engine;
+    PackageGraph graph;
+
+    // Clean, cheap parent; well-paying child carrying an obfuscated blob.
+    Hash256 parent = makeId(1), child = makeId(2), sibling = makeId(3);
+    ASSERT_TRUE(graph.add(parent, compactOf({label::PayStandard}, Tier::T0), 200, 200, {}));
+    ASSERT_TRUE(graph.add(child, compactOf({label::DaObfuscated}, Tier::T3), 200, 7800, {parent}));
+    ASSERT_TRUE(graph.add(sibling, compactOf({label::PayChannelOpen}, Tier::T1), 100, 1000, {parent}));
+    ASSERT_TRUE(!graph.add(child, compactOf({}, Tier::T0), 1, 1, {}));
+
+    PackageEvaluation pkg;
+    ASSERT_TRUE(graph.evaluateAncestors(engine, child, 1.0, pkg));
+    ASSERT_TRUE(pkg.members.count == 2);
+    ASSERT_TRUE(std::fabs(pkg.feerate - 20.0) < 1e-9);
+    ASSERT_TRUE(pkg.eval.arbda == Tier::T3);
+
+    // Same verdict as a single transaction carrying both labels.
+    Evaluation single = engine.evaluate(compactOf({label::PayStandard, label::DaObfuscated}, Tier::T0),
+                                        1.0, 20.0);
+    ASSERT_TRUE(std::fabs(pkg.eval.policy.required - single.policy.required) < 1e-9);
+    ASSERT_TRUE(std::fabs(pkg.eval.policy.score - single.policy.score) < 1e-9);
+
+    // The parent alone is clean; its descendant package is dragged to T3.
+    ASSERT_TRUE(graph.evaluateAncestors(engine, parent, 1.0, pkg));
+    ASSERT_TRUE(pkg.eval.arbda == Tier::T0 && pkg.members.count == 1);
+    ASSERT_TRUE(graph.evaluateDescendants(engine, parent, 1.0, pkg));
+    ASSERT_TRUE(pkg.members.count == 3 && pkg.eval.arbda == Tier::T3);
+    ASSERT_TRUE(pkg.members.vsize == 500 && pkg.members.fee == 9000);
+
+    // Evicting the child leaves a T1 descendant package behind.
+    ASSERT_TRUE(graph.removeWithDescendants(child) == 1);
+    ASSERT_TRUE(graph.evaluateDescendants(engine, parent, 1.0, pkg));
+    ASSERT_TRUE(pkg.members.count == 2 && pkg.eval.arbda == Tier::T1);
+    ASSERT_TRUE(pkg.members.labels[label::DaObfuscated] == 0);
+    ASSERT_TRUE(!graph.evaluateAncestors(engine, child, 1.0, pkg));
+
+    return true;
+}
+
+static bool test_long_chain_limit() {
+    std::cout << "[TEST] 25-transaction chain stays within the ancestor limit\n";
+
+    PackageGraph graph;
+    for (std::uint32_t i = 0; i < 25; ++i) {
+        std::vector<Hash256> parents;
+        if (i) parents.push_back(makeId(i - 1));
+        ASSERT_TRUE(graph.add(makeId(i), compactOf({label::PayStandard}, Tier::T0), 100, 100 * (i + 1),
+                              parents));
+    }
+    ASSERT_TRUE(!graph.add(makeId(25), compactOf({}, Tier::T0), 100, 100, {makeId(24)}));
+    ASSERT_TRUE(!graph.contains(makeId(25)));
+    ASSERT_TRUE(graph.ancestors(makeId(24))->count == 25);
+    ASSERT_TRUE(graph.descendants(makeId(0))->count == 25);
+    ASSERT_TRUE(graph.ancestors(makeId(24))->labels[label::PayStandard] == 25);
+
+    // Confirming the root makes room for one more.
+    ASSERT_TRUE(!graph.removeConfirmed(makeId(5)));
+    ASSERT_TRUE(graph.removeConfirmed(makeId(0)));
+    ASSERT_TRUE(graph.ancestors(makeId(24))->count == 24);
+    ASSERT_TRUE(graph.ancestors(makeId(24))->fee == 100 * (325 - 1));
+    ASSERT_TRUE(graph.add(makeId(25), compactOf({}, Tier::T0), 100, 100, {makeId(24)}));
+    ASSERT_TRUE(graph.descendants(makeId(1))->count == 25);
+
+    ASSERT_TRUE(graph.removeWithDescendants(makeId(13)) == 13);
+    ASSERT_TRUE(graph.size() == 12);
+    ASSERT_TRUE(graph.descendants(makeId(1))->count == 12);
+
+    return true;
+}
+
+static bool test_wide_descendant_fanout() {
+    std::cout << "[TEST] label counts do not wrap on a 65,536-child fan-out\n";
+
+    TagEngine engine;
+    PackageGraph graph;
+    Hash256 parent = makeId(0);
+    ASSERT_TRUE(graph.add(parent, compactOf({label::PayStandard}, Tier::T0), 200, 200, {}));
+    const std::uint32_t children = 65536;
+    for (std::uint32_t i = 1; i <= children; ++i) {
+        ASSERT_TRUE(graph.add(makeId(i), compactOf({label::DaObfuscated}, Tier::T3), 100, 100, {parent}));
+    }
+    ASSERT_TRUE(graph.descendants(parent)->labels[label::DaObfuscated] == children);
+
+    // The label still drives the descendant package's multiplier and boost.
+    PackageEvaluation pkg;
+    ASSERT_TRUE(graph.evaluateDescendants(engine, parent, 1.0, pkg));
+    Evaluation single = engine.evaluate(compactOf({label::PayStandard, label::DaObfuscated}, Tier::T0),
+                                        1.0, pkg.feerate);
+    ASSERT_TRUE(pkg.eval.arbda == Tier::T3);
+    ASSERT_TRUE(std::fabs(pkg.eval.policy.required - single.policy.required) < 1e-9);
+    ASSERT_TRUE(std::fabs(pkg.eval.policy.score - single.policy.score) < 1e-9);
+    return true;
+}
+
+int main() {
+    if (!test_aggregates_match_brute_force()) return 1;
+    if (!test_cpfp_package_policy()) return 1;
+    if (!test_long_chain_limit()) return 1;
+    if (!test_wide_descendant_fanout()) return 1;
+
+    std::cout << "All BUDS package tests passed.\n";
+    return 0;
+}
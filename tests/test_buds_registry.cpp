@@ -0,0 +1,170 @@
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buds_json.h"
+#include "buds_registry.h"
+#include "buds_snapshot.h"
+#include "buds_tagger.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+// Tests are run from the repository root or from a build directory below it.
+static std::string registryPath(const char* name) {
+    for (const char* prefix : {"registry/", "../registry/"}) {
+        std::string path = std::string(prefix) + name;
+        if (std::ifstream(path)) return path;
+    }
+    return std::string("registry/") + name;
+}
+
+// --- Tests ---
+
+static bool test_json_parser() {
+    std::cout << "[TEST] JSON reader\n";
+
+    JsonValue v;
+    ASSERT_TRUE(parseJson(" {\"a\": [1, -2.5e1, true, false, null], \"b\": {\"c\": \"x\\ty\"}} ", v));
+    ASSERT_TRUE(v.isObject() && v.object.size() == 2);
+    const JsonValue* a = v.find("a");
+    ASSERT_TRUE(a && a->isArray() && a->array.size() == 5);
+    ASSERT_TRUE(a->array[0].number == 1.0 && a->array[1].number == -25.0);
+    ASSERT_TRUE(a->array[2].isBool() && a->array[2].boolean && !a->array[3].boolean);
+    ASSERT_TRUE(a->array[4].isNull());
+    ASSERT_TRUE(v.find("b")->find("c")->string == "x\ty");
+    ASSERT_TRUE(!v.find("missing") && !a->find("a"));
+
+    ASSERT_TRUE(parseJson("\"\\u00e9\\ud83d\\ude00\"", v));
+    ASSERT_TRUE(v.string == "\xc3\xa9\xf0\x9f\x98\x80");
+
+    std::string error;
+    const char* bad[] = {"", "{", "[1,]", "{\"a\" 1}", "01", "1.", "\"\\ud800\"", "\"a\nb\"",
+                         "tru", "{} {}", "\"\\x\""};
+    for (const char* text : bad) {
+        ASSERT_TRUE(!parseJson(text, v, &error));
+        ASSERT_TRUE(error.find("offset") != std::string::npos);
+    }
+    ASSERT_TRUE(!parseJson(std::string(100, '['), v, &error));
+    ASSERT_TRUE(error.find("too deep") != std::string::npos);
+
+    return true;
+}
+
+static bool test_registry_files_match_builtin() {
+    std::cout << "[TEST] registry-v2.json compiles to the built-in v2 table\n";
+
+    Registry builtin;
+    Registry loaded;
+    std::string error;
+    ASSERT_TRUE(Registry::loadFile(registryPath("registry-v2.json"), loaded, &error));
+    ASSERT_TRUE(loaded.version() == 2);
+    ASSERT_TRUE(loaded.ignoredLabels() == 0);
+    ASSERT_TRUE(loaded == builtin);
+
+    // The v1 snapshot uses "suggested_category" and the same vocabulary.
+    Registry v1;
+    ASSERT_TRUE(Registry::loadFile(registryPath("registry.json"), v1, &error));
+    ASSERT_TRUE(v1.version() == 1);
+    ASSERT_TRUE(v1.tier(label::PayStandard) == Tier::T1);
+
+    ASSERT_TRUE(!Registry::loadFile("no/such/registry.json", loaded, &error));
+    ASSERT_TRUE(!Registry::fromJson("{\"labels\": []}", loaded, &error));
+    ASSERT_TRUE(!Registry::fromJson("{\"labels\": [{\"tier\": \"T0\"}]}", loaded, &error));
+    for (const char* version : {"-1", "2.5", "3e9", "1e400", "\"2\"", "null"}) {
+        std::string text = std::string("{\"version\": ") + version +
+                           ", \"labels\": [{\"label\": \"da.unknown\", \"suggested_tier\": \"T2\"}]}";
+        ASSERT_TRUE(!Registry::fromJson(text, loaded, &error));
+        ASSERT_TRUE(error.find("version") != std::string::npos);
+    }
+    ASSERT_TRUE(loaded == builtin); // untouched on failure
+
+    // Unlisted labels and unknown tier strings fall back to T3.
+    Registry custom;
+    ASSERT_TRUE(Registry::fromJson(
+        "{\"version\": 3, \"labels\": ["
+        " {\"label\": \"da.unknown\", \"suggested_tier\": \"T2\"},"
+        " {\"label\": \"pay.standard\", \"suggested_tier\": \"T9\"},"
+        " {\"label\": \"vendor.future\", \"suggested_tier\": \"T1\"}]}",
+        custom, &error));
+    ASSERT_TRUE(custom.version() == 3 && custom.ignoredLabels() == 1);
+    ASSERT_TRUE(custom.tier(label::DaUnknown) == Tier::T2);
+    ASSERT_TRUE(custom.tier(label::PayStandard) == Tier::T3);
+    ASSERT_TRUE(custom.tier(label::ConsensusSig) == Tier::T3);
+    ASSERT_TRUE(custom.tier(kInvalidLabel) == Tier::T3);
+
+    TagEngine engine;
+    ASSERT_TRUE(engine.getTierForLabel("da.unknown") == "T3");
+    engine.setRegistry(custom);
+    ASSERT_TRUE(engine.getTierForLabel("da.unknown") == "T2");
+    ASSERT_TRUE(engine.tierForLabel(label::PayStandard) == Tier::T3);
+    ASSERT_TRUE(engine.loadRegistry(registryPath("registry-v2.json")));
+    ASSERT_TRUE(engine.config()->registry == builtin);
+    ASSERT_TRUE(!engine.loadRegistry("no/such/registry.json", &error));
+    ASSERT_TRUE(engine.config()->registry == builtin);
+
+    return true;
+}
+
+static bool test_hot_reload_under_load() {
+    std::cout << "[TEST] registry hot reload while classifier threads read\n";
+
+    // Two registries that disagree on every label; a reader that pins one
+    // must see all of its entries agree.
+    Registry all0, all3;
+    std::string json0 = "{\"labels\": [";
+    for (std::size_t i = 0; i < kLabelCount; ++i) {
+        json0 += std::string(i ? "," : "") + "{\"label\": \"" + labelName(static_cast<LabelId>(i)) +
+                 "\", \"suggested_tier\": \"T0\"}";
+    }
+    json0 += "]}";
+    ASSERT_TRUE(Registry::fromJson(json0, all0));
+    ASSERT_TRUE(Registry::fromJson("{\"labels\": [{\"label\": \"x\"}]}", all3));
+
+    SnapshotCell<Registry> cell(all0);
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> torn{0}, reads{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto snap = cell.read();
+                Tier first = snap->tier(0);
+                for (LabelId id = 1; id < kLabelCount; ++id) {
+                    if (snap->tier(id) != first) torn.fetch_add(1, std::memory_order_relaxed);
+                }
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (int i = 0; i < 2000; ++i) cell.publish(i % 2 ? all0 : all3);
+    stop.store(true);
+    for (auto& t : readers) t.join();
+
+    ASSERT_TRUE(torn.load() == 0);
+    ASSERT_TRUE(cell.generation() == 2000);
+    ASSERT_TRUE(cell.read()->tier(label::ConsensusSig) == Tier::T0);
+
+    return true;
+}
+
+int main() {
+    if (!test_json_parser()) return 1;
+    if (!test_registry_files_match_builtin()) return 1;
+    if (!test_hot_reload_under_load()) return 1;
+
+    std::cout << "All BUDS registry tests passed.\n";
+    return 0;
+}
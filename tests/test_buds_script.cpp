@@ -0,0 +1,183 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buds_script.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+static std::vector<std::uint8_t> fromHex(const std::string& hex) {
+    std::vector<std::uint8_t> out;
+    for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+        out.push_back(static_cast<std::uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    }
+    return out;
+}
+
+// --- Tests ---
+
+static bool test_read_script_ops() {
+    std::cout << "[TEST] readScriptOp walks pushes and opcodes\n";
+
+    // OP_0, push 2, OP_PUSHDATA1 3, OP_PUSHDATA2 1, OP_RETURN
+    std::vector<std::uint8_t> script = fromHex("00" "02aabb" "4c03010203" "4d0100ff" "6a");
+    std::size_t pos = 0;
+    ScriptOp o;
+
+    ASSERT_TRUE(readScriptOp(script, pos, o) && o.opcode == 0x00 && o.push.empty() && o.isPush());
+    ASSERT_TRUE(readScriptOp(script, pos, o) && o.offset == 1 && o.push.size() == 2 && o.push[1] == 0xbb);
+    ASSERT_TRUE(readScriptOp(script, pos, o) && o.opcode == op::PushData1 && o.push.size() == 3);
+    ASSERT_TRUE(o.push.data() == script.data() + 6);
+    ASSERT_TRUE(readScriptOp(script, pos, o) && o.opcode == op::PushData2 && o.push.size() == 1);
+    ASSERT_TRUE(o.push[0] == 0xff);
+    ASSERT_TRUE(readScriptOp(script, pos, o) && o.opcode == op::Return && !o.isPush());
+    ASSERT_TRUE(!readScriptOp(script, pos, o));
+
+    // Pushes running past the end fail.
+    for (const char* bad : {"05aabb", "4c", "4c05aa", "4d01", "4e00000001ff"}) {
+        std::vector<std::uint8_t> s = fromHex(bad);
+        pos = 0;
+        ASSERT_TRUE(!readScriptOp(s, pos, o));
+    }
+
+    return true;
+}
+
+static bool test_script_templates() {
+    std::cout << "[TEST] analyzeScriptPubKey templates\n";
+
+    const std::string h20(40, '1'), h32(64, '2');
+    struct Case { std::string hex; ScriptType type; };
+    const Case cases[] = {
+        {"76a914" + h20 + "88ac", ScriptType::P2PKH},
+        {"a914" + h20 + "87", ScriptType::P2SH},
+        {"0014" + h20, ScriptType::P2WPKH},
+        {"0020" + h32, ScriptType::P2WSH},
+        {"5120" + h32, ScriptType::P2TR},
+        {"21" + std::string(66, '3') + "ac", ScriptType::P2PK},
+        {"41" + std::string(130, '4') + "ac", ScriptType::P2PK},
+        {"6a", ScriptType::NullData},
+        // near misses
+        {"76a914" + h20 + "88ad", ScriptType::NonStandard},
+        {"0014" + h20 + "00", ScriptType::NonStandard},
+        {"5220" + h32, ScriptType::NonStandard},
+        {"", ScriptType::NonStandard},
+    };
+    for (const auto& c : cases) {
+        std::vector<std::uint8_t> script = fromHex(c.hex);
+        ASSERT_TRUE(analyzeScriptPubKey(script).type == c.type);
+    }
+    ASSERT_TRUE(std::string(scriptTypeName(ScriptType::P2TR)) == "p2tr");
+
+    return true;
+}
+
+static bool test_null_data_payload() {
+    std::cout << "[TEST] analyzeScriptPubKey OP_RETURN payloads\n";
+
+    // OP_RETURN <"ab"> OP_PUSHDATA1 <3 bytes> OP_0
+    std::vector<std::uint8_t> multi = fromHex("6a" "026162" "4c03010203" "00");
+    ScriptInfo info = analyzeScriptPubKey(multi);
+    ASSERT_TRUE(info.type == ScriptType::NullData && info.pushOnly);
+    ASSERT_TRUE(info.pushCount == 3);
+    ASSERT_TRUE(info.payloadSize == 5 && info.payloadPrintable == 2);
+    ASSERT_TRUE(info.payloadStart == 2 && info.payloadEnd == 9);
+    ASSERT_TRUE(info.firstPushSize == 2);
+
+    // A non-push opcode after OP_RETURN: the raw tail is the payload.
+    std::vector<std::uint8_t> mixed = fromHex("6a" "026162" "76");
+    info = analyzeScriptPubKey(mixed);
+    ASSERT_TRUE(!info.pushOnly);
+    ASSERT_TRUE(info.payloadStart == 1 && info.payloadEnd == 5 && info.payloadSize == 4);
+
+    // Bare OP_RETURN has an empty payload at the end of the script.
+    std::vector<std::uint8_t> bare = fromHex("6a");
+    info = analyzeScriptPubKey(bare);
+    ASSERT_TRUE(info.pushOnly && info.payloadSize == 0 && info.payloadStart == 1 && info.payloadEnd == 1);
+
+    return true;
+}
+
+static bool test_ordinal_envelope() {
+    std::cout << "[TEST] findOrdinalEnvelope ranges and content type\n";
+
+    const std::string key = "20" + std::string(64, '1') + "ac"; // <key> OP_CHECKSIG
+    const std::string envelope =
+        "0063036f7264"               // OP_FALSE OP_IF "ord"
+        "0101" "09696d6167652f706e67" // 1 "image/png"
+        "0102" "01ff"                 // unrelated field
+        "00" "03aabbcc" "4c02ddee"    // body: two pushes, 5 bytes
+        "68";                         // OP_ENDIF
+
+    std::vector<std::uint8_t> script = fromHex(key + envelope);
+    OrdinalEnvelope env;
+    ASSERT_TRUE(findOrdinalEnvelope(script, env));
+    ASSERT_TRUE(env.start == 34);
+    ASSERT_TRUE(env.end == script.size());
+    ASSERT_TRUE(std::string(env.contentType.begin(), env.contentType.end()) == "image/png");
+    ASSERT_TRUE(env.bodySize == 5);
+
+    // OP_1 as the content-type tag is accepted too.
+    std::vector<std::uint8_t> op1 = fromHex(key + "0063036f7264" "51" "0a746578742f706c61696e" "68");
+    ASSERT_TRUE(findOrdinalEnvelope(op1, env));
+    ASSERT_TRUE(env.contentType.size() == 10 && env.bodySize == 0);
+
+    // The header hidden inside push data is skipped; a later real one is found.
+    std::vector<std::uint8_t> hidden = fromHex("080063036f726468aa" + key + envelope);
+    ASSERT_TRUE(findOrdinalEnvelope(hidden, env));
+    ASSERT_TRUE(env.start == 9 + 34);
+
+    // Not envelopes: bare "ord", missing OP_ENDIF, non-push inside, garbage.
+    for (const std::string& bad : {std::string("6f7264"),
+                                   key + "0063036f7264" "0101" "00",
+                                   key + "0063036f7264" "76" "68",
+                                   std::string("4cff") + "0063036f726468" + std::string(200, 'e')}) {
+        std::vector<std::uint8_t> s = fromHex(bad);
+        ASSERT_TRUE(!findOrdinalEnvelope(s, env));
+    }
+
+    return true;
+}
+
+static bool test_looks_like_script() {
+    std::cout << "[TEST] looksLikeScript separates scripts from data\n";
+
+    std::string key = "20" + std::string(64, 'a');
+    // 3-of-3 tapscript multisig, P2PKH-style script, IF/ELSE/ENDIF timelock.
+    for (const std::string& good : {key + "ac" + key + "ba" + key + "ba" "53" "9c",
+                                    std::string("76a914") + std::string(40, '1') + "88ac",
+                                    "63" + key + "ac" "67" "029000b275" + key + "ac" "68"}) {
+        std::vector<std::uint8_t> s = fromHex(good);
+        ASSERT_TRUE(looksLikeScript(s));
+    }
+    // Push-only, truncated push, reserved / unassigned opcodes, unbalanced IF.
+    for (const std::string& bad : {key + key, std::string("4cff00"), key + "ac50",
+                                   key + "acbb", std::string("6f7264") + "6f7264",
+                                   "68" + key + "ac", std::string()}) {
+        std::vector<std::uint8_t> s = fromHex(bad);
+        ASSERT_TRUE(!looksLikeScript(s));
+    }
+
+    return true;
+}
+
+int main() {
+    if (!test_read_script_ops()) return 1;
+    if (!test_script_templates()) return 1;
+    if (!test_null_data_payload()) return 1;
+    if (!test_ordinal_envelope()) return 1;
+    if (!test_looks_like_script()) return 1;
+
+    std::cout << "All BUDS script tests passed.\n";
+    return 0;
+}
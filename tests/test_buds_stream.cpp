@@ -0,0 +1,223 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buds_json.h"
+#include "buds_stream.h"
+#include "buds_threadpool.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+// version 2, one input, outputs [P2PKH, OP_RETURN "ok"], witness ["0123456789", 010203]
+static const char* kSegwitTx =
+    "02000000000101000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "0100000000fdffffff02e8030000000000001976a91400112233445566778899aabbccddeeff00"
+    "11223388ac0000000000000000046a026f6b020a3031323334353637383903010203"
+    "00000000";
+static const char* kTxid = "ff2d8536ff0e9e9f969d2290a1a65de85933092a06a0bb2e0849b2a2a12010b9";
+
+// The same transaction as bitcoind's decoderawtransaction prints it.
+static std::string verboseTx(const std::string& txid, bool withFee) {
+    return "{\"txid\": \"" + txid + "\", \"version\": 2, \"vsize\": 141, \"locktime\": 0,"
+           " \"vin\": [{\"txid\": \"1f1e\", \"vout\": 1, \"scriptSig\": {\"asm\": \"\", \"hex\": \"\"},"
+           " \"txinwitness\": [\"30313233343536373839\", \"010203\"], \"sequence\": 4294967293}],"
+           " \"vout\": [{\"value\": 0.00001, \"n\": 0, \"scriptPubKey\": {\"asm\": \"OP_DUP OP_HASH160\","
+           " \"hex\": \"76a91400112233445566778899aabbccddeeff0011223388ac\", \"type\": \"pubkeyhash\"}},"
+           " {\"value\": 0, \"n\": 1, \"scriptPubKey\": {\"asm\": \"OP_RETURN 6f6b\", \"hex\": \"6a026f6b\","
+           " \"type\": \"nulldata\"}}]" + std::string(withFee ? ", \"fee\": 0.00000705" : "") + "}";
+}
+
+static std::string runStream(const std::string& input, const StreamOptions& options,
+                             ThreadPool& pool, StreamStats* statsOut = nullptr) {
+    std::FILE* in = std::tmpfile();
+    std::FILE* out = std::tmpfile();
+    if (!in || !out) return "<tmpfile failed>";
+    std::fwrite(input.data(), 1, input.size(), in);
+    std::rewind(in);
+    TagEngine engine;
+    StreamStats stats = classifyStream(in, out, engine, pool, options);
+    if (statsOut) *statsOut = stats;
+    std::rewind(out);
+    std::string result;
+    char buf[4096];
+    std::size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), out)) > 0) result.append(buf, n);
+    std::fclose(in);
+    std::fclose(out);
+    return result;
+}
+
+static std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::size_t start = 0;
+    while (start < text.size()) {
+        std::size_t nl = text.find('\n', start);
+        if (nl == std::string::npos) nl = text.size();
+        lines.push_back(text.substr(start, nl - start));
+        start = nl + 1;
+    }
+    return lines;
+}
+
+// --- Tests ---
+
+static bool test_json_cursor() {
+    std::cout << "[TEST] JsonCursor walks, skips and rejects\n";
+
+    std::string doc = " {\"a\": [1, -2.5e1, true, null, {\"x\": \"y\"}], \"b\": \"q\\\"uote\","
+                      " \"long\": \"0123456789abcdef0123456789\\\\\", \"n\": 7} ";
+    JsonCursor cur(doc.data(), doc.size());
+    JsonCursor::Str key, value;
+    ASSERT_TRUE(cur.beginObject());
+    ASSERT_TRUE(cur.nextMember(key) && key.equals("a"));
+    ASSERT_TRUE(cur.peek() == JsonCursor::Kind::Array && cur.skipValue());
+    ASSERT_TRUE(cur.nextMember(key) && key.equals("b"));
+    ASSERT_TRUE(cur.readString(value) && value.escaped && value.size == 7);
+    ASSERT_TRUE(cur.nextMember(key) && key.equals("long"));
+    ASSERT_TRUE(cur.readString(value) && value.escaped && value.size == 28);
+    ASSERT_TRUE(cur.nextMember(key) && key.equals("n"));
+    double n = 0;
+    ASSERT_TRUE(cur.readNumber(n) && n == 7.0);
+    ASSERT_TRUE(!cur.nextMember(key) && !cur.failed() && cur.atEnd());
+
+    // Quote found at every offset within and across 8-byte words.
+    for (std::size_t len = 0; len < 20; ++len) {
+        std::string s = "\"" + std::string(len, 'k') + "\"";
+        JsonCursor c(s.data(), s.size());
+        ASSERT_TRUE(c.readString(value) && value.size == len && !value.escaped && c.atEnd());
+    }
+
+    for (const char* bad : {"{\"a\" 1}", "{\"a\": 1,}", "[1 2]", "{\"a\": tru}", "\"open",
+                            "\"esc\\", "{\"a\": [", "[-]"}) {
+        JsonCursor c(bad, std::strlen(bad));
+        ASSERT_TRUE(!c.skipValue() || !c.atEnd());
+    }
+    std::string deep(100, '[');
+    JsonCursor d(deep.data(), deep.size());
+    ASSERT_TRUE(!d.skipValue() && d.failed());
+
+    return true;
+}
+
+static bool test_parse_tx_line() {
+    std::cout << "[TEST] parseTxLine accepts raw hex, JSON strings and verbose objects\n";
+
+    TxRecord record;
+    std::string raw = kSegwitTx;
+    ASSERT_TRUE(parseTxLine(raw.data(), raw.size(), record));
+    ASSERT_TRUE(record.hasRaw && record.raw.size() == raw.size() / 2);
+
+    std::string quoted = "  \"" + raw + "\"\r";
+    ASSERT_TRUE(parseTxLine(quoted.data(), quoted.size(), record) && record.hasRaw);
+
+    std::string verbose = verboseTx("abc", true);
+    ASSERT_TRUE(parseTxLine(verbose.data(), verbose.size(), record));
+    ASSERT_TRUE(!record.hasRaw && record.tx.txid == "abc");
+    ASSERT_TRUE(record.tx.vout.size() == 2 && record.tx.vout[1].spk.asm_repr == "OP_RETURN");
+    ASSERT_TRUE(record.tx.witness.size() == 1 && record.tx.witness[0].stack.size() == 2);
+    ASSERT_TRUE(record.feeSats > 704.9 && record.feeSats < 705.1 && record.vsize == 141.0);
+
+    // "hex" anywhere in the object takes the raw path.
+    std::string withHex = verbose.substr(0, verbose.size() - 1) + ", \"hex\": \"" + raw + "\"}";
+    ASSERT_TRUE(parseTxLine(withHex.data(), withHex.size(), record));
+    ASSERT_TRUE(record.hasRaw && record.tx.vout.empty() && record.tx.txid == "abc");
+
+    std::string error;
+    for (const std::string& bad : {std::string("0g"), std::string("abc"), std::string("{}"),
+                                   std::string("{\"vin\": [1]}"), verbose + "x",
+                                   std::string("{\"hex\": \"zz\"}"), std::string("   ")}) {
+        ASSERT_TRUE(!parseTxLine(bad.data(), bad.size(), record, &error) && !error.empty());
+    }
+
+    return true;
+}
+
+static bool test_stream_order_and_formats() {
+    std::cout << "[TEST] classifyStream keeps input order across batches and threads\n";
+
+    std::string input;
+    std::vector<std::string> expectTxid;
+    for (int i = 0; i < 500; ++i) {
+        switch (i % 5) {
+        case 0: input += std::string(kSegwitTx) + "\n"; break;
+        case 1: input += verboseTx("v" + std::to_string(i), i % 2 == 0) + "\n"; break;
+        case 2: input += "\n"; break;                       // blank: skipped, still numbered
+        case 3: input += "not hex\n"; break;
+        default: input += "\"" + std::string(kSegwitTx) + "\"\r\n"; break;
+        }
+    }
+    input += kSegwitTx;   // no trailing newline
+
+    ThreadPool pool(4);
+    StreamOptions options;
+    options.batchLines = 7;
+    options.maxBatchesInFlight = 2;
+    StreamStats stats;
+    std::vector<std::string> lines = splitLines(runStream(input, options, pool, &stats));
+    ASSERT_TRUE(stats.lines == 401 && stats.txs == 301 && stats.errors == 100);
+    ASSERT_TRUE(stats.arbda[3] == 301 && stats.bytes == input.size() && !stats.writeFailed);
+    ASSERT_TRUE(lines.size() == 401);
+
+    std::size_t k = 0;
+    for (int i = 0; i <= 500; ++i) {
+        if (i % 5 == 2 && i < 500) continue;
+        const std::string& line = lines[k++];
+        std::string prefix = "{\"line\":" + std::to_string(i + 1) + ",";
+        ASSERT_TRUE(line.compare(0, prefix.size(), prefix) == 0);
+        if (i % 5 == 3 && i < 500) {
+            ASSERT_TRUE(line.find("\"error\":\"invalid hex\"") != std::string::npos);
+        } else if (i % 5 == 1) {
+            ASSERT_TRUE(line.find("\"txid\":\"v" + std::to_string(i) + "\"") != std::string::npos);
+            // Fee and vsize come from the object: 705 sat / 141 vB.
+            ASSERT_TRUE(line.find(i % 2 == 0 ? "\"feerate\":5," : "\"feerate\":null") != std::string::npos);
+        } else {
+            ASSERT_TRUE(line.find(std::string("\"txid\":\"") + kTxid + "\"") != std::string::npos);
+            ASSERT_TRUE(line.find("\"arbda\":\"T3\",\"tiers\":{\"T0\":0,\"T1\":1,\"T2\":1,\"T3\":2}") !=
+                        std::string::npos);
+        }
+    }
+
+    // Raw and verbose forms of the same transaction agree, with tags.
+    options.tags = true;
+    std::string both = std::string(kSegwitTx) + "\n" + verboseTx(kTxid, false) + "\n";
+    lines = splitLines(runStream(both, options, pool));
+    ASSERT_TRUE(lines.size() == 2);
+    ASSERT_TRUE(lines[0].substr(lines[0].find(",\"txid\"")) == lines[1].substr(lines[1].find(",\"txid\"")));
+    ASSERT_TRUE(lines[0].find("{\"surface\":\"witness.stack[0:1]\",\"start\":0,\"end\":3,"
+                              "\"labels\":[\"da.unknown\"]}") != std::string::npos);
+
+    options.tags = false;
+    options.format = OutputFormat::Csv;
+    options.baseMinFeerate = 2.0;
+    lines = splitLines(runStream(verboseTx("a,b", true) + "\n??\n", options, pool));
+    ASSERT_TRUE(lines.size() == 2);
+    ASSERT_TRUE(lines[0] == "1,\"a,b\",T3,0,1,1,2,pay.standard;meta.indexer_hint;"
+                            "da.unregistered_vendor;da.unknown,5,4,3.25,");
+    ASSERT_TRUE(lines[1] == "2,,,,,,,,,,,invalid hex");
+    ASSERT_TRUE(std::string(csvHeader()).find("line,txid,arbda") == 0);
+
+    ASSERT_TRUE(runStream("", options, pool).empty());
+
+    return true;
+}
+
+int main() {
+    if (!test_json_cursor()) return 1;
+    if (!test_parse_tx_line()) return 1;
+    if (!test_stream_order_and_formats()) return 1;
+
+    std::cout << "All BUDS stream tests passed.\n";
+    return 0;
+}
@@ -1,8 +1,13 @@
+#include <atomic>
+#include <cstdio>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "buds_tagger.h"
+#include "buds_threadpool.h"
 
 using namespace buds;
 
@@ -19,14 +24,28 @@ static bool hasLabelOnSurface(const Classification& cls,
                               const std::string& surface,
                               const std::string& label) {
     for (const auto& tag : cls.tags) {
-        if (tag.surface != surface) continue;
-        for (const auto& l : tag.labels) {
-            if (l == label) return true;
+        if (tag.surface() != surface) continue;
+        for (LabelId l : tag.labels) {
+            if (labelName(l) == label) return true;
         }
     }
     return false;
 }
 
+// Hex of `bytes` xorshift bytes: uniform-looking, never a valid script.
+static std::string randomHex(std::size_t bytes, std::uint32_t& state) {
+    std::string hex;
+    char buf[3];
+    for (std::size_t i = 0; i < bytes; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        std::snprintf(buf, sizeof(buf), "%02x", (state >> 7) & 0xff);
+        hex += buf;
+    }
+    return hex;
+}
+
 // --- Tests ---
 
 static bool test_p2pkh_pay_standard() {
@@ -94,6 +113,27 @@ static bool test_opreturn_hint_and_rollup() {
         ASSERT_TRUE(hasLabelOnSurface(cls, "scriptpubkey[0]", "commitment.rollup_root"));
     }
 
+    // 3) Multi-push and OP_PUSHDATA1 payloads: only pushed bytes count, and
+    //    the tag range covers them.
+    {
+        Tx tx;
+        tx.txid = "test-multipush";
+
+        TxOutput multi;
+        multi.spk.hex = "6a" "0461626364" "0465666768";   // "abcd" "efgh"
+        tx.vout.push_back(multi);
+        TxOutput pushdata;
+        pushdata.spk.hex = "6a" "4c08" "6162636465666768"; // OP_PUSHDATA1 "abcdefgh"
+        tx.vout.push_back(pushdata);
+
+        TagEngine engine;
+        Classification cls = engine.classify(tx);
+        ASSERT_TRUE(hasLabelOnSurface(cls, "scriptpubkey[0]", "meta.indexer_hint"));
+        ASSERT_TRUE(cls.tags[0].start == 2 && cls.tags[0].end == 11);
+        ASSERT_TRUE(hasLabelOnSurface(cls, "scriptpubkey[1]", "meta.indexer_hint"));
+        ASSERT_TRUE(cls.tags[1].start == 3 && cls.tags[1].end == 11);
+    }
+
     return true;
 }
 
@@ -138,76 +178,694 @@ static bool test_witness_vendor_unknown_obfuscated() {
         ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:0]", "da.unknown"));
     }
 
-    // 3) Large blob (>512B) -> da.obfuscated, ARBDA = T3
+    // 3) Large low-entropy blobs (padding, JSON text) are judged by their
+    //    byte distribution, not their size: da.unknown, still ARBDA = T3.
+    //    The size-only cutoff is available as an explicit option.
     {
         Tx tx;
-        tx.txid = "test-obfuscated";
+        tx.txid = "test-large-plain";
 
         Witness w;
-        WitnessItem item;
-        // 600 bytes of 0x00 -> 1200 hex chars
-        std::string hex;
-        for (int i = 0; i < 600; ++i) hex += "00";
-        item.hex = hex;
-        w.stack.push_back(item);
+        std::string zeros;
+        for (int i = 0; i < 600; ++i) zeros += "00";
+        std::string json = "{\"records\": [";
+        while (json.size() < 2048) json += "{\"id\": 12345, \"name\": \"vendor payload\", \"ok\": true}, ";
+        json += "{}]}";
+        std::string jsonHex;
+        char buf[3];
+        for (unsigned char ch : json) {
+            std::snprintf(buf, sizeof(buf), "%02x", ch);
+            jsonHex += buf;
+        }
+        w.stack.push_back(WitnessItem{zeros});
+        w.stack.push_back(WitnessItem{jsonHex});
         tx.witness.push_back(w);
 
         Classification cls = engine.classify(tx);
         Summary summary = engine.summarizeTiers(cls);
 
+        ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:0]", "da.unknown"));
+        ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:1]", "da.unknown"));
+        ASSERT_TRUE(!hasLabelOnSurface(cls, "witness.stack[0:1]", "da.obfuscated"));
+        ASSERT_TRUE(engine.computeArbdaTierFromCounts(summary.counts) == "T3");
+
+        EngineConfig sizeCutoff;
+        sizeCutoff.largeBlobThreshold = 512;
+        TagEngine cutoff(sizeCutoff);
+        Classification byCut = cutoff.classify(tx);
+        ASSERT_TRUE(hasLabelOnSurface(byCut, "witness.stack[0:0]", "da.obfuscated"));
+        ASSERT_TRUE(hasLabelOnSurface(byCut, "witness.stack[0:1]", "da.obfuscated"));
+    }
+
+    // 4) Small random-looking blob -> da.obfuscated by its byte distribution;
+    //    a signature-sized one is too short to judge.
+    {
+        Tx tx;
+        tx.txid = "test-entropy";
+
+        std::uint32_t state = 0x6a09e667;
+        Witness w;
+        w.stack.push_back(WitnessItem{randomHex(200, state)});
+        w.stack.push_back(WitnessItem{randomHex(72, state)});
+        // 20-key tapscript multisig: large and key-heavy, but a script.
+        std::string multisig;
+        for (int k = 0; k < 20; ++k) multisig += "20" + randomHex(32, state) + (k ? "ba" : "ac");
+        multisig += "0114" "9c";
+        w.stack.push_back(WitnessItem{multisig});
+        tx.witness.push_back(w);
+
+        Classification cls = engine.classify(tx);
+        ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:0]", "da.obfuscated"));
+        ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:1]", "da.unknown"));
+        ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:2]", "da.unknown"));
+
+        // Above 64 KB only evenly spaced 4 KB blocks are histogrammed. Make
+        // exactly those blocks random and the gaps between them zero: the
+        // sampled verdict is obfuscated, a whole-item histogram is not.
+        const std::size_t block = 4096, stride = 2 * block, bytes = block + 15 * stride;
+        std::string sampled;
+        for (std::size_t at = 0; at < bytes; at += block) {
+            sampled += at % stride == 0 ? randomHex(block, state) : std::string(2 * block, '0');
+        }
+        Tx big;
+        big.txid = "test-entropy-sampled";
+        big.witness.push_back(Witness{{WitnessItem{sampled}}});
+        cls = engine.classify(big);
         ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:0]", "da.obfuscated"));
-        ASSERT_TRUE(summary.counts.T3 >= 1);
 
-        std::string arbda = engine.computeArbdaTierFromCounts(summary.counts);
-        ASSERT_TRUE(arbda == "T3");
+        EngineConfig unsampled;
+        unsampled.entropy.sampleAbove = bytes;
+        cls = TagEngine(unsampled).classify(big);
+        ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:0]", "da.unknown"));
     }
 
     return true;
 }
 
+// Tapscript "<32-byte key> OP_CHECKSIG" followed by an ordinal envelope
+// with content type text/plain and `body` as the (single-push) body.
+static std::string ordinalTapscriptHex(const std::string& bodyHex) {
+    std::string hex = "20" + std::string(64, '1') + "ac";
+    hex += "0063036f7264";                       // OP_FALSE OP_IF "ord"
+    hex += "01010a746578742f706c61696e";         // 1 "text/plain"
+    hex += "00";                                 // body marker
+    std::size_t n = bodyHex.size() / 2;
+    char len[24];
+    if (n < 0x4c) {
+        std::snprintf(len, sizeof(len), "%02zx", n);
+        hex += len;
+    } else {
+        std::snprintf(len, sizeof(len), "4d%02zx%02zx", n & 0xff, n >> 8); // OP_PUSHDATA2
+        hex += len;
+    }
+    hex += bodyHex;
+    hex += "68";                                 // OP_ENDIF
+    return hex;
+}
+
 static bool test_ordinal_inscription() {
     std::cout << "[TEST] ordinal / inscription witness detection\n";
 
     TagEngine engine;
 
-    // Small ord-like witness -> meta.ordinal (or meta.inscription depending on size threshold)
+    // Small envelope -> meta.ordinal, tag range covers just the envelope
     {
         Tx tx;
         tx.txid = "test-ord-small";
 
         Witness w;
-        WitnessItem item;
-        // hex for ASCII "ord" = 6f7264
-        std::string hex = "6f7264";
-        item.hex = hex;
-        w.stack.push_back(item);
+        w.stack.push_back(WitnessItem{ordinalTapscriptHex("6869")}); // "hi"
         tx.witness.push_back(w);
 
         Classification cls = engine.classify(tx);
-        ASSERT_TRUE(
-            hasLabelOnSurface(cls, "witness.stack[0:0]", "meta.ordinal") ||
-            hasLabelOnSurface(cls, "witness.stack[0:0]", "meta.inscription")
-        );
+        ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:0]", "meta.ordinal"));
+        ASSERT_TRUE(cls.tags[0].start == 34);
+        ASSERT_TRUE(cls.tags[0].end == 34 + 6 + 13 + 1 + 3 + 1);
     }
 
-    // Larger ord-like witness -> meta.inscription
+    // Large envelope -> meta.inscription
     {
         Tx tx;
         tx.txid = "test-ord-large";
 
         Witness w;
-        WitnessItem item;
-        std::string hex;
-        // Build a larger payload containing "6f7264" many times
-        for (int i = 0; i < 200; ++i) hex += "6f7264";
-        item.hex = hex;
-        w.stack.push_back(item);
+        std::string body;
+        for (int i = 0; i < 400; ++i) body += "3c";
+        w.stack.push_back(WitnessItem{ordinalTapscriptHex(body)});
         tx.witness.push_back(w);
 
         Classification cls = engine.classify(tx);
         ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:0]", "meta.inscription"));
     }
 
+    // Bare "ord" bytes are not an envelope: short ASCII stays a vendor hint,
+    // and "ord" repeated inside a large blob is just (low-entropy) unknown data.
+    {
+        Tx tx;
+        tx.txid = "test-ord-bare";
+
+        Witness w;
+        w.stack.push_back(WitnessItem{"6f7264"});
+        std::string blob;
+        for (int i = 0; i < 200; ++i) blob += "6f7264";
+        w.stack.push_back(WitnessItem{blob});
+        tx.witness.push_back(w);
+
+        Classification cls = engine.classify(tx);
+        ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:0]", "da.unregistered_vendor"));
+        ASSERT_TRUE(hasLabelOnSurface(cls, "witness.stack[0:1]", "da.unknown"));
+        ASSERT_TRUE(!hasLabelOnSurface(cls, "witness.stack[0:1]", "meta.ordinal"));
+    }
+
+    return true;
+}
+
+static bool test_policy_tables() {
+    std::cout << "[TEST] policy profiles and custom tables\n";
+
+    Tx tx;
+    tx.txid = "test-policy";
+    TxOutput out;
+    out.spk.hex = "76a91400112233445566778899aabbccddeeff0011223388ac";
+    tx.vout.push_back(out);
+    Witness w;
+    WitnessItem item;
+    item.hex = std::string(128, '0'); // 64 bytes of 0x00 -> da.unknown
+    w.stack.push_back(item);
+    w.stack.push_back(item);          // repeated label: boost counted once
+    tx.witness.push_back(w);
+
+    TagEngine engine(PolicyProfile::Strict);
+    Classification cls = engine.classify(tx);
+
+    PolicyResult strict = engine.computePolicy(cls, 1.0, 10.0);
+    ASSERT_TRUE(strict.mult == 3.0);
+    ASSERT_TRUE(strict.boostSum == -0.4);
+    ASSERT_TRUE(strict.required == 3.0);
+
+    engine.setPolicyProfile(PolicyProfile::Permissive);
+    PolicyResult permissive = engine.computePolicy(cls, 1.0, 10.0);
+    ASSERT_TRUE(permissive.mult == 1.5);
+    ASSERT_TRUE(permissive.boostSum == -0.1);
+
+    engine.setPolicyTable(PolicyTable::fromRules({
+        {"da.unknown", 5.0, -2.0},
+        {"not.a.label", 9.0, 0.5},
+    }));
+    PolicyResult custom = engine.computePolicy(cls, 2.0, 10.0);
+    ASSERT_TRUE(custom.mult == 5.0);
+    ASSERT_TRUE(custom.required == 10.0);
+    ASSERT_TRUE(custom.boostSum == -0.9); // clamped
+
+    return true;
+}
+
+static bool test_label_and_tier_interning() {
+    std::cout << "[TEST] interned labels / tiers\n";
+
+    for (LabelId id = 0; id < kLabelCount; ++id) {
+        ASSERT_TRUE(labelIdFromName(labelName(id)) == id);
+    }
+    ASSERT_TRUE(labelIdFromName("pay.standardx") == kInvalidLabel);
+    ASSERT_TRUE(labelIdFromName("") == kInvalidLabel);
+
+    TagEngine engine;
+    ASSERT_TRUE(engine.getTierForLabel("consensus.sig") == "T0");
+    ASSERT_TRUE(engine.getTierForLabel("commitment.rollup_root") == "T1");
+    ASSERT_TRUE(engine.getTierForLabel("meta.ordinal") == "T2");
+    ASSERT_TRUE(engine.getTierForLabel("da.obfuscated") == "T3");
+    // prefix fallbacks for labels outside the registry
+    ASSERT_TRUE(engine.getTierForLabel("consensus.future") == "T0");
+    ASSERT_TRUE(engine.getTierForLabel("contracts.new") == "T1");
+    ASSERT_TRUE(engine.getTierForLabel("meta.new") == "T2");
+    ASSERT_TRUE(engine.getTierForLabel("vendor.x") == "T3");
+    ASSERT_TRUE(engine.tierForLabel(label::PayStandard) == Tier::T1);
+
+    // tiersPresent iterates in T0..T3 order regardless of insertion order
+    Classification cls;
+    Tag t3;
+    t3.labels.insert(label::DaUnknown);
+    Tag t1;
+    t1.labels.insert(label::PayStandard);
+    cls.tags.push_back(t3);
+    cls.tags.push_back(t1);
+    Summary summary = engine.summarizeTiers(cls);
+    ASSERT_TRUE(summary.tiersPresent.size() == 2);
+    ASSERT_TRUE(*summary.tiersPresent.begin() == Tier::T1);
+    ASSERT_TRUE(summary.tiersPresent.contains(Tier::T3));
+    ASSERT_TRUE(!summary.tiersPresent.contains(Tier::T2));
+    ASSERT_TRUE(engine.arbdaTier(summary.counts) == Tier::T3);
+
+    return true;
+}
+
+static bool test_classification_buffer_reuse() {
+    std::cout << "[TEST] compact tags / buffer reuse\n";
+
+    Tx tx;
+    tx.txid = "test-reuse";
+    for (int i = 0; i < 12; ++i) {
+        TxOutput out;
+        out.spk.hex = "0014" + std::string(40, 'a');
+        tx.vout.push_back(out);
+    }
+    Witness w;
+    w.stack.push_back(WitnessItem{"41424344"});
+    w.stack.push_back(WitnessItem{"41424344"});
+    tx.witness.push_back(Witness{});
+    tx.witness.push_back(w);
+
+    TagEngine engine;
+    Classification cls;
+    engine.classify(tx, cls);
+    ASSERT_TRUE(cls.tags.size() == 14);
+    ASSERT_TRUE(cls.tags[11].surface() == "scriptpubkey[11]");
+    ASSERT_TRUE(cls.tags[13].kind == Surface::WitnessStack);
+    ASSERT_TRUE(cls.tags[13].surface() == "witness.stack[1:1]");
+
+    char buf[8];
+    ASSERT_TRUE(cls.tags[13].formatSurface(buf, sizeof(buf)) == 18); // truncated, full length reported
+
+    // A second classification into the same object keeps its capacity.
+    const Tag* storage = cls.tags.data();
+    Tx small;
+    small.txid = "small";
+    small.vout.push_back(tx.vout[0]);
+    engine.classify(small, cls);
+    ASSERT_TRUE(cls.txid == "small");
+    ASSERT_TRUE(cls.tags.size() == 1);
+    ASSERT_TRUE(cls.tags.data() == storage);
+
+    return true;
+}
+
+static bool test_batch_matches_single() {
+    std::cout << "[TEST] classifyBatch preserves order and matches classify\n";
+
+    std::vector<Tx> txs;
+    for (int i = 0; i < 40; ++i) {
+        Tx tx;
+        tx.txid = "batch-" + std::to_string(i);
+        TxOutput out;
+        out.spk.hex = (i % 3 == 0) ? "6a026f6b" : "76a91400112233445566778899aabbccddeeff0011223388ac";
+        tx.vout.push_back(out);
+        for (int vin = 0; vin < i % 4; ++vin) {
+            Witness w;
+            for (int k = 0; k <= vin; ++k) {
+                // sizes straddle the vendor and entropy-judging thresholds
+                w.stack.push_back(WitnessItem{std::string(static_cast<std::size_t>(64 + 300 * k), k % 2 ? '4' : '0')});
+            }
+            tx.witness.push_back(w);
+        }
+        txs.push_back(tx);
+    }
+
+    TagEngine engine;
+    engine.setBatchSplitBytes(200); // force multi-worker splits
+    ThreadPool pool(3);
+    BatchStats stats;
+    std::vector<Classification> batch = engine.classifyBatch(txs, pool, &stats);
+
+    ASSERT_TRUE(batch.size() == txs.size());
+    ASSERT_TRUE(stats.txCount == txs.size());
+    ASSERT_TRUE(stats.workUnits > txs.size());
+    for (std::size_t i = 0; i < txs.size(); ++i) {
+        Classification single = engine.classify(txs[i]);
+        ASSERT_TRUE(batch[i].txid == single.txid);
+        ASSERT_TRUE(batch[i].tags.size() == single.tags.size());
+        for (std::size_t t = 0; t < single.tags.size(); ++t) {
+            ASSERT_TRUE(batch[i].tags[t].surface() == single.tags[t].surface());
+            ASSERT_TRUE(batch[i].tags[t].end == single.tags[t].end);
+            ASSERT_TRUE(batch[i].tags[t].labels == single.tags[t].labels);
+        }
+    }
+
+    std::vector<std::uint8_t> junk = {0x01, 0x02};
+    std::vector<ByteSpan> raw = {ByteSpan(junk)};
+    std::vector<Classification> rawBatch = engine.classifyBatch(raw, pool, &stats);
+    ASSERT_TRUE(rawBatch.size() == 1 && rawBatch[0].txid == "<invalid>");
+    ASSERT_TRUE(stats.invalidCount == 1);
+
+    return true;
+}
+
+static bool test_evaluate_matches_multi_step() {
+    std::cout << "[TEST] evaluate matches classify + summarize + policy\n";
+
+    std::vector<Tx> txs;
+    for (int i = 0; i < 12; ++i) {
+        Tx tx;
+        tx.txid = "eval-" + std::to_string(i);
+        // Enough regions to span several internal blocks.
+        for (int o = 0; o < 3 * i; ++o) {
+            TxOutput out;
+            out.spk.hex = (o % 4 == 0) ? "6a026f6b"
+                        : (o % 4 == 1) ? "0014" + std::string(40, 'a')
+                        : "76a91400112233445566778899aabbccddeeff0011223388ac";
+            tx.vout.push_back(out);
+        }
+        for (int vin = 0; vin < i % 5; ++vin) {
+            Witness w;
+            for (int k = 0; k <= vin; ++k) {
+                w.stack.push_back(WitnessItem{std::string(static_cast<std::size_t>(64 + 300 * k), k % 2 ? '4' : '0')});
+            }
+            tx.witness.push_back(w);
+        }
+        txs.push_back(tx);
+    }
+
+    // Boosts that are not exactly representable make summation order visible.
+    PolicyTable custom = PolicyTable::fromRules({
+        {"pay.standard", 1.1, 0.1},
+        {"meta.indexer_hint", 1.3, 0.2},
+        {"da.op_return_embed", 1.7, 0.3},
+        {"da.unregistered_vendor", 1.9, -0.07},
+    });
+
+    for (int profile = 0; profile < 4; ++profile) {
+        TagEngine engine(profile < 3 ? static_cast<PolicyProfile>(profile) : PolicyProfile::Neutral);
+        if (profile == 3) engine.setPolicyTable(custom);
+        for (const auto& tx : txs) {
+            Classification c = engine.classify(tx);
+            Summary s = engine.summarizeTiers(c);
+            PolicyResult p = engine.computePolicy(c, 1.0, 7.3);
+            Evaluation e = engine.evaluate(tx, 1.0, 7.3);
+
+            ASSERT_TRUE(e.counts.T0 == s.counts.T0 && e.counts.T1 == s.counts.T1);
+            ASSERT_TRUE(e.counts.T2 == s.counts.T2 && e.counts.T3 == s.counts.T3);
+            ASSERT_TRUE(tierName(e.arbda) == engine.computeArbdaTierFromCounts(s.counts));
+            ASSERT_TRUE(e.policy.mult == p.mult);
+            ASSERT_TRUE(e.policy.boostSum == p.boostSum);
+            ASSERT_TRUE(e.policy.required == p.required);
+            ASSERT_TRUE(e.policy.score == p.score);
+        }
+    }
+
+    std::vector<std::uint8_t> junk = {0x01, 0x02};
+    bool threw = false;
+    try {
+        TagEngine().evaluate(ByteSpan(junk), 1.0, 1.0);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+
+    return true;
+}
+
+static bool sameEvaluation(const Evaluation& a, const Evaluation& b) {
+    return a.counts.T0 == b.counts.T0 && a.counts.T1 == b.counts.T1 &&
+           a.counts.T2 == b.counts.T2 && a.counts.T3 == b.counts.T3 && a.arbda == b.arbda &&
+           a.policy.mult == b.policy.mult && a.policy.boostSum == b.policy.boostSum &&
+           a.policy.required == b.policy.required && a.policy.score == b.policy.score;
+}
+
+static bool test_config_snapshots_under_concurrency() {
+    std::cout << "[TEST] engine config snapshots: thresholds and concurrent switches\n";
+
+    Tx blob;
+    blob.txid = "cfg-blob";
+    Witness w;
+    w.stack.push_back(WitnessItem{std::string(1200, '0')});           // 600 zero bytes
+    w.stack.push_back(WitnessItem{ordinalTapscriptHex(std::string(600, '6'))}); // ~325-byte envelope
+    blob.witness.push_back(w);
+    TxOutput hint;
+    hint.spk.hex = "6a026f6b";
+    blob.vout.push_back(hint);
+
+    // Thresholds come from the config.
+    EngineConfig tuned = EngineConfig::forProfile(PolicyProfile::Strict);
+    tuned.largeBlobThreshold = 512;
+    tuned.inscriptionThreshold = 512;
+    TagEngine engine;
+    Classification c = engine.classify(blob);
+    ASSERT_TRUE(hasLabelOnSurface(c, "witness.stack[0:0]", "da.unknown"));
+    ASSERT_TRUE(hasLabelOnSurface(c, "witness.stack[0:1]", "meta.inscription"));
+    engine.setConfig(tuned);
+    c = engine.classify(blob);
+    ASSERT_TRUE(hasLabelOnSurface(c, "witness.stack[0:0]", "da.obfuscated"));
+    ASSERT_TRUE(hasLabelOnSurface(c, "witness.stack[0:1]", "meta.ordinal"));
+    ASSERT_TRUE(engine.config()->profile == PolicyProfile::Strict);
+    engine.setPolicyProfile(PolicyProfile::Permissive);
+    ASSERT_TRUE(engine.config()->profile == PolicyProfile::Permissive);
+    ASSERT_TRUE(engine.config()->largeBlobThreshold == 512); // setters keep the rest
+
+    // Every combination of thresholds, registry and profile the writer can
+    // produce; each result seen by a reader must match exactly one of them.
+    Registry shifted;
+    ASSERT_TRUE(Registry::fromJson(
+        "{\"labels\": [{\"label\": \"da.unknown\", \"suggested_tier\": \"T1\"},"
+        " {\"label\": \"meta.indexer_hint\", \"suggested_tier\": \"T0\"}]}", shifted));
+    std::vector<EngineConfig> configs;
+    for (int variant = 0; variant < 4; ++variant) {
+        for (int p = 0; p < 3; ++p) {
+            EngineConfig cfg = EngineConfig::forProfile(static_cast<PolicyProfile>(p));
+            if (variant & 1) {
+                cfg.largeBlobThreshold = tuned.largeBlobThreshold;
+                cfg.inscriptionThreshold = tuned.inscriptionThreshold;
+            }
+            if (variant & 2) cfg.registry = shifted;
+            configs.push_back(cfg);
+        }
+    }
+
+    std::vector<Tx> txs{blob};
+    for (int i = 0; i < 6; ++i) {
+        Tx tx = blob;
+        tx.txid = "cfg-" + std::to_string(i);
+        tx.witness[0].stack[0].hex = std::string(static_cast<std::size_t>(400 * i), '0');
+        txs.push_back(tx);
+    }
+    std::vector<std::vector<Evaluation>> expected(configs.size());
+    for (std::size_t k = 0; k < configs.size(); ++k) {
+        TagEngine reference(configs[k]);
+        for (const auto& tx : txs) expected[k].push_back(reference.evaluate(tx, 1.0, 5.0));
+    }
+
+    TagEngine shared;
+    shared.setConfig(configs[0]);
+    std::atomic<bool> stop{false};
+    std::atomic<std::size_t> mismatches{0}, evaluations{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 8; ++t) {
+        readers.emplace_back([&, t] {
+            for (std::size_t i = static_cast<std::size_t>(t); !stop.load(std::memory_order_relaxed); ++i) {
+                std::size_t j = i % txs.size();
+                Evaluation e = shared.evaluate(txs[j], 1.0, 5.0);
+                bool matched = false;
+                for (const auto& perConfig : expected) matched = matched || sameEvaluation(e, perConfig[j]);
+                if (!matched) mismatches.fetch_add(1, std::memory_order_relaxed);
+                evaluations.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (int round = 0; round < 400; ++round) {
+        // Keep readers interleaved with the writer even on a single core.
+        while (evaluations.load(std::memory_order_relaxed) < static_cast<std::size_t>(round)) {
+            std::this_thread::yield();
+        }
+        shared.setConfig(configs[static_cast<std::size_t>(round * 5) % configs.size()]);
+        if (round % 3 == 0) shared.setPolicyProfile(static_cast<PolicyProfile>((round / 3) % 3));
+        if (round % 5 == 0) shared.setRegistry(round % 2 ? shifted : Registry());
+    }
+    stop.store(true);
+    for (auto& r : readers) r.join();
+
+    ASSERT_TRUE(mismatches.load() == 0);
+    ASSERT_TRUE(evaluations.load() > 0);
+
+    return true;
+}
+
+static bool test_work_budget() {
+    std::cout << "[TEST] budgeted classify / evaluate truncate to da.unknown\n";
+
+    Tx tx;
+    tx.txid = "budget";
+    TxOutput p2pkh;
+    p2pkh.spk.hex = "76a91400112233445566778899aabbccddeeff0011223388ac";
+    tx.vout.push_back(p2pkh);
+    Witness w;
+    w.stack.push_back(WitnessItem{"6f6b"});                        // ascii vendor
+    w.stack.push_back(WitnessItem{std::string(2000, '0')});        // 1000-byte blob
+    std::uint32_t state = 0x510e527f;
+    w.stack.push_back(WitnessItem{randomHex(10000, state)});       // 10000-byte random blob
+    tx.witness.push_back(w);
+
+    TagEngine engine;
+    Classification full = engine.classify(tx);
+    Evaluation plain = engine.evaluate(tx, 1.0, 5.0);
+
+    // A budget that covers everything changes nothing.
+    for (std::size_t maxBytes : {std::size_t(0), std::size_t(128 * 1024)}) {
+        WorkBudget budget;
+        budget.maxBytes = maxBytes;
+        Classification c;
+        engine.classify(tx, budget, c);
+        ASSERT_TRUE(!c.truncated && c.txid == full.txid && c.tags.size() == full.tags.size());
+        for (std::size_t i = 0; i < c.tags.size(); ++i) ASSERT_TRUE(c.tags[i].labels == full.tags[i].labels);
+        Evaluation e = engine.evaluate(tx, 1.0, 5.0, budget);
+        ASSERT_TRUE(!e.truncated && sameEvaluation(e, plain));
+    }
+
+    // Room for the output, the vendor item and the first blob only: the
+    // remaining region is left unscanned and tagged da.unknown.
+    WorkBudget tight;
+    tight.maxBytes = 25 + 2 + 1000 + 3 * WorkBudget::kRegionCost;
+    Classification c;
+    engine.classify(tx, tight, c);
+    ASSERT_TRUE(c.truncated && c.tags.size() == 4);
+    for (std::size_t i = 0; i < 3; ++i) ASSERT_TRUE(c.tags[i].labels == full.tags[i].labels);
+    ASSERT_TRUE(hasLabelOnSurface(full, "witness.stack[0:2]", "da.obfuscated"));
+    ASSERT_TRUE(hasLabelOnSurface(c, "witness.stack[0:2]", "da.unknown"));
+    ASSERT_TRUE(c.tags[3].start == 0 && c.tags[3].end == 10000);
+    Evaluation e = engine.evaluate(tx, 1.0, 5.0, tight);
+    ASSERT_TRUE(e.truncated && e.arbda == Tier::T3);
+    ASSERT_TRUE(e.counts.T3 == plain.counts.T3);  // blob swapped for da.unknown
+
+    // Once a region is refused, later smaller ones are not scanned either.
+    tight.maxBytes -= 1000;
+    engine.classify(tx, tight, c);
+    ASSERT_TRUE(c.truncated && c.tags[1].labels == full.tags[1].labels);
+    ASSERT_TRUE(hasLabelOnSurface(c, "witness.stack[0:1]", "da.unknown"));
+
+    // Buffer reuse clears the flag.
+    engine.classify(tx, c);
+    ASSERT_TRUE(!c.truncated);
+
+    // Raw path, and a time limit that is exhausted almost immediately: a
+    // transaction with thousands of regions cannot finish within 1ns.
+    std::vector<std::uint8_t> raw;
+    for (const char* p = "02000000000101000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+                         "0100000000fdffffff02e8030000000000001976a91400112233445566778899aabbccddeeff00"
+                         "11223388ac0000000000000000046a026f6b020a3031323334353637383903010203"
+                         "00000000"; *p; p += 2) {
+        raw.push_back(static_cast<std::uint8_t>(std::stoul(std::string(p, 2), nullptr, 16)));
+    }
+    WorkBudget outputOnly;
+    outputOnly.maxBytes = 25 + WorkBudget::kRegionCost;
+    e = engine.evaluate(ByteSpan(raw), 1.0, 5.0, outputOnly);
+    ASSERT_TRUE(e.truncated && e.counts.T1 == 1 && e.counts.T3 == 3);
+
+    Tx wide;
+    Witness many;
+    for (int i = 0; i < 5000; ++i) many.stack.push_back(WitnessItem{"30440220"});
+    wide.witness.push_back(many);
+    // evaluate accounts for the unscanned tail in bulk; it must agree with
+    // the per-region tags of the budgeted classify.
+    WorkBudget hundred;
+    hundred.maxBytes = 100 * (4 + WorkBudget::kRegionCost);
+    engine.classify(wide, hundred, c);
+    Summary summary = engine.summarizeTiers(c);
+    e = engine.evaluate(wide, 1.0, 5.0, hundred);
+    ASSERT_TRUE(c.truncated && e.truncated);
+    ASSERT_TRUE(e.counts.T3 == summary.counts.T3 && e.counts.T3 == 5000);
+    ASSERT_TRUE(e.policy.mult == engine.computePolicy(c, 1.0, 5.0).mult);
+
+    WorkBudget instant;
+    instant.maxBytes = 0;
+    instant.maxTime = std::chrono::nanoseconds(1);
+    engine.classify(wide, instant, c);
+    ASSERT_TRUE(c.truncated && c.tags.size() == 5000);
+    ASSERT_TRUE(hasLabelOnSurface(c, "witness.stack[0:4999]", "da.unknown"));
+
+    return true;
+}
+
+static bool test_triage_matches_evaluate() {
+    std::cout << "[TEST] triage ARBDA verdict matches evaluate; lazy classification\n";
+
+    // Every region kind the detectors distinguish, mixed so that some
+    // transactions carry no T3 region at all.
+    const std::vector<std::string> outputs = {
+        "76a91400112233445566778899aabbccddeeff0011223388ac",
+        "6a026f6b",                                         // indexer hint
+        "6a20" + std::string(64, 'c'),                      // rollup root
+        "6a4c64" + std::string(200, '7'),                   // embed_misc
+        "0014" + std::string(40, 'a'),
+    };
+    std::uint32_t blobState = 0x3c6ef372;
+    const std::vector<std::string> items = {
+        ordinalTapscriptHex("6869"),                        // meta.ordinal
+        ordinalTapscriptHex(std::string(1200, '5')),        // meta.inscription
+        "6f6b",                                             // vendor
+        std::string(144, 'e'),                              // da.unknown
+        randomHex(700, blobState),                          // da.obfuscated
+    };
+    std::vector<Tx> txs;
+    std::uint32_t state = 0x9e3779b9;
+    for (int i = 0; i < 300; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        Tx tx;
+        tx.txid = "triage-" + std::to_string(i);
+        for (std::uint32_t o = 0; o < 1 + state % 4; ++o) {
+            TxOutput out;
+            out.spk.hex = outputs[(state >> (4 + 3 * o)) % outputs.size()];
+            tx.vout.push_back(out);
+        }
+        Witness w;
+        // Only envelopes on odd transactions, so ARBDA < T3 happens.
+        for (std::uint32_t k = 0; k < (state >> 20) % 3; ++k) {
+            std::size_t pick = (state >> (22 + 2 * k)) % items.size();
+            w.stack.push_back(WitnessItem{items[i % 2 ? pick % 2 : pick]});
+        }
+        tx.witness.push_back(w);
+        txs.push_back(tx);
+    }
+
+    // Defaults take every shortcut; the others force detectors to run.
+    Registry split;
+    ASSERT_TRUE(Registry::fromJson(
+        "{\"labels\": [{\"label\": \"da.unknown\", \"suggested_tier\": \"T1\"},"
+        " {\"label\": \"meta.inscription\", \"suggested_tier\": \"T3\"},"
+        " {\"label\": \"meta.indexer_hint\", \"suggested_tier\": \"T0\"}]}", split));
+    int belowT3 = 0, early = 0;
+    for (int variant = 0; variant < 2; ++variant) {
+        TagEngine engine;
+        if (variant == 1) engine.setRegistry(split);
+        for (const auto& tx : txs) {
+            ArbdaVerdict v = engine.triage(tx);
+            ASSERT_TRUE(v.arbda == engine.evaluate(tx, 1.0, 1.0).arbda);
+            ASSERT_TRUE(v.regionsExamined <= tx.vout.size() + tx.witness[0].stack.size());
+            ASSERT_TRUE(!v.earlyExit || v.arbda == Tier::T3);
+            belowT3 += v.arbda != Tier::T3;
+            early += v.earlyExit;
+        }
+    }
+    ASSERT_TRUE(belowT3 > 0 && early > 0);
+
+    // Raw path: witness items are reached first, so the verdict is in after
+    // one region and the OP_RETURN output is never looked at.
+    std::vector<std::uint8_t> raw;
+    for (const char* p = "02000000000101000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+                         "0100000000fdffffff02e8030000000000001976a91400112233445566778899aabbccddeeff00"
+                         "11223388ac0000000000000000046a026f6b020a3031323334353637383903010203"
+                         "00000000"; *p; p += 2) {
+        raw.push_back(static_cast<std::uint8_t>(std::stoul(std::string(p, 2), nullptr, 16)));
+    }
+    TagEngine engine;
+    ArbdaVerdict v = engine.triage(ByteSpan(raw));
+    ASSERT_TRUE(v.arbda == Tier::T3 && v.regionsExamined == 1 && v.earlyExit);
+
+    LazyClassification lazy(engine, ByteSpan(raw));
+    ASSERT_TRUE(lazy.arbda() == Tier::T3 && !lazy.materialized());
+    const Classification& full = lazy.classification();
+    ASSERT_TRUE(lazy.materialized() && &lazy.classification() == &full);
+    Classification direct = engine.classify(ByteSpan(raw));
+    ASSERT_TRUE(full.txid == direct.txid && full.tags.size() == direct.tags.size());
+    for (std::size_t i = 0; i < full.tags.size(); ++i) ASSERT_TRUE(full.tags[i].labels == direct.tags[i].labels);
+
+    raw.pop_back();
+    bool threw = false;
+    try {
+        LazyClassification broken(engine, ByteSpan(raw));
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+
     return true;
 }
 
@@ -216,6 +874,14 @@ int main() {
     if (!test_opreturn_hint_and_rollup()) return 1;
     if (!test_witness_vendor_unknown_obfuscated()) return 1;
     if (!test_ordinal_inscription()) return 1;
+    if (!test_policy_tables()) return 1;
+    if (!test_label_and_tier_interning()) return 1;
+    if (!test_classification_buffer_reuse()) return 1;
+    if (!test_batch_matches_single()) return 1;
+    if (!test_evaluate_matches_multi_step()) return 1;
+    if (!test_config_snapshots_under_concurrency()) return 1;
+    if (!test_work_budget()) return 1;
+    if (!test_triage_matches_evaluate()) return 1;
 
     std::cout << "All BUDS TagEngine tests passed.\n";
     return 0;
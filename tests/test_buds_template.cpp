@@ -0,0 +1,235 @@
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "buds_template.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+static std::uint32_t nextRand(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static TemplateCandidate makeTx(std::uint32_t weight, double score, Tier tier = Tier::T1,
+                                std::uint32_t labelMask = 0) {
+    TemplateCandidate c;
+    c.id.bytes[0] = static_cast<std::uint8_t>(weight);
+    c.weight = weight;
+    c.fee = static_cast<std::uint64_t>(score * weight / 4);
+    c.score = score;
+    c.arbda = tier;
+    c.labelMask = labelMask;
+    return c;
+}
+
+// Every parent is selected before its child, nothing twice, caps hold.
+static bool checkValid(const TemplateBuilder& b, const BlockTemplate& t,
+                       const std::vector<std::vector<std::uint32_t>>& parents,
+                       const TemplateLimits& limits) {
+    std::vector<int> pos(b.size(), -1);
+    std::uint64_t weight = 0;
+    for (std::size_t i = 0; i < t.txs.size(); ++i) {
+        std::uint32_t v = t.txs[i];
+        ASSERT_TRUE(pos[v] == -1);
+        pos[v] = static_cast<int>(i);
+        for (std::uint32_t p : parents[v]) ASSERT_TRUE(pos[p] >= 0);
+        weight += b.candidate(v).weight;
+    }
+    ASSERT_TRUE(weight == t.weight);
+    ASSERT_TRUE(t.weight <= limits.maxWeight);
+    for (std::size_t tier = 0; tier < kTierCount; ++tier) {
+        ASSERT_TRUE(t.tierWeight[tier] <= limits.tierShare[tier] * limits.maxWeight);
+    }
+    return true;
+}
+
+// --- Tests ---
+
+static bool test_child_pays_for_parent() {
+    std::cout << "[TEST] template: ancestor packages and parent ordering\n";
+
+    TemplateBuilder b;
+    std::uint32_t parent = b.add(makeTx(1000, 1.0));
+    std::uint32_t filler = b.add(makeTx(1000, 5.0));
+    std::uint32_t child = b.add(makeTx(1000, 20.0), &parent, 1);
+    b.computeAncestorScores();
+    ASSERT_TRUE(b.candidate(child).ancestorScore == 10.5);
+
+    // Room for two: the parent+child package (10.5) beats the filler (5.0).
+    TemplateLimits limits;
+    limits.maxWeight = 2000;
+    BlockTemplate t = b.build(limits);
+    ASSERT_TRUE(t.txs.size() == 2);
+    ASSERT_TRUE(t.txs[0] == parent && t.txs[1] == child);
+    ASSERT_TRUE(t.weight == 2000);
+    (void)filler;
+
+    return true;
+}
+
+static bool test_tier_and_label_caps() {
+    std::cout << "[TEST] template: tier and label weight caps\n";
+
+    TemplateBuilder b;
+    std::vector<std::vector<std::uint32_t>> parents;
+    const std::uint32_t inscription = 1u << label::MetaInscription;
+    for (int i = 0; i < 100; ++i) {
+        // High-paying T3 and inscription traffic, cheaper T1 payments.
+        b.add(makeTx(1000, 50.0, Tier::T3));
+        b.add(makeTx(1000, 40.0, Tier::T2, inscription));
+        b.add(makeTx(1000, 10.0, Tier::T1));
+        parents.resize(parents.size() + 3);
+    }
+
+    TemplateLimits limits;
+    limits.maxWeight = 50000;
+    limits.tierShare[static_cast<std::size_t>(Tier::T3)] = 0.1;
+    limits.labelShare.push_back({label::MetaInscription, 0.2});
+    BlockTemplate t = b.build(limits);
+
+    ASSERT_TRUE(checkValid(b, t, parents, limits));
+    ASSERT_TRUE(t.tierWeight[static_cast<std::size_t>(Tier::T3)] == 5000);
+    ASSERT_TRUE(t.tierWeight[static_cast<std::size_t>(Tier::T2)] == 10000);
+    ASSERT_TRUE(t.tierWeight[static_cast<std::size_t>(Tier::T1)] == 35000);
+    ASSERT_TRUE(t.weight == 50000);
+
+    return true;
+}
+
+static bool test_swap_pass() {
+    std::cout << "[TEST] template: swap pass trades cheap leaves for a rejected package\n";
+
+    TemplateBuilder b;
+    std::uint32_t a = b.add(makeTx(1500, 10.0));
+    std::uint32_t x = b.add(makeTx(1000, 9.0));
+    std::uint32_t big = b.add(makeTx(1500, 8.9));
+    std::uint32_t y = b.add(makeTx(500, 1.0));
+
+    TemplateLimits limits;
+    limits.maxWeight = 3000;
+    limits.improve = false;
+    BlockTemplate greedy = b.build(limits);
+    ASSERT_TRUE(greedy.txs.size() == 3);
+    ASSERT_TRUE(greedy.txs[0] == a && greedy.txs[1] == x && greedy.txs[2] == y);
+
+    // Dropping x and y (value 9500) makes room for `big` (value 13350).
+    limits.improve = true;
+    BlockTemplate swapped = b.build(limits);
+    ASSERT_TRUE(swapped.greedyCount == 3);
+    ASSERT_TRUE(swapped.txs.size() == 2);
+    ASSERT_TRUE(swapped.txs[0] == a && swapped.txs[1] == big);
+    ASSERT_TRUE(swapped.weight == 3000);
+
+    return true;
+}
+
+static bool test_swap_pass_keeps_parents_and_no_duplicates() {
+    std::cout << "[TEST] template: swap pass never evicts a parent or lists a tx twice\n";
+
+    auto tx = [](std::uint32_t weight, double score, double ancestorScore) {
+        TemplateCandidate c = makeTx(weight, score);
+        c.ancestorScore = ancestorScore;
+        return c;
+    };
+    TemplateBuilder b;
+    std::vector<std::vector<std::uint32_t>> parents(6);
+    b.add(tx(500, 7.0, 9.0));                      // F1
+    std::uint32_t a = b.add(tx(200, 0.5, 5.0));    // A
+    b.add(tx(400, 4.0, 4.0));                      // B
+    b.add(tx(400, 10.0, 3.0), &a, 1);              // C, spends A
+    parents[3].push_back(a);
+    b.add(tx(200, 20.0, 2.0));                     // D
+    b.add(tx(40, 0.1, 1.5));                       // X
+
+    TemplateLimits limits;
+    limits.maxWeight = 1150;
+    BlockTemplate t = b.build(limits);
+    ASSERT_TRUE(checkValid(b, t, parents, limits));
+    std::uint64_t fees = 0;
+    for (std::uint32_t v : t.txs) fees += b.candidate(v).fee;
+    ASSERT_TRUE(t.fees == fees);
+
+    // Small mempools with tight blocks and arbitrary ancestor scores make
+    // the swap pass evict, re-admit and re-evict the same txs.
+    std::uint32_t seed = 0x7e3a11c5;
+    for (int round = 0; round < 5000; ++round) {
+        TemplateBuilder rb;
+        std::vector<std::vector<std::uint32_t>> rparents;
+        std::uint32_t count = 3 + nextRand(seed) % 10;
+        for (std::uint32_t i = 0; i < count; ++i) {
+            std::vector<std::uint32_t> ps;
+            if (i > 0 && nextRand(seed) % 2) ps.push_back(nextRand(seed) % i);
+            if (i > 1 && nextRand(seed) % 2) {
+                std::uint32_t q = nextRand(seed) % i;
+                if (ps.empty() || ps[0] != q) ps.push_back(q);
+            }
+            rb.add(tx(20 + nextRand(seed) % 500, (nextRand(seed) % 200) / 10.0,
+                      0.01 + (nextRand(seed) % 100) / 10.0),
+                   ps.data(), ps.size());
+            rparents.push_back(ps);
+        }
+        if (round % 2) rb.computeAncestorScores();
+        TemplateLimits rl;
+        rl.maxWeight = 300 + nextRand(seed) % 1500;
+        BlockTemplate rt = rb.build(rl);
+        ASSERT_TRUE(checkValid(rb, rt, rparents, rl));
+        fees = 0;
+        for (std::uint32_t v : rt.txs) fees += rb.candidate(v).fee;
+        ASSERT_TRUE(rt.fees == fees);
+    }
+
+    return true;
+}
+
+static bool test_random_mempool_is_valid() {
+    std::cout << "[TEST] template: random mempool yields a valid template\n";
+
+    std::uint32_t seed = 0x5eed1234;
+    TemplateBuilder b;
+    std::vector<std::vector<std::uint32_t>> parents;
+    for (std::uint32_t i = 0; i < 20000; ++i) {
+        std::vector<std::uint32_t> ps;
+        if (i > 10 && nextRand(seed) % 3 == 0) {
+            std::uint32_t k = 1 + nextRand(seed) % 2;
+            for (std::uint32_t j = 0; j < k; ++j) ps.push_back(i - 1 - nextRand(seed) % 10);
+        }
+        Tier tier = static_cast<Tier>(nextRand(seed) % kTierCount);
+        std::uint32_t mask = 1u << (nextRand(seed) % kLabelCount);
+        b.add(makeTx(400 + nextRand(seed) % 4000, 1.0 + nextRand(seed) % 100, tier, mask),
+              ps.data(), ps.size());
+        parents.push_back(ps);
+    }
+    b.computeAncestorScores();
+
+    TemplateLimits limits;
+    limits.tierShare[static_cast<std::size_t>(Tier::T3)] = 0.05;
+    limits.labelShare.push_back({label::DaObfuscated, 0.02});
+    BlockTemplate t = b.build(limits);
+    ASSERT_TRUE(checkValid(b, t, parents, limits));
+    ASSERT_TRUE(t.weight > limits.maxWeight * 0.99);
+
+    return true;
+}
+
+int main() {
+    if (!test_child_pays_for_parent()) return 1;
+    if (!test_tier_and_label_caps()) return 1;
+    if (!test_swap_pass()) return 1;
+    if (!test_swap_pass_keeps_parents_and_no_duplicates()) return 1;
+    if (!test_random_mempool_is_valid()) return 1;
+
+    std::cout << "All BUDS template builder tests passed.\n";
+    return 0;
+}
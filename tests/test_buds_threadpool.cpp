@@ -0,0 +1,119 @@
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "buds_threadpool.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+// --- Tests ---
+
+static bool test_parallel_for_covers_every_index() {
+    std::cout << "[TEST] parallelFor runs each index exactly once\n";
+
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> hits(10007);
+    for (auto& h : hits) h.store(0);
+
+    pool.parallelFor(hits.size(), [&](std::size_t i) { hits[i].fetch_add(1); });
+    for (auto& h : hits) ASSERT_TRUE(h.load() == 1);
+
+    pool.parallelFor(hits.size(), [&](std::size_t i) { hits[i].fetch_add(1); }, 1);
+    for (auto& h : hits) ASSERT_TRUE(h.load() == 2);
+
+    pool.parallelFor(0, [&](std::size_t) { hits[0].fetch_add(1); });
+    ASSERT_TRUE(hits[0].load() == 2);
+
+    return true;
+}
+
+static bool test_nested_and_exceptions() {
+    std::cout << "[TEST] nested parallelFor / exception propagation\n";
+
+    ThreadPool pool(2);
+    std::atomic<int> total{0};
+    // Waiting workers help run queued chunks, so nesting cannot deadlock.
+    pool.parallelFor(8, [&](std::size_t) {
+        pool.parallelFor(8, [&](std::size_t) { total.fetch_add(1); });
+    });
+    ASSERT_TRUE(total.load() == 64);
+
+    bool threw = false;
+    try {
+        pool.parallelFor(100, [](std::size_t i) {
+            if (i == 42) throw std::runtime_error("boom");
+        });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+
+    return true;
+}
+
+static double threadCpuSeconds() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+static bool test_waiter_sleeps_on_slow_chunk() {
+    std::cout << "[TEST] parallelFor caller sleeps while the last chunk runs\n";
+
+    ThreadPool pool(2);
+    // Chunks on a worker block for 200ms without using the CPU; chunks the
+    // caller picks up return once a worker is busy, so the caller is always
+    // left waiting for a worker's chunk.
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<bool> workerBusy{false};
+    double cpu0 = threadCpuSeconds();
+    auto t0 = std::chrono::steady_clock::now();
+    pool.parallelFor(3, [&](std::size_t) {
+        if (std::this_thread::get_id() != caller) {
+            workerBusy.store(true);
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            return;
+        }
+        while (!workerBusy.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }, 1);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    double cpu = threadCpuSeconds() - cpu0;
+    ASSERT_TRUE(wall >= 0.19);
+    ASSERT_TRUE(cpu < 0.05);   // a yield loop would burn most of the wait
+
+    // Nested fan-out still completes when every waiter may be asleep.
+    std::atomic<int> total{0};
+    for (int round = 0; round < 50; ++round) {
+        pool.parallelFor(4, [&](std::size_t) {
+            pool.parallelFor(4, [&](std::size_t) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                total.fetch_add(1);
+            }, 1);
+        }, 1);
+    }
+    ASSERT_TRUE(total.load() == 50 * 16);
+
+    return true;
+}
+
+int main() {
+    if (!test_parallel_for_covers_every_index()) return 1;
+    if (!test_nested_and_exceptions()) return 1;
+    if (!test_waiter_sleeps_on_slow_chunk()) return 1;
+
+    std::cout << "All BUDS ThreadPool tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "buds_tagger.h"
+#include "buds_tx.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+static std::vector<std::uint8_t> fromHex(const std::string& hex) {
+    std::vector<std::uint8_t> out;
+    for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+        out.push_back(static_cast<std::uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    }
+    return out;
+}
+
+// version 2, one input, outputs [P2PKH, OP_RETURN "ok"], witness ["0123456789", 010203]
+static const char* kSegwitTx =
+    "02000000000101000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "0100000000fdffffff02e8030000000000001976a91400112233445566778899aabbccddeeff00"
+    "11223388ac0000000000000000046a026f6b020a3031323334353637383903010203"
+    "00000000";
+
+// --- Tests ---
+
+static bool test_parse_segwit_tx() {
+    std::cout << "[TEST] parse segwit tx in place\n";
+
+    std::vector<std::uint8_t> raw = fromHex(kSegwitTx);
+    TxView view;
+    ASSERT_TRUE(parseTx(raw, view));
+    ASSERT_TRUE(view.segwit);
+    ASSERT_TRUE(view.version == 2);
+    ASSERT_TRUE(view.vin.size() == 1);
+    ASSERT_TRUE(view.vin[0].sequence == 0xfffffffd);
+    ASSERT_TRUE(view.vout.size() == 2);
+    ASSERT_TRUE(view.vout[0].value == 1000);
+    ASSERT_TRUE(view.vout[0].scriptPubKey.size() == 25);
+    ASSERT_TRUE(view.vout[0].scriptPubKey.data() > raw.data());
+    ASSERT_TRUE(view.vin[0].witnessCount == 2);
+    ASSERT_TRUE(view.witnessItem(0, 0).size() == 10);
+    ASSERT_TRUE(view.witnessItem(0, 1).size() == 3);
+
+    ASSERT_TRUE(view.txid().toHex() ==
+                "ff2d8536ff0e9e9f969d2290a1a65de85933092a06a0bb2e0849b2a2a12010b9");
+    ASSERT_TRUE(view.wtxid().toHex() ==
+                "1f45c10c2042ef858339ecf4d6b29bbdbab599a072c19434ad4ce012d6697d39");
+
+    // Truncated and trailing-garbage inputs are rejected.
+    std::vector<std::uint8_t> truncated(raw.begin(), raw.end() - 1);
+    ASSERT_TRUE(!parseTx(truncated, view));
+    std::vector<std::uint8_t> padded = raw;
+    padded.push_back(0);
+    ASSERT_TRUE(!parseTx(padded, view));
+    std::size_t consumed = 0;
+    ASSERT_TRUE(parseTx(padded, view, &consumed));
+    ASSERT_TRUE(consumed == raw.size());
+
+    return true;
+}
+
+static bool test_raw_matches_hex_adapter() {
+    std::cout << "[TEST] raw classify matches hex adapter\n";
+
+    std::vector<std::uint8_t> raw = fromHex(kSegwitTx);
+    TagEngine engine;
+    Classification fromRaw = engine.classify(ByteSpan(raw));
+
+    Tx tx;
+    tx.txid = "ff2d8536ff0e9e9f969d2290a1a65de85933092a06a0bb2e0849b2a2a12010b9";
+    TxOutput p2pkh;
+    p2pkh.spk.hex = "76a91400112233445566778899aabbccddeeff0011223388ac";
+    tx.vout.push_back(p2pkh);
+    TxOutput opReturn;
+    opReturn.spk.hex = "6A026F6B"; // case-insensitive
+    tx.vout.push_back(opReturn);
+    Witness w;
+    w.stack.push_back(WitnessItem{"30313233343536373839"});
+    w.stack.push_back(WitnessItem{"010203"});
+    tx.witness.push_back(w);
+    Classification fromHexTx = engine.classify(tx);
+
+    ASSERT_TRUE(fromRaw.txid == fromHexTx.txid);
+    ASSERT_TRUE(fromRaw.tags.size() == fromHexTx.tags.size());
+    for (std::size_t i = 0; i < fromRaw.tags.size(); ++i) {
+        ASSERT_TRUE(fromRaw.tags[i].surface() == fromHexTx.tags[i].surface());
+        ASSERT_TRUE(fromRaw.tags[i].end == fromHexTx.tags[i].end);
+        ASSERT_TRUE(fromRaw.tags[i].labels == fromHexTx.tags[i].labels);
+    }
+
+    bool threw = false;
+    try {
+        raw.pop_back();
+        engine.classify(ByteSpan(raw));
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+
+    return true;
+}
+
+int main() {
+    if (!test_parse_segwit_tx()) return 1;
+    if (!test_raw_matches_hex_adapter()) return 1;
+
+    std::cout << "All BUDS TxView tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,247 @@
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "buds_txindex.h"
+
+using namespace buds;
+
+#define ASSERT_TRUE(expr)                                                   \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::cerr << "ASSERT FAILED: " #expr                            \
+                      << " at " << __FILE__ << ":" << __LINE__ << "\n";     \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+static Hash256 txidFor(std::uint32_t n) {
+    std::uint8_t b[4] = {std::uint8_t(n), std::uint8_t(n >> 8), std::uint8_t(n >> 16),
+                         std::uint8_t(n >> 24)};
+    return sha256d(ByteSpan(b, 4));
+}
+
+static TxIndexEntry entryFor(std::uint32_t n, std::uint32_t height) {
+    TxIndexEntry e;
+    e.txid = txidFor(n);
+    e.height = height;
+    e.arbda = static_cast<Tier>(n % 4);
+    e.compact.counts.T0 = static_cast<int>(n % 7);
+    e.compact.counts.T3 = static_cast<int>(n % 3);
+    e.compact.labelCount = 2;
+    e.compact.labels[0] = label::PayStandard;
+    e.compact.labels[1] = static_cast<std::uint8_t>(n % kLabelCount);
+    return e;
+}
+
+static bool matches(const TxIndex& index, std::uint32_t n, std::uint32_t height) {
+    TxIndexEntry e;
+    if (!index.find(txidFor(n), e)) return false;
+    TxIndexEntry want = entryFor(n, height);
+    return e.txid == want.txid && e.height == height && e.arbda == want.arbda &&
+           e.compact.counts.T0 == want.compact.counts.T0 &&
+           e.compact.counts.T3 == want.compact.counts.T3 && e.compact.labelCount == 2 &&
+           e.compact.labels[1] == want.compact.labels[1];
+}
+
+static std::filesystem::path freshDir(const char* name) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+// --- Tests ---
+
+static bool test_txindex_append_find_reopen() {
+    std::cout << "[TEST] txid index append, lookup, overwrite and reopen\n";
+
+    std::filesystem::path dir = freshDir("buds_txindex_test");
+    std::string path = (dir / "tx").string();
+    {
+        TxIndex index;
+        std::string error;
+        ASSERT_TRUE(index.open(path, &error));
+        // Enough entries to grow the table several times from its minimum.
+        for (std::uint32_t n = 0; n < 5000; ++n) ASSERT_TRUE(index.append(entryFor(n, 100 + n / 10)));
+        ASSERT_TRUE(index.size() == 5000);
+        ASSERT_TRUE(index.stats().capacity >= 8192);
+        for (std::uint32_t n = 0; n < 5000; n += 7) ASSERT_TRUE(matches(index, n, 100 + n / 10));
+
+        // A reorg re-confirms tx 42 higher up: the latest record wins.
+        ASSERT_TRUE(index.append(entryFor(42, 9999)));
+        ASSERT_TRUE(index.size() == 5000);
+        ASSERT_TRUE(index.stats().records == 5001);
+        ASSERT_TRUE(matches(index, 42, 9999));
+
+        TxIndexEntry e;
+        ASSERT_TRUE(!index.find(txidFor(123456), e));
+        ASSERT_TRUE(index.sync());
+    }
+
+    TxIndex index;
+    ASSERT_TRUE(index.open(path));
+    TxIndexStats stats = index.stats();
+    ASSERT_TRUE(stats.replayed == 0);
+    ASSERT_TRUE(stats.droppedBytes == 0);
+    ASSERT_TRUE(index.size() == 5000);
+    for (std::uint32_t n = 0; n < 5000; ++n) {
+        if (n != 42) ASSERT_TRUE(matches(index, n, 100 + n / 10));
+    }
+    ASSERT_TRUE(matches(index, 42, 9999));
+
+    index.close();
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+static bool test_txindex_recovery() {
+    std::cout << "[TEST] txid index recovers from a stale table and a torn log\n";
+
+    std::filesystem::path dir = freshDir("buds_txindex_recovery");
+    std::string path = (dir / "tx").string();
+    std::filesystem::path idx = path + ".idx";
+    std::filesystem::path log = path + ".log";
+    {
+        TxIndex index;
+        ASSERT_TRUE(index.open(path));
+        for (std::uint32_t n = 0; n < 1000; ++n) index.append(entryFor(n, n));
+        ASSERT_TRUE(index.sync());
+    }
+    std::filesystem::copy_file(idx, dir / "covers1000.idx");
+    {
+        TxIndex index;
+        ASSERT_TRUE(index.open(path));
+        for (std::uint32_t n = 1000; n < 1500; ++n) index.append(entryFor(n, n));
+    } // close() syncs
+
+    // Crash before the table reached disk: the old table covers 1000 records.
+    std::filesystem::copy_file(dir / "covers1000.idx", idx,
+                               std::filesystem::copy_options::overwrite_existing);
+    {
+        TxIndex index;
+        ASSERT_TRUE(index.open(path));
+        ASSERT_TRUE(index.stats().replayed == 500);
+        ASSERT_TRUE(index.size() == 1500);
+        for (std::uint32_t n = 0; n < 1500; n += 3) ASSERT_TRUE(matches(index, n, n));
+    }
+
+    // Torn tail: half a record of garbage after the last good one.
+    {
+        std::ofstream out(log, std::ios::binary | std::ios::app);
+        out.write("garbage-garbage-garbage-garbage-garbage!", 40);
+    }
+    {
+        TxIndex index;
+        ASSERT_TRUE(index.open(path));
+        ASSERT_TRUE(index.stats().droppedBytes == 40);
+        ASSERT_TRUE(matches(index, 1499, 1499));
+    }
+
+    // A corrupt record among the uncovered ones cuts the log there.
+    std::filesystem::copy_file(dir / "covers1000.idx", idx,
+                               std::filesystem::copy_options::overwrite_existing);
+    {
+        std::fstream f(log, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(16 + 1200 * 80 + 40);
+        f.put('\x5a');
+    }
+    {
+        TxIndex index;
+        ASSERT_TRUE(index.open(path));
+        ASSERT_TRUE(index.stats().replayed == 200);
+        ASSERT_TRUE(index.stats().records == 1200);
+        ASSERT_TRUE(index.stats().droppedBytes == 300 * 80);
+        ASSERT_TRUE(matches(index, 1199, 1199));
+        TxIndexEntry e;
+        ASSERT_TRUE(!index.find(txidFor(1200), e));
+        ASSERT_TRUE(!index.find(txidFor(1300), e));
+        // Appends continue from the cut.
+        ASSERT_TRUE(index.append(entryFor(1300, 7)));
+        ASSERT_TRUE(matches(index, 1300, 7));
+    }
+
+    // Table lost entirely: rebuilt from the log.
+    std::filesystem::remove(idx);
+    {
+        TxIndex index;
+        ASSERT_TRUE(index.open(path));
+        ASSERT_TRUE(index.stats().replayed == 1201);
+        ASSERT_TRUE(index.size() == 1201);
+        ASSERT_TRUE(matches(index, 0, 0));
+        ASSERT_TRUE(matches(index, 1300, 7));
+    }
+
+    // Not an index at all.
+    {
+        std::ofstream out(log, std::ios::binary | std::ios::trunc);
+        out << "definitely not a txid index log";
+    }
+    TxIndex index;
+    std::string error;
+    ASSERT_TRUE(!index.open(path, &error));
+    ASSERT_TRUE(!error.empty());
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+static bool test_txindex_crash_before_sync() {
+    std::cout << "[TEST] txid index keeps durable records when a process dies before sync\n";
+
+    std::filesystem::path dir = freshDir("buds_txindex_crash");
+    std::string path = (dir / "tx").string();
+    {
+        TxIndex index;
+        ASSERT_TRUE(index.open(path));
+        ASSERT_TRUE(index.append(entryFor(7, 100)));
+        ASSERT_TRUE(index.sync());
+    }
+
+    // The child re-appends tx 7 (repointing its slot at a record that only
+    // lives in memory), adds tx 9, and dies without syncing or closing.
+    pid_t child = fork();
+    ASSERT_TRUE(child >= 0);
+    if (child == 0) {
+        TxIndex* index = new TxIndex();
+        bool ok = index->open(path) && index->append(entryFor(7, 200)) && index->append(entryFor(9, 9));
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_TRUE(waitpid(child, &status, 0) == child);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    TxIndex index;
+    ASSERT_TRUE(index.open(path));
+    ASSERT_TRUE(index.stats().records == 1);
+    ASSERT_TRUE(index.size() == 1);
+    ASSERT_TRUE(matches(index, 7, 100));
+    TxIndexEntry e;
+    ASSERT_TRUE(!index.find(txidFor(9), e));
+    index.close();
+
+    // A clean reopen after that recovery needs no replay.
+    ASSERT_TRUE(index.open(path));
+    ASSERT_TRUE(index.stats().replayed == 0);
+    ASSERT_TRUE(matches(index, 7, 100));
+    index.close();
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+int main() {
+    if (!test_txindex_append_find_reopen()) return 1;
+    if (!test_txindex_recovery()) return 1;
+    if (!test_txindex_crash_before_sync()) return 1;
+
+    std::cout << "All BUDS txid index tests passed.\n";
+    return 0;
+}